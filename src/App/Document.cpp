@@ -65,6 +65,11 @@ recompute path. Also enables more complicated dependencies beyond trees.
 #include <boost/bind.hpp>
 #include <boost/regex.hpp>
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QtConcurrentMap>
 
 #include "Document.h"
 #include "DocumentPy.h"
@@ -143,6 +148,15 @@ struct DocumentP
     int iUndoMode;
     unsigned int UndoMemSize;
     unsigned int UndoMaxStackSize;
+    // parallel recompute
+    bool parallelRecompute;
+    bool parallelRunning;
+    QMutex recomputeMutex;
+    std::vector<std::pair<const DocumentObject*, const Property*> > pendingChanges;
+    // dependency graph that is kept up-to-date on link changes
+    std::map<const DocumentObject*, std::vector<DocumentObject*> > outLists;
+    std::map<const DocumentObject*, std::vector<DocumentObject*> > inLists;
+    bool dependenciesValid;
 
     DocumentP() {
         activeObject = 0;
@@ -155,11 +169,112 @@ struct DocumentP
         iUndoMode = 0;
         UndoMemSize = 0;
         UndoMaxStackSize = 20;
+        parallelRecompute = false;
+        parallelRunning = false;
+        dependenciesValid = false;
     }
 };
 
+/// The outcome of a DocumentObject::recompute() call, possibly run in a worker thread
+struct RecomputeResult
+{
+    enum Status {
+        Success,        // execute() returned normally
+        Abort,          // user abort, stops the recompute
+        NoMemory,       // out of memory, stops the recompute
+        Exception,      // Base::Exception, the recompute goes on
+        StdException,   // std::exception, the recompute goes on
+        Unknown,        // unknown exception, stops the recompute
+        Skipped         // not executed because another object of the level stopped the recompute
+    };
+
+    RecomputeResult() : Feat(0), ReturnCode(0), Code(Success) {}
+
+    DocumentObject* Feat;
+    DocumentObjectExecReturn* ReturnCode;
+    Status Code;
+    std::string Why;
+};
+
 } // namespace App
 
+namespace {
+// Executes the object and catches every exception. Nothing in here may write to the
+// recompute log or the console because this function is also called from worker threads.
+App::RecomputeResult executeFeature(App::DocumentObject* Feat)
+{
+    App::RecomputeResult res;
+    res.Feat = Feat;
+    try {
+        res.ReturnCode = Feat->recompute();
+    }
+    catch (Base::AbortException &e) {
+        res.Code = App::RecomputeResult::Abort;
+        res.Why = e.what();
+    }
+    catch (const Base::MemoryException& e) {
+        res.Code = App::RecomputeResult::NoMemory;
+        res.Why = e.what();
+    }
+    catch (Base::Exception &e) {
+        res.Code = App::RecomputeResult::Exception;
+        res.Why = e.what();
+    }
+    catch (std::exception &e) {
+        res.Code = App::RecomputeResult::StdException;
+        res.Why = e.what();
+    }
+#ifndef FC_DEBUG
+    catch (...) {
+        res.Code = App::RecomputeResult::Unknown;
+    }
+#endif
+    return res;
+}
+
+// Runs executeFeature() in a worker thread. Once an object stopped the recompute the
+// objects of the level that are not yet started are skipped.
+struct ExecuteFeatureInThread
+{
+    typedef App::RecomputeResult result_type;
+
+    ExecuteFeatureInThread(QAtomicInt* stop) : stop(stop) {}
+
+    App::RecomputeResult operator()(App::DocumentObject* Feat) const
+    {
+        if (*stop) {
+            App::RecomputeResult res;
+            res.Feat = Feat;
+            res.Code = App::RecomputeResult::Skipped;
+            return res;
+        }
+
+        App::RecomputeResult res = executeFeature(Feat);
+        if (res.Code == App::RecomputeResult::Abort ||
+            res.Code == App::RecomputeResult::NoMemory ||
+            res.Code == App::RecomputeResult::Unknown)
+            stop->fetchAndStoreOrdered(1);
+        return res;
+    }
+
+    QAtomicInt* stop;
+};
+
+// Python features never leave the main thread because of the GIL
+bool canRecomputeInThread(App::DocumentObject* Feat)
+{
+    return Feat->canRecomputeInThread() && Feat->getPropertyByName("Proxy") == 0;
+}
+
+bool isLinkProperty(const App::Property* prop)
+{
+    return prop->isDerivedFrom(App::PropertyLink::getClassTypeId()) ||
+           prop->isDerivedFrom(App::PropertyLinkSub::getClassTypeId()) ||
+           prop->isDerivedFrom(App::PropertyLinkList::getClassTypeId()) ||
+           prop->isDerivedFrom(App::PropertyLinkSubList::getClassTypeId());
+}
+}
+
 PROPERTY_SOURCE(App::Document, App::PropertyContainer)
 
 void Document::writeDependencyGraphViz(std::ostream &out)
@@ -396,7 +511,28 @@ int Document::getUndoMode(void) const
 
 unsigned int Document::getUndoMemSize (void) const
 {
-    return d->UndoMemSize;
+    // data that the undo copies share with the document costs no extra memory
+    std::set<const void*> sharedData;
+    std::vector<Property*> props;
+    for (std::vector<DocumentObject*>::const_iterator it = d->objectArray.begin(); it != d->objectArray.end(); ++it) {
+        props.clear();
+        (*it)->getPropertyList(props);
+        for (std::vector<Property*>::const_iterator jt = props.begin(); jt != props.end(); ++jt) {
+            const void* data = (*jt)->getSharedData();
+            if (data)
+                sharedData.insert(data);
+        }
+    }
+
+    unsigned int size = 0;
+    std::list<Transaction*>::const_iterator It;
+    for (It = mUndoTransactions.begin(); It != mUndoTransactions.end(); ++It)
+        size += (*It)->getMemSize(sharedData);
+    for (It = mRedoTransactions.begin(); It != mRedoTransactions.end(); ++It)
+        size += (*It)->getMemSize(sharedData);
+    if (d->activeUndoTransaction)
+        size += d->activeUndoTransaction->getMemSize(sharedData);
+    return size;
 }
 
 void Document::setUndoLimit(unsigned int UndoMemSize)
@@ -421,19 +557,104 @@ void Document::onChanged(const Property* prop)
         App::GetApplication().signalRelabelDocument(*this);
 }
 
-void Document::onBeforeChangeProperty(const DocumentObject *Who, const Property *What)
+void Document::onBeforeChangeProperty(const DocumentObject *Who, const Property *What, int start, int count)
 {
+    // a null mutex is not locked, only parallel recomputes need the lock
+    QMutexLocker locker(d->parallelRunning ? &d->recomputeMutex : 0);
     if (d->activeUndoTransaction && !d->rollback)
-        d->activeUndoTransaction->addObjectChange(Who,What);
+        d->activeUndoTransaction->addObjectChange(Who,What,start,count);
 }
 
 void Document::onChangedProperty(const DocumentObject *Who, const Property *What)
 {
+    if (d->parallelRunning) {
+        // the observers are not thread-safe, so the signal is emitted later
+        // from the main thread, see _flushPendingChanges()
+        QMutexLocker locker(&d->recomputeMutex);
+        if (d->activeTransaction && !d->rollback)
+            d->activeTransaction->addObjectChange(Who,What);
+        if (isLinkProperty(What))
+            _updateDependencies(Who);
+        d->pendingChanges.push_back(std::make_pair(Who,What));
+        return;
+    }
+
     if (d->activeTransaction && !d->rollback)
         d->activeTransaction->addObjectChange(Who,What);
+    if (isLinkProperty(What))
+        _updateDependencies(Who);
     signalChangedObject(*Who, *What);
 }
 
+void Document::_updateDependencies(const DocumentObject* obj)
+{
+    if (!d->dependenciesValid)
+        return; // will be rebuilt completely on the next recompute
+
+    // remove the old edges
+    std::vector<DocumentObject*>& OutList = d->outLists[obj];
+    for (std::vector<DocumentObject*>::iterator it = OutList.begin(); it != OutList.end(); ++it) {
+        std::vector<DocumentObject*>& InList = d->inLists[*it];
+        std::vector<DocumentObject*>::iterator pos = std::find(InList.begin(), InList.end(), obj);
+        if (pos != InList.end())
+            InList.erase(pos);
+    }
+
+    // and add the new ones
+    OutList = obj->getOutList();
+    for (std::vector<DocumentObject*>::iterator it = OutList.begin(); it != OutList.end(); ++it)
+        d->inLists[*it].push_back(const_cast<DocumentObject*>(obj));
+}
+
+void Document::_removeDependencies(const DocumentObject* obj)
+{
+    if (!d->dependenciesValid)
+        return;
+
+    std::vector<DocumentObject*>& OutList = d->outLists[obj];
+    for (std::vector<DocumentObject*>::iterator it = OutList.begin(); it != OutList.end(); ++it) {
+        std::vector<DocumentObject*>& InList = d->inLists[*it];
+        std::vector<DocumentObject*>::iterator pos = std::find(InList.begin(), InList.end(), obj);
+        if (pos != InList.end())
+            InList.erase(pos);
+    }
+    d->outLists.erase(obj);
+
+    // objects still linking to the removed object would keep a dangling pointer
+    std::map<const DocumentObject*, std::vector<DocumentObject*> >::iterator jt = d->inLists.find(obj);
+    if (jt != d->inLists.end() && !jt->second.empty())
+        d->dependenciesValid = false;
+    else
+        d->inLists.erase(obj);
+}
+
+void Document::_rebuildDependencies()
+{
+    d->outLists.clear();
+    d->inLists.clear();
+    for (std::vector<DocumentObject*>::const_iterator it = d->objectArray.begin(); it != d->objectArray.end(); ++it) {
+        std::vector<DocumentObject*>& OutList = d->outLists[*it];
+        OutList = (*it)->getOutList();
+        for (std::vector<DocumentObject*>::iterator jt = OutList.begin(); jt != OutList.end(); ++jt)
+            d->inLists[*jt].push_back(*it);
+    }
+    d->dependenciesValid = true;
+}
+
+void Document::_flushPendingChanges()
+{
+    std::vector<std::pair<const DocumentObject*, const Property*> > changes;
+    changes.swap(d->pendingChanges);
+
+    std::set<std::pair<const DocumentObject*, const Property*> > done;
+    for (std::vector<std::pair<const DocumentObject*, const Property*> >::iterator
+        it = changes.begin(); it != changes.end(); ++it) {
+        // emit each change only once but keep the order of the first occurrence
+        if (done.insert(*it).second)
+            signalChangedObject(*it->first, *it->second);
+    }
+}
+
 void Document::setTransactionMode(int iMode)
 {
     /*  if(_iTransactionMode == 0 && iMode == 1)
@@ -527,6 +748,9 @@ Document::Document(void)
         TransDir.createDirectory();
     ADD_PROPERTY_TYPE(TransientDir,(TransDir.filePath().c_str()),0,Prop_Transient,
         "Transient directory, where the files live while the document is open");
+
+    d->parallelRecompute = GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Document")->GetBool("ParallelRecompute",false);
 }
 
 Document::~Document()
@@ -719,6 +943,7 @@ void Document::Restore(Base::XMLReader &reader)
     }
 
     reader.readEndElement("Document");
+    d->dependenciesValid = false;
 }
 
 void Document::exportObjects(const std::vector<App::DocumentObject*>& obj,
@@ -826,6 +1051,7 @@ Document::importObjects(std::istream& input)
     // reset all touched
     for (std::vector<DocumentObject*>::iterator it= objs.begin();it!=objs.end();++it)
         (*it)->purgeTouched();
+    d->dependenciesValid = false;
     return objs;
 }
 
@@ -895,6 +1121,8 @@ bool Document::save (void)
 
             writer.setComment("FreeCAD Document");
             writer.setLevel(compression);
+            writer.setParallel(App::GetApplication().GetParameterGroupByPath
+                ("User parameter:BaseApp/Preferences/Document")->GetBool("ParallelSave",false));
             writer.putNextEntry("Document.xml");
 
             Document::Save(writer);
@@ -1110,19 +1338,49 @@ void Document::recompute()
         delete *it;
     _RecomputeLog.clear();
 
+    if (!d->dependenciesValid)
+        _rebuildDependencies();
+
+    // Only the touched objects and everything that depends on them can change.
+    // Collect this downstream closure with the help of the cached in-lists.
+    std::set<DocumentObject*> closure;
+    std::vector<DocumentObject*> stack;
+    for (std::vector<DocumentObject*>::const_iterator It = d->objectArray.begin(); It != d->objectArray.end(); ++It) {
+        if ((*It)->isTouched() || (*It)->mustExecute() != 0) {
+            if (closure.insert(*It).second)
+                stack.push_back(*It);
+        }
+    }
+    while (!stack.empty()) {
+        DocumentObject* Cur = stack.back();
+        stack.pop_back();
+        std::map<const DocumentObject*, std::vector<DocumentObject*> >::const_iterator pos = d->inLists.find(Cur);
+        if (pos == d->inLists.end())
+            continue;
+        for (std::vector<DocumentObject*>::const_iterator It = pos->second.begin(); It != pos->second.end(); ++It) {
+            if (closure.insert(*It).second)
+                stack.push_back(*It);
+        }
+    }
+
+    if (closure.empty())
+        return;
+
     DependencyList DepList;
     std::map<DocumentObject*,Vertex> VertexObjectList;
 
     // Filling up the adjacency List
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It)
+    for (std::set<DocumentObject*>::const_iterator It = closure.begin(); It != closure.end();++It)
         // add the object as Vertex and remember the index
-        VertexObjectList[It->second] = add_vertex(DepList);
-    // add the edges
-    for (std::map<std::string,DocumentObject*>::const_iterator It = d->objectMap.begin(); It != d->objectMap.end();++It) {
-        std::vector<DocumentObject*> OutList = It->second->getOutList();
-        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2)
-            if (*It2)
-                add_edge(VertexObjectList[It->second],VertexObjectList[*It2],DepList);
+        VertexObjectList[*It] = add_vertex(DepList);
+    // add the edges, objects outside the closure are untouched and can be ignored
+    for (std::set<DocumentObject*>::const_iterator It = closure.begin(); It != closure.end();++It) {
+        const std::vector<DocumentObject*>& OutList = d->outLists[*It];
+        for (std::vector<DocumentObject*>::const_iterator It2=OutList.begin();It2!=OutList.end();++It2) {
+            std::map<DocumentObject*,Vertex>::iterator pos = VertexObjectList.find(*It2);
+            if (pos != VertexObjectList.end())
+                add_edge(VertexObjectList[*It],pos->second,DepList);
+        }
     }
 
     std::list<Vertex> make_order;
@@ -1141,47 +1399,74 @@ void Document::recompute()
     for (std::map<DocumentObject*,Vertex>::const_iterator It1= VertexObjectList.begin();It1 != VertexObjectList.end(); ++It1)
         d->vertexMap[It1->second] = It1->first;
 
+    if (d->parallelRecompute) {
+        // An object's level is one more than the highest level of its dependencies.
+        // Hence all objects of the same level are independent of each other.
+        std::vector<int> level(num_vertices(DepList), 0);
+        std::vector< std::vector<DocumentObject*> > levels;
+        for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
+            for (boost::tie(j, jend) = out_edges(*i, DepList); j != jend; ++j)
+                level[*i] = std::max<int>(level[*i], level[target(*j, DepList)] + 1);
+            if (level[*i] >= (int)levels.size())
+                levels.resize(level[*i] + 1);
+            DocumentObject* Cur = d->vertexMap[*i];
+            if (Cur)
+                levels[level[*i]].push_back(Cur);
+        }
+
+        Base::TimeInfo start;
+        bool abort = _recomputeLevels(levels);
+        Base::Console().Log("Document::recompute: %d objects in %d levels took %.3f s\n",
+            (int)d->vertexMap.size(), (int)levels.size(),
+            Base::TimeInfo::diffTimeF(start, Base::TimeInfo()));
+        if (abort) {
+            d->vertexMap.clear();
+            return;
+        }
+    }
+    else {
 #ifdef FC_LOGFEATUREUPDATE
-    std::clog << "make ordering: " << std::endl;
+        std::clog << "make ordering: " << std::endl;
 #endif
 
-    for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
-        DocumentObject* Cur = d->vertexMap[*i];
-        if (!Cur) continue;
+        for (std::list<Vertex>::reverse_iterator i = make_order.rbegin();i != make_order.rend(); ++i) {
+            DocumentObject* Cur = d->vertexMap[*i];
+            if (!Cur) continue;
 #ifdef FC_LOGFEATUREUPDATE
-        std::clog << Cur->getNameInDocument() << " dep on: " ;
+            std::clog << Cur->getNameInDocument() << " dep on: " ;
 #endif
-        bool NeedUpdate = false;
-
-        // ask the object if it should be recomputed
-        if (Cur->mustExecute() == 1)
-            NeedUpdate = true;
-        else {// if (Cur->mustExecute() == -1)
-            // update if one of the dependencies is touched
-            for (boost::tie(j, jend) = out_edges(*i, DepList); j != jend; ++j) {
-                DocumentObject* Test = d->vertexMap[target(*j, DepList)];
-                if (!Test) continue;
+            bool NeedUpdate = false;
+
+            // ask the object if it should be recomputed
+            if (Cur->mustExecute() == 1)
+                NeedUpdate = true;
+            else {// if (Cur->mustExecute() == -1)
+                // update if one of the dependencies is touched
+                for (boost::tie(j, jend) = out_edges(*i, DepList); j != jend; ++j) {
+                    DocumentObject* Test = d->vertexMap[target(*j, DepList)];
+                    if (!Test) continue;
 #ifdef FC_LOGFEATUREUPDATE
-                std::clog << Test->getNameInDocument() << ", " ;
+                    std::clog << Test->getNameInDocument() << ", " ;
 #endif
-                if (Test->isTouched()) {
-                    NeedUpdate = true;
-                    break;
+                    if (Test->isTouched()) {
+                        NeedUpdate = true;
+                        break;
+                    }
                 }
-            }
 #ifdef FC_LOGFEATUREUPDATE
-            std::clog << std::endl;
+                std::clog << std::endl;
 #endif
-        }
-        // if one touched recompute
-        if (NeedUpdate) {
+            }
+            // if one touched recompute
+            if (NeedUpdate) {
 #ifdef FC_LOGFEATUREUPDATE
-            std::clog << "Recompute" << std::endl;
+                std::clog << "Recompute" << std::endl;
 #endif
-            if (_recomputeFeature(Cur)) {
-                // if somthing happen break execution of recompute
-                d->vertexMap.clear();
-                return;
+                if (_recomputeFeature(Cur)) {
+                    // if somthing happen break execution of recompute
+                    d->vertexMap.clear();
+                    return;
+                }
             }
         }
     }
@@ -1194,6 +1479,73 @@ void Document::recompute()
     d->vertexMap.clear();
 }
 
+bool Document::_recomputeLevels(const std::vector< std::vector<DocumentObject*> >& levels)
+{
+    for (std::vector< std::vector<DocumentObject*> >::const_iterator it = levels.begin(); it != levels.end(); ++it) {
+        std::vector<DocumentObject*> parallel, serial;
+        for (std::vector<DocumentObject*>::const_iterator jt = it->begin(); jt != it->end(); ++jt) {
+            DocumentObject* Cur = *jt;
+            bool NeedUpdate = (Cur->mustExecute() == 1);
+            if (!NeedUpdate) {
+                // all dependencies are in lower levels and thus already done
+                std::vector<DocumentObject*> OutList = Cur->getOutList();
+                for (std::vector<DocumentObject*>::iterator kt = OutList.begin(); kt != OutList.end(); ++kt) {
+                    if (*kt && (*kt)->isTouched()) {
+                        NeedUpdate = true;
+                        break;
+                    }
+                }
+            }
+            if (NeedUpdate) {
+                if (canRecomputeInThread(Cur))
+                    parallel.push_back(Cur);
+                else
+                    serial.push_back(Cur);
+            }
+        }
+
+        bool abort = false;
+        if (parallel.size() > 1) {
+            QAtomicInt stop(0);
+            d->parallelRunning = true;
+            QFuture<RecomputeResult> future = QtConcurrent::mapped(parallel, ExecuteFeatureInThread(&stop));
+            future.waitForFinished();
+            d->parallelRunning = false;
+            _flushPendingChanges();
+
+            // handle the results in the order of the level, independent of the thread scheduling
+            for (QFuture<RecomputeResult>::const_iterator jt = future.begin(); jt != future.end(); ++jt) {
+                if (_processRecomputeResult(*jt))
+                    abort = true;
+            }
+        }
+        else if (parallel.size() == 1) {
+            serial.insert(serial.begin(), parallel.front());
+        }
+
+        for (std::vector<DocumentObject*>::iterator jt = serial.begin(); jt != serial.end() && !abort; ++jt) {
+            if (_recomputeFeature(*jt))
+                abort = true;
+        }
+
+        // if somthing happen break execution of recompute
+        if (abort)
+            return true;
+    }
+
+    return false;
+}
+
+void Document::setParallelRecompute(bool on)
+{
+    d->parallelRecompute = on;
+}
+
+bool Document::isParallelRecompute() const
+{
+    return d->parallelRecompute;
+}
+
 const char * Document::getErrorDescription(const App::DocumentObject*Obj) const
 {
     for (std::vector<App::DocumentObjectExecReturn*>::const_iterator it=_RecomputeLog.begin();it!=_RecomputeLog.end();++it)
@@ -1209,44 +1561,48 @@ bool Document::_recomputeFeature(DocumentObject* Feat)
     std::clog << "Solv: Executing Feature: " << Feat->getNameInDocument() << std::endl;;
 #endif
 
-    DocumentObjectExecReturn  *returnCode = 0;
-    try {
-        returnCode = Feat->recompute();
-    }
-    catch(Base::AbortException &e){
-        e.ReportException();
+    return _processRecomputeResult(executeFeature(Feat));
+}
+
+// writes the outcome of a recompute into the log. Returns true if the recompute must be stopped.
+bool Document::_processRecomputeResult(const RecomputeResult& res)
+{
+    DocumentObject* Feat = res.Feat;
+    switch (res.Code) {
+    case RecomputeResult::Abort:
+        Base::AbortException(res.Why.c_str()).ReportException();
         _RecomputeLog.push_back(new DocumentObjectExecReturn("User abort",Feat));
         Feat->setError();
         return true;
-    }
-    catch (const Base::MemoryException& e) {
-        Base::Console().Error("Memory exception in feature '%s' thrown: %s\n",Feat->getNameInDocument(),e.what());
+    case RecomputeResult::NoMemory:
+        Base::Console().Error("Memory exception in feature '%s' thrown: %s\n",Feat->getNameInDocument(),res.Why.c_str());
         _RecomputeLog.push_back(new DocumentObjectExecReturn("Out of memory exception",Feat));
         Feat->setError();
         return true;
-    }
-    catch (Base::Exception &e) {
-        e.ReportException();
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
+    case RecomputeResult::Exception:
+        Base::Exception(res.Why.c_str()).ReportException();
+        _RecomputeLog.push_back(new DocumentObjectExecReturn(res.Why,Feat));
         Feat->setError();
         return false;
-    }
-    catch (std::exception &e) {
-        Base::Console().Warning("exception in Feature \"%s\" thrown: %s\n",Feat->getNameInDocument(),e.what());
-        _RecomputeLog.push_back(new DocumentObjectExecReturn(e.what(),Feat));
+    case RecomputeResult::StdException:
+        Base::Console().Warning("exception in Feature \"%s\" thrown: %s\n",Feat->getNameInDocument(),res.Why.c_str());
+        _RecomputeLog.push_back(new DocumentObjectExecReturn(res.Why,Feat));
         Feat->setError();
         return false;
-    }
-#ifndef FC_DEBUG
-    catch (...) {
+    case RecomputeResult::Unknown:
         Base::Console().Error("App::Document::_RecomputeFeature(): Unknown exception in Feature \"%s\" thrown\n",Feat->getNameInDocument());
         _RecomputeLog.push_back(new DocumentObjectExecReturn("Unknown exeption!"));
         Feat->setError();
         return true;
+    case RecomputeResult::Skipped:
+        // stays touched for the next recompute
+        return false;
+    default:
+        break;
     }
-#endif
 
     // error code
+    DocumentObjectExecReturn *returnCode = res.ReturnCode;
     if (returnCode == DocumentObject::StdReturn) {
         Feat->resetError();
     }
@@ -1331,6 +1687,7 @@ void Document::_addObject(DocumentObject* pcObject, const char* pObjectName)
     d->objectArray.push_back(pcObject);
     // cache the pointer to the name string in the Object (for performance of DocumentObject::getNameInDocument())
     pcObject->pcNameInDocument = &(d->objectMap.find(pObjectName)->first);
+    _updateDependencies(pcObject);
 
     // do no transactions if we do a rollback!
     if(!d->rollback){
@@ -1372,6 +1729,7 @@ void Document::remObject(const char* sName)
 
     // Before deleting we must nullify all dependant objects
     breakDependency(pos->second, true);
+    _removeDependencies(pos->second);
 
     // do no transactions if we do a rollback!
     if(!d->rollback){
@@ -1428,6 +1786,7 @@ void Document::_remObject(DocumentObject* pcObject)
     }
     // remove from map
     d->objectMap.erase(pos);
+    _removeDependencies(pcObject);
     //// set name cache false
     //pcObject->pcNameInDocument = 0;
 
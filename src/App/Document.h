@@ -51,6 +51,7 @@ namespace App
     class DocumentPy; // the python document class
     class Application;
     class Transaction;
+    struct RecomputeResult;
 }
 
 namespace App
@@ -187,6 +188,14 @@ public:
     void recompute();
     /// Recompute only one feature
     void recomputeFeature(DocumentObject* Feat);
+    /** Enables or disables the parallel recompute.
+     * In parallel mode all objects of the same dependency level are executed concurrently
+     * on worker threads. Python features are always executed in the main thread.
+     * The default is taken from the parameter BaseApp/Preferences/Document/ParallelRecompute.
+     */
+    void setParallelRecompute(bool);
+    /// Checks whether the parallel recompute is enabled
+    bool isParallelRecompute() const;
     /// get the error log from the recompute run
     const std::vector<App::DocumentObjectExecReturn*> &getRecomputeLog(void)const{return _RecomputeLog;}
     /// get the text of the error of a spezified object
@@ -268,12 +277,30 @@ protected:
     void breakDependency(DocumentObject* pcObject, bool clear);
 
     void onChanged(const Property* prop);
-    /// callback from the Document objects before property will be changed
-    void onBeforeChangeProperty(const DocumentObject *Who, const Property *What);
+    /** callback from the Document objects before property will be changed,
+     * a non-negative \a count restricts the change to a range of a list property
+     */
+    void onBeforeChangeProperty(const DocumentObject *Who, const Property *What, int start=0, int count=-1);
     /// callback from the Document objects after property was changed
     void onChangedProperty(const DocumentObject *Who, const Property *What);
     /// helper which Recompute only this feature
     bool _recomputeFeature(DocumentObject* Feat);
+    /// helper which recomputes the objects level by level
+    bool _recomputeLevels(const std::vector< std::vector<DocumentObject*> >&);
+    /// helper which writes the outcome of a recompute into the log
+    bool _processRecomputeResult(const RecomputeResult&);
+    /// emits the property changes that were queued during a parallel recompute
+    void _flushPendingChanges();
+    /** @name Incremental dependency graph
+     * The document caches the out- and in-lists of its objects. The cache is updated
+     * whenever a link property changes so that recompute() only needs to visit the
+     * touched objects and everything that depends on them.
+     */
+    //@{
+    void _updateDependencies(const DocumentObject*);
+    void _removeDependencies(const DocumentObject*);
+    void _rebuildDependencies();
+    //@}
     void _clearRedos();
 
 
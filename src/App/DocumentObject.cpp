@@ -179,6 +179,12 @@ void DocumentObject::onBeforeChange(const Property* prop)
         _pDoc->onBeforeChangeProperty(this,prop);
 }
 
+void DocumentObject::onBeforeChangeRange(const Property* prop, int start, int count)
+{
+    if (_pDoc)
+        _pDoc->onBeforeChangeProperty(this,prop,start,count);
+}
+
 /// get called by the container when a Property was changed
 void DocumentObject::onChanged(const Property* prop)
 {
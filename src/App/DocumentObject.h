@@ -123,6 +123,13 @@ public:
      * -1: the document examine all links of this object and if one is touched -> recompute
      */
     virtual short mustExecute(void) const;
+    /** Returns true if execute() may run in a worker thread during a parallel
+     * recompute. This requires that execute() only reads its own and its linked
+     * objects' properties, i.e. no user parameters or other global state.
+     * The default is false.
+     */
+    virtual bool canRecomputeInThread(void) const
+    { return false; }
 
     /// get the status Message
     const char *getStatusString(void) const;
@@ -177,6 +184,8 @@ protected:
 
     /// get called before the value is changed
     virtual void onBeforeChange(const Property* prop);
+    /// get called before only a range of a list is changed
+    virtual void onBeforeChangeRange(const Property* prop, int start, int count);
     /// get called by the container when a property was changed
     virtual void onChanged(const Property* prop);
     /// get called after a document has been fully restored
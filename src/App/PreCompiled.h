@@ -67,6 +67,7 @@
 #include <queue>
 #include <bitset>
 #include <exception>
+#include <algorithm>
 
 // Boost
 #include <boost/signals.hpp>
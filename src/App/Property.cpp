@@ -101,6 +101,12 @@ void Property::aboutToSetValue(void)
         father->onBeforeChange(this);
 }
 
+void Property::aboutToSetValue(int start, int count)
+{
+    if (father)
+        father->onBeforeChangeRange(this, start, count);
+}
+
 Property *Property::Copy(void) const 
 {
     // have to be reimplemented by a subclass!
@@ -29,12 +29,14 @@
 #include <Base/Persistence.h>
 #include <string>
 #include <bitset>
+#include <vector>
 
 
 namespace App
 {
 
 class PropertyContainer;
+class PropertyDelta;
 
 /** Base class of all properties
  * This is the father of all properties. Properties are objects which are used
@@ -95,6 +97,20 @@ public:
     virtual Property *Copy(void) const = 0;
     /// Paste the value from the property (mainly for Undo/Redo and transactions)
     virtual void Paste(const Property &from) = 0;
+    /** Returns an identifier of the data if Copy() shares it with the copy
+     * instead of duplicating it, or 0 otherwise. It is used to count the memory
+     * of shared data only once, see Document::getUndoMemSize().
+     */
+    virtual const void* getSharedData(void) const { return 0; }
+    /** Returns the old values of the elements [start, start+count) of a property
+     * holding an array, or 0 if the property can only be copied as a whole.
+     * If \a delta is given the range is added to it. Transactions keep such a
+     * record instead of a Copy() if the change was announced with
+     * aboutToSetValue(start, count).
+     */
+    virtual PropertyDelta *CopyRange(int /*start*/, int /*count*/, PropertyDelta* /*delta*/=0) const { return 0; }
+    /// Restores the values recorded by CopyRange() (mainly for Undo/Redo and transactions)
+    virtual void PasteRange(const PropertyDelta& /*from*/) {}
     /// Encodes an attribute upon saving.
     std::string encodeAttribute(const std::string&) const;
 
@@ -118,6 +134,8 @@ protected:
     void hasSetValue(void);
     /// Gets called by all setValue() methods before the value has changed
     void aboutToSetValue(void);
+    /// Gets called before only the elements [start, start+count) change, see CopyRange()
+    void aboutToSetValue(int start, int count);
 
 private:
     // forbidden
@@ -143,6 +161,52 @@ public:
     virtual int getSize(void) const =0;   
 };
 
+
+/** Base class of the records made by Property::CopyRange().
+ */
+class AppExport PropertyDelta
+{
+public:
+    virtual ~PropertyDelta() {}
+    virtual unsigned int getMemSize (void) const = 0;
+};
+
+/** Old values of some ranges of a list property.
+ * The ranges are kept in the order they were added and may overlap, hence
+ * they must be restored in reverse order.
+ */
+template <class T>
+class PropertyListDelta : public PropertyDelta
+{
+public:
+    /// Adds the values [first, last) as the old values of the range at \a start
+    template <class InputIt>
+    void addRange(int start, InputIt first, InputIt last) {
+        Range r;
+        r.start = start;
+        r.offset = values.size();
+        values.insert(values.end(), first, last);
+        r.count = static_cast<int>(values.size() - r.offset);
+        ranges.push_back(r);
+    }
+    std::size_t countRanges(void) const {return ranges.size();}
+    int getStart(std::size_t i) const {return ranges[i].start;}
+    int getCount(std::size_t i) const {return ranges[i].count;}
+    const T* getValues(std::size_t i) const {return &values[ranges[i].offset];}
+
+    virtual unsigned int getMemSize (void) const {
+        return static_cast<unsigned int>(ranges.size() * sizeof(Range) + values.size() * sizeof(T));
+    }
+
+private:
+    struct Range {
+        int start, count;
+        std::size_t offset;
+    };
+    std::vector<Range> ranges;
+    std::vector<T> values;
+};
+
 } // namespace App
 
 #endif // APP_PROPERTY_H
@@ -262,12 +262,8 @@ void PropertyContainer::Restore(Base::XMLReader &reader)
 
 void PropertyData::addProperty(const PropertyContainer *container,const char* PropName, Property *Prop, const char* PropertyGroup , PropertyType Type, const char* PropertyDocu)
 {
-  bool IsIn = false;
-  for (vector<PropertySpec>::const_iterator It = propertyData.begin(); It != propertyData.end(); ++It)
-    if(strcmp(It->Name,PropName)==0)
-      IsIn = true;
-
-  if( !IsIn )
+  // every instance registers its properties, only the first one adds them
+  if( nameIndex.find(PropName) == nameIndex.end() )
   {
     PropertySpec temp;
     temp.Name   = PropName;
@@ -275,15 +271,17 @@ void PropertyData::addProperty(const PropertyContainer *container,const char* Pr
     temp.Group  = PropertyGroup;
     temp.Type   = Type;
     temp.Docu   = PropertyDocu;
+    nameIndex[PropName] = propertyData.size();
+    offsetIndex.insert(std::make_pair(temp.Offset, propertyData.size()));
     propertyData.push_back(temp);
   }
 }
 
 const PropertyData::PropertySpec *PropertyData::findProperty(const PropertyContainer *container,const char* PropName) const
 {
-  for (vector<PropertyData::PropertySpec>::const_iterator It = propertyData.begin(); It != propertyData.end(); ++It)
-    if(strcmp(It->Name,PropName)==0)
-      return &(*It);
+  NameIndex::const_iterator It = nameIndex.find(PropName);
+  if(It != nameIndex.end())
+    return &propertyData[It->second];
 
   if(parentPropertyData)
       return parentPropertyData->findProperty(container,PropName);
@@ -295,10 +293,10 @@ const PropertyData::PropertySpec *PropertyData::findProperty(const PropertyConta
 {
   const int diff = (int) ((char*)prop - (char*)container);
 
-  for (vector<PropertyData::PropertySpec>::const_iterator It = propertyData.begin(); It != propertyData.end(); ++It)
-    if(diff == It->Offset)
-      return &(*It);
-  
+  OffsetIndex::const_iterator It = offsetIndex.find((short)diff);
+  if(It != offsetIndex.end() && It->first == diff)
+    return &propertyData[It->second];
+
   if(parentPropertyData)
       return parentPropertyData->findProperty(container,prop);
 
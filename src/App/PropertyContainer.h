@@ -25,6 +25,7 @@
 #define APP_PROPERTYCONTAINER_H
 
 #include <map>
+#include <boost/unordered_map.hpp>
 #include <Base/Persistence.h>
 
 namespace Base {
@@ -56,8 +57,14 @@ struct AppExport PropertyData
     const char * Docu;
     short Offset,Type;
   };
+  typedef boost::unordered_map<const char*, std::size_t, Base::CStringHasher, Base::CStringHasher> NameIndex;
+  typedef boost::unordered_map<short, std::size_t> OffsetIndex;
+
   // vector of all properties
   std::vector<PropertySpec> propertyData;
+  // the positions in propertyData by name and by offset, filled by addProperty()
+  NameIndex nameIndex;
+  OffsetIndex offsetIndex;
   const PropertyData *parentPropertyData;
 
   void addProperty(const PropertyContainer *container,const char* PropName, Property *Prop, const char* PropertyGroup= 0, PropertyType = Prop_None, const char* PropertyDocu= 0 );
@@ -159,6 +166,8 @@ protected:
   virtual void onChanged(const Property* /*prop*/){};
   /// get called before the value is changed
   virtual void onBeforeChange(const Property* /*prop*/){};
+  /// get called before only the elements [start, start+count) of a list are changed
+  virtual void onBeforeChangeRange(const Property* prop, int /*start*/, int /*count*/){onBeforeChange(prop);};
 
   //void hasChanged(Propterty* prop);
   static const  PropertyData * getPropertyDataPtr(void); 
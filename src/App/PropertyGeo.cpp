@@ -25,6 +25,7 @@
 
 #ifndef _PreComp_
 #	include <assert.h>
+#	include <algorithm>
 #endif
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -224,9 +225,27 @@ void PropertyVectorList::setValue(float x, float y, float z)
     hasSetValue();
 }
 
+static bool isSameVector(const Base::Vector3f& v1, const Base::Vector3f& v2)
+{
+    // must be exact, a tolerance would let undo miss small changes
+    return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z;
+}
+
 void PropertyVectorList::setValues(const std::vector<Base::Vector3f>& values)
 {
-    aboutToSetValue();
+    if (values.size() == _lValueList.size()) {
+        // record only the range between the first and the last modified value
+        std::size_t first = 0, last = values.size();
+        while (first < last && isSameVector(values[first], _lValueList[first]))
+            ++first;
+        while (last > first && isSameVector(values[last-1], _lValueList[last-1]))
+            --last;
+        if (first < last)
+            aboutToSetValue(static_cast<int>(first), static_cast<int>(last-first));
+    }
+    else {
+        aboutToSetValue();
+    }
     _lValueList = values;
     hasSetValue();
 }
@@ -298,9 +317,10 @@ void PropertyVectorList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<Base::Vector3f>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << it->x << it->y << it->z;
-    }
+    // a Base::Vector3f consists of three consecutive floats, so the list is
+    // written as one block in the same format as value by value
+    if (uCt > 0)
+        str.write(&_lValueList[0].x, 3 * _lValueList.size());
 }
 
 void PropertyVectorList::RestoreDocFile(Base::Reader &reader)
@@ -309,10 +329,11 @@ void PropertyVectorList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<Base::Vector3f> values(uCt);
-    for (std::vector<Base::Vector3f>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> it->x >> it->y >> it->z;
-    }
-    setValues(values);
+    if (uCt > 0)
+        str.read(&values[0].x, 3 * values.size());
+    aboutToSetValue();
+    _lValueList.swap(values);
+    hasSetValue();
 }
 
 Property *PropertyVectorList::Copy(void) const
@@ -329,6 +350,28 @@ void PropertyVectorList::Paste(const Property &from)
     hasSetValue();
 }
 
+PropertyDelta *PropertyVectorList::CopyRange(int start, int count, PropertyDelta* delta) const
+{
+    PropertyListDelta<Base::Vector3f> *d = delta
+        ? dynamic_cast<PropertyListDelta<Base::Vector3f>*>(delta)
+        : new PropertyListDelta<Base::Vector3f>();
+    d->addRange(start, _lValueList.begin()+start, _lValueList.begin()+start+count);
+    return d;
+}
+
+void PropertyVectorList::PasteRange(const PropertyDelta &from)
+{
+    const PropertyListDelta<Base::Vector3f>& delta = dynamic_cast<const PropertyListDelta<Base::Vector3f>&>(from);
+    // the ranges may overlap, so the first recorded values must be written last
+    for (std::size_t i = delta.countRanges(); i-- > 0; ) {
+        int start = delta.getStart(i);
+        int count = delta.getCount(i);
+        aboutToSetValue(start, count);
+        std::copy(delta.getValues(i), delta.getValues(i)+count, _lValueList.begin()+start);
+    }
+    hasSetValue();
+}
+
 unsigned int PropertyVectorList::getMemSize (void) const
 {
     return static_cast<unsigned int>(_lValueList.size() * sizeof(Base::Vector3f));
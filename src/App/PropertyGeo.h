@@ -134,6 +134,9 @@ public:
         _lValueList.operator[] (idx) = value;
     }
 
+    /** Sets the values. If the size doesn't change only the range of
+     * modified values is recorded for undo.
+     */
     void setValues (const std::vector<Base::Vector3f>& values);
 
     const std::vector<Base::Vector3f> &getValues(void) const {
@@ -148,9 +151,12 @@ public:
 
     virtual void SaveDocFile (Base::Writer &writer) const;
     virtual void RestoreDocFile(Base::Reader &reader);
+    virtual bool canSaveDocFileInThread() const {return true;}
 
     virtual Property *Copy(void) const;
     virtual void Paste(const Property &from);
+    virtual PropertyDelta *CopyRange(int start, int count, PropertyDelta* delta=0) const;
+    virtual void PasteRange(const PropertyDelta &from);
 
     virtual unsigned int getMemSize (void) const;
 
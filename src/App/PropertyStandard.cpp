@@ -26,6 +26,7 @@
 #ifndef _PreComp_
 # include <boost/version.hpp>
 # include <boost/filesystem/path.hpp>
+# include <algorithm>
 #endif
 
 /// Here the FreeCAD includes sorted by Base,App,Gui......
@@ -917,7 +918,19 @@ void PropertyFloatList::setValue(float lValue)
 
 void PropertyFloatList::setValues(const std::vector<float>& values)
 {
-    aboutToSetValue();
+    if (values.size() == _lValueList.size()) {
+        // record only the range between the first and the last modified value
+        std::size_t first = 0, last = values.size();
+        while (first < last && values[first] == _lValueList[first])
+            ++first;
+        while (last > first && values[last-1] == _lValueList[last-1])
+            --last;
+        if (first < last)
+            aboutToSetValue(static_cast<int>(first), static_cast<int>(last-first));
+    }
+    else {
+        aboutToSetValue();
+    }
     _lValueList = values;
     hasSetValue();
 }
@@ -992,9 +1005,8 @@ void PropertyFloatList::SaveDocFile (Base::Writer &writer) const
     Base::OutputStream str(writer.Stream());
     uint32_t uCt = (uint32_t)getSize();
     str << uCt;
-    for (std::vector<float>::const_iterator it = _lValueList.begin(); it != _lValueList.end(); ++it) {
-        str << *it;
-    }
+    if (uCt > 0)
+        str.write(&_lValueList[0], _lValueList.size());
 }
 
 void PropertyFloatList::RestoreDocFile(Base::Reader &reader)
@@ -1003,10 +1015,11 @@ void PropertyFloatList::RestoreDocFile(Base::Reader &reader)
     uint32_t uCt=0;
     str >> uCt;
     std::vector<float> values(uCt);
-    for (std::vector<float>::iterator it = values.begin(); it != values.end(); ++it) {
-        str >> *it;
-    }
-    setValues(values);
+    if (uCt > 0)
+        str.read(&values[0], values.size());
+    aboutToSetValue();
+    _lValueList.swap(values);
+    hasSetValue();
 }
 
 Property *PropertyFloatList::Copy(void) const
@@ -1023,6 +1036,28 @@ void PropertyFloatList::Paste(const Property &from)
     hasSetValue();
 }
 
+PropertyDelta *PropertyFloatList::CopyRange(int start, int count, PropertyDelta* delta) const
+{
+    PropertyListDelta<float> *d = delta
+        ? dynamic_cast<PropertyListDelta<float>*>(delta)
+        : new PropertyListDelta<float>();
+    d->addRange(start, _lValueList.begin()+start, _lValueList.begin()+start+count);
+    return d;
+}
+
+void PropertyFloatList::PasteRange(const PropertyDelta &from)
+{
+    const PropertyListDelta<float>& delta = dynamic_cast<const PropertyListDelta<float>&>(from);
+    // the ranges may overlap, so the first recorded values must be written last
+    for (std::size_t i = delta.countRanges(); i-- > 0; ) {
+        int start = delta.getStart(i);
+        int count = delta.getCount(i);
+        aboutToSetValue(start, count);
+        std::copy(delta.getValues(i), delta.getValues(i)+count, _lValueList.begin()+start);
+    }
+    hasSetValue();
+}
+
 unsigned int PropertyFloatList::getMemSize (void) const
 {
     return static_cast<unsigned int>(_lValueList.size() * sizeof(float));
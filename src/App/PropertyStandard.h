@@ -424,6 +424,9 @@ public:
     
     
     void set1Value (const int idx, float value){_lValueList.operator[] (idx) = value;}
+    /** Sets the values. If the size doesn't change only the range of
+     * modified values is recorded for undo.
+     */
     void setValues (const std::vector<float>& values);
     
     const std::vector<float> &getValues(void) const{return _lValueList;}
@@ -436,9 +439,12 @@ public:
     
     virtual void SaveDocFile (Base::Writer &writer) const;
     virtual void RestoreDocFile(Base::Reader &reader);
+    virtual bool canSaveDocFileInThread() const {return true;}
     
     virtual Property *Copy(void) const;
     virtual void Paste(const Property &from);
+    virtual PropertyDelta *CopyRange(int start, int count, PropertyDelta* delta=0) const;
+    virtual void PasteRange(const PropertyDelta &from);
     virtual unsigned int getMemSize (void) const;
 
 private:
@@ -685,6 +691,7 @@ public:
     
     virtual void SaveDocFile (Base::Writer &writer) const;
     virtual void RestoreDocFile(Base::Reader &reader);
+    virtual bool canSaveDocFileInThread() const {return true;}
     
     virtual Property *Copy(void) const;
     virtual void Paste(const Property &from);
@@ -84,7 +84,21 @@ Transaction::~Transaction()
 
 unsigned int Transaction::getMemSize (void) const
 {
-    return 0;
+    std::set<const void*> sharedData;
+    return getMemSize(sharedData);
+}
+
+unsigned int Transaction::getMemSize (std::set<const void*>& sharedData) const
+{
+    unsigned int size = 0;
+    std::map<const DocumentObject*,TransactionObject*>::const_iterator It;
+    for (It= _Objects.begin();It!=_Objects.end();++It) {
+        // a removed object is kept alive by the transaction, see ~Transaction()
+        if (It->second->status == TransactionObject::New && !It->first->pcNameInDocument)
+            size += It->first->getMemSize();
+        size += It->second->getMemSize(sharedData);
+    }
+    return size;
 }
 
 void Transaction::Save (Base::Writer &/*writer*/) const
@@ -165,7 +179,7 @@ void Transaction::addObjectDel(const DocumentObject *Obj)
     }
 }
 
-void Transaction::addObjectChange(const DocumentObject *Obj,const Property *Prop)
+void Transaction::addObjectChange(const DocumentObject *Obj,const Property *Prop,int start,int count)
 {
     std::map<const DocumentObject*,TransactionObject*>::iterator pos = _Objects.find(Obj);
     TransactionObject *To;
@@ -179,7 +193,10 @@ void Transaction::addObjectChange(const DocumentObject *Obj,const Property *Prop
         To->status = TransactionObject::Chn;
     }
 
-    To->setProperty(Prop);
+    if (count < 0)
+        To->setProperty(Prop);
+    else
+        To->setProperty(Prop,start,count);
 }
 
 
@@ -213,6 +230,9 @@ TransactionObject::~TransactionObject()
     std::map<const Property*,Property*>::const_iterator It;
     for (It=_PropChangeMap.begin();It!=_PropChangeMap.end();++It)
         delete It->second;
+    std::map<const Property*,PropertyDelta*>::const_iterator Jt;
+    for (Jt=_PropDeltaMap.begin();Jt!=_PropDeltaMap.end();++Jt)
+        delete Jt->second;
 }
 
 void TransactionObject::applyDel(Document &Doc, DocumentObject *pcObj)
@@ -243,19 +263,70 @@ void TransactionObject::applyChn(Document & /*Doc*/, DocumentObject * /*pcObj*/,
             for (It=_PropChangeMap.begin();It!=_PropChangeMap.end();++It)
                 const_cast<Property*>(It->first)->Paste(*(It->second));
         }
+        // a property is either in the change or in the delta map
+        std::map<const Property*,PropertyDelta*>::const_iterator Jt;
+        for (Jt=_PropDeltaMap.begin();Jt!=_PropDeltaMap.end();++Jt)
+            const_cast<Property*>(Jt->first)->PasteRange(*(Jt->second));
     }
 }
 
 void TransactionObject::setProperty(const Property* pcProp)
 {
     std::map<const Property*,Property*>::iterator pos = _PropChangeMap.find(pcProp);
-    if (pos == _PropChangeMap.end())
-        _PropChangeMap[pcProp] = pcProp->Copy();
+    if (pos == _PropChangeMap.end()) {
+        Property* copy = pcProp->Copy();
+        // the whole property changes after some of its ranges have already
+        // been changed in this transaction, so restore them in the copy
+        std::map<const Property*,PropertyDelta*>::iterator jt = _PropDeltaMap.find(pcProp);
+        if (jt != _PropDeltaMap.end()) {
+            copy->PasteRange(*(jt->second));
+            delete jt->second;
+            _PropDeltaMap.erase(jt);
+        }
+        _PropChangeMap[pcProp] = copy;
+    }
+}
+
+void TransactionObject::setProperty(const Property* pcProp, int start, int count)
+{
+    // the old value of the whole property is already kept
+    if (_PropChangeMap.find(pcProp) != _PropChangeMap.end())
+        return;
+
+    std::map<const Property*,PropertyDelta*>::iterator pos = _PropDeltaMap.find(pcProp);
+    if (pos != _PropDeltaMap.end()) {
+        pcProp->CopyRange(start, count, pos->second);
+    }
+    else {
+        PropertyDelta* delta = pcProp->CopyRange(start, count);
+        if (delta)
+            _PropDeltaMap[pcProp] = delta;
+        else
+            _PropChangeMap[pcProp] = pcProp->Copy();
+    }
 }
 
 unsigned int TransactionObject::getMemSize (void) const
 {
-    return 0;
+    std::set<const void*> sharedData;
+    return getMemSize(sharedData);
+}
+
+unsigned int TransactionObject::getMemSize (std::set<const void*>& sharedData) const
+{
+    unsigned int size = 0;
+    std::map<const Property*,Property*>::const_iterator It;
+    for (It=_PropChangeMap.begin();It!=_PropChangeMap.end();++It) {
+        // data shared with the document or another transaction is counted only once
+        const void* data = It->second->getSharedData();
+        if (data && !sharedData.insert(data).second)
+            continue;
+        size += It->second->getMemSize();
+    }
+    std::map<const Property*,PropertyDelta*>::const_iterator Jt;
+    for (Jt=_PropDeltaMap.begin();Jt!=_PropDeltaMap.end();++Jt)
+        size += Jt->second->getMemSize();
+    return size;
 }
 
 void TransactionObject::Save (Base::Writer &/*writer*/) const
@@ -25,6 +25,7 @@
 #define APP_TRANSACTION_H
 
 #include <Base/Persistence.h>
+#include <set>
 
 namespace App
 {
@@ -32,6 +33,7 @@ namespace App
 class Document;
 class DocumentObject;
 class Property;
+class PropertyDelta;
 class Transaction;
 
 
@@ -52,8 +54,12 @@ public:
     void applyChn(Document &Doc, DocumentObject *pcObj,bool Forward);
 
     void setProperty(const Property* pcProp);
+    /// Records only the elements [start, start+count) if the property supports it
+    void setProperty(const Property* pcProp, int start, int count);
 
     virtual unsigned int getMemSize (void) const;
+    /// Returns the memory size without the shared data listed in \a sharedData and adds its own to it
+    unsigned int getMemSize (std::set<const void*>& sharedData) const;
     virtual void Save (Base::Writer &writer) const;
     /// This method is used to restore properties from an XML document.
     virtual void Restore(Base::XMLReader &reader);
@@ -63,6 +69,7 @@ public:
 protected:
     enum Status {New,Del,Chn} status;
     std::map<const Property*,Property*> _PropChangeMap;
+    std::map<const Property*,PropertyDelta*> _PropDeltaMap;
     std::string _NameInDocument;
 };
 
@@ -87,6 +94,8 @@ public:
     std::string Name; 
 
     virtual unsigned int getMemSize (void) const;
+    /// Returns the memory size without the shared data listed in \a sharedData and adds its own to it
+    unsigned int getMemSize (std::set<const void*>& sharedData) const;
     virtual void Save (Base::Writer &writer) const;
     /// This method is used to restore properties from an XML document.
     virtual void Restore(Base::XMLReader &reader);
@@ -99,7 +108,8 @@ public:
 protected:
     void addObjectNew(DocumentObject *Obj);
     void addObjectDel(const DocumentObject *Obj);
-    void addObjectChange(const DocumentObject *Obj,const Property *Prop);
+    /// a non-negative \a count only records the given range of a list property
+    void addObjectChange(const DocumentObject *Obj,const Property *Prop,int start=0,int count=-1);
 
 private:
     int iPos;
@@ -396,15 +396,19 @@ bool ParameterGrp::HasGroup(const char* Name) const
 
 bool ParameterGrp::GetBool(const char* Name, bool bPreset) const
 {
-    // check if Element in group
-    DOMElement *pcElem = FindElement(_pGroupNode,"FCBool",Name);
+    QMutexLocker locker(&_cacheMutex);
+    std::map<std::string, CacheEntry<bool> >::iterator it = _BoolCache.find(Name);
+    if (it == _BoolCache.end()) {
+        CacheEntry<bool> entry;
+        // check if Element in group
+        DOMElement *pcElem = FindElement(_pGroupNode,"FCBool",Name);
+        entry.exists = (pcElem != 0);
+        // if yes check the value
+        entry.value = pcElem && !strcmp(StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str(),"1");
+        it = _BoolCache.insert(std::make_pair(std::string(Name), entry)).first;
+    }
     // if not return preset
-    if (!pcElem) return bPreset;
-    // if yes check the value and return
-    if (strcmp(StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str(),"1"))
-        return false;
-    else
-        return true;
+    return it->second.exists ? it->second.value : bPreset;
 }
 
 void  ParameterGrp::SetBool(const char* Name, bool bValue)
@@ -414,7 +418,7 @@ void  ParameterGrp::SetBool(const char* Name, bool bValue)
     // and set the vaue
     pcElem->setAttribute(XStr("Value").unicodeForm(), XStr(bValue?"1":"0").unicodeForm());
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 std::vector<bool> ParameterGrp::GetBools(const char * sFilter) const
@@ -463,12 +467,19 @@ std::vector<std::pair<std::string,bool> > ParameterGrp::GetBoolMap(const char *
 
 long ParameterGrp::GetInt(const char* Name, long lPreset) const
 {
-    // check if Element in group
-    DOMElement *pcElem = FindElement(_pGroupNode,"FCInt",Name);
+    QMutexLocker locker(&_cacheMutex);
+    std::map<std::string, CacheEntry<long> >::iterator it = _IntCache.find(Name);
+    if (it == _IntCache.end()) {
+        CacheEntry<long> entry;
+        // check if Element in group
+        DOMElement *pcElem = FindElement(_pGroupNode,"FCInt",Name);
+        entry.exists = (pcElem != 0);
+        // if yes check the value
+        entry.value = pcElem ? atol (StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str()) : 0;
+        it = _IntCache.insert(std::make_pair(std::string(Name), entry)).first;
+    }
     // if not return preset
-    if (!pcElem) return lPreset;
-    // if yes check the value and return
-    return atol (StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str());
+    return it->second.exists ? it->second.value : lPreset;
 }
 
 void  ParameterGrp::SetInt(const char* Name, long lValue)
@@ -480,7 +491,7 @@ void  ParameterGrp::SetInt(const char* Name, long lValue)
     sprintf(cBuf,"%li",lValue);
     pcElem->setAttribute(XStr("Value").unicodeForm(), XStr(cBuf).unicodeForm());
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 std::vector<long> ParameterGrp::GetInts(const char * sFilter) const
@@ -524,12 +535,19 @@ std::vector<std::pair<std::string,long> > ParameterGrp::GetIntMap(const char * s
 
 unsigned long ParameterGrp::GetUnsigned(const char* Name, unsigned long lPreset) const
 {
-    // check if Element in group
-    DOMElement *pcElem = FindElement(_pGroupNode,"FCUInt",Name);
+    QMutexLocker locker(&_cacheMutex);
+    std::map<std::string, CacheEntry<unsigned long> >::iterator it = _UnsignedCache.find(Name);
+    if (it == _UnsignedCache.end()) {
+        CacheEntry<unsigned long> entry;
+        // check if Element in group
+        DOMElement *pcElem = FindElement(_pGroupNode,"FCUInt",Name);
+        entry.exists = (pcElem != 0);
+        // if yes check the value
+        entry.value = pcElem ? strtoul (StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str(),0,10) : 0;
+        it = _UnsignedCache.insert(std::make_pair(std::string(Name), entry)).first;
+    }
     // if not return preset
-    if (!pcElem) return lPreset;
-    // if yes check the value and return
-    return strtoul (StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str(),0,10);
+    return it->second.exists ? it->second.value : lPreset;
 }
 
 void  ParameterGrp::SetUnsigned(const char* Name, unsigned long lValue)
@@ -541,7 +559,7 @@ void  ParameterGrp::SetUnsigned(const char* Name, unsigned long lValue)
     sprintf(cBuf,"%lu",lValue);
     pcElem->setAttribute(XStr("Value").unicodeForm(), XStr(cBuf).unicodeForm());
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 std::vector<unsigned long> ParameterGrp::GetUnsigneds(const char * sFilter) const
@@ -585,12 +603,19 @@ std::vector<std::pair<std::string,unsigned long> > ParameterGrp::GetUnsignedMap(
 
 double ParameterGrp::GetFloat(const char* Name, double dPreset) const
 {
-    // check if Element in group
-    DOMElement *pcElem = FindElement(_pGroupNode,"FCFloat",Name);
+    QMutexLocker locker(&_cacheMutex);
+    std::map<std::string, CacheEntry<double> >::iterator it = _FloatCache.find(Name);
+    if (it == _FloatCache.end()) {
+        CacheEntry<double> entry;
+        // check if Element in group
+        DOMElement *pcElem = FindElement(_pGroupNode,"FCFloat",Name);
+        entry.exists = (pcElem != 0);
+        // if yes check the value
+        entry.value = pcElem ? atof (StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str()) : 0.0;
+        it = _FloatCache.insert(std::make_pair(std::string(Name), entry)).first;
+    }
     // if not return preset
-    if (!pcElem) return dPreset;
-    // if yes check the value and return
-    return atof (StrX(pcElem->getAttribute(XStr("Value").unicodeForm())).c_str());
+    return it->second.exists ? it->second.value : dPreset;
 }
 
 void  ParameterGrp::SetFloat(const char* Name, double dValue)
@@ -602,7 +627,7 @@ void  ParameterGrp::SetFloat(const char* Name, double dValue)
     sprintf(cBuf,"%.12f",dValue); // use %.12f instead of %f to handle values < 1.0e-6
     pcElem->setAttribute(XStr("Value").unicodeForm(), XStr(cBuf).unicodeForm());
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 std::vector<double> ParameterGrp::GetFloats(const char * sFilter) const
@@ -673,28 +698,30 @@ void  ParameterGrp::SetASCII(const char* Name, const char *sValue)
         pcElem2->setNodeValue(XUTF8Str(sValue).unicodeForm());
     }
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 
 }
 
 std::string ParameterGrp::GetASCII(const char* Name, const char * pPreset) const
 {
-    // check if Element in group
-    DOMElement *pcElem = FindElement(_pGroupNode,"FCText",Name);
-    // if not return preset
-    if (!pcElem) {
-        if (pPreset==0)
-            return std::string("");
-        else
-            return std::string(pPreset);
+    QMutexLocker locker(&_cacheMutex);
+    std::map<std::string, CacheEntry<std::string> >::iterator it = _ASCIICache.find(Name);
+    if (it == _ASCIICache.end()) {
+        CacheEntry<std::string> entry;
+        // check if Element in group, an element without text counts as not existing
+        DOMElement *pcElem = FindElement(_pGroupNode,"FCText",Name);
+        DOMNode *pcElem2 = pcElem ? pcElem->getFirstChild() : 0;
+        entry.exists = (pcElem2 != 0);
+        // if yes check the value
+        if (pcElem2)
+            entry.value = StrXUTF8(pcElem2->getNodeValue()).c_str();
+        it = _ASCIICache.insert(std::make_pair(std::string(Name), entry)).first;
     }
-    // if yes check the value and return
-    DOMNode *pcElem2 = pcElem->getFirstChild();
-    if (pcElem2)
-        return std::string(StrXUTF8(pcElem2->getNodeValue()).c_str());
+    // if not return preset
+    if (it->second.exists)
+        return it->second.value;
     else if (pPreset==0)
         return std::string("");
-
     else
         return std::string(pPreset);
 }
@@ -759,7 +786,7 @@ void ParameterGrp::RemoveGrp(const char* Name)
     else
         _pGroupNode->removeChild(pcElem);
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 void ParameterGrp::RemoveASCII(const char* Name)
@@ -772,7 +799,7 @@ void ParameterGrp::RemoveASCII(const char* Name)
     else
         _pGroupNode->removeChild(pcElem);
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 
 }
 
@@ -787,7 +814,7 @@ void ParameterGrp::RemoveBool(const char* Name)
         _pGroupNode->removeChild(pcElem);
 
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 void ParameterGrp::RemoveBlob(const char* /*Name*/)
@@ -814,7 +841,7 @@ void ParameterGrp::RemoveFloat(const char* Name)
         _pGroupNode->removeChild(pcElem);
 
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 void ParameterGrp::RemoveInt(const char* Name)
@@ -828,7 +855,7 @@ void ParameterGrp::RemoveInt(const char* Name)
         _pGroupNode->removeChild(pcElem);
 
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 void ParameterGrp::RemoveUnsigned(const char* Name)
@@ -842,7 +869,7 @@ void ParameterGrp::RemoveUnsigned(const char* Name)
         _pGroupNode->removeChild(pcElem);
 
     // trigger observer
-    Notify(Name);
+    NotifyChange(Name);
 }
 
 void ParameterGrp::Clear(void)
@@ -870,7 +897,7 @@ void ParameterGrp::Clear(void)
         pcTemp->release();
     }
     // trigger observer
-    Notify(0);
+    NotifyChange(0);
 }
 
 //**************************************************************************
@@ -929,32 +956,58 @@ XERCES_CPP_NAMESPACE_QUALIFIER DOMElement *ParameterGrp::FindOrCreateElement(XER
     return pcElem;
 }
 
+void ParameterGrp::_ResetCache(const char* Name)
+{
+    QMutexLocker locker(&_cacheMutex);
+    if (Name) {
+        _BoolCache.erase(Name);
+        _IntCache.erase(Name);
+        _UnsignedCache.erase(Name);
+        _FloatCache.erase(Name);
+        _ASCIICache.erase(Name);
+    }
+    else {
+        _BoolCache.clear();
+        _IntCache.clear();
+        _UnsignedCache.clear();
+        _FloatCache.clear();
+        _ASCIICache.clear();
+    }
+}
+
+void ParameterGrp::NotifyChange(const char* Name)
+{
+    // the observers may read the new value already
+    _ResetCache(Name);
+    Subject<const char*>::Notify(Name);
+}
+
 void ParameterGrp::NotifyAll()
 {
     // get all ints and notify
     std::vector<std::pair<std::string,long> > IntMap = GetIntMap();
     for (std::vector<std::pair<std::string,long> >::iterator It1= IntMap.begin(); It1 != IntMap.end(); It1++)
-        Notify(It1->first.c_str());
+        NotifyChange(It1->first.c_str());
 
     // get all booleans and notify
     std::vector<std::pair<std::string,bool> > BoolMap = GetBoolMap();
     for (std::vector<std::pair<std::string,bool> >::iterator It2= BoolMap.begin(); It2 != BoolMap.end(); It2++)
-        Notify(It2->first.c_str());
+        NotifyChange(It2->first.c_str());
 
     // get all Floats and notify
     std::vector<std::pair<std::string,double> > FloatMap  = GetFloatMap();
     for (std::vector<std::pair<std::string,double> >::iterator It3= FloatMap.begin(); It3 != FloatMap.end(); It3++)
-        Notify(It3->first.c_str());
+        NotifyChange(It3->first.c_str());
 
     // get all strings and notify
     std::vector<std::pair<std::string,std::string> > StringMap = GetASCIIMap();
     for (std::vector<std::pair<std::string,std::string> >::iterator It4= StringMap.begin(); It4 != StringMap.end(); It4++)
-        Notify(It4->first.c_str());
+        NotifyChange(It4->first.c_str());
 
     // get all uints and notify
     std::vector<std::pair<std::string,unsigned long> > UIntMap = GetUnsignedMap();
     for (std::vector<std::pair<std::string,unsigned long> >::iterator It5= UIntMap.begin(); It5 != UIntMap.end(); It5++)
-        Notify(It5->first.c_str());
+        NotifyChange(It5->first.c_str());
 }
 
 //**************************************************************************
@@ -1143,6 +1196,7 @@ int  ParameterManager::LoadDocument(const char* sFileName)
         throw Exception("Malformed Parameter document: Root group not found");
 
     _pGroupNode = FindElement(rootElem,"FCParamGroup","Root");
+    _ResetCache(0);
 
     if (!_pGroupNode)
         throw Exception("Malformed Parameter document: Root group not found");
@@ -1336,6 +1390,7 @@ void  ParameterManager::CreateDocument(void)
     _pGroupNode = _pDocument->createElement(XStr("FCParamGroup").unicodeForm());
     ((DOMElement*)_pGroupNode)->setAttribute(XStr("Name").unicodeForm(), XStr("Root").unicodeForm());
     rootElem->appendChild(_pGroupNode);
+    _ResetCache(0);
 
 
 }
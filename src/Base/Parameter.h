@@ -40,8 +40,10 @@
 #include <sstream>
 #endif
 #include <map>
+#include <string>
 #include <vector>
 #include <xercesc/util/XercesDefs.hpp>
+#include <QMutex>
 
 // Std. configurations
 #include "Handle.h"
@@ -213,6 +215,11 @@ public:
         return _cName.c_str();
     }
 
+    /** Resets the cached values of the entry \a Name, or of all entries if \a Name
+     * is 0, and notifies the observers. Every change of the group ends here, so the
+     * cache is never out of date.
+     */
+    void NotifyChange(const char* Name);
     /** Notifies all observers for all entries except of sub-groups.
      */
     void NotifyAll();
@@ -242,6 +249,9 @@ protected:
      */
     XERCES_CPP_NAMESPACE_QUALIFIER DOMElement *FindOrCreateElement(XERCES_CPP_NAMESPACE_QUALIFIER DOMElement *Start, const char* Type, const char* Name) const;
 
+    /// removes the cached values of \a Name or all cached values if \a Name is 0
+    void _ResetCache(const char* Name);
+
 
     /// DOM Node of the Base node of this group
     XERCES_CPP_NAMESPACE_QUALIFIER DOMElement *_pGroupNode;
@@ -250,9 +260,109 @@ protected:
     /// map of already exported groups
     std::map <std::string ,Base::Reference<ParameterGrp> > _GroupMap;
 
+    /** @name value cache
+     * The values already read from the DOM, including the information that an
+     * entry doesn't exist. The getters fill the cache, NotifyChange() resets it.
+     * The mutex guards the cache, so the getters can be called from worker threads
+     * as long as the group is not modified at the same time.
+     */
+    //@{
+    template <class T>
+    struct CacheEntry {
+        bool exists;
+        T value;
+    };
+    mutable std::map<std::string, CacheEntry<bool> > _BoolCache;
+    mutable std::map<std::string, CacheEntry<long> > _IntCache;
+    mutable std::map<std::string, CacheEntry<unsigned long> > _UnsignedCache;
+    mutable std::map<std::string, CacheEntry<double> > _FloatCache;
+    mutable std::map<std::string, CacheEntry<std::string> > _ASCIICache;
+    mutable QMutex _cacheMutex;
+    //@}
 };
 
 
+namespace Base {
+
+/** A single parameter of a group bound once. The value is kept up to date through
+ * the observer notifications of the group, reading it is as cheap as reading a
+ * member variable. This is meant for parameters that are queried very often, e.g.
+ * on every redraw.
+ * \code
+ * Base::ParameterFloat deviation(hGrp, "MeshDeviation", 0.2);
+ * ...
+ * double value = deviation.getValue();
+ * \endcode
+ * T must be one of bool, long, unsigned long, double or std::string.
+ * The classes live in the Base namespace because the parameter editor of the
+ * GUI has item classes with the same names.
+ */
+template <class T>
+class ParameterValue : public Observer<const char*>
+{
+public:
+    ParameterValue(ParameterGrp::handle hGrp, const char* Name, const T& Preset)
+      : _hGrp(hGrp), _cName(Name), _preset(Preset)
+    {
+        _value = read();
+        _hGrp->Attach(this);
+    }
+    ~ParameterValue()
+    {
+        _hGrp->Detach(this);
+    }
+
+    /// the current value of the parameter or the preset if it doesn't exist
+    const T& getValue() const
+    { return _value; }
+    operator const T&() const
+    { return _value; }
+
+    void OnChange(Subject<const char*>&, const char* Name)
+    {
+        if (!Name || _cName == Name)
+            _value = read();
+    }
+
+private:
+    T read() const;
+
+    // not copyable, each object is registered as observer
+    ParameterValue(const ParameterValue&);
+    ParameterValue& operator=(const ParameterValue&);
+
+private:
+    ParameterGrp::handle _hGrp;
+    std::string _cName;
+    T _preset;
+    T _value;
+};
+
+template <>
+inline bool ParameterValue<bool>::read() const
+{ return _hGrp->GetBool(_cName.c_str(), _preset); }
+template <>
+inline long ParameterValue<long>::read() const
+{ return _hGrp->GetInt(_cName.c_str(), _preset); }
+template <>
+inline unsigned long ParameterValue<unsigned long>::read() const
+{ return _hGrp->GetUnsigned(_cName.c_str(), _preset); }
+template <>
+inline double ParameterValue<double>::read() const
+{ return _hGrp->GetFloat(_cName.c_str(), _preset); }
+template <>
+inline std::string ParameterValue<std::string>::read() const
+{ return _hGrp->GetASCII(_cName.c_str(), _preset.c_str()); }
+
+typedef ParameterValue<bool>          ParameterBool;
+typedef ParameterValue<long>          ParameterInt;
+typedef ParameterValue<unsigned long> ParameterUnsigned;
+typedef ParameterValue<double>        ParameterFloat;
+typedef ParameterValue<std::string>   ParameterString;
+
+} // namespace Base
+
+
 /** The parameter manager class
  *  This class manages a parameter XML document.
  *  Does loding, saving and handling the DOM document.
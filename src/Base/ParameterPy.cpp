@@ -539,7 +539,7 @@ PyObject *ParameterGrpPy::PyNotify(PyObject *args)
     if (!PyArg_ParseTuple(args, "s", &pstr))     // convert args: Python->C 
         return NULL;                             // NULL triggers exception 
     PY_TRY {
-        _cParamGrp->Notify(pstr);
+        _cParamGrp->NotifyChange(pstr);
         Py_Return;
     }PY_CATCH;
 } 
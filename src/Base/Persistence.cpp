@@ -68,3 +68,8 @@ void Persistence::SaveDocFile (Writer &/*writer*/) const
 void Persistence::RestoreDocFile(Reader &/*reader*/)
 {
 }
+
+bool Persistence::canSaveDocFileInThread() const
+{
+    return false;
+}
@@ -146,6 +146,13 @@ public:
      * @see Base::Reader,Base::XMLReader
      */
     virtual void RestoreDocFile(Reader &/*reader*/);
+    /** Returns true if SaveDocFile() can be called from a worker thread.
+     * This allows the Base::ZipWriter to serialize and compress several files concurrently.
+     * Re-implement it only if SaveDocFile() just reads the own data and neither touches
+     * Python, the GUI nor requests further files with Writer::addFile().
+     * The default is false.
+     */
+    virtual bool canSaveDocFileInThread() const;
 };
 
 } //namespace Base
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef BASE_PLYTYPES_H
+#define BASE_PLYTYPES_H
+
+#include <cstring>
+#include <string>
+#include <boost/cstdint.hpp>
+
+#include "Swap.h"
+
+namespace Base {
+
+/** Value types of the properties in a PLY file. */
+enum PlyType {
+    PlyNone, PlyInt8, PlyUInt8, PlyInt16, PlyUInt16, PlyInt32, PlyUInt32, PlyFloat32, PlyFloat64
+};
+
+/** Returns the type for a type name of the PLY header or PlyNone if it is unknown. */
+inline PlyType plyType(const std::string& type)
+{
+    if (type == "char" || type == "int8")
+        return PlyInt8;
+    if (type == "uchar" || type == "uint8")
+        return PlyUInt8;
+    if (type == "short" || type == "int16")
+        return PlyInt16;
+    if (type == "ushort" || type == "uint16")
+        return PlyUInt16;
+    if (type == "int" || type == "int32")
+        return PlyInt32;
+    if (type == "uint" || type == "uint32")
+        return PlyUInt32;
+    if (type == "float" || type == "float32")
+        return PlyFloat32;
+    if (type == "double" || type == "float64")
+        return PlyFloat64;
+    return PlyNone;
+}
+
+/** Returns the size in bytes of a value of the given type. */
+inline std::size_t plySize(PlyType type)
+{
+    switch (type) {
+    case PlyInt8:
+    case PlyUInt8:
+        return 1;
+    case PlyInt16:
+    case PlyUInt16:
+        return 2;
+    case PlyInt32:
+    case PlyUInt32:
+    case PlyFloat32:
+        return 4;
+    case PlyFloat64:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+template <typename T>
+inline double readPly(const char* p, bool swap)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    if (swap)
+        Base::SwapEndian<T>(value);
+    return double(value);
+}
+
+/** Reads a value of the given type at \a p. The caller must make sure that
+ * plySize(type) bytes can be read.
+ */
+inline double readPly(PlyType type, const char* p, bool swap)
+{
+    switch (type) {
+    case PlyInt8:    return readPly<boost::int8_t>(p, swap);
+    case PlyUInt8:   return readPly<boost::uint8_t>(p, swap);
+    case PlyInt16:   return readPly<boost::int16_t>(p, swap);
+    case PlyUInt16:  return readPly<boost::uint16_t>(p, swap);
+    case PlyInt32:   return readPly<boost::int32_t>(p, swap);
+    case PlyUInt32:  return readPly<boost::uint32_t>(p, swap);
+    case PlyFloat32: return readPly<float>(p, swap);
+    case PlyFloat64: return readPly<double>(p, swap);
+    default:         return 0.0;
+    }
+}
+
+/** Checks whether the machine uses little endian byte order. */
+inline bool isLittleEndian()
+{
+    unsigned short value = 1;
+    return *reinterpret_cast<unsigned char*>(&value) == 1;
+}
+
+} // namespace Base
+
+#endif // BASE_PLYTYPES_H
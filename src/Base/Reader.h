@@ -154,7 +154,10 @@ public:
     //@{
     /// add a read request of a persistent object
     const char *addFile(const char* Name, Base::Persistence *Object);
-    /// process the requested file writes
+    /** process the requested file reads
+     * Unlike ZipWriter::writeFiles() this is not done in parallel: the entries are
+     * inflated and restored one after the other from the single zip stream.
+     */
     void readFiles(zipios::ZipInputStream &zipstream) const;
     /// get all registered file names
     const std::vector<std::string>& getFilenames() const;
@@ -144,6 +144,39 @@ OutputStream& OutputStream::operator << (double d)
     return *this;
 }
 
+template <class T>
+static void writeArray(std::ostream& out, bool swap, const T* values, std::size_t count)
+{
+    if (swap) {
+        for (std::size_t i = 0; i < count; i++) {
+            T v = values[i];
+            SwapEndian<T>(v);
+            out.write((const char*)&v, sizeof(T));
+        }
+    }
+    else {
+        out.write((const char*)values, count * sizeof(T));
+    }
+}
+
+OutputStream& OutputStream::write(const int32_t* values, std::size_t count)
+{
+    writeArray<int32_t>(_out, _swap, values, count);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const float* values, std::size_t count)
+{
+    writeArray<float>(_out, _swap, values, count);
+    return *this;
+}
+
+OutputStream& OutputStream::write(const double* values, std::size_t count)
+{
+    writeArray<double>(_out, _swap, values, count);
+    return *this;
+}
+
 InputStream::InputStream(std::istream &rin) : _in(rin)
 {
 }
@@ -226,6 +259,34 @@ InputStream& InputStream::operator >> (double& d)
     return *this;
 }
 
+template <class T>
+static void readArray(std::istream& in, bool swap, T* values, std::size_t count)
+{
+    in.read((char*)values, count * sizeof(T));
+    if (swap) {
+        for (std::size_t i = 0; i < count; i++)
+            SwapEndian<T>(values[i]);
+    }
+}
+
+InputStream& InputStream::read(int32_t* values, std::size_t count)
+{
+    readArray<int32_t>(_in, _swap, values, count);
+    return *this;
+}
+
+InputStream& InputStream::read(float* values, std::size_t count)
+{
+    readArray<float>(_in, _swap, values, count);
+    return *this;
+}
+
+InputStream& InputStream::read(double* values, std::size_t count)
+{
+    readArray<double>(_in, _swap, values, count);
+    return *this;
+}
+
 // ----------------------------------------------------------------------
 
 ByteArrayOStreambuf::ByteArrayOStreambuf(QByteArray& ba) : _buffer(new QBuffer(&ba))
@@ -76,6 +76,15 @@ public:
     OutputStream& operator << (float f);
     OutputStream& operator << (double d);
 
+    /** @name Arrays
+     * Unless the bytes must be swapped an array is written with a single call.
+     */
+    //@{
+    OutputStream& write(const int32_t* values, std::size_t count);
+    OutputStream& write(const float* values, std::size_t count);
+    OutputStream& write(const double* values, std::size_t count);
+    //@}
+
 private:
     OutputStream (const OutputStream&);
     void operator = (const OutputStream&);
@@ -106,6 +115,15 @@ public:
     InputStream& operator >> (float& f);
     InputStream& operator >> (double& d);
 
+    /** @name Arrays
+     * Unless the bytes must be swapped an array is read with a single call.
+     */
+    //@{
+    InputStream& read(int32_t* values, std::size_t count);
+    InputStream& read(float* values, std::size_t count);
+    InputStream& read(double* values, std::size_t count);
+    //@}
+
     operator bool() const
     {
         // test if _Ipfx succeeded
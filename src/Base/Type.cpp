@@ -24,8 +24,11 @@
 
 #ifndef _PreComp_
 # include <assert.h>
+# include <cstring>
 #endif
 
+#include <boost/unordered_map.hpp>
+
 /// Here the FreeCAD includes sorted by Base,App,Gui......
 #include "Type.h"
 #include "Exception.h"
@@ -49,9 +52,16 @@ struct Base::TypeData
   Type parent;
   Type type;
   Type::instantiationMethod instMethod;
+  /// the keys of all ancestors starting with the topmost one, ending with the type itself
+  std::vector<unsigned int> ancestors;
 };
 
-map<string,unsigned int> Type::typemap;
+namespace {
+// the keys point to the names in the type data
+typedef boost::unordered_map<const char*, unsigned int, CStringHasher, CStringHasher> TypeMap;
+TypeMap typemap;
+}
+
 vector<TypeData*>        Type::typedata;
 set<string>              Type::loadModuleSet;
 
@@ -144,10 +154,15 @@ const Type Type::createType(const Type parent, const char *name, instantiationMe
   Type newType;
   newType.index = Type::typedata.size();
   TypeData * typeData = new TypeData(name, newType, parent,method);
+  // the parent is always registered before, so isDerivedFrom() only needs to
+  // look at one position of this list
+  if (!parent.isBad())
+    typeData->ancestors = Type::typedata[parent.getKey()]->ancestors;
+  typeData->ancestors.push_back(newType.getKey());
   Type::typedata.push_back(typeData);
 
   // add to dictionary for fast lookup
-  Type::typemap[name] = newType.getKey();
+  typemap[typeData->name.c_str()] = newType.getKey();
 
   return newType;
 }
@@ -158,8 +173,10 @@ void Type::init(void)
   assert(Type::typedata.size() == 0);
 
 
-  Type::typedata.push_back(new TypeData("BadType"));
-  Type::typemap["BadType"] = 0;
+  TypeData * typeData = new TypeData("BadType");
+  typeData->ancestors.push_back(0);
+  Type::typedata.push_back(typeData);
+  typemap[typeData->name.c_str()] = 0;
 
 
 }
@@ -175,8 +192,8 @@ void Type::destruct(void)
 
 Type Type::fromName(const char *name)
 {
-  std::map<std::string,unsigned int>::const_iterator pos;
-  
+  TypeMap::const_iterator pos;
+
   pos = typemap.find(name);
   if(pos != typemap.end())
     return typedata[pos->second]->type;
@@ -196,15 +213,10 @@ const Type Type::getParent(void) const
 
 bool Type::isDerivedFrom(const Type type) const
 {
-  
-  Type temp(*this);
-  do {
-    if(temp == type)
-      return true;
-    temp = temp.getParent();
-  } while (temp != badType());
-
-  return false;
+  // type is an ancestor if it appears at its own depth in the list of ancestors
+  const std::vector<unsigned int>& ancestors = typedata[index]->ancestors;
+  std::size_t depth = typedata[type.index]->ancestors.size() - 1;
+  return depth < ancestors.size() && ancestors[depth] == type.index;
 }
 
 int Type::getAllDerivedFrom(const Type type, std::vector<Type> & List)
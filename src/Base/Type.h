@@ -30,12 +30,23 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <cstring>
+#include <boost/functional/hash.hpp>
 
 namespace Base
 {
 
 struct TypeData;
 
+/// hashes and compares C strings by their contents, for use as hash map keys
+struct CStringHasher
+{
+  std::size_t operator()(const char* s) const
+  { return boost::hash_range(s, s + std::strlen(s)); }
+  bool operator()(const char* s1, const char* s2) const
+  { return std::strcmp(s1, s2) == 0; }
+};
+
 
 /** Type system class
   Many of the classes in the FreeCAD must have their type
@@ -127,7 +138,6 @@ private:
   unsigned int index;
 
 
-  static std::map<std::string,unsigned int> typemap;
   static std::vector<TypeData*>     typedata;
 
   static std::set<std::string>  loadModuleSet;
@@ -37,6 +37,11 @@
 
 #include <algorithm>
 #include <locale>
+#include <zlib.h>
+
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
 
 using namespace Base;
 using namespace std;
@@ -98,7 +103,7 @@ bool Writer::isForceXML(void)
     return forceXML;
 }
 
-std::string Writer::addFile(const char* Name,const Base::Persistence *Object)
+std::string Writer::addFile(const char* Name,const Base::Persistence *Object, int level)
 {
     // always check isForceXML() before requesting a file!
     assert(isForceXML()==false);
@@ -106,6 +111,7 @@ std::string Writer::addFile(const char* Name,const Base::Persistence *Object)
     FileEntry temp;
     temp.FileName = getUniqueFileName(Name);
     temp.Object = Object;
+    temp.Level = level;
   
     FileList.push_back(temp);
 
@@ -169,29 +175,206 @@ void Writer::decInd(void)
 }
 
 ZipWriter::ZipWriter(const char* FileName) 
-  : ZipStream(FileName)
+  : ZipStream(FileName), level(6), parallel(false)
 {
-#ifdef _MSC_VER
-    ZipStream.imbue(std::locale::empty());
-#else
-    //FIXME: Check whether this is correct
-    ZipStream.imbue(std::locale::classic());
-#endif
-    ZipStream.precision(12);
-    ZipStream.setf(ios::fixed,ios::floatfield);
+    setupStream(ZipStream);
 }
 
 ZipWriter::ZipWriter(std::ostream& os) 
-  : ZipStream(os)
+  : ZipStream(os), level(6), parallel(false)
+{
+    setupStream(ZipStream);
+}
+
+void ZipWriter::setupStream(std::ostream& str)
 {
 #ifdef _MSC_VER
-    ZipStream.imbue(std::locale::empty());
+    str.imbue(std::locale::empty());
 #else
     //FIXME: Check whether this is correct
-    ZipStream.imbue(std::locale::classic());
+    str.imbue(std::locale::classic());
 #endif
-    ZipStream.precision(12);
-    ZipStream.setf(ios::fixed,ios::floatfield);
+    str.precision(12);
+    str.setf(ios::fixed,ios::floatfield);
+}
+
+namespace Base {
+
+/** Stream buffer that computes the CRC and deflates the data written to it
+ * chunk-wise into a string. Thus only the compressed data of a file is kept in memory.
+ */
+class DeflateStreambuf : public std::streambuf
+{
+public:
+    DeflateStreambuf(int level, std::string& out)
+      : out(out), stored(level == 0), open(false), failed(false)
+      , crc(crc32(0L, Z_NULL, 0)), size(0), buffer(65536), chunk(65536)
+    {
+        setp(&buffer[0], &buffer[0] + buffer.size());
+        if (!stored) {
+            zs.zalloc = Z_NULL;
+            zs.zfree = Z_NULL;
+            zs.opaque = Z_NULL;
+            // zip files contain raw deflate streams, i.e. without zlib header
+            int ret = deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+            if (ret == Z_OK)
+                open = true;
+            else
+                setError(ret);
+        }
+    }
+    ~DeflateStreambuf()
+    {
+        if (open)
+            deflateEnd(&zs);
+    }
+    /// compresses the remaining data and throws an exception if something went wrong
+    void finish()
+    {
+        compress(Z_FINISH);
+        if (open) {
+            deflateEnd(&zs);
+            open = false;
+        }
+        if (failed)
+            throw Base::Exception(error);
+    }
+    unsigned long getCrc() const
+    {
+        return crc;
+    }
+    unsigned long getSize() const
+    {
+        return size;
+    }
+
+protected:
+    int overflow(int c)
+    {
+        if (!compress(Z_NO_FLUSH))
+            return traits_type::eof();
+        if (c != traits_type::eof()) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync()
+    {
+        return compress(Z_NO_FLUSH) ? 0 : -1;
+    }
+
+private:
+    bool compress(int flush)
+    {
+        if (failed)
+            return false;
+        uInt len = (uInt)(pptr() - pbase());
+        crc = crc32(crc, (const Bytef*)pbase(), len);
+        size += len;
+        setp(&buffer[0], &buffer[0] + buffer.size());
+        if (stored) {
+            out.append(&buffer[0], len);
+            return true;
+        }
+
+        zs.next_in = (Bytef*)&buffer[0];
+        zs.avail_in = len;
+        int ret;
+        do {
+            zs.next_out = (Bytef*)&chunk[0];
+            zs.avail_out = (uInt)chunk.size();
+            ret = deflate(&zs, flush);
+            if (ret == Z_STREAM_ERROR) {
+                setError(ret);
+                return false;
+            }
+            out.append(&chunk[0], chunk.size() - zs.avail_out);
+        }
+        while (zs.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+        return true;
+    }
+    void setError(int ret)
+    {
+        std::stringstream str;
+        str << "Compression failed with zlib error " << ret;
+        if (ret == Z_MEM_ERROR)
+            str << " (out of memory)";
+        error = str.str();
+        failed = true;
+    }
+
+private:
+    std::string& out;
+    z_stream zs;
+    bool stored, open, failed;
+    std::string error;
+    unsigned long crc, size;
+    std::vector<char> buffer, chunk;
+};
+
+/** Writer that compresses everything written to its stream.
+ * It is used to save a single file in a worker thread.
+ */
+class DeflateWriter : public Writer
+{
+public:
+    DeflateWriter(int level, std::string& out) : buf(level, out), str(&buf) {}
+    virtual std::ostream &Stream(void){return str;}
+    virtual void writeFiles(void){assert(0);}
+    DeflateStreambuf& buffer(void){return buf;}
+
+private:
+    DeflateStreambuf buf;
+    std::ostream str;
+};
+
+}
+
+ZipWriter::RawEntry ZipWriter::compressFile(const FileEntry& entry)
+{
+    RawEntry raw;
+    raw.FileName = entry.FileName;
+    raw.Size = 0;
+    raw.Crc = 0;
+    raw.Stored = (entry.Level == 0);
+    raw.Failed = false;
+    raw.NoMemory = false;
+
+    // Exceptions must not leave the worker thread because QtConcurrent would
+    // replace them by an UnhandledException. They are re-thrown in writeFiles().
+    try {
+        // serialize the object with the same stream settings as the zip stream
+        DeflateWriter writer(entry.Level, raw.Data);
+        setupStream(writer.Stream());
+        entry.Object->SaveDocFile(writer);
+        writer.Stream().flush();
+        writer.buffer().finish();
+        raw.Size = writer.buffer().getSize();
+        raw.Crc = writer.buffer().getCrc();
+    }
+    catch (const Base::MemoryException&) {
+        raw.NoMemory = true;
+    }
+    catch (const Base::Exception& e) {
+        raw.Error = e.what();
+    }
+    catch (const std::bad_alloc&) {
+        raw.NoMemory = true;
+    }
+    catch (const std::exception& e) {
+        raw.Error = e.what();
+    }
+    catch (...) {
+        raw.Error = "Unknown exception while saving ";
+        raw.Error += entry.FileName;
+    }
+
+    if (raw.NoMemory || !raw.Error.empty()) {
+        raw.Failed = true;
+        std::string().swap(raw.Data);
+    }
+    return raw;
 }
 
 void ZipWriter::writeFiles(void)
@@ -200,8 +383,45 @@ void ZipWriter::writeFiles(void)
     // processing the files new ones can be added
     size_t index = 0;
     while (index < FileList.size()) {
+        if (parallel) {
+            // collect the next files that can be written in worker threads and
+            // limit their number to keep the memory consumption bounded
+            std::vector<FileEntry> batch;
+            size_t maxBatch = (size_t)std::max<int>(2, QThread::idealThreadCount());
+            for (size_t pos = index; pos < FileList.size() && batch.size() < maxBatch; pos++) {
+                FileEntry entry = FileList[pos];
+                if (!entry.Object->canSaveDocFileInThread())
+                    break;
+                if (entry.Level < 0)
+                    entry.Level = this->level;
+                batch.push_back(entry);
+            }
+
+            if (batch.size() > 1) {
+                QFuture<RawEntry> future = QtConcurrent::mapped(batch, &ZipWriter::compressFile);
+                future.waitForFinished();
+                for (QFuture<RawEntry>::const_iterator it = future.begin(); it != future.end(); ++it) {
+                    // report the first failure like the serial code would do
+                    if (it->Failed) {
+                        if (it->NoMemory)
+                            throw Base::MemoryException();
+                        throw Base::Exception(it->Error);
+                    }
+                    ZipStream.putRawEntry(zipios::ZipCDirEntry(it->FileName),
+                        it->Data.c_str(), it->Data.size(), it->Size, it->Crc,
+                        it->Stored ? zipios::STORED : zipios::DEFLATED);
+                }
+                index += batch.size();
+                continue;
+            }
+        }
+
         FileEntry entry = FileList.begin()[index];
+        if (entry.Level >= 0)
+            ZipStream.setLevel(entry.Level);
         ZipStream.putNextEntry(entry.FileName);
+        // the level is applied in putNextEntry(), so restore it for the next files
+        ZipStream.setLevel(this->level);
         entry.Object->SaveDocFile(*this);
         index++;
     }
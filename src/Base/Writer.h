@@ -70,8 +70,11 @@ public:
 
     /** @name additional file writing */
     //@{
-    /// add a write request of a persistent object
-    std::string addFile(const char* Name, const Base::Persistence *Object);
+    /** add a write request of a persistent object
+     * With \a level a compression level (0-9) can be set for this file, where 0 means
+     * no compression at all. By default (-1) the level of the writer is used.
+     */
+    std::string addFile(const char* Name, const Base::Persistence *Object, int level=-1);
     /// process the requested file storing
     virtual void writeFiles(void)=0;
     /// get all registered file names
@@ -98,6 +101,7 @@ protected:
     struct FileEntry {
         std::string FileName;
         const Base::Persistence *Object;
+        int Level;
     };
     std::vector<FileEntry> FileList;
     std::vector<std::string> FileNames;
@@ -128,11 +132,33 @@ public:
     virtual std::ostream &Stream(void){return ZipStream;}
 
     void setComment(const char* str){ZipStream.setComment(str);}
-    void setLevel(int level){ZipStream.setLevel( level );}
+    void setLevel(int level){ZipStream.setLevel( level ); this->level = level;}
     void putNextEntry(const char* str){ZipStream.putNextEntry(str);}
+    /** If enabled the files of all objects that support it are serialized and
+     * compressed in worker threads. Only writing the compressed data to the
+     * archive is done serially. This needs temporarily as much memory as the
+     * files of one batch. By default it is disabled.
+     * @see Persistence::canSaveDocFileInThread()
+     */
+    void setParallel(bool on){parallel = on;}
 
 private:
+    struct RawEntry {
+        std::string FileName;
+        std::string Data;
+        unsigned long Size;
+        unsigned long Crc;
+        bool Stored;
+        bool Failed;
+        bool NoMemory;
+        std::string Error;
+    };
+    static RawEntry compressFile(const FileEntry&);
+    static void setupStream(std::ostream&);
+
     zipios::ZipOutputStream ZipStream;
+    int level;
+    bool parallel;
 };
 
 /** The StringWriter class 
@@ -27,7 +27,8 @@
 
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Mesh/App/Core/Builder.h>
-#include <Mod/Mesh/App/Core/Grid.h>
+#include <Mod/Mesh/App/Core/FacetTree.h>
+#include <Mod/Mesh/App/Core/Iterator.h>
 
 #include <BRepAdaptor_Surface.hxx>
 #include <Base/Builder3D.h>
@@ -157,41 +158,45 @@ bool Deviation::Compute()
 
 	std::vector<int> FailProj;
 
-	MeshCore::MeshFacetGrid aFacetGrid(m_Mesh,10);
-	MeshCore::MeshAlgorithm malg(m_Mesh);
-	MeshCore::MeshAlgorithm malg2(m_Mesh);
+	// project the points along their normals in both directions, the tree traverses
+	// neighbouring rays together
+	MeshCore::MeshFacetTree aFacetTree(m_Mesh);
 	MeshCore::MeshPointIterator p_it(m_MeshCad);
 
-	Base::Vector3f projPoint, distVec, nvec(0,0,0), projPoint2;
-	unsigned long  facetIndex;
-	std::stringstream text;
+	std::vector<Base::Vector3f> pnts, dirs(m_nlvec);
+	for (p_it.Begin(); p_it.More(); p_it.Next())
+		pnts.push_back(*p_it);
+
+	std::vector<Base::Vector3f> projFwd, projBwd;
+	std::vector<unsigned long> facetFwd, facetBwd;
+	aFacetTree.NearestFacetsOnRays(pnts, dirs, facetFwd, projFwd);
+	for (std::size_t j=0; j<dirs.size(); j++)
+		dirs[j] = -dirs[j];
+	aFacetTree.NearestFacetsOnRays(pnts, dirs, facetBwd, projBwd);
 
+	Base::Vector3f nvec(0,0,0);
 	unsigned int c=0;
-	int i=0;
 
-	for (p_it.Begin(); p_it.More(); p_it.Next())
+	for (std::size_t i=0; i<pnts.size(); i++)
 	{
-		if (malg.NearestFacetOnRay(*p_it, m_nlvec[i], aFacetGrid, projPoint, facetIndex))   // gridoptimiert
+		bool fwd = facetFwd[i] != ULONG_MAX;
+		bool bwd = facetBwd[i] != ULONG_MAX;
+		if (fwd && bwd)
 		{
-			distVec  = projPoint - *p_it;
-			m_nlvec[i] = distVec;   // berschreibt normalenvektor
+			if (Base::Distance(pnts[i], projBwd[i]) < Base::Distance(pnts[i], projFwd[i]))
+				fwd = false;
 		}
+
+		if (fwd)
+			m_nlvec[i] = projFwd[i] - pnts[i];   // berschreibt normalenvektor
+		else if (bwd)
+			m_nlvec[i] = projBwd[i] - pnts[i];
 		else
 		{
-			if (!malg2.NearestFacetOnRay(*p_it, m_nlvec[i], projPoint, facetIndex))   // nicht gridoptimiert
-			{
-				c++;
-				FailProj.push_back(i);
-				m_nlvec[i] = nvec;
-			}
-			else
-			{
-				distVec  = projPoint - *p_it;
-				m_nlvec[i] = distVec;   // berschreibt normalenvektor
-			}
+			c++;
+			FailProj.push_back(i);
+			m_nlvec[i] = nvec;
 		}
-
-		++i;
 	}
 
 	for(int i=0; i<m_nlvec.size(); i++)
@@ -25,6 +25,7 @@
 
 #ifndef _PreComp_
 # include <cstdlib>
+# include <cstring>
 # include <memory>
 # include <strstream>
 # include <Bnd_Box.hxx>
@@ -40,6 +41,7 @@
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Mesh/App/Core/Evaluation.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
+#include <Mod/Mesh/App/Core/NastranReader.h>
 
 #include "FemMesh.h"
 
@@ -368,94 +370,64 @@ void FemMesh::compute()
 }
 
 
+static bool lookupNodes(const MeshCore::NastranReader& reader,
+                        const std::vector<const SMDS_MeshNode*>& nodes,
+                        const int* ids, int count, const SMDS_MeshNode** n)
+{
+    for (int i = 0; i < count; i++) {
+        long index = reader.getNodeIndex(ids[i]);
+        if (index < 0 || !nodes[index])
+            return false;
+        n[i] = nodes[index];
+    }
+    return true;
+}
+
 void FemMesh::readNastran(const std::string &Filename)
 {
-	std::ifstream inputfile;
-	inputfile.open(Filename.c_str());
-	inputfile.seekg(std::ifstream::beg);
-	std::string line1,line2,temp;
-	Base::Vector3d current_node;
-	std::vector<Base::Vector3d> vertices;
-	vertices.clear();
-	std::vector<unsigned int> tetra_element;
-	std::vector<std::vector<unsigned int> > all_elements;
-	std::vector<unsigned int> element_id;
-	element_id.clear();
-	do
-	{
-		std::getline(inputfile,line1);
-		if (line1.size() == 0) continue;
-		if (line1.find("GRID*")!= std::string::npos) //We found a Grid line
-		{
-			//Now lets extract the GRID Points = Nodes
-			//As each GRID Line consists of two subsequent lines we have to
-			//take care of that as well
-			std::getline(inputfile,line2);
-			//Extract X Value
-			current_node.x = atof(line1.substr(40,56).c_str());
-			//Extract Y Value
-			current_node.y = atof(line1.substr(56,72).c_str());
-			//Extract Z Value
-			current_node.z = atof(line2.substr(8,24).c_str());
-
-			vertices.push_back(current_node);
-		}
-		else if (line1.find("CTETRA")!= std::string::npos)
-		{
-			tetra_element.clear();
-			//Lets extract the elements
-			//As each Element Line consists of two subsequent lines as well 
-			//we have to take care of that
-			//At a first step we only extract Quadratic Tetrahedral Elements
-			std::getline(inputfile,line2);
-			element_id.push_back(atoi(line1.substr(8,16).c_str()));
-			tetra_element.push_back(atoi(line1.substr(24,32).c_str()));
-			tetra_element.push_back(atoi(line1.substr(32,40).c_str()));
-			tetra_element.push_back(atoi(line1.substr(40,48).c_str()));
-			tetra_element.push_back(atoi(line1.substr(48,56).c_str()));
-			tetra_element.push_back(atoi(line1.substr(56,64).c_str()));
-			tetra_element.push_back(atoi(line1.substr(64,72).c_str()));
-			tetra_element.push_back(atoi(line2.substr(8,16).c_str()));
-			tetra_element.push_back(atoi(line2.substr(16,24).c_str()));
-			tetra_element.push_back(atoi(line2.substr(24,32).c_str()));
-			tetra_element.push_back(atoi(line2.substr(32,40).c_str()));
-
-			all_elements.push_back(tetra_element);
-		}
+    // The deck is parsed in parallel from the memory-mapped file, the nodes and
+    // elements are then handed over to SMESH with their ids from the file.
+    MeshCore::NastranReader reader;
+    if (!reader.read(Filename.c_str()))
+        throw Base::FileException("Cannot open file", Filename.c_str());
+    reader.buildNodeIndex();
 
-	}
-	while (inputfile.good());
-	inputfile.close();
-
-	//Now fill the SMESH datastructure
-	std::vector<Base::Vector3d>::const_iterator anodeiterator;
-	SMESHDS_Mesh* meshds = this->myMesh->GetMeshDS();
-	meshds->ClearMesh();
-	int j=1;
-	for(anodeiterator=vertices.begin(); anodeiterator!=vertices.end(); anodeiterator++)
-	{
-		meshds->AddNodeWithID((*anodeiterator).x,(*anodeiterator).y,(*anodeiterator).z,j);
-		j++;
-	}
+    SMESHDS_Mesh* meshds = this->myMesh->GetMeshDS();
+    meshds->ClearMesh();
 
-	for(unsigned int i=0;i<all_elements.size();i++)
-	{
-		//Die Reihenfolge wie hier die Elemente hinzugefgt werden ist sehr wichtig. 
-		//Ansonsten ist eine konsistente Datenstruktur nicht mglich
-		meshds->AddVolumeWithID(
-			meshds->FindNode(all_elements[i][0]),
-			meshds->FindNode(all_elements[i][2]),
-			meshds->FindNode(all_elements[i][1]),
-			meshds->FindNode(all_elements[i][3]),
-			meshds->FindNode(all_elements[i][6]),
-			meshds->FindNode(all_elements[i][5]),
-			meshds->FindNode(all_elements[i][4]),
-			meshds->FindNode(all_elements[i][9]),
-			meshds->FindNode(all_elements[i][7]),
-			meshds->FindNode(all_elements[i][8]),
-			element_id[i]
-		);
-	}
+    const std::vector<int>& ids = reader.getNodeIds();
+    const std::vector<double>& coords = reader.getNodeCoords();
+    std::vector<const SMDS_MeshNode*> nodes(ids.size());
+    for (std::size_t i = 0; i < ids.size(); i++)
+        nodes[i] = meshds->AddNodeWithID(coords[3*i], coords[3*i+1], coords[3*i+2], ids[i]);
+
+    const SMDS_MeshNode* n[10];
+    const std::vector<int>& tria = reader.getTriangles();
+    for (std::size_t i = 0; i < tria.size(); i += MeshCore::NastranReader::TriangleSize) {
+        if (lookupNodes(reader, nodes, &tria[i+1], 3, n))
+            meshds->AddFaceWithID(n[0], n[1], n[2], tria[i]);
+    }
+
+    const std::vector<int>& quad = reader.getQuads();
+    for (std::size_t i = 0; i < quad.size(); i += MeshCore::NastranReader::QuadSize) {
+        if (lookupNodes(reader, nodes, &quad[i+1], 4, n))
+            meshds->AddFaceWithID(n[0], n[1], n[2], n[3], quad[i]);
+    }
+
+    const std::vector<int>& tetra = reader.getTetras();
+    for (std::size_t i = 0; i < tetra.size(); i += MeshCore::NastranReader::TetraSize) {
+        // the order in which the nodes are passed is important for SMESH
+        // to get a consistent data structure
+        if (tetra[i+5] == 0) {
+            if (lookupNodes(reader, nodes, &tetra[i+1], 4, n))
+                meshds->AddVolumeWithID(n[0], n[2], n[1], n[3], tetra[i]);
+        }
+        else if (lookupNodes(reader, nodes, &tetra[i+1], 10, n)) {
+            meshds->AddVolumeWithID(n[0], n[2], n[1], n[3],
+                                    n[6], n[5], n[4], n[9], n[7], n[8],
+                                    tetra[i]);
+        }
+    }
 }
 
 void FemMesh::read(const char *FileName)
@@ -606,16 +578,303 @@ void FemMesh::Restore(Base::XMLReader &reader)
 {
 }
 
+// The binary format stores the nodes as a block of ids followed by a block
+// of coordinates. Edges, faces and volumes are stored as blocks of integers
+// where each element consists of its id, its number of nodes (negated for
+// polygons and polyhedra), for a polyhedron its number of faces followed by
+// the number of nodes of each face, and the ids of its nodes.
+static const char femMeshMagic[8] = {'F','C','F','E','M','B','I','N'};
+static const int32_t femMeshVersion = 1;
+
+static void appendElement(std::vector<int32_t>& data, const SMDS_MeshElement* elem)
+{
+    if (elem->IsPoly() && elem->GetType() == SMDSAbs_Volume) {
+        const SMDS_PolyhedralVolumeOfNodes* poly = dynamic_cast<const SMDS_PolyhedralVolumeOfNodes*>(elem);
+        if (!poly) return;
+        // the nodes of a polyhedron are listed face by face
+        const std::vector<int>& quantities = poly->GetQuanities();
+        int numNodes = 0;
+        for (std::vector<int>::const_iterator it = quantities.begin(); it != quantities.end(); ++it)
+            numNodes += *it;
+        data.push_back(elem->GetID());
+        data.push_back(-numNodes);
+        data.push_back((int32_t)quantities.size());
+        data.insert(data.end(), quantities.begin(), quantities.end());
+        for (int i=1; i<=poly->NbFaces(); i++) {
+            for (int j=1; j<=poly->NbFaceNodes(i); j++)
+                data.push_back(poly->GetFaceNode(i, j)->GetID());
+        }
+        return;
+    }
+
+    int numNodes = elem->NbNodes();
+    data.push_back(elem->GetID());
+    data.push_back(elem->IsPoly() ? -numNodes : numNodes);
+    for (int i=0; i<numNodes; i++)
+        data.push_back(elem->GetNode(i)->GetID());
+}
+
+static void writeBlock(Base::OutputStream& str, const std::vector<int32_t>& data)
+{
+    str << (uint32_t)data.size();
+    if (!data.empty())
+        str.write(&data[0], data.size());
+}
+
+/** Reads \a count values. The count is taken from the file, so the vector only
+ * grows with the data actually read and a count beyond the end of the entry is
+ * rejected without allocating memory for it.
+ */
+template <class T>
+static void readValues(Base::InputStream& str, std::istream& in, std::vector<T>& data, std::size_t count)
+{
+    const std::size_t chunkSize = 1024 * 1024;
+    data.clear();
+    while (data.size() < count) {
+        std::size_t start = data.size();
+        data.resize(start + std::min<std::size_t>(chunkSize, count - start));
+        str.read(&data[start], data.size() - start);
+        if (!in)
+            throw Base::Exception("Unexpected end of FEM mesh data");
+    }
+}
+
+static void readBlock(Base::InputStream& str, std::istream& in, std::vector<int32_t>& data)
+{
+    uint32_t size=0;
+    str >> size;
+    if (!in)
+        throw Base::Exception("Unexpected end of FEM mesh data");
+    readValues(str, in, data, size);
+}
+
+static int32_t nextValue(const std::vector<int32_t>& data, std::size_t& pos)
+{
+    if (pos >= data.size())
+        throw Base::Exception("Invalid FEM mesh data");
+    return data[pos++];
+}
+
+static void nextNodes(const SMESHDS_Mesh* meshds, const std::vector<int32_t>& data, std::size_t& pos,
+                      int32_t count, std::vector<const SMDS_MeshNode*>& nodes)
+{
+    if (count < 0 || (std::size_t)count > data.size() - pos)
+        throw Base::Exception("Invalid FEM mesh data");
+    nodes.resize(count);
+    for (int32_t i=0; i<count; i++) {
+        nodes[i] = meshds->FindNode(data[pos++]);
+        if (!nodes[i])
+            throw Base::Exception("Invalid node id in FEM mesh data");
+    }
+}
+
 void FemMesh::SaveDocFile (Base::Writer &writer) const
+{
+    // the UNV file keeps the groups, RestoreDocFile() detects the format
+    if (hasGroupsOrSubMeshes()) {
+        saveUNV(writer);
+        return;
+    }
+
+    // write the mesh data directly into the zip stream, see RestoreDocFile()
+    SMESHDS_Mesh* meshds = myMesh->GetMeshDS();
+    const SMDS_MeshInfo& info = meshds->GetMeshInfo();
+    writer.Stream().write(femMeshMagic, sizeof(femMeshMagic));
+    Base::OutputStream str(writer.Stream());
+    str << femMeshVersion;
+
+    std::vector<int32_t> ids;
+    std::vector<double> coords;
+    ids.reserve(info.NbNodes());
+    coords.reserve(3 * info.NbNodes());
+    SMDS_NodeIteratorPtr aNodeIter = meshds->nodesIterator();
+    for (;aNodeIter->more();) {
+        const SMDS_MeshNode* aNode = aNodeIter->next();
+        ids.push_back(aNode->GetID());
+        coords.push_back(aNode->X());
+        coords.push_back(aNode->Y());
+        coords.push_back(aNode->Z());
+    }
+    writeBlock(str, ids);
+    if (!coords.empty())
+        str.write(&coords[0], coords.size());
+
+    std::vector<int32_t> data;
+    SMDS_EdgeIteratorPtr aEdgeIter = meshds->edgesIterator();
+    for (;aEdgeIter->more();)
+        appendElement(data, aEdgeIter->next());
+    writeBlock(str, data);
+
+    data.clear();
+    SMDS_FaceIteratorPtr aFaceIter = meshds->facesIterator();
+    for (;aFaceIter->more();)
+        appendElement(data, aFaceIter->next());
+    writeBlock(str, data);
+
+    data.clear();
+    SMDS_VolumeIteratorPtr aVolIter = meshds->volumesIterator();
+    for (;aVolIter->more();)
+        appendElement(data, aVolIter->next());
+    writeBlock(str, data);
+}
+
+void FemMesh::RestoreDocFile(Base::Reader &reader)
+{
+    char magic[sizeof(femMeshMagic)];
+    reader.read(magic, sizeof(magic));
+    std::streamsize numRead = reader.gcount();
+    if (numRead != sizeof(magic) || memcmp(magic, femMeshMagic, sizeof(magic)) != 0) {
+        // documents of older versions and meshes with groups contain a UNV file
+        restoreUNV(reader, magic, numRead);
+        return;
+    }
+
+    Base::InputStream str(reader);
+    int32_t version=0;
+    str >> version;
+    if (version != femMeshVersion)
+        throw Base::Exception("Unsupported version of FEM mesh data");
+
+    SMESHDS_Mesh* meshds = myMesh->GetMeshDS();
+    meshds->ClearMesh();
+
+    std::vector<int32_t> data;
+    std::vector<double> coords;
+    readBlock(str, reader, data);
+    readValues(str, reader, coords, 3 * data.size());
+    for (std::size_t i=0; i<data.size(); i++)
+        meshds->AddNodeWithID(coords[3*i], coords[3*i+1], coords[3*i+2], data[i]);
+    coords.clear();
+
+    std::vector<const SMDS_MeshNode*> nodes;
+    readBlock(str, reader, data);
+    for (std::size_t pos=0; pos<data.size();) {
+        int32_t id = nextValue(data, pos);
+        int32_t numNodes = nextValue(data, pos);
+        nextNodes(meshds, data, pos, numNodes, nodes);
+        if (numNodes == 2)
+            meshds->AddEdgeWithID(nodes[0], nodes[1], id);
+        else if (numNodes == 3)
+            meshds->AddEdgeWithID(nodes[0], nodes[1], nodes[2], id);
+        else
+            throw Base::Exception("Unsupported edge in FEM mesh data");
+    }
+
+    readBlock(str, reader, data);
+    for (std::size_t pos=0; pos<data.size();) {
+        int32_t id = nextValue(data, pos);
+        int32_t numNodes = nextValue(data, pos);
+        if (numNodes < 0) {
+            nextNodes(meshds, data, pos, -numNodes, nodes);
+            meshds->AddPolygonalFaceWithID(nodes, id);
+            continue;
+        }
+        nextNodes(meshds, data, pos, numNodes, nodes);
+        switch (numNodes) {
+            case 3:
+                meshds->AddFaceWithID(nodes[0], nodes[1], nodes[2], id);
+                break;
+            case 4:
+                meshds->AddFaceWithID(nodes[0], nodes[1], nodes[2], nodes[3], id);
+                break;
+            case 6:
+                meshds->AddFaceWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                      nodes[5], id);
+                break;
+            case 8:
+                meshds->AddFaceWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                      nodes[5], nodes[6], nodes[7], id);
+                break;
+            default:
+                throw Base::Exception("Unsupported face in FEM mesh data");
+        }
+    }
+
+    std::vector<int> quantities;
+    readBlock(str, reader, data);
+    for (std::size_t pos=0; pos<data.size();) {
+        int32_t id = nextValue(data, pos);
+        int32_t numNodes = nextValue(data, pos);
+        if (numNodes < 0) {
+            // the number of faces and their node counts must fit into the entry
+            int32_t numFaces = nextValue(data, pos);
+            if (numFaces < 0 || (std::size_t)numFaces > data.size() - pos)
+                throw Base::Exception("Invalid FEM mesh data");
+            quantities.resize(numFaces);
+            for (std::vector<int>::iterator it = quantities.begin(); it != quantities.end(); ++it) {
+                *it = nextValue(data, pos);
+                if (*it < 0)
+                    throw Base::Exception("Invalid FEM mesh data");
+            }
+            nextNodes(meshds, data, pos, -numNodes, nodes);
+            meshds->AddPolyhedralVolumeWithID(nodes, quantities, id);
+            continue;
+        }
+        nextNodes(meshds, data, pos, numNodes, nodes);
+        switch (numNodes) {
+            case 4:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], id);
+                break;
+            case 5:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4], id);
+                break;
+            case 6:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                        nodes[5], id);
+                break;
+            case 8:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                        nodes[5], nodes[6], nodes[7], id);
+                break;
+            case 10:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                        nodes[5], nodes[6], nodes[7], nodes[8], nodes[9], id);
+                break;
+            case 13:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                        nodes[5], nodes[6], nodes[7], nodes[8], nodes[9],
+                                        nodes[10], nodes[11], nodes[12], id);
+                break;
+            case 15:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                        nodes[5], nodes[6], nodes[7], nodes[8], nodes[9],
+                                        nodes[10], nodes[11], nodes[12], nodes[13], nodes[14], id);
+                break;
+            case 20:
+                meshds->AddVolumeWithID(nodes[0], nodes[1], nodes[2], nodes[3], nodes[4],
+                                        nodes[5], nodes[6], nodes[7], nodes[8], nodes[9],
+                                        nodes[10], nodes[11], nodes[12], nodes[13], nodes[14],
+                                        nodes[15], nodes[16], nodes[17], nodes[18], nodes[19], id);
+                break;
+            default:
+                throw Base::Exception("Unsupported volume in FEM mesh data");
+        }
+    }
+}
+
+bool FemMesh::hasGroupsOrSubMeshes() const
+{
+    const SMESHDS_Mesh* meshds = myMesh->GetMeshDS();
+    if (myMesh->NbGroup() > 0 || meshds->GetNbGroups() > 0)
+        return true;
+    const std::map<int,SMESHDS_SubMesh*>& subMeshes = meshds->SubMeshes();
+    for (std::map<int,SMESHDS_SubMesh*>::const_iterator it = subMeshes.begin(); it != subMeshes.end(); ++it) {
+        if (it->second && (it->second->NbElements() > 0 || it->second->NbNodes() > 0))
+            return true;
+    }
+    return false;
+}
+
+void FemMesh::saveUNV(Base::Writer &writer) const
 {
     // create a temporary file and copy the content to the zip stream
     Base::FileInfo fi(Base::FileInfo::getTempFileName().c_str());
 
     myMesh->ExportUNV(fi.filePath().c_str());
- 
+
     Base::ifstream file(fi, std::ios::in | std::ios::binary);
     if (file){
-        unsigned long ulSize = 0; 
+        unsigned long ulSize = 0;
         std::streambuf* buf = file.rdbuf();
         if (buf) {
             unsigned long ulCurr;
@@ -635,13 +894,14 @@ void FemMesh::SaveDocFile (Base::Writer &writer) const
     fi.deleteFile();
 }
 
-void FemMesh::RestoreDocFile(Base::Reader &reader)
+void FemMesh::restoreUNV(Base::Reader &reader, const char* head, std::streamsize headSize)
 {
     // create a temporary file and copy the content from the zip stream
     Base::FileInfo fi(Base::FileInfo::getTempFileName().c_str());
 
     // read in the ASCII file and write back to the file stream
     Base::ofstream file(fi, std::ios::out | std::ios::binary);
+    file.write(head, headSize);
     if (reader)
         reader >> file.rdbuf();
     file.close();
@@ -102,6 +102,12 @@ public:
 
 private:
     void copyMeshData(const FemMesh&);
+    /// returns true if the mesh has groups or sub-meshes, which the binary format doesn't keep
+    bool hasGroupsOrSubMeshes() const;
+    /// saves the mesh as UNV file
+    void saveUNV(Base::Writer &writer) const;
+    /// restores the mesh from a UNV file
+    void restoreUNV(Base::Reader &reader, const char* head, std::streamsize headSize);
     void readNastran(const std::string &Filename);
 
 private:
@@ -141,7 +141,7 @@ void PropertyFemMesh::Save (Base::Writer &writer) const
     if (!writer.isForceXML()) {
         //See SaveDocFile(), RestoreDocFile()
         writer.Stream() << writer.ind() << "<FemMesh file=\"" 
-                        << writer.addFile("FemMesh.unv", this)
+                        << writer.addFile("FemMesh.bin", this)
                         << "\"/>" << std::endl;
     }
 }
@@ -0,0 +1,54 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, os, tempfile, zipfile, Fem, BenchmarkApp
+from TestFemApp import CreateTetraBlock
+
+
+def benchSaveRestore():
+	# compares the document format with a UNV file
+	mesh = Fem.FemMesh()
+	CreateTetraBlock(mesh, 40)
+	FreeCAD.Console.PrintMessage("%d volumes\n" % mesh.VolumeCount)
+
+	unvName = os.path.join(tempfile.gettempdir(), "FemMeshBenchmark.unv")
+	BenchmarkApp.measure("UNV file: save", mesh.write, unvName)
+	BenchmarkApp.measure("UNV file: load", Fem.read, unvName)
+	FreeCAD.Console.PrintMessage("UNV file: %d bytes\n" % os.path.getsize(unvName))
+	os.remove(unvName)
+
+	fileName = os.path.join(tempfile.gettempdir(), "FemMeshBenchmark.FCStd")
+	doc = FreeCAD.newDocument("FemMeshBenchmark")
+	obj = doc.addObject("Fem::FemMeshObject", "Mesh")
+	obj.FemMesh = mesh
+	BenchmarkApp.measure("document: save", doc.saveAs, fileName)
+	FreeCAD.closeDocument(doc.Name)
+	doc = BenchmarkApp.measure("document: load", FreeCAD.openDocument, fileName)
+	info = zipfile.ZipFile(fileName).getinfo("FemMesh.bin")
+	FreeCAD.Console.PrintMessage("document: %d bytes (%d compressed)\n"
+	                             % (info.file_size, info.compress_size))
+	FreeCAD.closeDocument(doc.Name)
+	os.remove(fileName)
+
+def run():
+	benchSaveRestore()
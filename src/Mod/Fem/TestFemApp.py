@@ -0,0 +1,109 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, os, tempfile, unittest, struct, zipfile, Fem
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD Fem module
+#---------------------------------------------------------------------------
+
+def CreateTetraBlock(mesh, count):
+	""" Fills the mesh with count x count x count cubes split into five tetrahedra """
+	nodes = {}
+	for i in range(count+1):
+		for j in range(count+1):
+			for k in range(count+1):
+				nodes[(i,j,k)] = mesh.addNode(float(i), float(j), float(k))
+	for i in range(count):
+		for j in range(count):
+			for k in range(count):
+				c = [nodes[(i+a,j+b,k+d)] for d in range(2) for b in range(2) for a in range(2)]
+				mesh.addVolume(c[0], c[1], c[2], c[4])
+				mesh.addVolume(c[1], c[3], c[2], c[7])
+				mesh.addVolume(c[1], c[4], c[5], c[7])
+				mesh.addVolume(c[2], c[4], c[7], c[6])
+				mesh.addVolume(c[1], c[2], c[4], c[7])
+
+
+class FemMeshSaveCases(unittest.TestCase):
+	def setUp(self):
+		self.Doc = FreeCAD.newDocument("FemMeshTest")
+		self.FileName = os.path.join(tempfile.gettempdir(), "FemMeshTest.FCStd")
+
+	def saveAndRestore(self, mesh):
+		obj = self.Doc.addObject("Fem::FemMeshObject", "Mesh")
+		obj.FemMesh = mesh
+		self.Doc.saveAs(self.FileName)
+		FreeCAD.closeDocument(self.Doc.Name)
+		self.Doc = FreeCAD.openDocument(self.FileName)
+		return self.Doc.getObject("Mesh").FemMesh
+
+	def testSaveAndRestore(self):
+		mesh = Fem.FemMesh()
+		CreateTetraBlock(mesh, 3)
+		mesh.addEdge(1, 2)
+		mesh.addFace(1, 2, 5)
+		copy = self.saveAndRestore(mesh)
+		self.failUnless(copy.NodeCount == 64)
+		self.failUnless(copy.TetraCount == 135)
+		self.failUnless(copy.EdgeCount == mesh.EdgeCount)
+		self.failUnless(copy.FacesCount == mesh.FacesCount)
+		self.failUnless(copy.BoundBox.XMax == 3.0)
+
+	def restoreModified(self, mesh, modify):
+		# saves the mesh, changes its data in the project file and restores it
+		obj = self.Doc.addObject("Fem::FemMeshObject", "Mesh")
+		obj.FemMesh = mesh
+		self.Doc.saveAs(self.FileName)
+		FreeCAD.closeDocument(self.Doc.Name)
+		source = zipfile.ZipFile(self.FileName, "r")
+		entries = [(info, source.read(info.filename)) for info in source.infolist()]
+		source.close()
+		target = zipfile.ZipFile(self.FileName, "w", zipfile.ZIP_DEFLATED)
+		for info, data in entries:
+			if data.startswith("FCFEMBIN"):
+				data = modify(data)
+			target.writestr(info, data)
+		target.close()
+		self.Doc = FreeCAD.openDocument(self.FileName)
+		return self.Doc.getObject("Mesh").FemMesh
+
+	def testRestoreInvalidCounts(self):
+		mesh = Fem.FemMesh()
+		CreateTetraBlock(mesh, 2)
+		# the magic and the version are followed by the number of nodes, a huge
+		# number must be rejected without allocating memory for it
+		copy = self.restoreModified(mesh, lambda data: data[:12] + struct.pack("<I", 0x7fffffff) + data[16:])
+		self.failUnless(copy.NodeCount == 0)
+
+	def testRestoreTruncated(self):
+		mesh = Fem.FemMesh()
+		CreateTetraBlock(mesh, 2)
+		copy = self.restoreModified(mesh, lambda data: data[:len(data)/2])
+		self.failUnless(copy.VolumeCount < mesh.VolumeCount)
+
+	def tearDown(self):
+		FreeCAD.closeDocument(self.Doc.Name)
+		if os.path.exists(self.FileName):
+			os.remove(self.FileName)
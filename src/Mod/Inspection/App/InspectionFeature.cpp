@@ -22,14 +22,18 @@
 
 
 #include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+#endif
+
 #include <gp_Pnt.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <TopoDS_Vertex.hxx>
 
-#include <QEventLoop>
 #include <QFuture>
-#include <QFutureWatcher>
 #include <QtConcurrentMap>
 
 #include <boost/signals.hpp>
@@ -37,7 +41,6 @@
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
-#include <Base/FutureWatcherProgress.h>
 #include <Base/Parameter.h>
 #include <Base/Sequencer.h>
 #include <Base/Tools.h>
@@ -45,7 +48,7 @@
 #include <Mod/Mesh/App/Mesh.h>
 #include <Mod/Mesh/App/MeshFeature.h>
 #include <Mod/Mesh/App/Core/Algorithm.h>
-#include <Mod/Mesh/App/Core/Grid.h>
+#include <Mod/Mesh/App/Core/FacetTree.h>
 #include <Mod/Mesh/App/Core/Iterator.h>
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Points/App/PointsFeature.h>
@@ -122,138 +125,276 @@ Base::Vector3f InspectActualShape::getPoint(unsigned long index)
 
 // ----------------------------------------------------------------
 
+void InspectNominalGeometry::getDistances(const std::vector<Base::Vector3f>& points, std::vector<float>& distances)
+{
+    distances.resize(points.size());
+    for (std::size_t i = 0; i < points.size(); i++)
+        distances[i] = getDistance(points[i]);
+}
+
+// ----------------------------------------------------------------
+
 namespace Inspection {
-    class MeshInspectGrid : public MeshCore::MeshGrid
+    /** A flat grid over the transformed facets of a mesh to compute the exact
+     * signed distance of points to the mesh. The facet indices of all cells are
+     * stored in one array and the facets are prepared for a branch-free distance
+     * computation of several facets at once which the compiler can vectorize.
+     * All queries are read-only and thus thread-safe.
+     */
+    class MeshDistanceGrid
     {
     public:
-        MeshInspectGrid (const MeshCore::MeshKernel &mesh, float fGridLen, const Base::Matrix4D& m)
-            : MeshCore::MeshGrid(mesh), _transform(m)
+        MeshDistanceGrid(const MeshCore::MeshKernel& kernel, const Base::Matrix4D& mat, float fGridLen)
         {
-            Base::BoundBox3f clBBMesh = _pclMesh->GetBoundBox().Transformed(m);
-            Rebuild(std::max<unsigned long>((unsigned long)(clBBMesh.LengthX() / fGridLen), 1),
-                    std::max<unsigned long>((unsigned long)(clBBMesh.LengthY() / fGridLen), 1),
-                    std::max<unsigned long>((unsigned long)(clBBMesh.LengthZ() / fGridLen), 1));
-        }
-
-        void Validate (const MeshCore::MeshKernel&)
-        {
-            // do nothing
-        }
+            MeshCore::MeshFacetIterator clFIter(kernel);
+            clFIter.Transform(mat);
+            _facets.reserve(kernel.CountFacets());
+            Base::BoundBox3f box;
+            for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
+                const MeshCore::MeshGeomFacet& rFacet = *clFIter;
+                const Base::Vector3f& a = rFacet._aclPoints[0];
+                const Base::Vector3f& b = rFacet._aclPoints[1];
+                const Base::Vector3f& c = rFacet._aclPoints[2];
+                Base::Vector3f e[3] = {b - a, c - b, a - c};
+                Base::Vector3f n = (b - a) % (c - a);
+
+                Facet f;
+                f.a[0] = a.x; f.a[1] = a.y; f.a[2] = a.z;
+                for (int i = 0; i < 3; i++) {
+                    f.e[i][0] = e[i].x; f.e[i][1] = e[i].y; f.e[i][2] = e[i].z;
+                    float len = e[i].Sqr();
+                    f.inv[i] = len > 0.0f ? 1.0f / len : 0.0f;
+                }
+                // a degenerated facet has no inner region, only its edges count
+                f.valid = n.Sqr() > 1.0e-12f * e[0].Sqr() * e[2].Sqr() ? 1.0f : 0.0f;
+                if (f.valid > 0.0f)
+                    n.Normalize();
+                f.n[0] = n.x; f.n[1] = n.y; f.n[2] = n.z;
+                _facets.push_back(f);
+
+                box.Add(a); box.Add(b); box.Add(c);
+            }
 
-        void Validate (void)
-        {
-            // do nothing
-        }
+            if (_facets.empty()) {
+                for (int i = 0; i < 3; i++) {
+                    _cells[i] = 1; _min[i] = 0.0f; _len[i] = 1.0f; _invLen[i] = 1.0f;
+                }
+                _offsets.resize(2, 0);
+                return;
+            }
 
-        bool Verify() const
-        {
-            // do nothing
-            return true;
-        }
+            float length[3] = {box.LengthX(), box.LengthY(), box.LengthZ()};
+            float minimum[3] = {box.MinX, box.MinY, box.MinZ};
+            for (int i = 0; i < 3; i++) {
+                _cells[i] = std::max<unsigned long>((unsigned long)(length[i] / fGridLen), 1);
+                _min[i] = minimum[i];
+                _len[i] = length[i] > 0.0f ? length[i] / float(_cells[i]) : fGridLen;
+                _invLen[i] = 1.0f / _len[i];
+            }
 
-    protected:
-        void CalculateGridLength (unsigned long ulCtGrid, unsigned long ulMaxGrids)
-        {
-            // do nothing
-        }
+            // count the facets of each cell and then fill in the facet indices
+            unsigned long numCells = _cells[0] * _cells[1] * _cells[2];
+            _offsets.resize(numCells + 1, 0);
+            for (int pass = 0; pass < 2; pass++) {
+                std::vector<unsigned long> cursor;
+                if (pass == 1) {
+                    for (unsigned long i = 0; i < numCells; i++)
+                        _offsets[i + 1] += _offsets[i];
+                    cursor.assign(_offsets.begin(), _offsets.end() - 1);
+                    _indices.resize(_offsets.back());
+                }
 
-        void CalculateGridLength (int iCtGridPerAxis)
-        {
-            // do nothing
+                for (unsigned long index = 0; index < _facets.size(); index++) {
+                    const Facet& f = _facets[index];
+                    long lo[3], hi[3];
+                    for (int i = 0; i < 3; i++) {
+                        float v0 = f.a[i];
+                        float v1 = v0 + f.e[0][i];
+                        float v2 = v1 + f.e[1][i];
+                        lo[i] = cell(std::min<float>(v0, std::min<float>(v1, v2)), i);
+                        hi[i] = cell(std::max<float>(v0, std::max<float>(v1, v2)), i);
+                    }
+                    for (long z = lo[2]; z <= hi[2]; z++) {
+                        for (long y = lo[1]; y <= hi[1]; y++) {
+                            for (long x = lo[0]; x <= hi[0]; x++) {
+                                unsigned long c = x + _cells[0] * (y + _cells[1] * z);
+                                if (pass == 0)
+                                    _offsets[c + 1]++;
+                                else
+                                    _indices[cursor[c]++] = index;
+                            }
+                        }
+                    }
+                }
+            }
         }
 
-        unsigned long HasElements (void) const
+        unsigned long getCell(const Base::Vector3f& p) const
         {
-            return _pclMesh->CountFacets();
+            return cell(p.x, 0) + _cells[0] * (cell(p.y, 1) + _cells[1] * cell(p.z, 2));
         }
 
-        void Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
+        /** Returns the signed distance to the nearest facet or FLT_MAX if no facet is
+         * within \a maxDist. The sign is taken from the side of the nearest facet.
+         * \a buffer is only used to avoid allocations when calling this repeatedly.
+         */
+        float getDistance(const Base::Vector3f& p, float maxDist, std::vector<unsigned long>& buffer) const
         {
-            rulX = (unsigned long)((rclPoint.x - _fMinX) / _fGridLenX);
-            rulY = (unsigned long)((rclPoint.y - _fMinY) / _fGridLenY);
-            rulZ = (unsigned long)((rclPoint.z - _fMinZ) / _fGridLenZ);
+            if (_facets.empty())
+                return FLT_MAX;
+
+            const float pt[3] = {p.x, p.y, p.z};
+            const long pos[3] = {cell(p.x, 0), cell(p.y, 1), cell(p.z, 2)};
+            float fMinDist = maxDist * maxDist;
+            float fSide = 0.0f;
+            unsigned long ulFacet = ULONG_MAX;
+
+            // search the cells ring by ring until no closer facet can be found
+            for (long k = 0; ; k++) {
+                if (k > 0) {
+                    bool more = false;
+                    float bound = FLT_MAX;
+                    for (int i = 0; i < 3; i++) {
+                        if (pos[i] - k >= 0) {
+                            more = true;
+                            bound = std::min<float>(bound, pt[i] - (_min[i] + float(pos[i] - k + 1) * _len[i]));
+                        }
+                        if (pos[i] + k < (long)_cells[i]) {
+                            more = true;
+                            bound = std::min<float>(bound, _min[i] + float(pos[i] + k) * _len[i] - pt[i]);
+                        }
+                    }
+                    if (!more || (bound > 0.0f && bound * bound > fMinDist))
+                        break;
+                }
 
-            assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
-        }
+                buffer.clear();
+                long x0 = std::max<long>(pos[0] - k, 0), x1 = std::min<long>(pos[0] + k, (long)_cells[0] - 1);
+                long y0 = std::max<long>(pos[1] - k, 0), y1 = std::min<long>(pos[1] + k, (long)_cells[1] - 1);
+                for (long x = x0; x <= x1; x++) {
+                    for (long y = y0; y <= y1; y++) {
+                        bool border = (labs(x - pos[0]) == k || labs(y - pos[1]) == k);
+                        long step = (border || k == 0) ? 1 : 2 * k;
+                        for (long z = pos[2] - k; z <= pos[2] + k; z += step) {
+                            if (z < 0 || z >= (long)_cells[2])
+                                continue;
+                            unsigned long c = x + _cells[0] * (y + _cells[1] * z);
+                            buffer.insert(buffer.end(), _indices.begin() + _offsets[c],
+                                                        _indices.begin() + _offsets[c + 1]);
+                        }
+                    }
+                }
 
-        void AddFacet (const MeshCore::MeshGeomFacet &rclFacet, unsigned long ulFacetIndex)
-        {
-            unsigned long ulX, ulY, ulZ;
-            unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
-
-            Base::BoundBox3f clBB;
-            clBB &= rclFacet._aclPoints[0];
-            clBB &= rclFacet._aclPoints[1];
-            clBB &= rclFacet._aclPoints[2];
-
-            Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
-            Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
-  
-
-            if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2)) {
-                for (ulX = ulX1; ulX <= ulX2; ulX++) {
-                    for (ulY = ulY1; ulY <= ulY2; ulY++) {
-                        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++) {
-                            if (rclFacet.IntersectBoundingBox(GetBoundBox(ulX, ulY, ulZ)))
-                                _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+                float sqDist[BatchSize], side[BatchSize];
+                for (std::size_t i = 0; i < buffer.size(); i += BatchSize) {
+                    int num = (int)std::min<std::size_t>(BatchSize, buffer.size() - i);
+                    evaluate(pt, &buffer[i], num, sqDist, side);
+                    for (int j = 0; j < num; j++) {
+                        // for equal distances take the facet with the lowest index
+                        if (sqDist[j] < fMinDist || (sqDist[j] == fMinDist && buffer[i + j] < ulFacet)) {
+                            fMinDist = sqDist[j];
+                            fSide = side[j];
+                            ulFacet = buffer[i + j];
                         }
                     }
                 }
             }
-            else
-                _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
-        }
-
-        void InitGrid (void)
-        {
-            unsigned long i, j;
-
-            Base::BoundBox3f clBBMesh = _pclMesh->GetBoundBox().Transformed(_transform);
 
-            float fLengthX = clBBMesh.LengthX(); 
-            float fLengthY = clBBMesh.LengthY();
-            float fLengthZ = clBBMesh.LengthZ();
-
-            _fGridLenX = (1.0f + fLengthX) / float(_ulCtGridsX);
-            _fMinX = clBBMesh.MinX - 0.5f;
+            if (ulFacet == ULONG_MAX)
+                return FLT_MAX;
+            float fDist = sqrt(fMinDist);
+            return fSide > 0.0f ? fDist : -fDist;
+        }
 
-            _fGridLenY = (1.0f + fLengthY) / float(_ulCtGridsY);
-            _fMinY = clBBMesh.MinY - 0.5f;
+    private:
+        enum { BatchSize = 8 };
 
-            _fGridLenZ = (1.0f + fLengthZ) / float(_ulCtGridsZ);
-            _fMinZ = clBBMesh.MinZ - 0.5f;
+        struct Facet {
+            float a[3];    // first corner
+            float e[3][3]; // edges b-a, c-b, a-c
+            float n[3];    // unit normal
+            float inv[3];  // inverse squared edge lengths
+            float valid;   // 0 for degenerated facets
+        };
 
-            _aulGrid.clear();
-            _aulGrid.resize(_ulCtGridsX);
-            for (i = 0; i < _ulCtGridsX; i++) {
-                _aulGrid[i].resize(_ulCtGridsY);
-                for (j = 0; j < _ulCtGridsY; j++)
-                    _aulGrid[i][j].resize(_ulCtGridsZ);
-            }
+        long cell(float v, int axis) const
+        {
+            float f = (v - _min[axis]) * _invLen[axis];
+            if (!(f > 0.0f))
+                return 0;
+            if (f >= float(_cells[axis]))
+                return (long)_cells[axis] - 1;
+            return (long)f;
         }
 
-        void RebuildGrid (void)
+        /** Computes the squared distances of the point to up to BatchSize facets at once.
+         * The facets are copied into separate arrays and the distance is computed without
+         * branches, so the loop can be vectorized.
+         */
+        void evaluate(const float* p, const unsigned long* ids, int num, float* sqDist, float* side) const
         {
-            _ulCtElements = _pclMesh->CountFacets();
-            InitGrid();
- 
-            unsigned long i = 0;
-            MeshCore::MeshFacetIterator clFIter(*_pclMesh);
-            clFIter.Transform(_transform);
-            for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
-                AddFacet(*clFIter, i++);
+            float ax[BatchSize], ay[BatchSize], az[BatchSize];
+            float e0x[BatchSize], e0y[BatchSize], e0z[BatchSize];
+            float e1x[BatchSize], e1y[BatchSize], e1z[BatchSize];
+            float e2x[BatchSize], e2y[BatchSize], e2z[BatchSize];
+            float nx[BatchSize], ny[BatchSize], nz[BatchSize];
+            float i0[BatchSize], i1[BatchSize], i2[BatchSize], valid[BatchSize];
+
+            for (int j = 0; j < BatchSize; j++) {
+                const Facet& f = _facets[ids[j < num ? j : 0]];
+                ax[j] = f.a[0]; ay[j] = f.a[1]; az[j] = f.a[2];
+                e0x[j] = f.e[0][0]; e0y[j] = f.e[0][1]; e0z[j] = f.e[0][2];
+                e1x[j] = f.e[1][0]; e1y[j] = f.e[1][1]; e1z[j] = f.e[1][2];
+                e2x[j] = f.e[2][0]; e2y[j] = f.e[2][1]; e2z[j] = f.e[2][2];
+                nx[j] = f.n[0]; ny[j] = f.n[1]; nz[j] = f.n[2];
+                i0[j] = f.inv[0]; i1[j] = f.inv[1]; i2[j] = f.inv[2]; valid[j] = f.valid;
+            }
+
+            for (int j = 0; j < BatchSize; j++) {
+                // vectors from the corners a, b and c to the point
+                float apx = p[0] - ax[j], apy = p[1] - ay[j], apz = p[2] - az[j];
+                float bpx = apx - e0x[j], bpy = apy - e0y[j], bpz = apz - e0z[j];
+                float cpx = bpx - e1x[j], cpy = bpy - e1y[j], cpz = bpz - e1z[j];
+
+                // squared distances to the three edges
+                float t0 = (apx * e0x[j] + apy * e0y[j] + apz * e0z[j]) * i0[j];
+                float t1 = (bpx * e1x[j] + bpy * e1y[j] + bpz * e1z[j]) * i1[j];
+                float t2 = (cpx * e2x[j] + cpy * e2y[j] + cpz * e2z[j]) * i2[j];
+                t0 = t0 < 0.0f ? 0.0f : (t0 > 1.0f ? 1.0f : t0);
+                t1 = t1 < 0.0f ? 0.0f : (t1 > 1.0f ? 1.0f : t1);
+                t2 = t2 < 0.0f ? 0.0f : (t2 > 1.0f ? 1.0f : t2);
+                float d0x = apx - t0 * e0x[j], d0y = apy - t0 * e0y[j], d0z = apz - t0 * e0z[j];
+                float d1x = bpx - t1 * e1x[j], d1y = bpy - t1 * e1y[j], d1z = bpz - t1 * e1z[j];
+                float d2x = cpx - t2 * e2x[j], d2y = cpy - t2 * e2y[j], d2z = cpz - t2 * e2z[j];
+                float s0 = d0x * d0x + d0y * d0y + d0z * d0z;
+                float s1 = d1x * d1x + d1y * d1y + d1z * d1z;
+                float s2 = d2x * d2x + d2y * d2y + d2z * d2z;
+                float edge = s0 < s1 ? (s0 < s2 ? s0 : s2) : (s1 < s2 ? s1 : s2);
+
+                // the projection of the point lies inside if it is left of all edges
+                float c0 = nx[j] * (e0y[j] * apz - e0z[j] * apy) + ny[j] * (e0z[j] * apx - e0x[j] * apz) + nz[j] * (e0x[j] * apy - e0y[j] * apx);
+                float c1 = nx[j] * (e1y[j] * bpz - e1z[j] * bpy) + ny[j] * (e1z[j] * bpx - e1x[j] * bpz) + nz[j] * (e1x[j] * bpy - e1y[j] * bpx);
+                float c2 = nx[j] * (e2y[j] * cpz - e2z[j] * cpy) + ny[j] * (e2z[j] * cpx - e2x[j] * cpz) + nz[j] * (e2x[j] * cpy - e2y[j] * cpx);
+                float plane = apx * nx[j] + apy * ny[j] + apz * nz[j];
+                bool inside = (valid[j] > 0.0f) & (c0 >= 0.0f) & (c1 >= 0.0f) & (c2 >= 0.0f);
+
+                sqDist[j] = inside ? plane * plane : edge;
+                side[j] = plane;
             }
         }
 
     private:
-        Base::Matrix4D _transform;
+        std::vector<Facet> _facets;
+        std::vector<unsigned long> _offsets;
+        std::vector<unsigned long> _indices;
+        unsigned long _cells[3];
+        float _min[3], _len[3], _invLen[3];
     };
 }
 
-InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset) : _iter(rMesh.getKernel())
+InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset) : _offset(offset)
 {
     const MeshCore::MeshKernel& kernel = rMesh.getKernel();
-    _iter.Transform(rMesh.getTransform());
 
     // Max. limit of grid elements
     float fMaxGridElements=8000000.0f;
@@ -261,7 +402,7 @@ InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offs
 
     // estimate the minimum allowed grid length
     float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
-    float fGridLen = 5.0f * MeshCore::MeshAlgorithm(kernel).GetAverageEdgeLength();
+    float fGridLen = 2.0f * MeshCore::MeshAlgorithm(kernel).GetAverageEdgeLength();
 
     // We want to avoid to get too small grid elements otherwise building up the grid structure would take
     // too much time and memory. 
@@ -270,7 +411,7 @@ InspectNominalMesh::InspectNominalMesh(const Mesh::MeshObject& rMesh, float offs
     fGridLen = std::max<float>(fMinGridLen, fGridLen);
 
     // build up grid structure to speed up algorithms
-    _pGrid = new MeshInspectGrid(kernel, fGridLen, rMesh.getTransform());
+    _pGrid = new MeshDistanceGrid(kernel, rMesh.getTransform(), fGridLen);
     _box = box;
     _box.Enlarge(offset);
 }
@@ -285,99 +426,65 @@ float InspectNominalMesh::getDistance(const Base::Vector3f& point)
     if (!_box.IsInBox(point))
         return FLT_MAX; // must be inside bbox
 
-    std::vector<unsigned long> indices;
-    //_pGrid->GetElements(point, indices);
-    if (indices.empty()) {
-        std::set<unsigned long> inds;
-        _pGrid->MeshGrid::SearchNearestFromPoint(point, inds);
-        indices.insert(indices.begin(), inds.begin(), inds.end());
-    }
+    std::vector<unsigned long> buffer;
+    return _pGrid->getDistance(point, _offset, buffer);
+}
 
-    float fMinDist=FLT_MAX;
-    bool positive = true;
-    for (std::vector<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
-        if (fabs(fDist) < fabs(fMinDist)) {
-            fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
-        }
+void InspectNominalMesh::getDistances(const std::vector<Base::Vector3f>& points, std::vector<float>& distances)
+{
+    distances.resize(points.size());
+
+    // handle the points ordered by grid cells, so that the same facets are checked in a row
+    std::vector< std::pair<unsigned long, unsigned long> > order;
+    order.reserve(points.size());
+    for (unsigned long i = 0; i < points.size(); i++)
+        order.push_back(std::make_pair(_pGrid->getCell(points[i]), i));
+    std::sort(order.begin(), order.end());
+
+    std::vector<unsigned long> buffer;
+    for (std::vector< std::pair<unsigned long, unsigned long> >::iterator it = order.begin(); it != order.end(); ++it) {
+        const Base::Vector3f& point = points[it->second];
+        if (!_box.IsInBox(point))
+            distances[it->second] = FLT_MAX; // must be inside bbox
+        else
+            distances[it->second] = _pGrid->getDistance(point, _offset, buffer);
     }
-
-    if (!positive)
-        fMinDist = -fMinDist;
-    return fMinDist;
 }
 
 // ----------------------------------------------------------------
 
-InspectNominalFastMesh::InspectNominalFastMesh(const Mesh::MeshObject& rMesh, float offset) : _iter(rMesh.getKernel())
+InspectNominalFastMesh::InspectNominalFastMesh(const Mesh::MeshObject& rMesh, float offset) : _offset(offset)
 {
     const MeshCore::MeshKernel& kernel = rMesh.getKernel();
-    _iter.Transform(rMesh.getTransform());
-
-    // Max. limit of grid elements
-    float fMaxGridElements=8000000.0f;
-    Base::BoundBox3f box = kernel.GetBoundBox().Transformed(rMesh.getTransform());
 
-    // estimate the minimum allowed grid length
-    float fMinGridLen = (float)pow((box.LengthX()*box.LengthY()*box.LengthZ()/fMaxGridElements), 0.3333f);
-    float fGridLen = 5.0f * MeshCore::MeshAlgorithm(kernel).GetAverageEdgeLength();
-
-    // We want to avoid to get too small grid elements otherwise building up the grid structure would take
-    // too much time and memory. 
-    // Having quite a dense grid speeds up more the following algorithms extremely. Due to the issue above it's
-    // always a compromise between speed and memory usage.
-    fGridLen = std::max<float>(fMinGridLen, fGridLen);
-
-    // build up grid structure to speed up algorithms
-    _pGrid = new MeshInspectGrid(kernel, fGridLen, rMesh.getTransform());
-    _box = box;
+    // the tree adapts to the facet density, so there is no grid length to choose
+    _pTree = new MeshCore::MeshFacetTree(kernel, rMesh.getTransform());
+    _box = kernel.GetBoundBox().Transformed(rMesh.getTransform());
     _box.Enlarge(offset);
-    max_level = (unsigned long)(offset/fGridLen);
 }
 
 InspectNominalFastMesh::~InspectNominalFastMesh()
 {
-    delete this->_pGrid;
+    delete this->_pTree;
 }
 
 /**
- * This algorithm is not that exact as that from InspectNominalMesh but is by
- * factors faster and sufficient for many cases.
+ * The distance is exact like that from InspectNominalMesh, the bounding volume
+ * hierarchy is faster for meshes with very different facet sizes.
  */
 float InspectNominalFastMesh::getDistance(const Base::Vector3f& point)
 {
     if (!_box.IsInBox(point))
         return FLT_MAX; // must be inside bbox
 
-    std::set<unsigned long> indices;
-#if 0 // a point in a neighbour grid can be nearer
-    std::vector<unsigned long> elements;
-    _pGrid->GetElements(point, elements);
-    indices.insert(elements.begin(), elements.end());
-#else
-    unsigned long ulX, ulY, ulZ;
-    _pGrid->Position(point, ulX, ulY, ulZ);
-    unsigned long ulLevel = 0;
-    while (indices.size() == 0 && ulLevel <= max_level)
-        _pGrid->GetHull(ulX, ulY, ulZ, ulLevel++, indices);
-    if (indices.size() == 0 || ulLevel==1)
-        _pGrid->GetHull(ulX, ulY, ulZ, ulLevel, indices);
-#endif
-
-    float fMinDist=FLT_MAX;
-    bool positive = true;
-    for (std::set<unsigned long>::iterator it = indices.begin(); it != indices.end(); ++it) {
-        _iter.Set(*it);
-        float fDist = _iter->DistanceToPoint(point);
-        if (fabs(fDist) < fabs(fMinDist)) {
-            fMinDist = fDist;
-            positive = point.DistanceToPlane(_iter->_aclPoints[0], _iter->GetNormal()) > 0;
-        }
-    }
+    Base::Vector3f proj;
+    unsigned long index = _pTree->SearchNearestFromPoint(point, _offset, proj);
+    if (index == ULONG_MAX)
+        return FLT_MAX;
 
-    if (!positive)
+    MeshCore::MeshGeomFacet facet = _pTree->GetFacet(index);
+    float fMinDist = Base::Distance(point, proj);
+    if (point.DistanceToPlane(facet._aclPoints[0], facet.GetNormal()) <= 0)
         fMinDist = -fMinDist;
     return fMinDist;
 }
@@ -443,35 +550,43 @@ float InspectNominalShape::getDistance(const Base::Vector3f& point)
 // ----------------------------------------------------------------
 
 // helper class to use Qt's concurrent framework
+struct DistanceBlock
+{
+    std::vector<Base::Vector3f> points;
+    float* distances;
+};
+
 struct DistanceInspection
 {
 
-    DistanceInspection(float radius, InspectActualGeometry*  a,
-                       std::vector<InspectNominalGeometry*> n)
-                    : radius(radius), actual(a), nominal(n)
+    DistanceInspection(float radius, const std::vector<InspectNominalGeometry*>& n)
+                    : radius(radius), nominal(n)
     {
     }
-    float mapped(unsigned long index)
+    void inspect(DistanceBlock& block)
     {
-        Base::Vector3f pnt = actual->getPoint(index);
+        std::size_t count = block.points.size();
+        float* fMinDist = block.distances;
+        std::fill(fMinDist, fMinDist + count, FLT_MAX);
 
-        float fMinDist=FLT_MAX;
+        std::vector<float> fDist;
         for (std::vector<InspectNominalGeometry*>::iterator it = nominal.begin(); it != nominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
+            (*it)->getDistances(block.points, fDist);
+            for (std::size_t i = 0; i < count; i++) {
+                if (fabs(fDist[i]) < fabs(fMinDist[i]))
+                    fMinDist[i] = fDist[i];
+            }
         }
 
-        if (fMinDist > this->radius)
-            fMinDist = FLT_MAX;
-        else if (-fMinDist > this->radius)
-            fMinDist = -FLT_MAX;
-
-        return fMinDist;
+        for (std::size_t i = 0; i < count; i++) {
+            if (fMinDist[i] > this->radius)
+                fMinDist[i] = FLT_MAX;
+            else if (-fMinDist[i] > this->radius)
+                fMinDist[i] = -FLT_MAX;
+        }
     }
 
     float radius;
-    InspectActualGeometry*  actual;
     std::vector<InspectNominalGeometry*> nominal;
 };
 
@@ -484,10 +599,40 @@ Feature::Feature()
     ADD_PROPERTY(Actual,(0));
     ADD_PROPERTY(Nominals,(0));
     ADD_PROPERTY(Distances,(0.0f));
+    // the default is taken here because execute() may run in a worker thread
+    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Inspection");
+    ADD_PROPERTY(UseFacetTree,(hGrp->GetBool("UseFacetTree", false)));
+
+    connectChangedObject = App::GetApplication().signalChangedObject.connect
+        (boost::bind(&Feature::slotChangedObject, this, _1, _2));
+    connectDeletedObject = App::GetApplication().signalDeletedObject.connect
+        (boost::bind(&Feature::slotDeletedObject, this, _1));
 }
 
 Feature::~Feature()
 {
+    connectChangedObject.disconnect();
+    connectDeletedObject.disconnect();
+}
+
+void Feature::onChanged(const App::Property* prop)
+{
+    // the nominal meshes must be rebuilt with the other search structure
+    if (prop == &UseFacetTree)
+        nominalCache.clear();
+    App::DocumentObject::onChanged(prop);
+}
+
+void Feature::slotChangedObject(const App::DocumentObject& Obj, const App::Property&)
+{
+    // the search structures of a modified nominal must be rebuilt
+    nominalCache.erase(&Obj);
+}
+
+void Feature::slotDeletedObject(const App::DocumentObject& Obj)
+{
+    nominalCache.erase(&Obj);
 }
 
 short Feature::mustExecute() const
@@ -500,6 +645,8 @@ short Feature::mustExecute() const
         return 1;
     if (Nominals.isTouched())
         return 1;
+    if (UseFacetTree.isTouched())
+        return 1;
     return 0;
 }
 
@@ -526,14 +673,25 @@ App::DocumentObjectExecReturn* Feature::execute(void)
         throw Base::Exception("Unknown geometric type");
     }
 
-    // get a list of nominals
+    // get a list of nominals, unchanged nominals of the last recompute are reused
     std::vector<InspectNominalGeometry*> inspectNominal;
     const std::vector<App::DocumentObject*>& nominals = Nominals.getValues();
+    std::map<const App::DocumentObject*, CachedNominal> cache;
     for (std::vector<App::DocumentObject*>::const_iterator it = nominals.begin(); it != nominals.end(); ++it) {
+        std::map<const App::DocumentObject*, CachedNominal>::iterator jt = nominalCache.find(*it);
+        if (jt != nominalCache.end() && jt->second.first == this->SearchRadius.getValue()) {
+            cache[*it] = jt->second;
+            inspectNominal.push_back(jt->second.second.get());
+            continue;
+        }
+
         InspectNominalGeometry* nominal = 0;
         if ((*it)->getTypeId().isDerivedFrom(Mesh::Feature::getClassTypeId())) {
             Mesh::Feature* mesh = static_cast<Mesh::Feature*>(*it);
-            nominal = new InspectNominalMesh(mesh->Mesh.getValue(), this->SearchRadius.getValue());
+            if (UseFacetTree.getValue())
+                nominal = new InspectNominalFastMesh(mesh->Mesh.getValue(), this->SearchRadius.getValue());
+            else
+                nominal = new InspectNominalMesh(mesh->Mesh.getValue(), this->SearchRadius.getValue());
         }
         else if ((*it)->getTypeId().isDerivedFrom(Points::Feature::getClassTypeId())) {
             Points::Feature* pts = static_cast<Points::Feature*>(*it);
@@ -544,56 +702,57 @@ App::DocumentObjectExecReturn* Feature::execute(void)
             nominal = new InspectNominalShape(part->Shape.getValue(), this->SearchRadius.getValue());
         }
 
-        if (nominal)
+        if (nominal) {
+            cache[*it] = CachedNominal(this->SearchRadius.getValue(),
+                boost::shared_ptr<InspectNominalGeometry>(nominal));
             inspectNominal.push_back(nominal);
+        }
     }
+    nominalCache.swap(cache);
 
-#if 0 // test with some huge data sets
-    Standard::SetReentrant(Standard_True);
-    std::vector<unsigned long> index(actual->countPoints());
-    std::generate(index.begin(), index.end(), Base::iotaGen<unsigned long>(0));
-    DistanceInspection check(this->SearchRadius.getValue(), actual, inspectNominal);
-    QFuture<float> future = QtConcurrent::mapped
-        (index, boost::bind(&DistanceInspection::mapped, &check, _1));
-    //future.waitForFinished(); // blocks the GUI
-    Base::FutureWatcherProgress progress("Inspecting...", actual->countPoints());
-    QFutureWatcher<float> watcher;
-    QObject::connect(&watcher, SIGNAL(progressValueChanged(int)),
-                     &progress, SLOT(progressValueChanged(int)));
-    watcher.setFuture(future);
-
-    // keep it responsive during computation
-    QEventLoop loop;
-    QObject::connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
-    loop.exec();
-
-    std::vector<float> vals;
-    vals.insert(vals.end(), future.begin(), future.end());
-#else
     unsigned long count = actual->countPoints();
     std::stringstream str;
     str << "Inspecting " << this->Label.getValue() << "...";
-    Base::SequencerLauncher seq(str.str().c_str(), count);
+
+    // The points are fetched in chunks which are split into blocks. If all nominals
+    // allow it the blocks are handled in parallel.
+    bool parallel = true;
+    for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
+        if (!(*it)->isThreadSafe())
+            parallel = false;
+    }
+
+    const unsigned long blockSize = 4096;
+    const unsigned long chunkSize = 64 * blockSize;
+    Base::SequencerLauncher seq(str.str().c_str(), count / chunkSize + 1);
 
     std::vector<float> vals(count);
-    for (unsigned long index = 0; index < count; index++) {
-        Base::Vector3f pnt = actual->getPoint(index);
-
-        float fMinDist=FLT_MAX;
-        for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it) {
-            float fDist = (*it)->getDistance(pnt);
-            if (fabs(fDist) < fabs(fMinDist))
-                fMinDist = fDist;
+    DistanceInspection check(this->SearchRadius.getValue(), inspectNominal);
+    std::vector<DistanceBlock> blocks;
+    for (unsigned long start = 0; start < count; start += chunkSize) {
+        unsigned long stop = std::min<unsigned long>(count, start + chunkSize);
+        blocks.resize((stop - start + blockSize - 1) / blockSize);
+        for (unsigned long i = 0; i < blocks.size(); i++) {
+            DistanceBlock& block = blocks[i];
+            unsigned long first = start + i * blockSize;
+            unsigned long last = std::min<unsigned long>(stop, first + blockSize);
+            block.points.clear();
+            for (unsigned long index = first; index < last; index++)
+                block.points.push_back(actual->getPoint(index));
+            block.distances = &vals[first];
         }
 
-        if (fMinDist > this->SearchRadius.getValue())
-            fMinDist = FLT_MAX;
-        else if (-fMinDist > this->SearchRadius.getValue())
-            fMinDist = -FLT_MAX;
-        vals[index] = fMinDist;
+        if (parallel && blocks.size() > 1) {
+            QFuture<void> future = QtConcurrent::map
+                (blocks, boost::bind(&DistanceInspection::inspect, &check, _1));
+            future.waitForFinished();
+        }
+        else {
+            for (std::vector<DistanceBlock>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+                check.inspect(*it);
+        }
         seq.next();
     }
-#endif
 
     Distances.setValues(vals);
 
@@ -606,14 +765,18 @@ App::DocumentObjectExecReturn* Feature::execute(void)
         }
     }
 
-    fRMS = fRMS / countRMS;
-    fRMS = sqrt(fRMS);
-    Base::Console().Message("RMS value for '%s' with search radius=%.4f is: %.4f\n",
-        this->Label.getValue(), this->SearchRadius.getValue(), fRMS);
+    if (countRMS > 0) {
+        fRMS = fRMS / countRMS;
+        fRMS = sqrt(fRMS);
+        Base::Console().Message("RMS value for '%s' with search radius=%.4f is: %.4f\n",
+            this->Label.getValue(), this->SearchRadius.getValue(), fRMS);
+    }
+    else {
+        Base::Console().Message("No point of '%s' is within the search radius=%.4f\n",
+            this->Label.getValue(), this->SearchRadius.getValue());
+    }
 
     delete actual;
-    for (std::vector<InspectNominalGeometry*>::iterator it = inspectNominal.begin(); it != inspectNominal.end(); ++it)
-        delete *it;
 
     return 0;
 }
@@ -24,6 +24,10 @@
 #ifndef INSPECTION_FEATURE_H
 #define INSPECTION_FEATURE_H
 
+#include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/signals.hpp>
+
 #include <App/DocumentObject.h>
 #include <App/PropertyLinks.h>
 #include <App/DocumentObjectGroup.h>
@@ -36,7 +40,7 @@ class BRepExtrema_DistShapeShape;
 
 namespace MeshCore {
 class MeshKernel;
-class MeshGrid;
+class MeshFacetTree;
 }
 
 namespace Mesh   { class MeshObject; }
@@ -45,6 +49,7 @@ namespace Part   { class TopoShape;  }
 
 namespace Inspection
 {
+class MeshDistanceGrid;
 
 /** Delivers the number of points to be checked and returns the appropriate point to an index. */
 class InspectionExport InspectActualGeometry
@@ -100,33 +105,45 @@ public:
     InspectNominalGeometry() {}
     virtual ~InspectNominalGeometry() {}
     virtual float getDistance(const Base::Vector3f&) = 0;
+    /** Calculates the distances of a block of points. The default implementation
+     * calls getDistance() for each point.
+     */
+    virtual void getDistances(const std::vector<Base::Vector3f>&, std::vector<float>&);
+    /// Returns true if getDistances() can be called from several threads at the same time
+    virtual bool isThreadSafe() const { return false; }
 };
 
+/** Calculates the exact distance to a mesh. Points farther away than \a offset get FLT_MAX. */
 class InspectionExport InspectNominalMesh : public InspectNominalGeometry
 {
 public:
     InspectNominalMesh(const Mesh::MeshObject& rMesh, float offset);
     ~InspectNominalMesh();
     virtual float getDistance(const Base::Vector3f&);
+    virtual void getDistances(const std::vector<Base::Vector3f>&, std::vector<float>&);
+    virtual bool isThreadSafe() const { return true; }
 
 private:
-    MeshCore::MeshFacetIterator _iter;
-    MeshCore::MeshGrid* _pGrid;
+    MeshDistanceGrid* _pGrid;
     Base::BoundBox3f _box;
+    float _offset;
 };
 
+/** Does the same as InspectNominalMesh but uses a bounding volume hierarchy instead of a grid.
+ * It is selected with the property UseFacetTree and pays off for meshes with very different facet sizes.
+ */
 class InspectionExport InspectNominalFastMesh : public InspectNominalGeometry
 {
 public:
     InspectNominalFastMesh(const Mesh::MeshObject& rMesh, float offset);
     ~InspectNominalFastMesh();
     virtual float getDistance(const Base::Vector3f&);
+    virtual bool isThreadSafe() const { return true; }
 
 protected:
-    MeshCore::MeshFacetIterator _iter;
-    MeshCore::MeshGrid* _pGrid;
+    MeshCore::MeshFacetTree* _pTree;
     Base::BoundBox3f _box;
-    unsigned long max_level;
+    float _offset;
 };
 
 class InspectionExport InspectNominalPoints : public InspectNominalGeometry
@@ -135,6 +152,7 @@ public:
     InspectNominalPoints(const Points::PointKernel&, float offset);
     ~InspectNominalPoints();
     virtual float getDistance(const Base::Vector3f&);
+    virtual bool isThreadSafe() const { return true; }
 
 private:
     const Points::PointKernel& _rKernel;
@@ -174,6 +192,7 @@ public:
     App::PropertyLink      Actual;
     App::PropertyLinkList  Nominals;
     App::PropertyFloatList Distances;
+    App::PropertyBool      UseFacetTree;
     //@}
 
     /** @name Actions */
@@ -186,6 +205,22 @@ public:
     /// returns the type name of the ViewProvider
     const char* getViewProviderName(void) const 
     { return "InspectionGui::ViewProviderInspection"; }
+
+protected:
+    void onChanged(const App::Property* prop);
+
+private:
+    void slotChangedObject(const App::DocumentObject&, const App::Property&);
+    void slotDeletedObject(const App::DocumentObject&);
+
+private:
+    /** The nominals of the last recompute with the search radius used for them.
+     * They are reused as long as the nominal objects don't change.
+     */
+    typedef std::pair<float, boost::shared_ptr<InspectNominalGeometry> > CachedNominal;
+    std::map<const App::DocumentObject*, CachedNominal> nominalCache;
+    boost::signals::connection connectChangedObject;
+    boost::signals::connection connectDeletedObject;
 };
 
 class InspectionExport Group : public App::DocumentObjectGroup
@@ -0,0 +1,112 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, unittest, random, Mesh, Points, Inspection
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD Inspection module
+#---------------------------------------------------------------------------
+
+def makeRandomMesh(rnd, count):
+    facets = []
+    for i in range(count):
+        facets.append([(rnd.random(), rnd.random(), rnd.random()) for j in range(3)])
+    mesh = Mesh.Mesh()
+    mesh.addFacets(facets)
+    return mesh
+
+def makeRandomCloud(rnd, count):
+    return Points.Points([(rnd.uniform(-0.5,1.5), rnd.uniform(-0.5,1.5), rnd.uniform(-0.5,1.5)) for i in range(count)])
+
+class InspectionTestCases(unittest.TestCase):
+    def setUp(self):
+        self.rnd = random.Random(42)
+        self.doc = FreeCAD.newDocument("InspectionTest")
+        self.nominal = self.doc.addObject("Mesh::Feature","Nominal")
+        self.nominal.Mesh = makeRandomMesh(self.rnd, 300)
+        self.actual = self.doc.addObject("Points::Feature","Actual")
+        self.actual.Points = makeRandomCloud(self.rnd, 2000)
+        self.inspection = self.doc.addObject("Inspection::Feature","Inspection")
+        self.inspection.Actual = self.actual
+        self.inspection.Nominals = [self.nominal]
+        # all points are within the search radius
+        self.inspection.SearchRadius = 10.0
+
+    def checkDistances(self, mesh):
+        # compare with the brute force search over all facets
+        dist = self.inspection.Distances
+        pts = self.actual.Points.Points
+        self.failUnless(len(dist) == len(pts))
+        for i in range(len(pts)):
+            p = pts[i]
+            res = mesh.nearestFacetToPoint((p.x, p.y, p.z))
+            q = FreeCAD.Vector(res.values()[0])
+            self.failUnless(abs(abs(dist[i]) - (p - q).Length) < 1e-4,
+                "Distance of point %d is %f instead of %f" % (i, abs(dist[i]), (p - q).Length))
+
+    def testDistanceGrid(self):
+        self.doc.recompute()
+        self.checkDistances(self.nominal.Mesh)
+
+    def testFacetTree(self):
+        self.doc.recompute()
+        self.inspection.UseFacetTree = True
+        self.failUnless(self.inspection.mustExecute())
+        self.doc.recompute()
+        self.checkDistances(self.nominal.Mesh)
+        self.inspection.UseFacetTree = False
+        self.doc.recompute()
+        self.checkDistances(self.nominal.Mesh)
+
+    def testNominalChanged(self):
+        # the search structure of the old mesh must not be reused
+        self.doc.recompute()
+        mesh = self.nominal.Mesh.copy()
+        mesh.translate(0.0, 0.0, 0.5)
+        self.nominal.Mesh = mesh
+        self.doc.recompute()
+        self.checkDistances(mesh)
+
+    def testNominalDeleted(self):
+        # a new nominal may get the address of the deleted one
+        self.doc.recompute()
+        self.doc.removeObject("Nominal")
+        self.nominal = self.doc.addObject("Mesh::Feature","Nominal")
+        self.nominal.Mesh = makeRandomMesh(self.rnd, 100)
+        self.inspection.Nominals = [self.nominal]
+        self.doc.recompute()
+        self.checkDistances(self.nominal.Mesh)
+
+    def testNoPointInRange(self):
+        mesh = self.nominal.Mesh.copy()
+        mesh.translate(100.0, 0.0, 0.0)
+        self.nominal.Mesh = mesh
+        self.inspection.SearchRadius = 0.1
+        self.doc.recompute()
+        self.failIf("Invalid" in self.inspection.State)
+        for d in self.inspection.Distances:
+            self.failUnless(abs(d) > 1e38)
+
+    def tearDown(self):
+        FreeCAD.closeDocument("InspectionTest")
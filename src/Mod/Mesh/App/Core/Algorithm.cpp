@@ -27,11 +27,15 @@
 # include <algorithm>
 #endif
 
+#include <QAtomicInt>
+
 #include "Algorithm.h"
 #include "Approximation.h"
 #include "Elements.h"
 #include "Iterator.h"
 #include "Grid.h"
+#include "FacetTree.h"
+#include "Helpers.h"
 #include "Triangulation.h"
 
 #include <Base/Console.h>
@@ -68,6 +72,31 @@ bool MeshAlgorithm::IsVertexVisible (const Base::Vector3f &rcVertex, const Base:
   return true; // no facet between the two points
 }
 
+bool MeshAlgorithm::IsVertexVisible (const Base::Vector3f &rcVertex, const Base::Vector3f &rcView, const MeshFacetTree &rclTree ) const
+{
+  Base::Vector3f cDirection = rcVertex-rcView;
+  float fDistance = cDirection.Length();
+  Base::Vector3f cIntsct; unsigned long uInd;
+
+  // search for the nearest facet to rcView in direction to rcVertex
+  if ( NearestFacetOnRay( rcView, cDirection, rclTree, cIntsct, uInd) )
+  {
+    // now check if the facet overlays the point
+    float fLen = Base::Distance( rcView, cIntsct );
+    if ( fLen < fDistance )
+    {
+      // is it the same point?
+      if ( Base::Distance(rcVertex, cIntsct) > 0.001f )
+      {
+        // ok facet overlays the vertex
+        return false;
+      }
+    }
+  }
+
+  return true; // no facet between the two points
+}
+
 bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, Base::Vector3f &rclRes,
                                        unsigned long &rulFacet) const
 {
@@ -122,6 +151,12 @@ bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::
     return false;
 }
 
+bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetTree &rclTree,
+                                       Base::Vector3f &rclRes, unsigned long &rulFacet) const
+{
+    return rclTree.NearestFacetOnRay(rclPt, rclDir, FLOAT_MAX, rclRes, rulFacet);
+}
+
 bool MeshAlgorithm::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float fMaxSearchArea,
                                        const MeshFacetGrid &rclGrid, Base::Vector3f &rclRes, unsigned long &rulFacet) const
 {
@@ -208,16 +243,33 @@ bool MeshAlgorithm::RayNearestField (const Base::Vector3f &rclPt, const Base::Ve
 
 bool MeshAlgorithm::FirstFacetToVertex(const Base::Vector3f &rPt, float fMaxDistance, const MeshFacetGrid &rGrid, unsigned long &uIndex) const
 {
-    const float fEps = 0.001f;
-
-    bool found = false;
     std::vector<unsigned long> facets;
 
     // get the facets of the grid the point lies into
     rGrid.GetElements(rPt, facets);
+    return FirstFacetToVertex(rPt, fMaxDistance, facets, uIndex);
+}
+
+bool MeshAlgorithm::FirstFacetToVertex(const Base::Vector3f &rPt, float fMaxDistance, const MeshFacetTree &rTree, unsigned long &uIndex) const
+{
+    std::vector<unsigned long> facets;
+
+    // get the facets near the point, also those which are only close to an edge
+    Base::BoundBox3f clBox(rPt.x, rPt.y, rPt.z, rPt.x, rPt.y, rPt.z);
+    clBox.Enlarge(std::max<float>(fMaxDistance, 0.001f));
+    rTree.Inside(clBox, facets);
+    return FirstFacetToVertex(rPt, fMaxDistance, facets, uIndex);
+}
+
+bool MeshAlgorithm::FirstFacetToVertex(const Base::Vector3f &rPt, float fMaxDistance, const std::vector<unsigned long> &facets,
+                                       unsigned long &uIndex) const
+{
+    const float fEps = 0.001f;
+
+    bool found = false;
 
-    // Check all facets inside the grid if the point is part of it
-    for (std::vector<unsigned long>::iterator it = facets.begin(); it != facets.end(); ++it) {
+    // Check all facets if the point is part of it
+    for (std::vector<unsigned long>::const_iterator it = facets.begin(); it != facets.end(); ++it) {
         MeshGeomFacet cFacet = this->_rclMesh.GetFacet(*it);
         if (cFacet.IsPointOfFace(rPt, fMaxDistance)) {
             found = true;
@@ -626,8 +678,8 @@ bool MeshAlgorithm::FillupHole(const std::vector<unsigned long>& boundary,
     unsigned long refPoint0 = *(boundary.begin());
     unsigned long refPoint1 = *(boundary.begin()+1);
     if (pP2FStructure) {
-        const std::set<unsigned long>& ring1 = (*pP2FStructure)[refPoint0];
-        const std::set<unsigned long>& ring2 = (*pP2FStructure)[refPoint1];
+        MeshIndexRange ring1 = pP2FStructure->GetRange(refPoint0);
+        MeshIndexRange ring2 = pP2FStructure->GetRange(refPoint1);
         std::vector<unsigned long> f_int;
         std::set_intersection(ring1.begin(), ring1.end(), ring2.begin(), ring2.end(),
             std::back_insert_iterator<std::vector<unsigned long> >(f_int));
@@ -1171,13 +1223,7 @@ void MeshAlgorithm::CheckFacets(const Base::ViewProjMethod* pclProj, const Base:
 
 float MeshAlgorithm::Surface (void) const
 {
-  float              fTotal = 0.0f;
-  MeshFacetIterator clFIter(_rclMesh);
-
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
-    fTotal +=  clFIter->Area();
-  
-  return fTotal;
+  return _rclMesh.GetSurface();
 }
 
 void MeshAlgorithm::SubSampleByDist (float fDist, std::vector<Base::Vector3f> &rclPoints) const
@@ -1239,6 +1285,35 @@ void MeshAlgorithm::SearchFacetsFromPolyline (const std::vector<Base::Vector3f>
   rclResultFacetsIndices.insert(rclResultFacetsIndices.begin(), aclFacets.begin(), aclFacets.end());
 }
 
+void MeshAlgorithm::SearchFacetsFromPolyline (const std::vector<Base::Vector3f> &rclPolyline, float fRadius,
+                                              const MeshFacetTree& rclTree, std::vector<unsigned long> &rclResultFacetsIndices) const
+{
+  rclResultFacetsIndices.clear();
+  if ( rclPolyline.size() < 3 )
+    return; // no polygon defined
+
+  std::set<unsigned long>  aclFacets;
+  for (std::vector<Base::Vector3f>::const_iterator pV = rclPolyline.begin(); pV < (rclPolyline.end() - 1); pV++)
+  {
+    const Base::Vector3f &rclP0 = *pV, &rclP1 = *(pV + 1);
+
+    // bounding box of the segment enlarged by the search radius
+    BoundBox3f clSegmBB(rclP0.x, rclP0.y, rclP0.z, rclP0.x, rclP0.y, rclP0.z);
+    clSegmBB &= rclP1;
+    clSegmBB.Enlarge(fRadius);
+
+    std::vector<unsigned long> aclBBFacets;
+    rclTree.Inside(clSegmBB, aclBBFacets);
+    for (std::vector<unsigned long>::iterator it = aclBBFacets.begin(); it != aclBBFacets.end(); ++it)
+    {
+      if (_rclMesh.GetFacet(*it).DistanceToLineSegment(rclP0, rclP1) < fRadius)
+        aclFacets.insert(*it);
+    }
+  }
+
+  rclResultFacetsIndices.insert(rclResultFacetsIndices.begin(), aclFacets.begin(), aclFacets.end());
+}
+
 void MeshAlgorithm::CutBorderFacets (std::vector<unsigned long> &raclFacetIndices, unsigned short usLevel) const
 {
   std::vector<unsigned long> aclToDelete;
@@ -1390,6 +1465,24 @@ bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const Me
   return true;
 }
 
+bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree, unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const
+{
+  return NearestPointFromPoint(rclPt, rclTree, FLOAT_MAX, rclResFacetIndex, rclResPoint);
+}
+
+bool MeshAlgorithm::NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree, float fMaxSearchArea,
+                                           unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const
+{
+  unsigned long ulInd = rclTree.SearchNearestFromPoint(rclPt, fMaxSearchArea, rclResPoint);
+
+  if (ulInd == ULONG_MAX)
+    return false;  // no facet within the search area
+
+  rclResFacetIndex = ulInd;
+
+  return true;
+}
+
 bool MeshAlgorithm::CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                                   std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps, bool bConnectPolygons) const
 {
@@ -1408,10 +1501,24 @@ bool MeshAlgorithm::CutWithPlane (const Base::Vector3f &clBase, const Base::Vect
   std::sort(aulFacets.begin(), aulFacets.end());
   aulFacets.erase(std::unique(aulFacets.begin(), aulFacets.end()), aulFacets.end());  
 
+  return CutFacetsWithPlane(clBase, clNormal, aulFacets, rclResult, fMinEps, bConnectPolygons);
+}
+
+bool MeshAlgorithm::CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetTree &rclTree,
+                                  std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps, bool bConnectPolygons) const
+{
+  std::vector<unsigned long> aulFacets;
+  rclTree.CutByPlane(clBase, clNormal, aulFacets);
+  return CutFacetsWithPlane(clBase, clNormal, aulFacets, rclResult, fMinEps, bConnectPolygons);
+}
+
+bool MeshAlgorithm::CutFacetsWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const std::vector<unsigned long> &aulFacets,
+                                        std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps, bool bConnectPolygons) const
+{
   // alle Facets mit Ebene schneiden
   std::list<std::pair<Base::Vector3f, Base::Vector3f> > clTempPoly;  // Feld mit Schnittlinien (unsortiert, nicht verkettet)
 
-  for (std::vector<unsigned long>::iterator pF = aulFacets.begin(); pF != aulFacets.end(); pF++)
+  for (std::vector<unsigned long>::const_iterator pF = aulFacets.begin(); pF != aulFacets.end(); pF++)
   {
     Base::Vector3f  clE1, clE2;
     const MeshGeomFacet clF(_rclMesh.GetFacet(*pF));
@@ -1605,9 +1712,6 @@ void MeshAlgorithm::GetFacetsFromPlane (const MeshFacetGrid &rclGrid, const Base
 
     Base::Vector3f clBase = d * clNormal;
 
-    Base::Vector3f clPtNormal(rclLeft - rclRight);
-    clPtNormal.Normalize();
-
     // search grid 
     MeshGridIterator clGridIter(rclGrid);
     for (clGridIter.Init(); clGridIter.More(); clGridIter.Next()) {
@@ -1616,8 +1720,27 @@ void MeshAlgorithm::GetFacetsFromPlane (const MeshFacetGrid &rclGrid, const Base
             clGridIter.GetElements(aulFacets);
     }
 
+    FacetsFromPlane(aulFacets, clNormal, d, rclLeft, rclRight, rclRes);
+}
+
+void MeshAlgorithm::GetFacetsFromPlane (const MeshFacetTree &rclTree, const Base::Vector3f& clNormal, float d, const Base::Vector3f &rclLeft,
+                                        const Base::Vector3f &rclRight, std::vector<unsigned long> &rclRes) const
+{
+    std::vector<unsigned long> aulFacets;
+    rclTree.CutByPlane(d * clNormal, clNormal, aulFacets);
+    FacetsFromPlane(aulFacets, clNormal, d, rclLeft, rclRight, rclRes);
+}
+
+void MeshAlgorithm::FacetsFromPlane (const std::vector<unsigned long> &aulFacets, const Base::Vector3f& clNormal, float d,
+                                     const Base::Vector3f &rclLeft, const Base::Vector3f &rclRight, std::vector<unsigned long> &rclRes) const
+{
+    Base::Vector3f clBase = d * clNormal;
+
+    Base::Vector3f clPtNormal(rclLeft - rclRight);
+    clPtNormal.Normalize();
+
     // testing facet against planes
-    for (std::vector<unsigned long>::iterator pI = aulFacets.begin(); pI != aulFacets.end(); ++pI) {
+    for (std::vector<unsigned long>::const_iterator pI = aulFacets.begin(); pI != aulFacets.end(); ++pI) {
         MeshGeomFacet clSFacet = _rclMesh.GetFacet(*pI);
         if (clSFacet.IntersectWithPlane(clBase, clNormal) == true) {
             bool bInner = false;
@@ -1683,28 +1806,163 @@ float MeshAlgorithm::CalculateMinimumGridLength(float fLength, const Base::Bound
 
 // ----------------------------------------------------
 
-void MeshRefPointToFacets::Rebuild (void)
+namespace MeshCore {
+namespace IndexTableHelpers {
+
+/// A range of elements to handle in one thread while building up an index table
+struct Job
 {
-    _map.clear();
+    const MeshKernel* mesh;
+    const MeshRefPointToFacets* pt2fa;
+    std::vector<QAtomicInt>* counters;
+    unsigned long* offsets;
+    unsigned long* indices;
+    unsigned long first, last;
+    /// the ranges of all elements of the job, collected while counting
+    std::vector<unsigned long> buffer;
+};
 
-    const MeshPointArray& rPoints = _rclMesh.GetPoints();
-    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
-    _map.resize(rPoints.size());
+/// Turns the counts stored at offsets[1..n] into the start of each range
+void AccumulateOffsets (std::vector<unsigned long>& offsets)
+{
+    for (std::size_t i = 1; i < offsets.size(); i++)
+        offsets[i] += offsets[i - 1];
+}
+
+void CountPointFacets (Job& job)
+{
+    const MeshFacetArray& rFacets = job.mesh->GetFacets();
+    std::vector<QAtomicInt>& counters = *job.counters;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        const MeshFacet& rFace = rFacets[i];
+        counters[rFace._aulPoints[0]].fetchAndAddRelaxed(1);
+        if (rFace._aulPoints[1] != rFace._aulPoints[0])
+            counters[rFace._aulPoints[1]].fetchAndAddRelaxed(1);
+        if (rFace._aulPoints[2] != rFace._aulPoints[0] && rFace._aulPoints[2] != rFace._aulPoints[1])
+            counters[rFace._aulPoints[2]].fetchAndAddRelaxed(1);
+    }
+}
+
+void FillPointFacets (Job& job)
+{
+    // the counters still hold the number of facets of each point and are counted down,
+    // so each thread gets its own slots
+    const MeshFacetArray& rFacets = job.mesh->GetFacets();
+    std::vector<QAtomicInt>& counters = *job.counters;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        const MeshFacet& rFace = rFacets[i];
+        unsigned long p0 = rFace._aulPoints[0], p1 = rFace._aulPoints[1], p2 = rFace._aulPoints[2];
+        job.indices[job.offsets[p0] + counters[p0].fetchAndAddRelaxed(-1) - 1] = i;
+        if (p1 != p0)
+            job.indices[job.offsets[p1] + counters[p1].fetchAndAddRelaxed(-1) - 1] = i;
+        if (p2 != p0 && p2 != p1)
+            job.indices[job.offsets[p2] + counters[p2].fetchAndAddRelaxed(-1) - 1] = i;
+    }
+}
+
+void SortRanges (Job& job)
+{
+    for (unsigned long i = job.first; i < job.last; i++)
+        std::sort(job.indices + job.offsets[i], job.indices + job.offsets[i + 1]);
+}
+
+/// Collects the sorted neighbour points of the point \a ulPos
+void NeighbourPoints (const Job& job, unsigned long ulPos, std::vector<unsigned long>& points)
+{
+    const MeshFacetArray& rFacets = job.mesh->GetFacets();
+    MeshIndexRange faces = job.pt2fa->GetRange(ulPos);
+    points.clear();
+    for (MeshIndexRange::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+        const MeshFacet& rFace = rFacets[*it];
+        for (int i = 0; i < 3; i++) {
+            if (rFace._aulPoints[i] != ulPos)
+                points.push_back(rFace._aulPoints[i]);
+        }
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+}
 
-    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
-    for (MeshFacetArray::_TConstIterator pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
-        _map[pFIter->_aulPoints[0]].insert(pFIter - pFBegin);
-        _map[pFIter->_aulPoints[1]].insert(pFIter - pFBegin);
-        _map[pFIter->_aulPoints[2]].insert(pFIter - pFBegin);
+void CollectPointPoints (Job& job)
+{
+    std::vector<unsigned long> points;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        NeighbourPoints(job, i, points);
+        job.offsets[i + 1] = points.size();
+        job.buffer.insert(job.buffer.end(), points.begin(), points.end());
     }
 }
 
+/// Collects the sorted facets sharing a point with the facet \a ulPos
+void NeighbourFacets (const Job& job, unsigned long ulPos, std::vector<unsigned long>& facets)
+{
+    const MeshFacet& rFace = job.mesh->GetFacets()[ulPos];
+    facets.clear();
+    for (int i = 0; i < 3; i++) {
+        MeshIndexRange faces = job.pt2fa->GetRange(rFace._aulPoints[i]);
+        facets.insert(facets.end(), faces.begin(), faces.end());
+    }
+    std::sort(facets.begin(), facets.end());
+    facets.erase(std::unique(facets.begin(), facets.end()), facets.end());
+}
+
+void CollectFacetFacets (Job& job)
+{
+    std::vector<unsigned long> facets;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        NeighbourFacets(job, i, facets);
+        job.offsets[i + 1] = facets.size();
+        job.buffer.insert(job.buffer.end(), facets.begin(), facets.end());
+    }
+}
+
+/// The ranges of a job are consecutive, so its buffer is copied as one block
+void CopyBuffer (Job& job)
+{
+    std::copy(job.buffer.begin(), job.buffer.end(), job.indices + job.offsets[job.first]);
+    std::vector<unsigned long>().swap(job.buffer);
+}
+
+} // namespace IndexTableHelpers
+} // namespace MeshCore
+
+using namespace MeshCore::IndexTableHelpers;
+
+void MeshRefPointToFacets::Rebuild (void)
+{
+    unsigned long ulCtPoints = _rclMesh.CountPoints();
+    unsigned long ulCtFacets = _rclMesh.CountFacets();
+    _offsets.assign(ulCtPoints + 1, 0);
+    std::vector<unsigned long>().swap(_indices);
+
+    // first pass counts the facets of each point, the second pass stores them
+    std::vector<QAtomicInt> counters(ulCtPoints);
+    Job proto = { &_rclMesh, 0, &counters, 0, 0, 0, 0 };
+    std::vector<Job> jobs = MakeJobs(ulCtFacets, proto);
+    RunJobs(jobs, CountPointFacets);
+
+    for (unsigned long i = 0; i < ulCtPoints; i++)
+        _offsets[i + 1] = (int)counters[i];
+    AccumulateOffsets(_offsets);
+    _indices.resize(_offsets.back());
+
+    for (std::vector<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+        it->offsets = &_offsets[0];
+        it->indices = _indices.empty() ? 0 : &_indices[0];
+    }
+    RunJobs(jobs, FillPointFacets);
+
+    // the threads fill the ranges in any order
+    std::vector<Job> sort = MakeJobs(ulCtPoints, jobs.front());
+    RunJobs(sort, SortRanges);
+}
+
 Base::Vector3f MeshRefPointToFacets::GetNormal(unsigned long pos) const
 {
-    const std::set<unsigned long>& n = _map[pos];
+    MeshIndexRange n = GetRange(pos);
     Base::Vector3f normal;
     MeshGeomFacet f;
-    for (std::set<unsigned long>::const_iterator it = n.begin(); it != n.end(); ++it) {
+    for (MeshIndexRange::const_iterator it = n.begin(); it != n.end(); ++it) {
         f = _rclMesh.GetFacet(*it);
         normal += f.Area() * f.GetNormal();
     }
@@ -1722,8 +1980,8 @@ std::set<unsigned long> MeshRefPointToFacets::NeighbourPoints(const std::vector<
     for (int i=0; i < level; i++) {
         std::set<unsigned long> cur;
         for (std::set<unsigned long>::iterator it = lp.begin(); it != lp.end(); ++it) {
-            const std::set<unsigned long>& ft = (*this)[*it];
-            for (std::set<unsigned long>::const_iterator jt = ft.begin(); jt != ft.end(); ++jt) {
+            MeshIndexRange ft = GetRange(*it);
+            for (MeshIndexRange::const_iterator jt = ft.begin(); jt != ft.end(); ++jt) {
                 for (int j = 0; j < 3; j++) {
                     unsigned long index = f_it[*jt]._aulPoints[j];
                     if (cp.find(index) == cp.end() && nb.find(index) == nb.end()) {
@@ -1763,9 +2021,9 @@ void MeshRefPointToFacets::SearchNeighbours(const MeshFacetArray& rFacets, unsig
     visited.insert(index);
     collect.Append(_rclMesh, index);
     for (int i = 0; i < 3; i++) {
-        const std::set<unsigned long> &f = (*this)[face._aulPoints[i]];
+        MeshIndexRange f = GetRange(face._aulPoints[i]);
 
-        for (std::set<unsigned long>::const_iterator j = f.begin(); j != f.end(); ++j) {
+        for (MeshIndexRange::const_iterator j = f.begin(); j != f.end(); ++j) {
             SearchNeighbours(rFacets, *j, rclCenter, fMaxDist2, visited, collect);
         }
     }
@@ -1777,60 +2035,50 @@ MeshRefPointToFacets::GetFacet (unsigned long index) const
     return _rclMesh.GetFacets().begin() + index;
 }
 
-const std::set<unsigned long>&
-MeshRefPointToFacets::operator[] (unsigned long pos) const
-{
-    return _map[pos];
-}
-
 //----------------------------------------------------------------------------
 
 void MeshRefFacetToFacets::Rebuild (void)
 {
-    _map.clear();
+    unsigned long ulCtFacets = _rclMesh.CountFacets();
+    _offsets.assign(ulCtFacets + 1, 0);
+    std::vector<unsigned long>().swap(_indices);
 
-    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
-    _map.resize(rFacets.size());
+    // first pass collects the neighbours of each facet per job, the second pass
+    // copies them to their place in the table
+    MeshRefPointToFacets vertexFace(_rclMesh);
+    Job proto = { &_rclMesh, &vertexFace, 0, &_offsets[0], 0, 0, 0 };
+    std::vector<Job> jobs = MakeJobs(ulCtFacets, proto);
+    RunJobs(jobs, CollectFacetFacets);
 
-    MeshRefPointToFacets  vertexFace(_rclMesh);
-    MeshFacetArray::_TConstIterator pFBegin = rFacets.begin();
-    for (MeshFacetArray::_TConstIterator pFIter = pFBegin; pFIter != rFacets.end(); ++pFIter) {
-        for (int i = 0; i < 3; i++) {
-            const std::set<unsigned long>& faces = vertexFace[pFIter->_aulPoints[i]];
-            for (std::set<unsigned long>::const_iterator it = faces.begin(); it != faces.end(); ++it)
-                _map[pFIter - pFBegin].insert(*it);
-        }
-    }
-}
+    AccumulateOffsets(_offsets);
+    _indices.resize(_offsets.back());
 
-const std::set<unsigned long>&
-MeshRefFacetToFacets::operator[] (unsigned long pos) const
-{
-    return _map[pos];
+    for (std::vector<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+        it->indices = _indices.empty() ? 0 : &_indices[0];
+    RunJobs(jobs, CopyBuffer);
 }
 
 //----------------------------------------------------------------------------
 
 void MeshRefPointToPoints::Rebuild (void)
 {
-    _map.clear();
+    unsigned long ulCtPoints = _rclMesh.CountPoints();
+    _offsets.assign(ulCtPoints + 1, 0);
+    std::vector<unsigned long>().swap(_indices);
 
-    const MeshPointArray& rPoints = _rclMesh.GetPoints();
-    _map.resize(rPoints.size());
+    // first pass collects the neighbours of each point per job, the second pass
+    // copies them to their place in the table
+    MeshRefPointToFacets vertexFace(_rclMesh);
+    Job proto = { &_rclMesh, &vertexFace, 0, &_offsets[0], 0, 0, 0 };
+    std::vector<Job> jobs = MakeJobs(ulCtPoints, proto);
+    RunJobs(jobs, CollectPointPoints);
 
-    const MeshFacetArray& rFacets = _rclMesh.GetFacets();
-    for (MeshFacetArray::_TConstIterator pFIter = rFacets.begin(); pFIter != rFacets.end(); ++pFIter) {
-        unsigned long ulP0 = pFIter->_aulPoints[0];
-        unsigned long ulP1 = pFIter->_aulPoints[1];
-        unsigned long ulP2 = pFIter->_aulPoints[2];
+    AccumulateOffsets(_offsets);
+    _indices.resize(_offsets.back());
 
-        _map[ulP0].insert(ulP1);
-        _map[ulP0].insert(ulP2);
-        _map[ulP1].insert(ulP0);
-        _map[ulP1].insert(ulP2);
-        _map[ulP2].insert(ulP0);
-        _map[ulP2].insert(ulP1);
-    }
+    for (std::vector<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+        it->indices = _indices.empty() ? 0 : &_indices[0];
+    RunJobs(jobs, CopyBuffer);
 }
 
 Base::Vector3f MeshRefPointToPoints::GetNormal(unsigned long pos) const
@@ -1839,8 +2087,8 @@ Base::Vector3f MeshRefPointToPoints::GetNormal(unsigned long pos) const
     MeshCore::PlaneFit pf;
     pf.AddPoint(rPoints[pos]);
     MeshCore::MeshPoint center = rPoints[pos];
-    const std::set<unsigned long>& cv = _map[pos];
-    for (std::set<unsigned long>::const_iterator cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
+    MeshIndexRange cv = GetRange(pos);
+    for (MeshIndexRange::const_iterator cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
         pf.AddPoint(rPoints[*cv_it]);
         center += rPoints[*cv_it];
     }
@@ -1856,20 +2104,14 @@ float MeshRefPointToPoints::GetAverageEdgeLength(unsigned long index) const
 {
     const MeshPointArray& rPoints = _rclMesh.GetPoints();
     float len=0.0f;
-    const std::set<unsigned long>& n = (*this)[index];
+    MeshIndexRange n = GetRange(index);
     const Base::Vector3f& p = rPoints[index];
-    for (std::set<unsigned long>::const_iterator it = n.begin(); it != n.end(); ++it) {
+    for (MeshIndexRange::const_iterator it = n.begin(); it != n.end(); ++it) {
         len += Base::Distance(p, rPoints[*it]);
     }
     return (len/n.size());
 }
 
-const std::set<unsigned long>&
-MeshRefPointToPoints::operator[] (unsigned long pos) const
-{
-    return _map[pos];
-}
-
 //----------------------------------------------------------------------------
 
 void MeshRefEdgeToFacets::Rebuild (void)
@@ -45,6 +45,7 @@ class MeshGeomFacet;
 class MeshGeomEdge;
 class MeshKernel;
 class MeshFacetGrid;
+class MeshFacetTree;
 class MeshFacetArray;
 class MeshRefPointToFacets;
 class AbstractPolygonTriangulator;
@@ -81,6 +82,17 @@ public:
    */
   bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetGrid &rclGrid,
                           Base::Vector3f &rclRes, unsigned long &rulFacet) const;
+  /**
+   * Searches for the nearest facet to the ray defined by
+   * (\a rclPt, \a rclDir).
+   * The point \a rclRes holds the intersection point with the ray and the
+   * nearest facet with index \a rulFacet.
+   * \note This method uses a bounding volume hierarchy which, unlike the grid,
+   * also performs well on meshes with very different facet sizes. Only facets
+   * in front of \a rclPt are taken into account.
+   */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const MeshFacetTree &rclTree,
+                          Base::Vector3f &rclRes, unsigned long &rulFacet) const;
   /**
    * Searches for the nearest facet to the ray defined by
    * (\a rclPt, \a rclDir).
@@ -106,11 +118,20 @@ public:
    * \note If the point \a rclPt is outside of the grid \a rclGrid nothing is done.
    */
   bool FirstFacetToVertex(const Base::Vector3f &rclPt, float fMaxDistance, const MeshFacetGrid &rclGrid, unsigned long &rulFacet) const;
+  /**
+   * Does the same as the method above but searches all facets of the tree \a rclTree whose bounding box
+   * is within \a fMaxDistance of \a rclPt.
+   */
+  bool FirstFacetToVertex(const Base::Vector3f &rclPt, float fMaxDistance, const MeshFacetTree &rclTree, unsigned long &rulFacet) const;
   /**
    * Checks from the viewpoint \a rcView if the vertex \a rcVertex is visible or it is hidden by a facet. 
    * If the vertex is visible true is returned, false otherwise.
    */
   bool IsVertexVisible (const Base::Vector3f &rcVertex, const Base::Vector3f &rcView, const MeshFacetGrid &rclGrid ) const;
+  /**
+   * Does the same as the method above but uses a bounding volume hierarchy.
+   */
+  bool IsVertexVisible (const Base::Vector3f &rcVertex, const Base::Vector3f &rcView, const MeshFacetTree &rclTree ) const;
   /**
    * Calculates the average length of edges.
    */
@@ -264,6 +285,11 @@ public:
    */
   void SearchFacetsFromPolyline (const std::vector<Base::Vector3f> &rclPolyline, float fRadius,
                                  const MeshFacetGrid& rclGrid, std::vector<unsigned long> &rclResultFacetsIndices) const;
+  /**
+   * Does the same as the method above but uses a bounding volume hierarchy.
+   */
+  void SearchFacetsFromPolyline (const std::vector<Base::Vector3f> &rclPolyline, float fRadius,
+                                 const MeshFacetTree& rclTree, std::vector<unsigned long> &rclResultFacetsIndices) const;
   /** Projects a point directly to the mesh (means nearest facet), the result is the facet index and
    * the foraminate point, use second version with grid for more performance.
    */
@@ -272,15 +298,25 @@ public:
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetGrid& rclGrid, float fMaxSearchArea,
                               unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
+  bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree,
+                              unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
+  bool NearestPointFromPoint (const Base::Vector3f &rclPt, const MeshFacetTree& rclTree, float fMaxSearchArea,
+                              unsigned long &rclResFacetIndex, Base::Vector3f &rclResPoint) const;
   /** Cuts the mesh with a plane. The result is a list of polylines. */
   bool CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetGrid &rclGrid,
                      std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
+  /** Does the same as the method above but uses a bounding volume hierarchy. */
+  bool CutWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const MeshFacetTree &rclTree,
+                     std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps = 1.0e-2f, bool bConnectPolygons = false) const;
   /** 
    * Gets all facets that cut the plane (N,d) and that lie between the two points left and right. 
    * The plane is defined by it normalized normal and the signed distance to the origin.
    */
   void GetFacetsFromPlane (const MeshFacetGrid &rclGrid, const Base::Vector3f& clNormal, float dist, 
       const Base::Vector3f &rclLeft, const Base::Vector3f &rclRight, std::vector<unsigned long> &rclRes) const;
+  /** Does the same as the method above but uses a bounding volume hierarchy. */
+  void GetFacetsFromPlane (const MeshFacetTree &rclTree, const Base::Vector3f& clNormal, float dist, 
+      const Base::Vector3f &rclLeft, const Base::Vector3f &rclRight, std::vector<unsigned long> &rclRes) const;
 
   /** Returns true if the distance from the \a rclPt to the facet \a ulFacetIdx is less than \a fMaxDistance.
    * If this restriction is met \a rfDistance is set to the actual distance, otherwise false is returned.
@@ -298,6 +334,15 @@ protected:
                     float fMinEps) const;
   bool ConnectPolygons(std::list<std::vector<Base::Vector3f> > &clPolyList, std::list<std::pair<Base::Vector3f,
                        Base::Vector3f> > &rclLines) const;
+  /** Searches the first facet in \a raulFacets that \a rclPt lies on, see FirstFacetToVertex(). */
+  bool FirstFacetToVertex(const Base::Vector3f &rclPt, float fMaxDistance, const std::vector<unsigned long> &raulFacets,
+                          unsigned long &rulFacet) const;
+  /** Cuts the facets \a raulFacets with a plane, see CutWithPlane(). */
+  bool CutFacetsWithPlane (const Base::Vector3f &clBase, const Base::Vector3f &clNormal, const std::vector<unsigned long> &raulFacets,
+                           std::list<std::vector<Base::Vector3f> > &rclResult, float fMinEps, bool bConnectPolygons) const;
+  /** Appends the facets of \a raulFacets that cut the plane between the two points to \a rclRes, see GetFacetsFromPlane(). */
+  void FacetsFromPlane (const std::vector<unsigned long> &raulFacets, const Base::Vector3f& clNormal, float dist,
+      const Base::Vector3f &rclLeft, const Base::Vector3f &rclRight, std::vector<unsigned long> &rclRes) const;
   /** Searches the nearest facet in \a raulFacets to the ray (\a rclPt, \a rclDir). */
   bool RayNearestField (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, const std::vector<unsigned long> &raulFacets,
                         Base::Vector3f &rclRes, unsigned long &rulFacet, float fMaxAngle = F_PI) const;
@@ -347,13 +392,70 @@ private:
     std::vector<unsigned long>& indices;
 };
 
+/**
+ * The MeshIndexRange refers to the sorted indices stored for one element of a
+ * MeshIndexTable. It becomes invalid when the table is rebuilt or destroyed.
+ */
+class MeshExport MeshIndexRange
+{
+public:
+    typedef const unsigned long* const_iterator;
+
+    MeshIndexRange (const_iterator first, const_iterator last) : _first(first), _last(last)
+    { }
+
+    const_iterator begin (void) const
+    { return _first; }
+    const_iterator end (void) const
+    { return _last; }
+    unsigned long size (void) const
+    { return (unsigned long)(_last - _first); }
+    bool empty (void) const
+    { return _first == _last; }
+    unsigned long operator[] (unsigned long pos) const
+    { return _first[pos]; }
+
+private:
+    const_iterator _first, _last;
+};
+
+/**
+ * The MeshIndexTable is the base class of the topology structures below. The indices
+ * of all elements are stored as sorted ranges one after another in one array and a second
+ * array holds where each range starts (compressed sparse rows).
+ */
+class MeshExport MeshIndexTable
+{
+public:
+    /// Returns the sorted indices of the element \a pos
+    MeshIndexRange GetRange (unsigned long pos) const
+    {
+        const unsigned long* data = _indices.empty() ? 0 : &_indices[0];
+        return MeshIndexRange(data + _offsets[pos], data + _offsets[pos + 1]);
+    }
+    /// Returns the number of indices of the element \a pos
+    unsigned long CountIndices (unsigned long pos) const
+    { return _offsets[pos + 1] - _offsets[pos]; }
+    /// Returns the indices of the element \a pos as set. Use GetRange() instead
+    /// where possible, this exists for compatibility only.
+    std::set<unsigned long> operator[] (unsigned long pos) const
+    {
+        MeshIndexRange range = GetRange(pos);
+        return std::set<unsigned long>(range.begin(), range.end());
+    }
+
+protected:
+    std::vector<unsigned long> _offsets; /**< Start of the range of each element, plus the end of the last one. */
+    std::vector<unsigned long> _indices; /**< Indices of all elements. */
+};
+
 /**
  * The MeshRefPointToFacets builds up a structure to have access to all facets indexing
  * a point.
  * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
  * be rebuilt.
  */
-class MeshExport MeshRefPointToFacets
+class MeshExport MeshRefPointToFacets : public MeshIndexTable
 {
 public:
     /// Construction
@@ -365,7 +467,6 @@ public:
 
     /// Rebuilds up data structure
     void Rebuild (void);
-    const std::set<unsigned long>& operator[] (unsigned long) const;
     MeshFacetArray::_TConstIterator GetFacet (unsigned long) const;
     std::set<unsigned long> NeighbourPoints(const std::vector<unsigned long>& , int level) const;
     void Neighbours (unsigned long ulFacetInd, float fMaxDist, MeshCollector& collect) const;
@@ -377,7 +478,6 @@ protected:
 
 protected:
     const MeshKernel  &_rclMesh; /**< The mesh kernel. */
-    std::vector<std::set<unsigned long> > _map;
 };
 
 /**
@@ -386,7 +486,7 @@ protected:
  * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
  * be rebuilt.
  */
-class MeshExport MeshRefFacetToFacets
+class MeshExport MeshRefFacetToFacets : public MeshIndexTable
 {
 public:
     /// Construction
@@ -395,16 +495,12 @@ public:
     /// Destruction
     ~MeshRefFacetToFacets (void)
     { }
-    /// Rebuilds up data structure
+    /// Rebuilds up data structure, GetRange() returns the facets sharing one
+    /// or more points with a facet, including the facet itself.
     void Rebuild (void);
 
-    /// Returns a set of facets sharing one or more points with the facet with
-    /// index \a ulFacetIndex.
-    const std::set<unsigned long>& operator[] (unsigned long) const;
-
 protected:
     const MeshKernel  &_rclMesh; /**< The mesh kernel. */
-    std::vector<std::set<unsigned long> > _map;
 };
 
 /**
@@ -413,7 +509,7 @@ protected:
  * \note If the underlying mesh kernel gets changed this structure becomes invalid and must
  * be rebuilt.
  */
-class MeshExport MeshRefPointToPoints
+class MeshExport MeshRefPointToPoints : public MeshIndexTable
 {
 public:
     /// Construction
@@ -425,13 +521,11 @@ public:
 
     /// Rebuilds up data structure
     void Rebuild (void);
-    const std::set<unsigned long>& operator[] (unsigned long) const;
     Base::Vector3f GetNormal(unsigned long) const;
     float GetAverageEdgeLength(unsigned long) const;
 
 protected:
     const MeshKernel  &_rclMesh; /**< The mesh kernel. */
-    std::vector<std::set<unsigned long> > _map;
 };
 
 /**
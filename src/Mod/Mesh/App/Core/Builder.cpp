@@ -25,8 +25,17 @@
 
 #ifndef _PreComp_
 # include <algorithm>
+# include <cmath>
+# include <cfloat>
+# include <climits>
+# include <cstring>
+# include <stdint.h>
 #endif
 
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <Base/Sequencer.h>
 #include <Base/Exception.h>
 
@@ -35,6 +44,159 @@
 
 using namespace MeshCore;
 
+namespace {
+
+unsigned long mixHash(uint64_t h)
+{
+    // mix the bits so that neighbouring keys don't end up in neighbouring slots
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (unsigned long)h;
+}
+
+unsigned long hashCell(double x, double y, double z)
+{
+    // clamp to avoid an overflow when converting to integers
+    const double lim = 4.0e18;
+    int64_t ix = (int64_t)std::max<double>(-lim, std::min<double>(lim, x));
+    int64_t iy = (int64_t)std::max<double>(-lim, std::min<double>(lim, y));
+    int64_t iz = (int64_t)std::max<double>(-lim, std::min<double>(lim, z));
+    return mixHash((uint64_t)ix * 73856093ULL ^ (uint64_t)iy * 19349663ULL ^ (uint64_t)iz * 83492791ULL);
+}
+
+unsigned long hashEdge(unsigned long p0, unsigned long p1)
+{
+    return mixHash((uint64_t)p0 * 0x9e3779b97f4a7c15ULL ^ (uint64_t)p1);
+}
+
+unsigned long tableSize(unsigned long count)
+{
+    // keep the load factor of a hash table below 0.5
+    unsigned long size = 1024;
+    while (size < 2 * count)
+        size *= 2;
+    return size;
+}
+
+/**
+ * The vertices of a slab of the bounding box that are welded by one thread.
+ * The vertices are read from records of \a stride bytes, each with the three
+ * vertices of a facet as consecutive floats. Thus, facet arrays and the data
+ * of binary STL files can be used without copying them.
+ * Each slab has its own hash table of representative vertices. A vertex close to the
+ * border of the slab is also compared with the representatives of the adjacent slabs
+ * if these have been processed before.
+ */
+struct WeldSlab
+{
+    const char* vertices;
+    unsigned long stride;
+    const unsigned long* begin;  // ids of the vertices in this slab in ascending order
+    const unsigned long* end;
+    std::vector<unsigned long>* rep; // id of the representative vertex for each vertex
+    double lower, upper;  // range of cell indices in x direction
+    double invCellSize;
+    float tolerance;
+    const WeldSlab* prev;
+    const WeldSlab* next;
+    std::vector<unsigned long> table;
+
+    Base::Vector3f vertex(unsigned long v) const
+    {
+        // the records may not be aligned
+        Base::Vector3f p;
+        memcpy(&p.x, vertices + (v / 3) * stride + (v % 3) * 3 * sizeof(float), 3 * sizeof(float));
+        return p;
+    }
+    void insert(unsigned long v)
+    {
+        unsigned long mask = table.size() - 1;
+        Base::Vector3f p = vertex(v);
+        unsigned long slot = hashCell(std::floor(p.x * invCellSize),
+                                      std::floor(p.y * invCellSize),
+                                      std::floor(p.z * invCellSize)) & mask;
+        while (table[slot] != ULONG_MAX)
+            slot = (slot + 1) & mask;
+        table[slot] = v;
+    }
+    unsigned long find(double cx, double cy, double cz, const Base::Vector3f& p) const
+    {
+        unsigned long mask = table.size() - 1;
+        unsigned long slot = hashCell(cx, cy, cz) & mask;
+        while (table[slot] != ULONG_MAX) {
+            Base::Vector3f q = vertex(table[slot]);
+            if (fabs(q.x - p.x) < tolerance &&
+                fabs(q.y - p.y) < tolerance &&
+                fabs(q.z - p.z) < tolerance)
+                return table[slot];
+            slot = (slot + 1) & mask;
+        }
+        return ULONG_MAX;
+    }
+};
+
+void weldSlab(WeldSlab& slab)
+{
+    std::vector<unsigned long>& rep = *slab.rep;
+    // usually a point is shared by six facets
+    unsigned long ctReps = 0;
+    slab.table.assign(tableSize((slab.end - slab.begin) / 6), ULONG_MAX);
+
+    for (const unsigned long* it = slab.begin; it != slab.end; ++it) {
+        unsigned long v = *it;
+        Base::Vector3f p = slab.vertex(v);
+
+        // the cell size is twice the tolerance, so an equal point can only be in the same
+        // cell or in the adjacent cell towards the nearer cell border
+        double cx = p.x * slab.invCellSize;
+        double cy = p.y * slab.invCellSize;
+        double cz = p.z * slab.invCellSize;
+        double fx = std::floor(cx);
+        double fy = std::floor(cy);
+        double fz = std::floor(cz);
+        double cellX[2] = { fx, (cx - fx < 0.5) ? fx - 1.0 : fx + 1.0 };
+        double cellY[2] = { fy, (cy - fy < 0.5) ? fy - 1.0 : fy + 1.0 };
+        double cellZ[2] = { fz, (cz - fz < 0.5) ? fz - 1.0 : fz + 1.0 };
+
+        unsigned long r = ULONG_MAX;
+        for (int i = 0; i < 8 && r == ULONG_MAX; i++) {
+            double x = cellX[i & 1];
+            const WeldSlab* owner = &slab;
+            if (x < slab.lower)
+                owner = slab.prev;
+            else if (x >= slab.upper)
+                owner = slab.next;
+            if (owner)
+                r = owner->find(x, cellY[(i >> 1) & 1], cellZ[(i >> 2) & 1], p);
+        }
+
+        if (r != ULONG_MAX) {
+            rep[v] = r;
+        }
+        else {
+            rep[v] = v;
+            if (2 * (++ctReps) > slab.table.size()) {
+                // grow the table and re-insert the representatives
+                std::vector<unsigned long> old(2 * slab.table.size(), ULONG_MAX);
+                old.swap(slab.table);
+                for (std::vector<unsigned long>::iterator jt = old.begin(); jt != old.end(); ++jt) {
+                    if (*jt != ULONG_MAX)
+                        slab.insert(*jt);
+                }
+            }
+            slab.insert(v);
+        }
+    }
+}
+
+void weldSlabJob(WeldSlab* slab)
+{
+    weldSlab(*slab);
+}
+
+}
+
 
 MeshBuilder::MeshBuilder (MeshKernel& kernel) : _meshKernel(kernel), _seq(0)
 {
@@ -153,10 +315,14 @@ void MeshBuilder::AddFacet (Base::Vector3f* facetPoints, unsigned char flag, uns
 
 void MeshBuilder::SetNeighbourhood ()
 {
-    std::set<Edge> edges;
-    int facetIdx = 0;
-
-    for (MeshFacetArray::_TIterator it = _meshKernel._aclFacetArray.begin(); it != _meshKernel._aclFacetArray.end(); it++)
+    // Hash table of the edges that have been visited first. An entry is the index of the
+    // facet times three plus the side of the edge in the facet.
+    MeshFacetArray& rFacets = _meshKernel._aclFacetArray;
+    std::vector<unsigned long> edges(tableSize(3 * rFacets.size() / 2), ULONG_MAX);
+    unsigned long mask = edges.size() - 1;
+    unsigned long facetIdx = 0;
+
+    for (MeshFacetArray::_TIterator it = rFacets.begin(); it != rFacets.end(); it++)
     {
         this->_seq->next(true); // allow to cancel
         MeshFacet& mf = *it;
@@ -164,10 +330,20 @@ void MeshBuilder::SetNeighbourhood ()
         for (int i = 0; i < 3; i++)
         {
             Edge edge(mf._aulPoints[i], mf._aulPoints[(i+1)%3], facetIdx);
-            std::set<Edge>::iterator e = edges.find(edge);
-            if (e != edges.end())
+            unsigned long slot = hashEdge(edge.pt1, edge.pt2) & mask;
+            while (edges[slot] != ULONG_MAX)
+            {
+                const MeshFacet& rFace = rFacets[edges[slot] / 3];
+                int side = edges[slot] % 3;
+                if (Edge(rFace._aulPoints[side], rFace._aulPoints[(side+1)%3], 0) == edge)
+                    break;
+                slot = (slot + 1) & mask;
+            }
+
+            if (edges[slot] != ULONG_MAX)
             { // edge exists, set neighbourhood
-                MeshFacet& mf1 = _meshKernel._aclFacetArray[e->facetIdx];
+                unsigned long neighbourIdx = edges[slot] / 3;
+                MeshFacet& mf1 = rFacets[neighbourIdx];
                 if (mf1._aulPoints[0] == edge.pt1)
                 {
                     if (mf1._aulPoints[1] == edge.pt2)
@@ -185,11 +361,11 @@ void MeshBuilder::SetNeighbourhood ()
                 else
                     mf1._aulNeighbours[1] = facetIdx;
 
-                mf._aulNeighbours[i] = e->facetIdx;
+                mf._aulNeighbours[i] = neighbourIdx;
             }
             else
             {  // new edge
-                edges.insert(edge);
+                edges[slot] = 3 * facetIdx + i;
             }
         }
 
@@ -249,3 +425,197 @@ void MeshBuilder::Finish (bool freeMemory)
 
     _meshKernel.RecalcBoundBox();
 }
+
+void MeshBuilder::Weld (const char* vertices, unsigned long stride, unsigned long ctFacets,
+                        std::vector<unsigned long>& pointIndex)
+{
+    const float fTol = MeshDefinitions::_fMinPointDistanceD1;
+    const double invCellSize = 1.0 / (2.0 * double(fTol));
+    const unsigned long ctVertices = 3 * ctFacets;
+
+    WeldSlab all;
+    all.vertices = vertices;
+    all.stride = stride;
+
+    // Split the range of the cells in x direction into slabs. The vertices of each slab
+    // are sorted by their ids, so that the result doesn't depend on the number of threads.
+    double minX = DBL_MAX, maxX = -DBL_MAX;
+    for (unsigned long v = 0; v < ctVertices; v++) {
+        float x = all.vertex(v).x;
+        minX = std::min<double>(minX, x);
+        maxX = std::max<double>(maxX, x);
+    }
+    double lowerCell = std::floor(minX * invCellSize);
+    double range = std::floor(maxX * invCellSize) - lowerCell + 1.0;
+    unsigned long ctSlabs = 1;
+    if (ctFacets > 10000)
+        ctSlabs = (unsigned long)std::max<double>(1.0, std::min<double>(64.0, range));
+    double width = std::ceil(range / double(ctSlabs));
+
+    std::vector<unsigned long> slabOfVertex(ctVertices);
+    std::vector<unsigned long> offsets(ctSlabs + 1, 0);
+    for (unsigned long v = 0; v < ctVertices; v++) {
+        double cx = std::floor(all.vertex(v).x * invCellSize);
+        unsigned long s = std::min<unsigned long>(ctSlabs - 1, (unsigned long)((cx - lowerCell) / width));
+        slabOfVertex[v] = s;
+        offsets[s + 1]++;
+    }
+    for (unsigned long s = 0; s < ctSlabs; s++)
+        offsets[s + 1] += offsets[s];
+    std::vector<unsigned long> order(ctVertices);
+    {
+        std::vector<unsigned long> pos(offsets.begin(), offsets.end() - 1);
+        for (unsigned long v = 0; v < ctVertices; v++)
+            order[pos[slabOfVertex[v]]++] = v;
+    }
+    { std::vector<unsigned long>().swap(slabOfVertex); }
+
+    std::vector<unsigned long>& rep = pointIndex;
+    rep.resize(ctVertices);
+    std::vector<WeldSlab> slabs(ctSlabs);
+    for (unsigned long s = 0; s < ctSlabs; s++) {
+        WeldSlab& slab = slabs[s];
+        slab.vertices = vertices;
+        slab.stride = stride;
+        slab.begin = &order[0] + offsets[s];
+        slab.end = &order[0] + offsets[s + 1];
+        slab.rep = &rep;
+        slab.lower = (s == 0) ? -DBL_MAX : lowerCell + double(s) * width;
+        slab.upper = (s + 1 == ctSlabs) ? DBL_MAX : lowerCell + double(s + 1) * width;
+        slab.invCellSize = invCellSize;
+        slab.tolerance = fTol;
+        slab.prev = 0;
+        slab.next = 0;
+    }
+
+    // Weld the even slabs first and then the odd slabs which additionally search the
+    // representatives of their finished neighbours.
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<WeldSlab*> jobs;
+        for (unsigned long s = pass; s < ctSlabs; s += 2) {
+            if (pass == 1) {
+                slabs[s].prev = &slabs[s - 1];
+                slabs[s].next = (s + 1 < ctSlabs) ? &slabs[s + 1] : 0;
+            }
+            jobs.push_back(&slabs[s]);
+        }
+        if (jobs.size() > 1 && QThread::idealThreadCount() > 1) {
+            QFuture<void> future = QtConcurrent::map(jobs, weldSlabJob);
+            future.waitForFinished();
+        }
+        else {
+            for (std::vector<WeldSlab*>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+                weldSlab(**it);
+        }
+    }
+    { std::vector<WeldSlab>().swap(slabs); }
+    { std::vector<unsigned long>().swap(order); }
+
+    // The points are ordered by the ids of their representative vertices. Their indices are
+    // stored in the array of representatives and marked by the highest bit.
+    const unsigned long flag = ~(ULONG_MAX >> 1);
+    unsigned long ctPoints = 0;
+    for (unsigned long v = 0; v < ctVertices; v++) {
+        if (rep[v] == v)
+            ctPoints++;
+    }
+    _meshKernel._aclPointArray.reserve(ctPoints);
+    ctPoints = 0;
+    for (unsigned long v = 0; v < ctVertices; v++) {
+        if (rep[v] == v) {
+            rep[v] = flag | ctPoints++;
+            _meshKernel._aclPointArray.push_back(MeshPoint(all.vertex(v)));
+        }
+    }
+
+    // replace the representatives by the point indices
+    for (unsigned long v = 0; v < ctVertices; v++) {
+        unsigned long r = rep[v];
+        if (!(r & flag))
+            r = rep[r];
+        rep[v] = r;
+    }
+    for (unsigned long v = 0; v < ctVertices; v++)
+        rep[v] &= ~flag;
+}
+
+void MeshBuilder::AddWeldedFacet (MeshFacet& mf, const Base::Vector3f* points, const Base::Vector3f& normal)
+{
+    // check for degenerated facet (one edge has length 0)
+    if ((mf._aulPoints[0] == mf._aulPoints[1]) || (mf._aulPoints[0] == mf._aulPoints[2]) || (mf._aulPoints[1] == mf._aulPoints[2]))
+        return;
+
+    // adjust circulation direction
+    if ((((points[1] - points[0]) % (points[2] - points[0])) * normal) < 0.0f)
+        std::swap(mf._aulPoints[1], mf._aulPoints[2]);
+
+    _meshKernel._aclFacetArray.push_back(mf);
+}
+
+void MeshBuilder::FinishWelded ()
+{
+    SetNeighbourhood();
+    RemoveUnreferencedPoints();
+    _meshKernel.RecalcBoundBox();
+
+    delete this->_seq;
+    this->_seq = 0;
+}
+
+void MeshBuilder::Build (const std::vector<MeshGeomFacet>& facets, bool takeFlag, bool takeProperty)
+{
+    _meshKernel.Clear();
+    if (facets.empty())
+        return;
+
+    std::vector<unsigned long> pointIndex;
+    Weld(reinterpret_cast<const char*>(facets[0]._aclPoints), sizeof(MeshGeomFacet), facets.size(), pointIndex);
+
+    delete this->_seq;
+    this->_seq = new Base::SequencerLauncher("create mesh structure...", facets.size() * 2);
+
+    _meshKernel._aclFacetArray.reserve(facets.size());
+    for (unsigned long f = 0; f < facets.size(); f++) {
+        this->_seq->next(true); // allow to cancel
+        const MeshGeomFacet& rFacet = facets[f];
+        MeshFacet mf;
+        mf._ucFlag = takeFlag ? rFacet._ucFlag : 0;
+        mf._ulProp = takeProperty ? rFacet._ulProp : 0;
+        for (int i = 0; i < 3; i++)
+            mf._aulPoints[i] = pointIndex[3 * f + i];
+        AddWeldedFacet(mf, rFacet._aclPoints, rFacet.GetNormal());
+    }
+    { std::vector<unsigned long>().swap(pointIndex); }
+
+    FinishWelded();
+}
+
+void MeshBuilder::Build (const char* records, unsigned long ctFacets, unsigned long stride)
+{
+    _meshKernel.Clear();
+    if (ctFacets == 0)
+        return;
+
+    // the vertices follow the normal
+    std::vector<unsigned long> pointIndex;
+    Weld(records + 3 * sizeof(float), stride, ctFacets, pointIndex);
+
+    delete this->_seq;
+    this->_seq = new Base::SequencerLauncher("create mesh structure...", ctFacets * 2);
+
+    _meshKernel._aclFacetArray.reserve(ctFacets);
+    Base::Vector3f clVects[4];
+    const char* record = records;
+    for (unsigned long f = 0; f < ctFacets; f++, record += stride) {
+        this->_seq->next(true); // allow to cancel
+        // normal, points
+        memcpy(clVects, record, sizeof(clVects));
+        MeshFacet mf;
+        for (int i = 0; i < 3; i++)
+            mf._aulPoints[i] = pointIndex[3 * f + i];
+        AddWeldedFacet(mf, clVects + 1, clVects[0]);
+    }
+    { std::vector<unsigned long>().swap(pointIndex); }
+
+    FinishWelded();
+}
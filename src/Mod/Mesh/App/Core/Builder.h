@@ -110,6 +110,10 @@ private:
     void SetNeighbourhood  ();
     // As it's forbidden to insert a degenerated facet but insert its vertices anyway we must remove them 
     void RemoveUnreferencedPoints();
+    // merges the duplicated vertices of the records and returns the point index of each vertex
+    void Weld (const char* vertices, unsigned long stride, unsigned long ctFacets, std::vector<unsigned long>& pointIndex);
+    void AddWeldedFacet (MeshFacet& mf, const Base::Vector3f* points, const Base::Vector3f& normal);
+    void FinishWelded ();
 
 public:
     MeshBuilder(MeshKernel &rclM);
@@ -158,6 +162,24 @@ public:
      */
     void Finish (bool freeMemory=false);
 
+    /** Builds up the mesh structure from the array \a facets at once. The mesh kernel gets
+     * cleared before, and Initialize() and Finish() must not be called.
+     * Duplicated points are found with a spatial hash on quantized coordinates which works
+     * on several slabs of the bounding box in parallel. Points are merged by the same rule
+     * as with AddFacet(). But a point close to several others may get merged with another
+     * one than by Finish(), and the order of the points differs. So the result is not
+     * always identical to the facet-wise build. It doesn't depend on the number of threads.
+     * @param facets the facets
+     * @param takeFlag if true the flags from the MeshGeomFacet will be taken
+     * @param takeProperty
+     */
+    void Build (const std::vector<MeshGeomFacet>& facets, bool takeFlag = false, bool takeProperty = false);
+    /** Builds up the mesh structure at once like above from \a ctFacets records of \a stride
+     * bytes. Each record starts with the normal and the three points of a facet as floats,
+     * like in a binary STL file. The records are used in-place and needn't be aligned.
+     */
+    void Build (const char* records, unsigned long ctFacets, unsigned long stride);
+
     friend class MeshKernel;
 
 private:
@@ -0,0 +1,718 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+#endif
+
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "FacetTree.h"
+#include "Elements.h"
+#include "Iterator.h"
+#include "MeshKernel.h"
+
+#include <Base/Matrix.h>
+
+using namespace MeshCore;
+
+#define MESH_TREE_BINS        16  // Number of bins per axis to evaluate the surface area heuristic
+#define MESH_TREE_LEAF_SIZE   4   // Nodes with less triangles are never split
+#define MESH_TREE_MAX_LEAF    16  // Nodes with more triangles are always split
+#define MESH_TREE_SAH_DEPTH   64  // Below this depth nodes are split at the median
+#define MESH_TREE_STACK       128
+#define MESH_TREE_PACKET      8   // Number of rays traversed together
+#define MESH_TREE_RAY_JOB     1024
+
+namespace MeshCore {
+namespace FacetTreeHelpers {
+
+struct Bounds
+{
+  Base::Vector3f clMin, clMax;
+
+  Bounds() : clMin(FLOAT_MAX, FLOAT_MAX, FLOAT_MAX), clMax(-FLOAT_MAX, -FLOAT_MAX, -FLOAT_MAX) {}
+  void Add (const Base::Vector3f &rclPt)
+  {
+    clMin.x = std::min<float>(clMin.x, rclPt.x); clMax.x = std::max<float>(clMax.x, rclPt.x);
+    clMin.y = std::min<float>(clMin.y, rclPt.y); clMax.y = std::max<float>(clMax.y, rclPt.y);
+    clMin.z = std::min<float>(clMin.z, rclPt.z); clMax.z = std::max<float>(clMax.z, rclPt.z);
+  }
+  void Add (const Bounds &rclB)
+  {
+    // component-wise, so that empty bounds don't change anything
+    clMin.x = std::min<float>(clMin.x, rclB.clMin.x); clMax.x = std::max<float>(clMax.x, rclB.clMax.x);
+    clMin.y = std::min<float>(clMin.y, rclB.clMin.y); clMax.y = std::max<float>(clMax.y, rclB.clMax.y);
+    clMin.z = std::min<float>(clMin.z, rclB.clMin.z); clMax.z = std::max<float>(clMax.z, rclB.clMax.z);
+  }
+  float Area () const
+  {
+    if (clMin.x > clMax.x)
+      return 0.0f;
+    Base::Vector3f d = clMax - clMin;
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+  }
+};
+
+struct BuildTask
+{
+  unsigned long ulNode, ulBegin, ulEnd, ulDepth;
+};
+
+/// Intersects the ray with the box, returns false if it misses the box or enters it behind \a fMaxT
+inline bool IntersectBox (const Base::Vector3f &rclMin, const Base::Vector3f &rclMax, const Base::Vector3f &rclPt,
+                          const Base::Vector3f &rclInv, float fMaxT, float &rfEntry)
+{
+  float tx1 = (rclMin.x - rclPt.x) * rclInv.x, tx2 = (rclMax.x - rclPt.x) * rclInv.x;
+  float ty1 = (rclMin.y - rclPt.y) * rclInv.y, ty2 = (rclMax.y - rclPt.y) * rclInv.y;
+  float tz1 = (rclMin.z - rclPt.z) * rclInv.z, tz2 = (rclMax.z - rclPt.z) * rclInv.z;
+  float tmin = std::max<float>(std::max<float>(std::min<float>(tx1, tx2), std::min<float>(ty1, ty2)),
+                               std::max<float>(std::min<float>(tz1, tz2), 0.0f));
+  float tmax = std::min<float>(std::min<float>(std::max<float>(tx1, tx2), std::max<float>(ty1, ty2)),
+                               std::min<float>(std::max<float>(tz1, tz2), fMaxT));
+  rfEntry = tmin;
+  return tmin <= tmax;
+}
+
+/// Squared distance of the point to the box, 0 if it is inside
+inline float BoxDistance (const Base::Vector3f &rclMin, const Base::Vector3f &rclMax, const Base::Vector3f &rclPt)
+{
+  float dx = std::max<float>(std::max<float>(rclMin.x - rclPt.x, rclPt.x - rclMax.x), 0.0f);
+  float dy = std::max<float>(std::max<float>(rclMin.y - rclPt.y, rclPt.y - rclMax.y), 0.0f);
+  float dz = std::max<float>(std::max<float>(rclMin.z - rclPt.z, rclPt.z - rclMax.z), 0.0f);
+  return dx * dx + dy * dy + dz * dz;
+}
+
+/// Inverse of the ray direction, without infinities for axis-parallel rays
+inline Base::Vector3f Inverse (const Base::Vector3f &rclDir)
+{
+  return Base::Vector3f(rclDir.x != 0.0f ? 1.0f / rclDir.x : FLOAT_MAX,
+                        rclDir.y != 0.0f ? 1.0f / rclDir.y : FLOAT_MAX,
+                        rclDir.z != 0.0f ? 1.0f / rclDir.z : FLOAT_MAX);
+}
+
+/// Moeller-Trumbore ray/triangle test, the parameter \a rfT is only set for hits with t >= 0
+inline bool IntersectTriangle (const Base::Vector3f &p0, const Base::Vector3f &e1, const Base::Vector3f &e2,
+                               const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float &rfT)
+{
+  Base::Vector3f p = rclDir % e2;
+  float det = e1 * p;
+  if (det == 0.0f)
+    return false; // parallel or degenerated
+  float inv = 1.0f / det;
+  Base::Vector3f s = rclPt - p0;
+  float u = (s * p) * inv;
+  if (u < 0.0f || u > 1.0f)
+    return false;
+  Base::Vector3f q = s % e1;
+  float v = (rclDir * q) * inv;
+  if (v < 0.0f || u + v > 1.0f)
+    return false;
+  float t = (e2 * q) * inv;
+  if (t < 0.0f)
+    return false;
+  rfT = t;
+  return true;
+}
+
+/// Closest point on the triangle (p0, p0+e1, p0+e2) to \a rclPt, see Ericson: Real-Time Collision Detection
+inline Base::Vector3f ClosestPoint (const Base::Vector3f &p0, const Base::Vector3f &e1, const Base::Vector3f &e2,
+                                    const Base::Vector3f &rclPt)
+{
+  Base::Vector3f ap = rclPt - p0;
+  float d1 = e1 * ap, d2 = e2 * ap;
+  if (d1 <= 0.0f && d2 <= 0.0f)
+    return p0;
+
+  Base::Vector3f bp = ap - e1;
+  float d3 = e1 * bp, d4 = e2 * bp;
+  if (d3 >= 0.0f && d4 <= d3)
+    return p0 + e1;
+
+  float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+    return p0 + e1 * (d1 / (d1 - d3));
+
+  Base::Vector3f cp = ap - e2;
+  float d5 = e1 * cp, d6 = e2 * cp;
+  if (d6 >= 0.0f && d5 <= d6)
+    return p0 + e2;
+
+  float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+    return p0 + e2 * (d2 / (d2 - d6));
+
+  float va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+    return p0 + e1 + (e2 - e1) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+  float sum = va + vb + vc;
+  if (sum <= 0.0f)
+    return p0; // degenerated triangle
+  return p0 + e1 * (vb / sum) + e2 * (vc / sum);
+}
+
+/// Selects the nodes and triangles that overlap a box
+struct BoxQuery
+{
+  BoxQuery (const Base::BoundBox3f &rclBB)
+    : clMin(rclBB.MinX, rclBB.MinY, rclBB.MinZ), clMax(rclBB.MaxX, rclBB.MaxY, rclBB.MaxZ) {}
+  bool HitsNode (const Base::Vector3f &rclMin, const Base::Vector3f &rclMax) const
+  {
+    return rclMin.x <= clMax.x && clMin.x <= rclMax.x &&
+           rclMin.y <= clMax.y && clMin.y <= rclMax.y &&
+           rclMin.z <= clMax.z && clMin.z <= rclMax.z;
+  }
+  bool HitsTriangle (const Base::Vector3f &p0, const Base::Vector3f &e1, const Base::Vector3f &e2) const
+  {
+    Bounds clB;
+    clB.Add(p0);
+    clB.Add(p0 + e1);
+    clB.Add(p0 + e2);
+    return HitsNode(clB.clMin, clB.clMax);
+  }
+  Base::Vector3f clMin, clMax;
+};
+
+/// Selects the nodes and triangles that are cut by a plane
+struct PlaneQuery
+{
+  PlaneQuery (const Base::Vector3f &rclBase, const Base::Vector3f &rclNormal)
+    : clBase(rclBase), clNormal(rclNormal) {}
+  bool HitsNode (const Base::Vector3f &rclMin, const Base::Vector3f &rclMax) const
+  {
+    // the box is cut if its center is not farther away than its projection onto the normal
+    Base::Vector3f clHalf = (rclMax - rclMin) * 0.5f;
+    float fDist = ((rclMin + clHalf) - clBase) * clNormal;
+    float fRadius = clHalf.x * fabs(clNormal.x) + clHalf.y * fabs(clNormal.y) + clHalf.z * fabs(clNormal.z);
+    return fabs(fDist) <= fRadius;
+  }
+  bool HitsTriangle (const Base::Vector3f &p0, const Base::Vector3f &e1, const Base::Vector3f &e2) const
+  {
+    float d0 = (p0 - clBase) * clNormal;
+    float d1 = d0 + e1 * clNormal;
+    float d2 = d0 + e2 * clNormal;
+    return std::min<float>(d0, std::min<float>(d1, d2)) <= 0.0f &&
+           std::max<float>(d0, std::max<float>(d1, d2)) >= 0.0f;
+  }
+  Base::Vector3f clBase, clNormal;
+};
+
+struct BinOf
+{
+  BinOf (const std::vector<Base::Vector3f> &c, unsigned short a, float m, float s, int b)
+    : centers(c), axis(a), min(m), scale(s), bin(b) {}
+  bool operator () (unsigned long i) const
+  {
+    int b = std::min<int>(MESH_TREE_BINS - 1, (int)((centers[i][axis] - min) * scale));
+    return b < bin;
+  }
+  const std::vector<Base::Vector3f> &centers;
+  unsigned short axis;
+  float min, scale;
+  int bin;
+};
+
+struct CenterLess
+{
+  CenterLess (const std::vector<Base::Vector3f> &c, unsigned short a) : centers(c), axis(a) {}
+  bool operator () (unsigned long i, unsigned long j) const
+  {
+    return centers[i][axis] < centers[j][axis];
+  }
+  const std::vector<Base::Vector3f> &centers;
+  unsigned short axis;
+};
+
+} // namespace FacetTreeHelpers
+} // namespace MeshCore
+
+using namespace MeshCore::FacetTreeHelpers;
+
+struct MeshFacetTree::RayJob
+{
+  const MeshFacetTree* pclTree;
+  const Base::Vector3f *pclPts, *pclDirs;
+  unsigned long ulCount;
+  unsigned long *pulFacets;
+  Base::Vector3f *pclRes;
+};
+
+MeshFacetTree::MeshFacetTree (const MeshKernel &rclM)
+{
+  Build(rclM, 0);
+}
+
+MeshFacetTree::MeshFacetTree (const MeshKernel &rclM, const Base::Matrix4D &rclMat)
+{
+  Build(rclM, &rclMat);
+}
+
+MeshFacetTree::~MeshFacetTree ()
+{
+}
+
+void MeshFacetTree::Build (const MeshKernel &rclM, const Base::Matrix4D *pclMat)
+{
+  unsigned long ulCtFacets = rclM.CountFacets();
+  if (ulCtFacets == 0)
+    return;
+
+  std::vector<Triangle> aclTrias(ulCtFacets);
+  std::vector<Bounds> aclBounds(ulCtFacets);
+  std::vector<Base::Vector3f> aclCenters(ulCtFacets);
+  std::vector<unsigned long> aulOrder(ulCtFacets);
+
+  MeshFacetIterator clFIter(rclM);
+  if (pclMat)
+    clFIter.Transform(*pclMat);
+  for (clFIter.Init(); clFIter.More(); clFIter.Next()) {
+    unsigned long ulPos = clFIter.Position();
+    const MeshGeomFacet& rclFacet = *clFIter;
+    Triangle& rclTria = aclTrias[ulPos];
+    rclTria.p0 = rclFacet._aclPoints[0];
+    rclTria.e1 = rclFacet._aclPoints[1] - rclFacet._aclPoints[0];
+    rclTria.e2 = rclFacet._aclPoints[2] - rclFacet._aclPoints[0];
+    Bounds& rclB = aclBounds[ulPos];
+    rclB.Add(rclFacet._aclPoints[0]);
+    rclB.Add(rclFacet._aclPoints[1]);
+    rclB.Add(rclFacet._aclPoints[2]);
+    aclCenters[ulPos] = (rclB.clMin + rclB.clMax) * 0.5f;
+    aulOrder[ulPos] = ulPos;
+  }
+
+  _aclNodes.reserve(2 * ulCtFacets / MESH_TREE_LEAF_SIZE + 1);
+  _aclNodes.push_back(Node());
+
+  std::vector<BuildTask> aclTasks;
+  BuildTask clRoot = { 0, 0, ulCtFacets, 0 };
+  aclTasks.push_back(clRoot);
+  while (!aclTasks.empty()) {
+    BuildTask clTask = aclTasks.back();
+    aclTasks.pop_back();
+
+    Bounds clBox, clCenters;
+    for (unsigned long i = clTask.ulBegin; i < clTask.ulEnd; i++) {
+      clBox.Add(aclBounds[aulOrder[i]]);
+      clCenters.Add(aclCenters[aulOrder[i]]);
+    }
+    _aclNodes[clTask.ulNode].clMin = clBox.clMin;
+    _aclNodes[clTask.ulNode].clMax = clBox.clMax;
+    _aclNodes[clTask.ulNode].ulFirst = clTask.ulBegin;
+    _aclNodes[clTask.ulNode].ulCount = clTask.ulEnd - clTask.ulBegin;
+
+    unsigned long ulCount = clTask.ulEnd - clTask.ulBegin;
+    if (ulCount <= MESH_TREE_LEAF_SIZE)
+      continue;
+
+    // evaluate the surface area heuristic at the bin borders of all axes
+    float fBestCost = FLOAT_MAX;
+    unsigned short usBestAxis = 0;
+    int iBestBin = -1;
+    float fBestScale = 0.0f;
+    for (unsigned short a = 0; a < 3; a++) {
+      float fExtent = clCenters.clMax[a] - clCenters.clMin[a];
+      if (fExtent <= 0.0f)
+        continue;
+
+      float fScale = MESH_TREE_BINS / fExtent;
+      Bounds aclBins[MESH_TREE_BINS];
+      unsigned long aulBinCount[MESH_TREE_BINS] = { 0 };
+      for (unsigned long i = clTask.ulBegin; i < clTask.ulEnd; i++) {
+        unsigned long ulInd = aulOrder[i];
+        int b = std::min<int>(MESH_TREE_BINS - 1, (int)((aclCenters[ulInd][a] - clCenters.clMin[a]) * fScale));
+        aulBinCount[b]++;
+        aclBins[b].Add(aclBounds[ulInd]);
+      }
+
+      float afRightArea[MESH_TREE_BINS];
+      unsigned long aulRightCount[MESH_TREE_BINS];
+      Bounds clRight;
+      unsigned long ulRight = 0;
+      for (int b = MESH_TREE_BINS - 1; b > 0; b--) {
+        clRight.Add(aclBins[b]);
+        ulRight += aulBinCount[b];
+        afRightArea[b] = clRight.Area();
+        aulRightCount[b] = ulRight;
+      }
+
+      Bounds clLeft;
+      unsigned long ulLeft = 0;
+      for (int b = 1; b < MESH_TREE_BINS; b++) {
+        clLeft.Add(aclBins[b - 1]);
+        ulLeft += aulBinCount[b - 1];
+        if (ulLeft == 0 || aulRightCount[b] == 0)
+          continue;
+        float fCost = ulLeft * clLeft.Area() + aulRightCount[b] * afRightArea[b];
+        if (fCost < fBestCost) {
+          fBestCost = fCost;
+          usBestAxis = a;
+          iBestBin = b;
+          fBestScale = fScale;
+        }
+      }
+    }
+
+    // all centers coincide, there is no sensible split
+    if (iBestBin < 0)
+      continue;
+    // the traversal of an inner node costs about as much as a triangle test
+    float fArea = clBox.Area();
+    if (fBestCost + fArea >= ulCount * fArea && ulCount <= MESH_TREE_MAX_LEAF)
+      continue;
+
+    std::vector<unsigned long>::iterator clBegin = aulOrder.begin() + clTask.ulBegin;
+    std::vector<unsigned long>::iterator clEnd = aulOrder.begin() + clTask.ulEnd;
+    unsigned long ulMid = clTask.ulBegin;
+    if (clTask.ulDepth < MESH_TREE_SAH_DEPTH) {
+      ulMid = std::partition(clBegin, clEnd, BinOf(aclCenters, usBestAxis,
+                             clCenters.clMin[usBestAxis], fBestScale, iBestBin)) - aulOrder.begin();
+    }
+    if (clTask.ulDepth >= MESH_TREE_SAH_DEPTH || ulMid == clTask.ulBegin || ulMid == clTask.ulEnd) {
+      // avoid degenerated trees, the median keeps the remaining depth logarithmic
+      ulMid = clTask.ulBegin + ulCount / 2;
+      std::nth_element(clBegin, aulOrder.begin() + ulMid, clEnd, CenterLess(aclCenters, usBestAxis));
+    }
+
+    unsigned long ulLeft = (unsigned long)_aclNodes.size();
+    _aclNodes.push_back(Node());
+    _aclNodes.push_back(Node());
+    _aclNodes[clTask.ulNode].ulFirst = ulLeft;
+    _aclNodes[clTask.ulNode].ulCount = 0;
+
+    BuildTask clLeftTask  = { ulLeft,     clTask.ulBegin, ulMid,        clTask.ulDepth + 1 };
+    BuildTask clRightTask = { ulLeft + 1, ulMid,          clTask.ulEnd, clTask.ulDepth + 1 };
+    aclTasks.push_back(clRightTask);
+    aclTasks.push_back(clLeftTask);
+  }
+
+  // store the triangles in leaf order
+  _aclTrias.resize(ulCtFacets);
+  _aulFacets.swap(aulOrder);
+  _aulSlots.resize(ulCtFacets);
+  for (unsigned long i = 0; i < ulCtFacets; i++) {
+    _aclTrias[i] = aclTrias[_aulFacets[i]];
+    _aulSlots[_aulFacets[i]] = i;
+  }
+}
+
+bool MeshFacetTree::NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float fMaxDist,
+                                       Base::Vector3f &rclRes, unsigned long &rulFacet) const
+{
+  if (_aclNodes.empty())
+    return false;
+
+  Base::Vector3f clInv = Inverse(rclDir);
+  float fBestT = fMaxDist;
+  unsigned long ulBest = ULONG_MAX;
+
+  unsigned long aulStack[MESH_TREE_STACK];
+  int iTop = 0;
+  aulStack[iTop++] = 0;
+  while (iTop > 0) {
+    const Node& rclNode = _aclNodes[aulStack[--iTop]];
+    float fEntry;
+    if (!IntersectBox(rclNode.clMin, rclNode.clMax, rclPt, clInv, fBestT, fEntry))
+      continue;
+
+    if (rclNode.ulCount > 0) {
+      unsigned long ulEnd = rclNode.ulFirst + rclNode.ulCount;
+      for (unsigned long i = rclNode.ulFirst; i < ulEnd; i++) {
+        const Triangle& rclTria = _aclTrias[i];
+        float fT;
+        if (IntersectTriangle(rclTria.p0, rclTria.e1, rclTria.e2, rclPt, rclDir, fT)) {
+          if (fT < fBestT || (fT == fBestT && _aulFacets[i] < ulBest)) {
+            fBestT = fT;
+            ulBest = _aulFacets[i];
+          }
+        }
+      }
+    }
+    else {
+      // visit the nearer child first
+      const Node& rclLeft = _aclNodes[rclNode.ulFirst];
+      const Node& rclRight = _aclNodes[rclNode.ulFirst + 1];
+      float fLeft, fRight;
+      bool bLeft = IntersectBox(rclLeft.clMin, rclLeft.clMax, rclPt, clInv, fBestT, fLeft);
+      bool bRight = IntersectBox(rclRight.clMin, rclRight.clMax, rclPt, clInv, fBestT, fRight);
+      if (bLeft && bRight) {
+        if (fLeft <= fRight) {
+          aulStack[iTop++] = rclNode.ulFirst + 1;
+          aulStack[iTop++] = rclNode.ulFirst;
+        }
+        else {
+          aulStack[iTop++] = rclNode.ulFirst;
+          aulStack[iTop++] = rclNode.ulFirst + 1;
+        }
+      }
+      else if (bLeft) {
+        aulStack[iTop++] = rclNode.ulFirst;
+      }
+      else if (bRight) {
+        aulStack[iTop++] = rclNode.ulFirst + 1;
+      }
+    }
+  }
+
+  if (ulBest == ULONG_MAX)
+    return false;
+
+  rclRes = rclPt + rclDir * fBestT;
+  rulFacet = ulBest;
+  return true;
+}
+
+void MeshFacetTree::RayPacket (const Base::Vector3f *pclPts, const Base::Vector3f *pclDirs, unsigned long ulCount,
+                               unsigned long *pulFacets, Base::Vector3f *pclRes) const
+{
+  Base::Vector3f aclInv[MESH_TREE_PACKET];
+  float afBestT[MESH_TREE_PACKET];
+  for (unsigned long r = 0; r < ulCount; r++) {
+    aclInv[r] = Inverse(pclDirs[r]);
+    afBestT[r] = FLOAT_MAX;
+    pulFacets[r] = ULONG_MAX;
+  }
+
+  unsigned long aulStack[MESH_TREE_STACK];
+  int iTop = 0;
+  aulStack[iTop++] = 0;
+  while (iTop > 0) {
+    const Node& rclNode = _aclNodes[aulStack[--iTop]];
+
+    // the node is visited as soon as one ray of the packet hits it
+    bool bHit = false;
+    float fEntry;
+    for (unsigned long r = 0; r < ulCount && !bHit; r++)
+      bHit = IntersectBox(rclNode.clMin, rclNode.clMax, pclPts[r], aclInv[r], afBestT[r], fEntry);
+    if (!bHit)
+      continue;
+
+    if (rclNode.ulCount > 0) {
+      unsigned long ulEnd = rclNode.ulFirst + rclNode.ulCount;
+      for (unsigned long i = rclNode.ulFirst; i < ulEnd; i++) {
+        const Triangle& rclTria = _aclTrias[i];
+        for (unsigned long r = 0; r < ulCount; r++) {
+          float fT;
+          if (IntersectTriangle(rclTria.p0, rclTria.e1, rclTria.e2, pclPts[r], pclDirs[r], fT)) {
+            if (fT < afBestT[r] || (fT == afBestT[r] && _aulFacets[i] < pulFacets[r])) {
+              afBestT[r] = fT;
+              pulFacets[r] = _aulFacets[i];
+            }
+          }
+        }
+      }
+    }
+    else {
+      // the first ray decides about the order of the children
+      const Node& rclLeft = _aclNodes[rclNode.ulFirst];
+      const Node& rclRight = _aclNodes[rclNode.ulFirst + 1];
+      float fLeft, fRight;
+      IntersectBox(rclLeft.clMin, rclLeft.clMax, pclPts[0], aclInv[0], FLOAT_MAX, fLeft);
+      IntersectBox(rclRight.clMin, rclRight.clMax, pclPts[0], aclInv[0], FLOAT_MAX, fRight);
+      if (fLeft <= fRight) {
+        aulStack[iTop++] = rclNode.ulFirst + 1;
+        aulStack[iTop++] = rclNode.ulFirst;
+      }
+      else {
+        aulStack[iTop++] = rclNode.ulFirst;
+        aulStack[iTop++] = rclNode.ulFirst + 1;
+      }
+    }
+  }
+
+  for (unsigned long r = 0; r < ulCount; r++) {
+    if (pulFacets[r] != ULONG_MAX)
+      pclRes[r] = pclPts[r] + pclDirs[r] * afBestT[r];
+  }
+}
+
+void MeshFacetTree::RayJobRun (RayJob &rclJob)
+{
+  for (unsigned long i = 0; i < rclJob.ulCount; i += MESH_TREE_PACKET) {
+    unsigned long ulSize = std::min<unsigned long>(MESH_TREE_PACKET, rclJob.ulCount - i);
+    rclJob.pclTree->RayPacket(rclJob.pclPts + i, rclJob.pclDirs + i, ulSize,
+                              rclJob.pulFacets + i, rclJob.pclRes + i);
+  }
+}
+
+void MeshFacetTree::NearestFacetsOnRays (const std::vector<Base::Vector3f> &raclPts, const std::vector<Base::Vector3f> &raclDirs,
+                                         std::vector<unsigned long> &raulFacets, std::vector<Base::Vector3f> &raclRes) const
+{
+  unsigned long ulCtRays = (unsigned long)std::min<std::size_t>(raclPts.size(), raclDirs.size());
+  raulFacets.resize(ulCtRays);
+  raclRes.resize(ulCtRays);
+  if (ulCtRays == 0)
+    return;
+  if (_aclNodes.empty()) {
+    std::fill(raulFacets.begin(), raulFacets.end(), ULONG_MAX);
+    return;
+  }
+
+  std::vector<RayJob> aclJobs;
+  for (unsigned long i = 0; i < ulCtRays; i += MESH_TREE_RAY_JOB) {
+    RayJob clJob;
+    clJob.pclTree = this;
+    clJob.pclPts = &raclPts[i];
+    clJob.pclDirs = &raclDirs[i];
+    clJob.ulCount = std::min<unsigned long>(MESH_TREE_RAY_JOB, ulCtRays - i);
+    clJob.pulFacets = &raulFacets[i];
+    clJob.pclRes = &raclRes[i];
+    aclJobs.push_back(clJob);
+  }
+
+  if (aclJobs.size() > 1 && QThread::idealThreadCount() > 1) {
+    QFuture<void> future = QtConcurrent::map(aclJobs, &MeshFacetTree::RayJobRun);
+    future.waitForFinished();
+  }
+  else {
+    for (std::vector<RayJob>::iterator it = aclJobs.begin(); it != aclJobs.end(); ++it)
+      RayJobRun(*it);
+  }
+}
+
+unsigned long MeshFacetTree::SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist) const
+{
+  Base::Vector3f clRes;
+  return SearchNearestFromPoint(rclPt, fMaxDist, clRes);
+}
+
+unsigned long MeshFacetTree::SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist, Base::Vector3f &rclRes) const
+{
+  if (_aclNodes.empty())
+    return ULONG_MAX;
+
+  float fBestDist = fMaxDist * fMaxDist;
+  unsigned long ulBest = ULONG_MAX;
+
+  unsigned long aulStack[MESH_TREE_STACK];
+  int iTop = 0;
+  aulStack[iTop++] = 0;
+  while (iTop > 0) {
+    const Node& rclNode = _aclNodes[aulStack[--iTop]];
+    if (BoxDistance(rclNode.clMin, rclNode.clMax, rclPt) > fBestDist)
+      continue;
+
+    if (rclNode.ulCount > 0) {
+      unsigned long ulEnd = rclNode.ulFirst + rclNode.ulCount;
+      for (unsigned long i = rclNode.ulFirst; i < ulEnd; i++) {
+        const Triangle& rclTria = _aclTrias[i];
+        Base::Vector3f clProj = ClosestPoint(rclTria.p0, rclTria.e1, rclTria.e2, rclPt);
+        float fDist = (clProj - rclPt).Sqr();
+        if (fDist < fBestDist || (fDist == fBestDist && _aulFacets[i] < ulBest)) {
+          fBestDist = fDist;
+          ulBest = _aulFacets[i];
+          rclRes = clProj;
+        }
+      }
+    }
+    else {
+      // visit the nearer child first
+      const Node& rclLeft = _aclNodes[rclNode.ulFirst];
+      const Node& rclRight = _aclNodes[rclNode.ulFirst + 1];
+      float fLeft = BoxDistance(rclLeft.clMin, rclLeft.clMax, rclPt);
+      float fRight = BoxDistance(rclRight.clMin, rclRight.clMax, rclPt);
+      if (fLeft <= fRight) {
+        if (fRight <= fBestDist)
+          aulStack[iTop++] = rclNode.ulFirst + 1;
+        if (fLeft <= fBestDist)
+          aulStack[iTop++] = rclNode.ulFirst;
+      }
+      else {
+        if (fLeft <= fBestDist)
+          aulStack[iTop++] = rclNode.ulFirst;
+        if (fRight <= fBestDist)
+          aulStack[iTop++] = rclNode.ulFirst + 1;
+      }
+    }
+  }
+
+  return ulBest;
+}
+
+template <class Query>
+void MeshFacetTree::Collect (const Query &rclQuery, std::vector<unsigned long> &raulFacets) const
+{
+  raulFacets.clear();
+  if (_aclNodes.empty())
+    return;
+
+  unsigned long aulStack[MESH_TREE_STACK];
+  int iTop = 0;
+  aulStack[iTop++] = 0;
+  while (iTop > 0) {
+    const Node& rclNode = _aclNodes[aulStack[--iTop]];
+    if (!rclQuery.HitsNode(rclNode.clMin, rclNode.clMax))
+      continue;
+
+    if (rclNode.ulCount > 0) {
+      unsigned long ulEnd = rclNode.ulFirst + rclNode.ulCount;
+      for (unsigned long i = rclNode.ulFirst; i < ulEnd; i++) {
+        const Triangle& rclTria = _aclTrias[i];
+        if (rclQuery.HitsTriangle(rclTria.p0, rclTria.e1, rclTria.e2))
+          raulFacets.push_back(_aulFacets[i]);
+      }
+    }
+    else {
+      aulStack[iTop++] = rclNode.ulFirst + 1;
+      aulStack[iTop++] = rclNode.ulFirst;
+    }
+  }
+
+  std::sort(raulFacets.begin(), raulFacets.end());
+}
+
+void MeshFacetTree::Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulFacets) const
+{
+  Collect(BoxQuery(rclBB), raulFacets);
+}
+
+void MeshFacetTree::CutByPlane (const Base::Vector3f &rclBase, const Base::Vector3f &rclNormal, std::vector<unsigned long> &raulFacets) const
+{
+  Collect(PlaneQuery(rclBase, rclNormal), raulFacets);
+}
+
+MeshGeomFacet MeshFacetTree::GetFacet (unsigned long ulFacet) const
+{
+  const Triangle& rclTria = _aclTrias[_aulSlots[ulFacet]];
+  MeshGeomFacet clFacet;
+  clFacet._aclPoints[0] = rclTria.p0;
+  clFacet._aclPoints[1] = rclTria.p0 + rclTria.e1;
+  clFacet._aclPoints[2] = rclTria.p0 + rclTria.e2;
+  clFacet.CalcNormal();
+  return clFacet;
+}
+
+Base::BoundBox3f MeshFacetTree::GetBoundBox (void) const
+{
+  if (_aclNodes.empty())
+    return Base::BoundBox3f();
+  const Node& rclRoot = _aclNodes.front();
+  return Base::BoundBox3f(rclRoot.clMin.x, rclRoot.clMin.y, rclRoot.clMin.z,
+                          rclRoot.clMax.x, rclRoot.clMax.y, rclRoot.clMax.z);
+}
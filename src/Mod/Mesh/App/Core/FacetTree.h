@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef MESH_FACETTREE_H
+#define MESH_FACETTREE_H
+
+#include <vector>
+
+#include "Definitions.h"
+#include <Base/Vector3D.h>
+#include <Base/BoundBox.h>
+
+namespace Base {
+  class Matrix4D;
+}
+
+namespace MeshCore {
+
+class MeshKernel;
+class MeshGeomFacet;
+
+/**
+ * The MeshFacetTree is a bounding volume hierarchy over the facets of a mesh.
+ * In contrast to the MeshFacetGrid whose cells all have the same size the tree
+ * adapts to the distribution of the facets, so meshes with a highly varying
+ * density of triangles (e.g. scans with detail regions) don't need a compromise
+ * between too many empty and too many overcrowded cells.
+ *
+ * The tree is built with the surface area heuristic on binned centroids. It keeps
+ * its own copy of the (optionally transformed) triangles ordered by leaves, the
+ * returned facet indices refer to the mesh. If the mesh changes the tree must be
+ * rebuilt.
+ *
+ * All search methods are const and can be called from several threads at the same
+ * time.
+ */
+class MeshExport MeshFacetTree
+{
+public:
+  /** @name Construction */
+  //@{
+  /// Builds the tree over the facets of \a rclM
+  MeshFacetTree (const MeshKernel &rclM);
+  /// Builds the tree over the facets of \a rclM transformed by \a rclMat
+  MeshFacetTree (const MeshKernel &rclM, const Base::Matrix4D &rclMat);
+  /// Destruction
+  ~MeshFacetTree ();
+  //@}
+
+public:
+  /** @name Search */
+  //@{
+  /**
+   * Searches for the nearest facet hit by the ray starting at \a rclPt with the direction \a rclDir.
+   * Only intersections within the distance \a fMaxDist (measured in multiples of \a rclDir) are taken into
+   * account. \a rclRes is the intersection point and \a rulFacet the index of the facet.
+   * \note Unlike MeshGeomFacet::Foraminate() facets behind the start point are not taken into account.
+   */
+  bool NearestFacetOnRay (const Base::Vector3f &rclPt, const Base::Vector3f &rclDir, float fMaxDist,
+                          Base::Vector3f &rclRes, unsigned long &rulFacet) const;
+  /**
+   * Does the same as NearestFacetOnRay() for a whole set of rays. Neighbouring rays are traversed together
+   * so this is much faster for coherent rays, e.g. points sampled on a surface projected along their normals.
+   * For rays without any hit ULONG_MAX is set to \a raulFacets.
+   */
+  void NearestFacetsOnRays (const std::vector<Base::Vector3f> &raclPts, const std::vector<Base::Vector3f> &raclDirs,
+                            std::vector<unsigned long> &raulFacets, std::vector<Base::Vector3f> &raclRes) const;
+  /**
+   * Searches for the nearest facet to the point \a rclPt with a distance not higher than \a fMaxDist.
+   * If no facet is found ULONG_MAX is returned.
+   */
+  unsigned long SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist = FLOAT_MAX) const;
+  /**
+   * Does the same as the method above and additionally returns the nearest point on the facet in \a rclRes.
+   */
+  unsigned long SearchNearestFromPoint (const Base::Vector3f &rclPt, float fMaxDist, Base::Vector3f &rclRes) const;
+  /**
+   * Searches for all facets whose bounding box intersects \a rclBB. The indices in \a raulFacets are sorted.
+   */
+  void Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulFacets) const;
+  /**
+   * Searches for all facets cut by the plane through \a rclBase with the normal \a rclNormal. The indices
+   * in \a raulFacets are sorted.
+   */
+  void CutByPlane (const Base::Vector3f &rclBase, const Base::Vector3f &rclNormal, std::vector<unsigned long> &raulFacets) const;
+  //@}
+
+  /** @name Inquiry */
+  //@{
+  /// Returns the number of facets
+  unsigned long CountFacets (void) const
+  { return (unsigned long)_aulFacets.size(); }
+  /// Returns the facet with index \a ulFacet as it is stored in the tree, i.e. with transformation
+  MeshGeomFacet GetFacet (unsigned long ulFacet) const;
+  /// Returns the bounding box of all facets
+  Base::BoundBox3f GetBoundBox (void) const;
+  //@}
+
+private:
+  /// A triangle as first point and the two edges starting there
+  struct Triangle
+  {
+    Base::Vector3f p0, e1, e2;
+  };
+  /// Inner nodes have the two children at \a ulFirst and \a ulFirst+1, leaves refer to \a ulCount triangles
+  struct Node
+  {
+    Base::Vector3f clMin, clMax;
+    unsigned long ulFirst;
+    unsigned long ulCount;
+  };
+  struct RayJob;
+
+  void Build (const MeshKernel &rclM, const Base::Matrix4D *pclMat);
+  void RayPacket (const Base::Vector3f *pclPts, const Base::Vector3f *pclDirs, unsigned long ulCount,
+                  unsigned long *pulFacets, Base::Vector3f *pclRes) const;
+  static void RayJobRun (RayJob &rclJob);
+  template <class Query>
+  void Collect (const Query &rclQuery, std::vector<unsigned long> &raulFacets) const;
+
+private:
+  std::vector<Node>          _aclNodes;  /**< Nodes in build order, the root comes first */
+  std::vector<Triangle>      _aclTrias;  /**< Triangles ordered by leaves */
+  std::vector<unsigned long> _aulFacets; /**< Facet index of each triangle */
+  std::vector<unsigned long> _aulSlots;  /**< Triangle of each facet index */
+
+  // no copying
+  MeshFacetTree (const MeshFacetTree&);
+  void operator = (const MeshFacetTree&);
+};
+
+} // namespace MeshCore
+
+#endif // MESH_FACETTREE_H
@@ -32,6 +32,7 @@
 
 #include "MeshKernel.h"
 #include "Algorithm.h"
+#include "Helpers.h"
 #include "Tools.h"
 
 using namespace MeshCore;
@@ -62,7 +63,8 @@ void MeshGrid::Attach (const MeshKernel &rclM)
 
 void MeshGrid::Clear (void)
 {
-  _aulGrid.clear();
+  _aulGridOffsets.clear();
+  _aulGridElements.clear();
   _pclMesh = NULL;  
 }
 
@@ -93,8 +95,6 @@ void MeshGrid::InitGrid (void)
 {
   assert(_pclMesh != NULL);
 
-  unsigned long i, j;
-
   // Grid Laengen berechnen wenn nicht initialisiert
   //
   if ((_ulCtGridsX == 0) || (_ulCtGridsX == 0) || (_ulCtGridsX == 0))
@@ -128,20 +128,60 @@ void MeshGrid::InitGrid (void)
   }
 
   // Daten-Struktur anlegen
-  _aulGrid.clear();
-  _aulGrid.resize(_ulCtGridsX);
-  for (i = 0; i < _ulCtGridsX; i++)
+  _aulGridOffsets.assign(_ulCtGridsX * _ulCtGridsY * _ulCtGridsZ + 1, 0);
+  _aulGridElements.clear();
+}
+
+struct MeshGrid::CollectJob
+{
+  const MeshGrid* grid;
+  unsigned long first, last;
+  std::vector<GridEntry> entries;
+};
+
+void MeshGrid::CollectJobRun (CollectJob &rclJob)
+{
+  rclJob.grid->CollectElements(rclJob.first, rclJob.last, rclJob.entries);
+}
+
+void MeshGrid::FillGrid (void)
+{
+  unsigned long ulCtGrids = _ulCtGridsX * _ulCtGridsY * _ulCtGridsZ;
+  unsigned long ulCtElements = HasElements();
+
+  // find the grids of all elements, the ranges keep the element order
+  CollectJob clProto;
+  clProto.grid = this;
+  std::vector<CollectJob> jobs = MakeJobs(ulCtElements, clProto);
+  RunJobs(jobs, CollectJobRun);
+
+  // counting sort of the entries by grid, the elements of a grid stay sorted
+  std::vector<unsigned long> aulOffsets(ulCtGrids + 1, 0);
+  for (std::vector<CollectJob>::iterator it = jobs.begin(); it != jobs.end(); ++it)
   {
-    _aulGrid[i].resize(_ulCtGridsY);
-    for (j = 0; j < _ulCtGridsY; j++)
-      _aulGrid[i][j].resize(_ulCtGridsZ);
+    for (std::vector<GridEntry>::const_iterator jt = it->entries.begin(); jt != it->entries.end(); ++jt)
+      aulOffsets[jt->first + 1]++;
   }
+  for (unsigned long i = 0; i < ulCtGrids; i++)
+    aulOffsets[i + 1] += aulOffsets[i];
+
+  std::vector<unsigned long> aulElements(aulOffsets[ulCtGrids]);
+  std::vector<unsigned long> aulPos(aulOffsets.begin(), aulOffsets.end() - 1);
+  for (std::vector<CollectJob>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+  {
+    for (std::vector<GridEntry>::const_iterator jt = it->entries.begin(); jt != it->entries.end(); ++jt)
+      aulElements[aulPos[jt->first]++] = jt->second;
+    std::vector<GridEntry>().swap(it->entries);
+  }
+
+  _aulGridOffsets.swap(aulOffsets);
+  _aulGridElements.swap(aulElements);
 }
 
 unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsigned long> &raulElements,
                                 bool bDelDoubles) const
 {
-  unsigned long i, j, k, ulMinX, ulMinY, ulMinZ,  ulMaxX, ulMaxY, ulMaxZ;
+  unsigned long i, j, ulMinX, ulMinY, ulMinZ,  ulMaxX, ulMaxY, ulMaxZ;
   
   raulElements.clear();
 
@@ -149,14 +189,12 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
   Position(Base::Vector3f(rclBB.MinX, rclBB.MinY, rclBB.MinZ), ulMinX, ulMinY, ulMinZ);
   Position(Base::Vector3f(rclBB.MaxX, rclBB.MaxY, rclBB.MaxZ), ulMaxX, ulMaxY, ulMaxZ);
 
+  // the grids along z are stored one after another
   for (i = ulMinX; i <= ulMaxX; i++)
   {
     for (j = ulMinY; j <= ulMaxY; j++)
     {
-      for (k = ulMinZ; k <= ulMaxZ; k++)
-      {
-        raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
-      }
+      raulElements.insert(raulElements.end(), GridBegin(i, j, ulMinZ), GridEnd(i, j, ulMaxZ));
     }
   }  
 
@@ -190,7 +228,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
       for (k = ulMinZ; k <= ulMaxZ; k++)
       {
         if (Base::DistanceP2(GetBoundBox(i, j, k).CalcCenter(), rclOrg) < fMinDistP2)
-          raulElements.insert(raulElements.end(), _aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
+          raulElements.insert(raulElements.end(), GridBegin(i, j, k), GridEnd(i, j, k));
       }
     }
   }  
@@ -207,7 +245,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::vector<unsig
 
 unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned long> &raulElements) const
 {
-  unsigned long i, j, k, ulMinX, ulMinY, ulMinZ,  ulMaxX, ulMaxY, ulMaxZ;
+  unsigned long i, j, ulMinX, ulMinY, ulMinZ,  ulMaxX, ulMaxY, ulMaxZ;
   
   raulElements.clear();
 
@@ -219,10 +257,7 @@ unsigned long MeshGrid::Inside (const Base::BoundBox3f &rclBB, std::set<unsigned
   {
     for (j = ulMinY; j <= ulMaxY; j++)
     {
-      for (k = ulMinZ; k <= ulMaxZ; k++)
-      {
-        raulElements.insert(_aulGrid[i][j][k].begin(), _aulGrid[i][j][k].end());
-      }
+      raulElements.insert(GridBegin(i, j, ulMinZ), GridEnd(i, j, ulMaxZ));
     }
   }  
 
@@ -450,7 +485,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -464,7 +499,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsY; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[nX][i][j].begin(), _aulGrid[nX][i][j].end());
+              raclInd.insert(GridBegin(nX, i, j), GridEnd(nX, i, j));
           }
           nX++;
         }
@@ -478,7 +513,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY++;
         }
@@ -492,7 +527,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsZ; j++)
-              raclInd.insert(_aulGrid[i][nY][j].begin(), _aulGrid[i][nY][j].end());
+              raclInd.insert(GridBegin(i, nY, j), GridEnd(i, nY, j));
           }
           nY--;
         }
@@ -506,7 +541,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ++;
         }
@@ -520,7 +555,7 @@ void MeshGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt, std::set<uns
           for (unsigned long i = 0; i < _ulCtGridsX; i++)
           {
             for (unsigned long j = 0; j < _ulCtGridsY; j++)
-              raclInd.insert(_aulGrid[i][j][nZ].begin(), _aulGrid[i][j][nZ].end());
+              raclInd.insert(GridBegin(i, j, nZ), GridEnd(i, j, nZ));
           }
           nZ--;
         }
@@ -586,11 +621,12 @@ void MeshGrid::GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ,
 unsigned long MeshGrid::GetElements (unsigned long ulX, unsigned long ulY, unsigned long ulZ,  
                                      std::set<unsigned long> &raclInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  if (rclSet.size() > 0)
+  GridIterator itBegin = GridBegin(ulX, ulY, ulZ);
+  GridIterator itEnd = GridEnd(ulX, ulY, ulZ);
+  if (itBegin != itEnd)
   {
-    raclInd.insert(rclSet.begin(), rclSet.end());
-    return rclSet.size();
+    raclInd.insert(itBegin, itEnd);
+    return itEnd - itBegin;
   }
 
   return 0;
@@ -602,9 +638,7 @@ unsigned long MeshGrid::GetElements(const Base::Vector3f &rclPoint, std::vector<
   if (!CheckPosition(rclPoint, ulX, ulY, ulZ))
     return 0;
 
-  aulFacets.resize(_aulGrid[ulX][ulY][ulZ].size());
-
-  std::copy(_aulGrid[ulX][ulY][ulZ].begin(), _aulGrid[ulX][ulY][ulZ].end(), aulFacets.begin());
+  aulFacets.assign(GridBegin(ulX, ulY, ulZ), GridEnd(ulX, ulY, ulZ));
   return aulFacets.size();
 }
 
@@ -709,15 +743,23 @@ void MeshFacetGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-  MeshFacetIterator clFIter(*_pclMesh);
+  FillGrid();
+}
+
+void MeshFacetGrid::CollectElements (unsigned long ulFirst, unsigned long ulLast, std::vector<GridEntry> &raclEntries) const
+{
+  const MeshPointArray& rclPoints = _pclMesh->GetPoints();
+  const MeshFacetArray& rclFacets = _pclMesh->GetFacets();
 
-  unsigned long i = 0;
-  for (clFIter.Init(); clFIter.More(); clFIter.Next())
+  MeshGeomFacet clFacet;
+  for (unsigned long i = ulFirst; i < ulLast; i++)
   {
-//    AddFacet(*clFIter, i++, 2.0f);
-    AddFacet(*clFIter, i++);
+    const MeshFacet& rclFacet = rclFacets[i];
+    clFacet._aclPoints[0] = rclPoints[rclFacet._aulPoints[0]];
+    clFacet._aclPoints[1] = rclPoints[rclFacet._aulPoints[1]];
+    clFacet._aclPoints[2] = rclPoints[rclFacet._aulPoints[2]];
+    AddFacet(clFacet, i, raclEntries);
   }
-
 }
 
 unsigned long MeshFacetGrid::SearchNearestFromPoint (const Base::Vector3f &rclPt) const
@@ -918,8 +960,8 @@ void MeshFacetGrid::SearchNearestFacetInGrid(unsigned long ulX, unsigned long ul
                                              const Base::Vector3f &rclPt, float &rfMinDist,
                                              unsigned long &rulFacetInd) const
 {
-  const std::set<unsigned long> &rclSet = _aulGrid[ulX][ulY][ulZ];
-  for (std::set<unsigned long>::const_iterator pI = rclSet.begin(); pI != rclSet.end(); pI++)
+  GridIterator itEnd = GridEnd(ulX, ulY, ulZ);
+  for (GridIterator pI = GridBegin(ulX, ulY, ulZ); pI != itEnd; pI++)
   {
     float fDist = _pclMesh->GetFacet(*pI).DistanceToPoint(rclPt);
     if (fDist < rfMinDist)
@@ -964,12 +1006,19 @@ MeshPointGrid::MeshPointGrid (const MeshKernel &rclM, float fGridLen)
           std::max<unsigned long>((unsigned long)(clBBMesh.LengthZ() / fGridLen), 1));
 }
 
-void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon)
+void MeshPointGrid::AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, std::vector<GridEntry> &raclEntries) const
 {
   unsigned long ulX, ulY, ulZ;
   Pos(Base::Vector3f(rclPt.x, rclPt.y, rclPt.z), ulX, ulY, ulZ);
   if ( (ulX < _ulCtGridsX) && (ulY < _ulCtGridsY) && (ulZ < _ulCtGridsZ) )
-    _aulGrid[ulX][ulY][ulZ].insert(ulPtIndex);
+    raclEntries.push_back(GridEntry(GridIndex(ulX, ulY, ulZ), ulPtIndex));
+}
+
+void MeshPointGrid::CollectElements (unsigned long ulFirst, unsigned long ulLast, std::vector<GridEntry> &raclEntries) const
+{
+  const MeshPointArray& rclPoints = _pclMesh->GetPoints();
+  for (unsigned long i = ulFirst; i < ulLast; i++)
+    AddPoint(rclPoints[i], i, raclEntries);
 }
 
 void MeshPointGrid::Validate (const MeshKernel &rclMesh)
@@ -1020,14 +1069,7 @@ void MeshPointGrid::RebuildGrid (void)
   InitGrid();
  
   // Daten-Struktur fuellen
-
-  MeshPointIterator cPIter(*_pclMesh);
-
-  unsigned long i = 0;
-  for (cPIter.Init(); cPIter.More(); cPIter.Next())
-  {
-    AddPoint(*cPIter, i++);
-  }
+  FillGrid();
 }
 
 void MeshPointGrid::Pos (const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const
@@ -1089,7 +1131,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
   if ((_rclGrid.GetBoundBox().IsInBox(rclPt)) == true)
   {  // Voxel bestimmen, indem der Startpunkt liegt
     _rclGrid.Position(rclPt, _ulX, _ulY, _ulZ);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
     _bValidRay = true;
   }
   else
@@ -1102,7 +1144,7 @@ bool MeshGridIterator::InitOnRay (const Base::Vector3f &rclPt, const Base::Vecto
       else
         _rclGrid.Position(cP1, _ulX, _ulY, _ulZ);
 
-      raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+      raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
       _bValidRay = true;
     }
   }
@@ -1153,7 +1195,7 @@ bool MeshGridIterator::NextOnRay (std::vector<unsigned long> &raulElements)
   if ((_bValidRay == true) && (_rclGrid.CheckPos(_ulX, _ulY, _ulZ) == true))
   {
     GridElement pos(_ulX, _ulY, _ulZ); _cSearchPositions.insert(pos);
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end()); 
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ)); 
   }
   else
     _bValidRay = false;  // Strahl ausgetreten
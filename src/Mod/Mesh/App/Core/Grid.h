@@ -25,6 +25,8 @@
 #define MESH_GRID_H
 
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "MeshKernel.h"
 #include <Base/Vector3D.h>
@@ -51,6 +53,9 @@ class MeshGrid;
  *
  * Grids can be used within algorithms to avoid to iterate through all elements,
  * so grids can speed up algorithms dramatically.
+ *
+ * The element indices of all grids are kept in one array, sorted by grid and
+ * by index within a grid, and a second array holds where each grid starts.
  */
 class MeshExport MeshGrid
 {
@@ -125,7 +130,7 @@ public:
   bool GetPositionToIndex(unsigned long id, unsigned long& ulX, unsigned long& ulY, unsigned long& ulZ) const;
   /** Returns the number of elements in a given grid. */
   unsigned long GetCtElements(unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
-  { return _aulGrid[ulX][ulY][ulZ].size(); }
+  { unsigned long ulGrid = GridIndex(ulX, ulY, ulZ); return _aulGridOffsets[ulGrid+1] - _aulGridOffsets[ulGrid]; }
   /** Validates the grid structure and rebuilds it if needed. Must be implemented in sub-classes. */
   virtual void Validate (const MeshKernel &rclM) = 0;
   /** Verifies the grid structure and returns false if inconsistencies are found. */
@@ -143,8 +148,28 @@ public:
   void GetHull (unsigned long ulX, unsigned long ulY, unsigned long ulZ, unsigned long ulDistance, std::set<unsigned long> &raclInd) const;
 
 protected:
+  /// A pair of a grid index and an element index
+  typedef std::pair<unsigned long, unsigned long> GridEntry;
+  typedef std::vector<unsigned long>::const_iterator GridIterator;
+
   /** Initializes the size of the internal structure. */
   virtual void InitGrid (void);
+  /** Fills the grid structure with the elements found by CollectElements(). The elements are
+   * collected in parallel and then sorted into their grids with a counting sort. */
+  void FillGrid (void);
+  /** Appends the pairs of grid index and element index for all elements in the range
+   * [\a ulFirst, \a ulLast) to \a raclEntries. Must be implemented in sub-classes and
+   * must not modify the grid because it is called from several threads at once. */
+  virtual void CollectElements (unsigned long ulFirst, unsigned long ulLast, std::vector<GridEntry> &raclEntries) const = 0;
+  /** Returns the index of a grid element in the internal structure. */
+  unsigned long GridIndex (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return (ulX * _ulCtGridsY + ulY) * _ulCtGridsZ + ulZ; }
+  /** Returns the first element index of a given grid. */
+  GridIterator GridBegin (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)]; }
+  /** Returns the end of the element indices of a given grid. */
+  GridIterator GridEnd (unsigned long ulX, unsigned long ulY, unsigned long ulZ) const
+  { return _aulGridElements.begin() + _aulGridOffsets[GridIndex(ulX, ulY, ulZ)+1]; }
   /** Deletes the grid structure. */
   virtual void Clear (void);
   /** Calculates the grid length dependent on maximum number of grids. */
@@ -157,7 +182,8 @@ protected:
   virtual unsigned long HasElements (void) const = 0;
 
 protected:
-  std::vector<std::vector<std::vector<std::set<unsigned long> > > >  _aulGrid;   /**< Grid data structure. */
+  std::vector<unsigned long> _aulGridOffsets;  /**< Start of each grid in _aulGridElements, one more than grids. */
+  std::vector<unsigned long> _aulGridElements; /**< Element indices of all grids. */
   const MeshKernel* _pclMesh;     /**< The mesh kernel. */
   unsigned long     _ulCtElements;/**< Number of grid elements for validation issues. */
   unsigned long     _ulCtGridsX;  /**< Number of grid elements in z. */
@@ -170,6 +196,10 @@ protected:
   float             _fMinY;       /**< Grid null position in y. */ 
   float             _fMinZ;       /**< Grid null position in z. */
 
+private:
+  struct CollectJob;
+  static void CollectJobRun (CollectJob &rclJob);
+
   // friends
   friend class MeshGridIterator;
 };
@@ -227,7 +257,9 @@ protected:
   /** Adds a new facet element to the grid structure. \a rclFacet is the geometric facet and \a ulFacetIndex 
    * the corresponding index in the mesh kernel. The facet is added to each grid element that intersects 
    * the facet. */
-  inline void AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon = 0.0f);
+  inline void AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, std::vector<GridEntry> &raclEntries) const;
+  /** Adds the facets in the range [\a ulFirst, \a ulLast) to the grid entries. */
+  virtual void CollectElements (unsigned long ulFirst, unsigned long ulLast, std::vector<GridEntry> &raclEntries) const;
   /** Returns the number of stored elements. */
   unsigned long HasElements (void) const
   { return _pclMesh->CountFacets(); }
@@ -270,7 +302,9 @@ public:
 protected:
   /** Adds a new point element to the grid structure. \a rclPt is the geometric point and \a ulPtIndex 
    * the corresponding index in the mesh kernel. */
-  void AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, float fEpsilon = 0.0f);
+  void AddPoint (const MeshPoint &rclPt, unsigned long ulPtIndex, std::vector<GridEntry> &raclEntries) const;
+  /** Adds the points in the range [\a ulFirst, \a ulLast) to the grid entries. */
+  virtual void CollectElements (unsigned long ulFirst, unsigned long ulLast, std::vector<GridEntry> &raclEntries) const;
   /** Returns the grid numbers to the given point \a rclPoint. */
   void Pos(const Base::Vector3f &rclPoint, unsigned long &rulX, unsigned long &rulY, unsigned long &rulZ) const;
   /** Returns the number of stored elements. */
@@ -295,7 +329,7 @@ public:
   /** Returns indices of the elements in the current grid. */
   void GetElements (std::vector<unsigned long> &raulElements) const
   {
-    raulElements.insert(raulElements.end(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].begin(), _rclGrid._aulGrid[_ulX][_ulY][_ulZ].end());
+    raulElements.insert(raulElements.end(), _rclGrid.GridBegin(_ulX, _ulY, _ulZ), _rclGrid.GridEnd(_ulX, _ulY, _ulZ));
   }
   /** Returns the number of elements in the current grid. */
   unsigned long GetCtElements() const
@@ -434,38 +468,8 @@ inline void MeshFacetGrid::PosWithCheck (const Base::Vector3f &rclPoint, unsigne
   assert((rulX < _ulCtGridsX) && (rulY < _ulCtGridsY) && (rulZ < _ulCtGridsZ));
 }
 
-inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, float fEpsilon)
+inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned long ulFacetIndex, std::vector<GridEntry> &raclEntries) const
 {
-#if 0
-  unsigned long  i, ulX, ulY, ulZ, ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
-  
-  ulX1 = ulY1 = ulZ1 = ULONG_MAX;
-  ulX2 = ulY2 = ulZ2 = 0;
-
-  for (i = 0; i < 3; i++)
-  {
-    Pos(rclFacet._aclPoints[i], ulX, ulY, ulZ);
-    _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-    ulX1 = RSmin<unsigned long>(ulX1, ulX); ulY1 = RSmin<unsigned long>(ulY1, ulY); ulZ1 = RSmin<unsigned long>(ulZ1, ulZ);
-    ulX2 = RSmax<unsigned long>(ulX2, ulX); ulY2 = RSmax<unsigned long>(ulY2, ulY); ulZ2 = RSmax<unsigned long>(ulZ2, ulZ);
-  }
-  
-  // falls Facet ueber mehrere BB reicht
-  if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
-  {
-    for (ulX = ulX1; ulX <= ulX2; ulX++)
-    {
-      for (ulY = ulY1; ulY <= ulY2; ulY++)
-      {
-        for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
-        {
-          if (CMeshFacetFunc::BBoxContainFacet(GetBoundBox(ulX, ulY, ulZ), rclFacet) == TRUE)
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
-        }
-      }
-    }
-  }
-#else
   unsigned long ulX, ulY, ulZ;
 
   unsigned long ulX1, ulY1, ulZ1, ulX2, ulY2, ulZ2;
@@ -476,22 +480,8 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
   clBB &= rclFacet._aclPoints[1];
   clBB &= rclFacet._aclPoints[2];
 
-  //float fDiagonalLength = clBB.CalcDiagonalLength();
-
-  //clBB.Enlarge(fEpsilon*fDiagonalLength);
-
   Pos(Base::Vector3f(clBB.MinX,clBB.MinY,clBB.MinZ), ulX1, ulY1, ulZ1);
   Pos(Base::Vector3f(clBB.MaxX,clBB.MaxY,clBB.MaxZ), ulX2, ulY2, ulZ2);
-  
-  /*
-  if (ulX1 > 0) ulX1--;
-  if (ulY1 > 0) ulY1--;
-  if (ulZ1 > 0) ulZ1--;
-  
-  if (ulX2 < (_ulCtGridsX-1)) ulX2++;
-  if (ulY2 < (_ulCtGridsY-1)) ulY2++;
-  if (ulZ2 < (_ulCtGridsZ-1)) ulZ2++;
-  */
 
   // falls Facet ueber mehrere BB reicht
   if ((ulX1 < ulX2) || (ulY1 < ulY2) || (ulZ1 < ulZ2))
@@ -503,15 +493,13 @@ inline void MeshFacetGrid::AddFacet (const MeshGeomFacet &rclFacet, unsigned lon
         for (ulZ = ulZ1; ulZ <= ulZ2; ulZ++)
         {
           if ( rclFacet.IntersectBoundingBox( GetBoundBox(ulX, ulY, ulZ) ) )
-            _aulGrid[ulX][ulY][ulZ].insert(ulFacetIndex);
+            raclEntries.push_back(GridEntry(GridIndex(ulX, ulY, ulZ), ulFacetIndex));
         }
       }
     }
   }
   else
-    _aulGrid[ulX1][ulY1][ulZ1].insert(ulFacetIndex);
-
-#endif
+    raclEntries.push_back(GridEntry(GridIndex(ulX1, ulY1, ulZ1), ulFacetIndex));
 }
 
 } // namespace MeshCore
@@ -26,6 +26,10 @@
 
 #include "Elements.h"
 
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
+
 #include <Base/Vector3D.h>
 
 namespace MeshCore {
@@ -198,6 +202,50 @@ inline void MeshEdgeBuilder::Add (unsigned long ulInd1, unsigned long ulInd2,
   push_back(clObj);
 }
 
+/// Minimum number of elements a thread handles in MakeJobs()
+const unsigned long MESH_JOB_MIN_RANGE = 50000;
+
+/**
+ * Splits \a ulCount elements into consecutive ranges of at least MESH_JOB_MIN_RANGE
+ * elements, at most \a ulMaxJobs of them. Each job is a copy of \a clProto with its
+ * members \c first and \c last set to the range. Up to 2*MESH_JOB_MIN_RANGE elements
+ * or without a second core there is only one job.
+ */
+template <class Job>
+std::vector<Job> MakeJobs (unsigned long ulCount, const Job& clProto,
+                           unsigned long ulMaxJobs = 4 * QThread::idealThreadCount())
+{
+  unsigned long ulCtJobs = 1;
+  if (ulCount > 2 * MESH_JOB_MIN_RANGE && QThread::idealThreadCount() > 1)
+    ulCtJobs = std::max<unsigned long>(1, std::min<unsigned long>(ulMaxJobs, ulCount / MESH_JOB_MIN_RANGE));
+
+  std::vector<Job> jobs(ulCtJobs, clProto);
+  for (unsigned long i = 0; i < ulCtJobs; i++)
+  {
+    jobs[i].first = (ulCount * i) / ulCtJobs;
+    jobs[i].last  = (ulCount * (i + 1)) / ulCtJobs;
+  }
+  return jobs;
+}
+
+/**
+ * Calls \a func for all jobs, in the thread pool if there is more than one job.
+ */
+template <class Job>
+void RunJobs (std::vector<Job>& jobs, void (*func)(Job&))
+{
+  if (jobs.size() > 1)
+  {
+    QFuture<void> future = QtConcurrent::map(jobs, func);
+    future.waitForFinished();
+  }
+  else
+  {
+    for (typename std::vector<Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+      func(*it);
+  }
+}
+
 } // namespace MeshCore
 
 #endif // MESH_HELPERS_H 
@@ -28,17 +28,24 @@
 #include "MeshKernel.h"
 #include "MeshIO.h"
 #include "Builder.h"
+#include "NastranReader.h"
 
 #include <Base/Console.h>
 #include <Base/Exception.h>
 #include <Base/Reader.h>
 #include <Base/Writer.h>
 #include <Base/FileInfo.h>
+#include <Base/PlyTypes.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
+#include <Base/Swap.h>
 #include <zipios++/gzipoutputstream.h>
+#include <QFile>
 
 #include <math.h>
+#include <climits>
+#include <cstring>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <boost/regex.hpp>
@@ -299,6 +306,196 @@ Convert_Camera_Model(Vector *pos, Vector *at, Vector *up, Vector *res_axis,
 
 // --------------------------------------------------------------
 
+namespace {
+
+/** Checks whether the memory block contains a binary STL file. The same heuristic as in
+ * MeshInput::LoadSTL() is used.
+ */
+bool isBinarySTL(const char* data, std::size_t size)
+{
+    if (size < 84)
+        return false;
+    uint32_t ulCt;
+    memcpy(&ulCt, data + 80, sizeof(ulCt));
+    if (ulCt > (size - 84) / 50)
+        return false;
+
+    char szBuf[101];
+    std::size_t ulBytes = std::min<std::size_t>(100, size - 84);
+    memcpy(szBuf, data + 84, ulBytes);
+    szBuf[ulBytes] = 0;
+    upper(szBuf);
+    return ((strstr(szBuf, "SOLID") == NULL)  && (strstr(szBuf, "FACET") == NULL)    && (strstr(szBuf, "NORMAL") == NULL) &&
+            (strstr(szBuf, "VERTEX") == NULL) && (strstr(szBuf, "ENDFACET") == NULL) && (strstr(szBuf, "ENDLOOP") == NULL));
+}
+
+/** Checks whether the memory block contains a PLY file in binary format. */
+bool isBinaryPLY(const char* data, std::size_t size)
+{
+    if (size < 4 || strncmp(data, "ply", 3) != 0)
+        return false;
+    const char* end = data + std::min<std::size_t>(size, 1024);
+    const char* fmt = "format binary_";
+    return std::search(data, end, fmt, fmt + strlen(fmt)) != end;
+}
+
+struct PlyProperty {
+    std::string name;
+    Base::PlyType type;      // type of the value or of the list items
+    Base::PlyType countType; // type of the list size, Base::PlyNone for scalar properties
+};
+
+struct PlyElement {
+    std::string name;
+    std::size_t count;
+    std::vector<PlyProperty> properties;
+
+    int find(const char* prop) const {
+        for (std::size_t i = 0; i < properties.size(); i++) {
+            if (properties[i].name == prop)
+                return (int)i;
+        }
+        return -1;
+    }
+};
+
+/** Sequential reader of the binary data of a PLY file. If the end of the data
+ * block is reached the reader is set to the fail state and only returns zeros.
+ */
+class PlyReader
+{
+public:
+    PlyReader(const char* data, const char* end, bool swap)
+      : _pos(data), _end(end), _swap(swap), _fail(false)
+    {
+    }
+    bool fail() const
+    {
+        return _fail;
+    }
+    double read(Base::PlyType type)
+    {
+        std::size_t len = Base::plySize(type);
+        if (_fail || len == 0 || std::size_t(_end - _pos) < len) {
+            _fail = true;
+            return 0.0;
+        }
+        double value = Base::readPly(type, _pos, _swap);
+        _pos += len;
+        return value;
+    }
+    /// reads the size of a list and checks that its items are within the data block
+    std::size_t count(const PlyProperty& prop)
+    {
+        double ct = read(prop.countType);
+        std::size_t len = Base::plySize(prop.type);
+        std::size_t avail = std::size_t(_end - _pos);
+        // the value comes from the file, so check it before converting it
+        if (_fail || len == 0 || !(ct >= 0.0) || ct > double(avail / len) || ct != floor(ct)) {
+            _fail = true;
+            return 0;
+        }
+        return std::size_t(ct);
+    }
+    /// reads an index, negative or fractional values are mapped to ULONG_MAX
+    unsigned long index(Base::PlyType type)
+    {
+        double value = read(type);
+        if (!(value >= 0.0) || value >= double(ULONG_MAX) || value != floor(value))
+            return ULONG_MAX;
+        return (unsigned long)value;
+    }
+    void skip(const PlyProperty& prop)
+    {
+        std::size_t ct = 1;
+        if (prop.countType != Base::PlyNone)
+            ct = count(prop);
+        std::size_t len = ct * Base::plySize(prop.type);
+        if (_fail || std::size_t(_end - _pos) < len)
+            _fail = true;
+        else
+            _pos += len;
+    }
+
+private:
+    const char* _pos;
+    const char* _end;
+    bool _swap;
+    bool _fail;
+};
+
+/** Parses the header of a binary PLY file. Returns the beginning of the data block
+ * or null if the header is invalid.
+ */
+const char* parsePlyHeader(const char* data, std::size_t size, std::vector<PlyElement>& elements, bool& swap)
+{
+    const char* end = data + size;
+    const char* tag = "end_header";
+    const char* pos = std::search(data, end, tag, tag + strlen(tag));
+    if (pos == end)
+        return 0;
+    const char* body = std::find(pos, end, '\n');
+    if (body == end)
+        return 0;
+    body++;
+
+    std::istringstream str(std::string(data, pos));
+    std::string line;
+    bool format = false;
+    while (std::getline(str, line)) {
+        std::istringstream tokens(line);
+        std::string kw;
+        tokens >> kw;
+        if (kw == "format") {
+            std::string format_string, version;
+            tokens >> format_string >> version;
+            if (format_string == "binary_little_endian")
+                swap = !Base::isLittleEndian();
+            else if (format_string == "binary_big_endian")
+                swap = Base::isLittleEndian();
+            else
+                return 0;
+            if (version != "1.0")
+                return 0;
+            format = true;
+        }
+        else if (kw == "element") {
+            PlyElement element;
+            tokens >> element.name >> element.count;
+            if (!tokens)
+                return 0;
+            elements.push_back(element);
+        }
+        else if (kw == "property") {
+            if (elements.empty())
+                return 0;
+            PlyProperty prop;
+            std::string type;
+            tokens >> type;
+            if (type == "list") {
+                std::string countType, itemType;
+                tokens >> countType >> itemType;
+                prop.countType = Base::plyType(countType);
+                prop.type = Base::plyType(itemType);
+                if (prop.countType == Base::PlyNone)
+                    return 0;
+            }
+            else {
+                prop.countType = Base::PlyNone;
+                prop.type = Base::plyType(type);
+            }
+            tokens >> prop.name;
+            if (prop.type == Base::PlyNone)
+                return 0;
+            elements.back().properties.push_back(prop);
+        }
+    }
+
+    return format ? body : 0;
+}
+
+}
+
 bool MeshInput::LoadAny(const char* FileName)
 {
     // ask for read permission
@@ -315,6 +512,26 @@ bool MeshInput::LoadAny(const char* FileName)
         return true;
     }
     else {
+        // Binary STL and PLY files and Nastran decks are parsed directly from the
+        // memory-mapped file. This avoids the overhead of the stream and doesn't
+        // need an extra buffer.
+        if (fi.hasExtension("stl") || fi.hasExtension("ply") ||
+            fi.hasExtension("nas") || fi.hasExtension("bdf")) {
+            QFile file(QString::fromUtf8(FileName));
+            if (file.open(QIODevice::ReadOnly) && file.size() > 0) {
+                std::size_t size = (std::size_t)file.size();
+                const char* data = reinterpret_cast<const char*>(file.map(0, file.size()));
+                if (data) {
+                    if (fi.hasExtension("stl") && isBinarySTL(data, size))
+                        return LoadBinarySTL(data, size);
+                    if (fi.hasExtension("ply") && isBinaryPLY(data, size))
+                        return LoadBinaryPLY(data, size);
+                    if (fi.hasExtension("nas") || fi.hasExtension("bdf"))
+                        return LoadNastran(data, size);
+                }
+            }
+        }
+
         // read file
         bool ok = false;
         if (fi.hasExtension("stl") || fi.hasExtension("ast")) {
@@ -1052,6 +1269,167 @@ bool MeshInput::LoadBinarySTL (std::istream &rstrIn)
     return true;
 }
 
+/** Loads a binary STL file from a memory block. */
+bool MeshInput::LoadBinarySTL (const char* data, std::size_t size)
+{
+    if (size < 84)
+        return false;
+
+    // skip header info and read number of facets
+    uint32_t ulCt;
+    memcpy(&ulCt, data + 80, sizeof(ulCt));
+
+    // compare with the number of facets that fit into the block
+    if (ulCt > (size - 84) / 50)
+        return false; // not a valid STL file
+
+    try {
+        // the records consist of the normal, the points and 2 bytes attribute
+        MeshBuilder builder(this->_rclMesh);
+        builder.Build(data + 84, ulCt, 50);
+    }
+    catch (const Base::AbortException&) {
+        _rclMesh.Clear();
+        return false;
+    }
+    catch (...) {
+        _rclMesh.Clear();
+        throw;
+    }
+
+    return true;
+}
+
+/** Loads a binary PLY file from a memory block. */
+bool MeshInput::LoadBinaryPLY (const char* data, std::size_t size)
+{
+    std::vector<PlyElement> elements;
+    bool swap = false;
+    const char* body = parsePlyHeader(data, size, elements, swap);
+    if (!body)
+        return false;
+
+    MeshPointArray meshPoints;
+    MeshFacetArray meshFacets;
+    std::vector<App::Color> colors;
+    PlyReader reader(body, data + size, swap);
+
+    for (std::vector<PlyElement>::iterator it = elements.begin(); it != elements.end(); ++it) {
+        const std::vector<PlyProperty>& props = it->properties;
+        std::size_t numProps = props.size();
+        if (it->name == "vertex") {
+            int x = it->find("x"), y = it->find("y"), z = it->find("z");
+            int r = it->find("red"), g = it->find("green"), b = it->find("blue");
+            if (x < 0 || y < 0 || z < 0)
+                return false;
+            bool rgb = (r >= 0 && g >= 0 && b >= 0 && _material);
+            float scale = (rgb && props[r].type == Base::PlyUInt8) ? 1.0f/255.0f : 1.0f;
+            // as a vertex has only a few properties keep their values in a small buffer
+            std::vector<double> values(numProps);
+
+            meshPoints.resize(it->count);
+            if (rgb)
+                colors.reserve(it->count);
+            for (std::size_t i = 0; i < it->count; i++) {
+                for (std::size_t j = 0; j < numProps; j++) {
+                    if (props[j].countType != Base::PlyNone)
+                        reader.skip(props[j]);
+                    else
+                        values[j] = reader.read(props[j].type);
+                }
+                if (reader.fail())
+                    return false;
+                meshPoints[i].Set((float)values[x], (float)values[y], (float)values[z]);
+                if (rgb) {
+                    colors.push_back(App::Color((float)values[r]*scale,
+                                                (float)values[g]*scale,
+                                                (float)values[b]*scale));
+                }
+            }
+        }
+        else if (it->name == "face") {
+            int v = it->find("vertex_indices");
+            if (v < 0)
+                v = it->find("vertex_index");
+            if (v < 0 || props[v].countType == Base::PlyNone)
+                return false;
+
+            meshFacets.reserve(it->count);
+            unsigned long ulPoints = meshPoints.size();
+            unsigned long index[3];
+            for (std::size_t i = 0; i < it->count; i++) {
+                for (std::size_t j = 0; j < numProps; j++) {
+                    if ((int)j != v) {
+                        reader.skip(props[j]);
+                        continue;
+                    }
+                    std::size_t n = reader.count(props[j]);
+                    if (n != 3) {
+                        // only triangles are supported
+                        for (std::size_t k = 0; k < n && !reader.fail(); k++)
+                            reader.read(props[j].type);
+                        continue;
+                    }
+                    for (int k = 0; k < 3; k++)
+                        index[k] = reader.index(props[j].type);
+                    if (index[0] < ulPoints && index[1] < ulPoints && index[2] < ulPoints)
+                        meshFacets.push_back(MeshFacet(index[0], index[1], index[2]));
+                }
+                if (reader.fail())
+                    return false;
+            }
+        }
+        else {
+            for (std::size_t i = 0; i < it->count && !reader.fail(); i++) {
+                for (std::size_t j = 0; j < numProps; j++)
+                    reader.skip(props[j]);
+            }
+            if (reader.fail())
+                return false;
+        }
+    }
+
+    // remove the points that are not referenced by any facet
+    std::vector<unsigned long> increments(meshPoints.size(), 0);
+    for (MeshFacetArray::_TConstIterator it = meshFacets.begin(); it != meshFacets.end(); ++it) {
+        for (int i=0; i<3; i++)
+            increments[it->_aulPoints[i]] = 1;
+    }
+    unsigned long countPoints = 0;
+    for (std::vector<unsigned long>::iterator it = increments.begin(); it != increments.end(); ++it) {
+        if (*it > 0) {
+            unsigned long index = it - increments.begin();
+            *it = countPoints;
+            meshPoints[countPoints] = meshPoints[index];
+            if (!colors.empty())
+                colors[countPoints] = colors[index];
+            countPoints++;
+        }
+        else {
+            *it = ULONG_MAX;
+        }
+    }
+    if (countPoints < meshPoints.size()) {
+        meshPoints.resize(countPoints);
+        if (!colors.empty())
+            colors.resize(countPoints);
+        for (MeshFacetArray::_TIterator it = meshFacets.begin(); it != meshFacets.end(); ++it) {
+            for (int i=0; i<3; i++)
+                it->_aulPoints[i] = increments[it->_aulPoints[i]];
+        }
+    }
+
+    // the arrays are swapped into the kernel, so no copy of the data is needed
+    this->_rclMesh.Clear();
+    this->_rclMesh.Adopt(meshPoints, meshFacets, true);
+    if (_material && !colors.empty()) {
+        _material->binding = MeshIO::PER_VERTEX;
+        _material->diffuseColor.swap(colors);
+    }
+
+    return true;
+}
+
 /** Loads the mesh object from an XML file. */
 void MeshInput::LoadXML (Base::XMLReader &reader)
 {
@@ -1240,125 +1618,102 @@ bool MeshInput::LoadInventor (std::istream &rstrIn)
     return (rstrIn?true:false);
 }
 
-/** Loads a Nastran file. */
-bool MeshInput::LoadNastran (std::istream &rstrIn)
+namespace {
+
+/** Builds the mesh from the triangles and quadrangles of a Nastran deck. The
+ * quadrangles are split along their shorter diagonal.
+ * Returns false if the deck has no grid points or no usable elements.
+ */
+bool meshFromNastran(NastranReader& reader, MeshKernel& kernel)
 {
-    if ((!rstrIn) || (rstrIn.bad() == true))
+    if (reader.getNodeIds().empty())
         return false;
+    reader.buildNodeIndex();
+    const std::vector<double>& coords = reader.getNodeCoords();
+    const std::vector<int>& tria = reader.getTriangles();
+    const std::vector<int>& quad = reader.getQuads();
 
-    boost::regex rx_p("\\s*GRID\\s+([0-9]+)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                      "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*");
-    boost::regex rx_t("\\s*CTRIA3\\s+([0-9]+)\\s+([0-9]+)"
-                      "\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*");
-    boost::regex rx_q("\\s*CTRIA3\\s+([0-9]+)\\s+([0-9]+)"
-                      "\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s+([0-9]+)\\s*");
-    boost::cmatch what;
-
-    std::string line;
-    MeshFacet clMeshFacet;
     MeshPointArray vVertices;
-    MeshFacetArray vTriangle;
-
-    int index;
-    std::map <int, NODE> mNode;
-    std::map <int, TRIA> mTria;
-    std::map <int, QUAD> mQuad;
-
-    while (std::getline(rstrIn, line)) {
-        upper(ltrim(line));
-        if (line.find("GRID*") == 0) {
-            assert(0);
-        }
-        else if (line.find("*") == 0) {
-            assert(0);
-        }
-        // insert the read-in vertex into a map to preserve the order
-        else if (line.find("GRID") == 0) {
-            if (boost::regex_match(line.c_str(), what, rx_p)) {
-                index = std::atol(what[1].first)-1;
-                mNode[index].x = (float)std::atof(what[2].first);
-                mNode[index].y = (float)std::atof(what[5].first);
-                mNode[index].z = (float)std::atof(what[8].first);
-            }
-        }
-        // insert the read-in triangle into a map to preserve the order
-        else if (line.find("CTRIA3 ") == 0) {
-            if (boost::regex_match(line.c_str(), what, rx_t)) {
-                index = std::atol(what[1].first)-1;
-                mTria[index].iV[0] = std::atol(what[3].first)-1;
-                mTria[index].iV[1] = std::atol(what[4].first)-1;
-                mTria[index].iV[2] = std::atol(what[5].first)-1;
-            }
-        }
-        // insert the read-in quadrangle into a map to preserve the order
-        else if (line.find("CQUAD4") == 0) {
-            if (boost::regex_match(line.c_str(), what, rx_q)) {
-                index = std::atol(what[1].first)-1;
-                mQuad[index].iV[0] = std::atol(what[3].first)-1;
-                mQuad[index].iV[1] = std::atol(what[4].first)-1;
-                mQuad[index].iV[2] = std::atol(what[5].first)-1;
-                mQuad[index].iV[3] = std::atol(what[6].first)-1;
-            }
-        }
+    vVertices.resize(reader.getNodeIds().size());
+    for (std::size_t i = 0; i < vVertices.size(); i++) {
+        vVertices[i].Set((float)coords[3*i], (float)coords[3*i+1], (float)coords[3*i+2]);
     }
 
-    float fLength[2];
-    if (mTria.empty())
-        index = 0;
-    else
-        index = mTria.rbegin()->first + 1;
-    for (std::map <int, QUAD>::iterator QI=mQuad.begin(); QI!=mQuad.end(); QI++) {
-        for (int i = 0; i < 2; i++) {
-            float fDx = mNode[(*QI).second.iV[i+2]].x - mNode[(*QI).second.iV[i]].x;
-            float fDy = mNode[(*QI).second.iV[i+2]].y - mNode[(*QI).second.iV[i]].y;
-            float fDz = mNode[(*QI).second.iV[i+2]].z - mNode[(*QI).second.iV[i]].z;
-            fLength[i] = fDx*fDx + fDy*fDy + fDz*fDz;
-        }
+    MeshFacetArray vTriangle;
+    vTriangle.reserve(tria.size() / NastranReader::TriangleSize +
+                      2 * quad.size() / NastranReader::QuadSize);
+    MeshFacet clMeshFacet;
+    long iV[4];
+
+    // Negative conversion for right orientation of normal-vectors.
+    for (std::size_t i = 0; i < tria.size(); i += NastranReader::TriangleSize) {
+        for (int j = 0; j < 3; j++)
+            iV[j] = reader.getNodeIndex(tria[i+1+j]);
+        if (iV[0] < 0 || iV[1] < 0 || iV[2] < 0)
+            continue;
+        clMeshFacet._aulPoints[0] = iV[1];
+        clMeshFacet._aulPoints[1] = iV[0];
+        clMeshFacet._aulPoints[2] = iV[2];
+        vTriangle.push_back(clMeshFacet);
+    }
+
+    for (std::size_t i = 0; i < quad.size(); i += NastranReader::QuadSize) {
+        for (int j = 0; j < 4; j++)
+            iV[j] = reader.getNodeIndex(quad[i+1+j]);
+        if (iV[0] < 0 || iV[1] < 0 || iV[2] < 0 || iV[3] < 0)
+            continue;
+        float fLength[2];
+        for (int j = 0; j < 2; j++)
+            fLength[j] = Base::DistanceP2(vVertices[iV[j+2]], vVertices[iV[j]]);
         if (fLength[0] < fLength[1]) {
-            mTria[index].iV[0] = (*QI).second.iV[0];
-            mTria[index].iV[1] = (*QI).second.iV[1];
-            mTria[index].iV[2] = (*QI).second.iV[2];
-
-            mTria[index+1].iV[0] = (*QI).second.iV[0];
-            mTria[index+1].iV[1] = (*QI).second.iV[2];
-            mTria[index+1].iV[2] = (*QI).second.iV[3];
+            clMeshFacet._aulPoints[0] = iV[1];
+            clMeshFacet._aulPoints[1] = iV[0];
+            clMeshFacet._aulPoints[2] = iV[2];
+            vTriangle.push_back(clMeshFacet);
+            clMeshFacet._aulPoints[0] = iV[2];
+            clMeshFacet._aulPoints[1] = iV[0];
+            clMeshFacet._aulPoints[2] = iV[3];
+            vTriangle.push_back(clMeshFacet);
         }
         else {
-            mTria[index].iV[0] = (*QI).second.iV[0];
-            mTria[index].iV[1] = (*QI).second.iV[1];
-            mTria[index].iV[2] = (*QI).second.iV[3];
-
-            mTria[index+1].iV[0] = (*QI).second.iV[1];
-            mTria[index+1].iV[1] = (*QI).second.iV[2];
-            mTria[index+1].iV[2] = (*QI).second.iV[3];
+            clMeshFacet._aulPoints[0] = iV[1];
+            clMeshFacet._aulPoints[1] = iV[0];
+            clMeshFacet._aulPoints[2] = iV[3];
+            vTriangle.push_back(clMeshFacet);
+            clMeshFacet._aulPoints[0] = iV[2];
+            clMeshFacet._aulPoints[1] = iV[1];
+            clMeshFacet._aulPoints[2] = iV[3];
+            vTriangle.push_back(clMeshFacet);
         }
-
-        index += 2;
     }
 
-    // Applying the nodes
-    vVertices.reserve(mNode.size());
-    for (std::map<int, NODE>::iterator MI=mNode.begin(); MI!=mNode.end(); MI++) {
-        vVertices.push_back(Base::Vector3f(MI->second.x, MI->second.y, MI->second.z));
-    }
-
-    // Converting data to Mesh. Negative conversion for right orientation of normal-vectors.
-    vTriangle.reserve(mTria.size());
-    for (std::map<int, TRIA>::iterator MI=mTria.begin(); MI!=mTria.end(); MI++) {
-        clMeshFacet._aulPoints[0] = (*MI).second.iV[1];
-        clMeshFacet._aulPoints[1] = (*MI).second.iV[0];
-        clMeshFacet._aulPoints[2] = (*MI).second.iV[2];
-        vTriangle.push_back (clMeshFacet);
-    }
+    if (vTriangle.empty())
+        return false;
 
     // make sure to add only vertices which are referenced by the triangles
-    _rclMesh.Merge(vVertices, vTriangle);
-
+    kernel.Merge(vVertices, vTriangle);
     return true;
 }
 
+}
+
+/** Loads a Nastran file. */
+bool MeshInput::LoadNastran (std::istream &rstrIn)
+{
+    NastranReader reader;
+    if (!reader.read(rstrIn))
+        return false;
+    return meshFromNastran(reader, _rclMesh);
+}
+
+/** Loads a Nastran file from a memory block. */
+bool MeshInput::LoadNastran (const char* data, std::size_t size)
+{
+    NastranReader reader;
+    reader.parse(data, size);
+    return meshFromNastran(reader, _rclMesh);
+}
+
 /** Loads a Cadmould FE file. */
 bool MeshInput::LoadCadmouldFE (std::ifstream &rstrIn)
 {
@@ -91,12 +91,20 @@ public:
     bool LoadAsciiSTL (std::istream &rstrIn);
     /** Loads a binary STL file. */
     bool LoadBinarySTL (std::istream &rstrIn);
+    /** Loads a binary STL file from the memory block \a data of \a size bytes,
+     * e.g. a memory-mapped file.
+     */
+    bool LoadBinarySTL (const char* data, std::size_t size);
     /** Loads an OBJ Mesh file. */
     bool LoadOBJ (std::istream &rstrIn);
     /** Loads an OFF Mesh file. */
     bool LoadOFF (std::istream &rstrIn);
     /** Loads a PLY Mesh file. */
     bool LoadPLY (std::istream &rstrIn);
+    /** Loads a PLY Mesh file in binary format from the memory block \a data of \a size
+     * bytes, e.g. a memory-mapped file.
+     */
+    bool LoadBinaryPLY (const char* data, std::size_t size);
     /** Loads the mesh object from an XML file. */
     void LoadXML (Base::XMLReader &reader);
     /** Loads a node from an OpenInventor file. */
@@ -105,6 +113,8 @@ public:
     bool LoadInventor (std::istream &rstrIn);
     /** Loads a Nastran file. */
     bool LoadNastran (std::istream &rstrIn);
+    /** Loads a Nastran file from the memory block \a data of \a size bytes. */
+    bool LoadNastran (const char* data, std::size_t size);
     /** Loads a Cadmould FE file. */
     bool LoadCadmouldFE (std::ifstream &rstrIn);
 
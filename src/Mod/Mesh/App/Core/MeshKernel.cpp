@@ -46,6 +46,116 @@
 
 using namespace MeshCore;
 
+namespace MeshCore {
+namespace KernelHelpers {
+
+/// A range of points or facets to handle in one thread
+struct Job
+{
+    Job() : points(0), cpoints(0), facets(0), matrix(0), pt2fa(0),
+            facetNormals(0), normals(0),
+            minX(FLOAT_MAX), minY(FLOAT_MAX), minZ(FLOAT_MAX),
+            maxX(-FLOAT_MAX), maxY(-FLOAT_MAX), maxZ(-FLOAT_MAX),
+            surface(0.0), first(0), last(0)
+    { }
+
+    MeshPoint* points;
+    const MeshPoint* cpoints;
+    const MeshFacet* facets;
+    const Base::Matrix4D* matrix;
+    const MeshRefPointToFacets* pt2fa;
+    Base::Vector3f* facetNormals;
+    Base::Vector3f* normals;
+    float minX, minY, minZ, maxX, maxY, maxZ;
+    double surface;
+    unsigned long first, last;
+};
+
+void BoundPoints (Job& job)
+{
+    const MeshPoint* pts = job.cpoints;
+    float minX = FLOAT_MAX, minY = FLOAT_MAX, minZ = FLOAT_MAX;
+    float maxX = -FLOAT_MAX, maxY = -FLOAT_MAX, maxZ = -FLOAT_MAX;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        const MeshPoint& p = pts[i];
+        minX = std::min<float>(minX, p.x); maxX = std::max<float>(maxX, p.x);
+        minY = std::min<float>(minY, p.y); maxY = std::max<float>(maxY, p.y);
+        minZ = std::min<float>(minZ, p.z); maxZ = std::max<float>(maxZ, p.z);
+    }
+    job.minX = minX; job.minY = minY; job.minZ = minZ;
+    job.maxX = maxX; job.maxY = maxY; job.maxZ = maxZ;
+}
+
+void TransformPoints (Job& job)
+{
+    // same arithmetic as Base::Matrix4D::operator*(const Vector3f&) with the
+    // coefficients held in locals so that the loop can be vectorized
+    const Base::Matrix4D& m = *job.matrix;
+    const double m00 = m[0][0], m01 = m[0][1], m02 = m[0][2], m03 = m[0][3];
+    const double m10 = m[1][0], m11 = m[1][1], m12 = m[1][2], m13 = m[1][3];
+    const double m20 = m[2][0], m21 = m[2][1], m22 = m[2][2], m23 = m[2][3];
+    MeshPoint* pts = job.points;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        double x = pts[i].x, y = pts[i].y, z = pts[i].z;
+        pts[i].x = (float)(m00 * x + m01 * y + m02 * z + m03);
+        pts[i].y = (float)(m10 * x + m11 * y + m12 * z + m13);
+        pts[i].z = (float)(m20 * x + m21 * y + m22 * z + m23);
+    }
+    BoundPoints(job);
+}
+
+void CalcFacetNormals (Job& job)
+{
+    const MeshPoint* pts = job.cpoints;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        const unsigned long* pulPt = job.facets[i]._aulPoints;
+        const MeshPoint& p1 = pts[pulPt[0]];
+        job.facetNormals[i] = (pts[pulPt[1]] - p1) % (pts[pulPt[2]] - p1);
+    }
+}
+
+void GatherFacetNormals (Job& job)
+{
+    // the facets of a point are sorted, so they are added in the same order as
+    // a single thread would do it and the sums don't depend on the number of threads
+    const Base::Vector3f* facetNormals = job.facetNormals;
+    Base::Vector3f* normals = job.normals;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        MeshIndexRange faces = job.pt2fa->GetRange(i);
+        for (MeshIndexRange::const_iterator it = faces.begin(); it != faces.end(); ++it)
+            normals[i] += facetNormals[*it];
+    }
+}
+
+void SumAreas (Job& job)
+{
+    const MeshPoint* pts = job.cpoints;
+    double surface = 0.0;
+    for (unsigned long i = job.first; i < job.last; i++) {
+        const unsigned long* pulPt = job.facets[i]._aulPoints;
+        const MeshPoint& p1 = pts[pulPt[0]];
+        surface += ((pts[pulPt[1]] - p1) % (pts[pulPt[2]] - p1)).Length() / 2.0f;
+    }
+    job.surface = surface;
+}
+
+/// Merges the boxes of all jobs
+Base::BoundBox3f BoundBoxOf (const std::vector<Job>& jobs)
+{
+    Base::BoundBox3f clBox;
+    clBox.Flush();
+    for (std::vector<Job>::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
+        if (it->first < it->last) {
+            clBox &= Base::Vector3f(it->minX, it->minY, it->minZ);
+            clBox &= Base::Vector3f(it->maxX, it->maxY, it->maxZ);
+        }
+    }
+    return clBox;
+}
+
+} // namespace KernelHelpers
+} // namespace MeshCore
+
 MeshKernel::MeshKernel (void)
 : _bValid(true)
 {
@@ -71,12 +181,7 @@ MeshKernel& MeshKernel::operator = (const MeshKernel &rclMesh)
 MeshKernel& MeshKernel::operator = (const std::vector<MeshGeomFacet> &rclFAry)
 {
     MeshBuilder builder(*this);
-    builder.Initialize(rclFAry.size());
-
-    for (std::vector<MeshGeomFacet>::const_iterator it = rclFAry.begin(); it != rclFAry.end(); it++)
-        builder.AddFacet(*it);
-
-    builder.Finish();
+    builder.Build(rclFAry);
 
     return *this;
 }
@@ -889,15 +994,13 @@ void MeshKernel::operator *= (const Base::Matrix4D &rclMat)
 
 void MeshKernel::Transform (const Base::Matrix4D &rclMat)
 {
-    MeshPointArray::_TIterator  clPIter = _aclPointArray.begin(), clPEIter = _aclPointArray.end();
-    Base::Matrix4D clMatrix(rclMat);
-
-    _clBoundBox.Flush();
-    while (clPIter < clPEIter) {
-        *clPIter *= clMatrix;
-        _clBoundBox &= *clPIter;
-        clPIter++;
-    }
+    KernelHelpers::Job proto;
+    proto.points = _aclPointArray.empty() ? 0 : &_aclPointArray[0];
+    proto.cpoints = proto.points;
+    proto.matrix = &rclMat;
+    std::vector<KernelHelpers::Job> jobs = MakeJobs(CountPoints(), proto);
+    RunJobs(jobs, KernelHelpers::TransformPoints);
+    _clBoundBox = KernelHelpers::BoundBoxOf(jobs);
 }
 
 void MeshKernel::Smooth(int iterations, float stepsize)
@@ -907,40 +1010,69 @@ void MeshKernel::Smooth(int iterations, float stepsize)
 
 void MeshKernel::RecalcBoundBox (void)
 {
-    _clBoundBox.Flush();
-    for (MeshPointArray::_TConstIterator pI = _aclPointArray.begin(); pI != _aclPointArray.end(); pI++)
-        _clBoundBox &= *pI;
+    KernelHelpers::Job proto;
+    proto.cpoints = _aclPointArray.empty() ? 0 : &_aclPointArray[0];
+    std::vector<KernelHelpers::Job> jobs = MakeJobs(CountPoints(), proto);
+    RunJobs(jobs, KernelHelpers::BoundPoints);
+    _clBoundBox = KernelHelpers::BoundBoxOf(jobs);
 }
 
 std::vector<Base::Vector3f> MeshKernel::CalcVertexNormals() const
 {
     std::vector<Base::Vector3f> normals;
+    if (_aclFacetArray.empty()) {
+        normals.resize(CountPoints());
+        return normals;
+    }
 
     normals.resize(CountPoints());
-
-    unsigned long p1,p2,p3;
-    unsigned int ct = CountFacets();
-    for (unsigned int pFIter = 0;pFIter < ct; pFIter++) {
-        GetFacetPoints(pFIter,p1,p2,p3);
-        Base::Vector3f Norm = (GetPoint(p2)-GetPoint(p1)) % (GetPoint(p3)-GetPoint(p1));
-
-        normals[p1] += Norm;
-        normals[p2] += Norm;
-        normals[p3] += Norm;
+    KernelHelpers::Job proto;
+    std::vector<KernelHelpers::Job> pointJobs = MakeJobs(CountPoints(), proto);
+    if (pointJobs.size() == 1) {
+        const MeshPointArray& rPoints = _aclPointArray;
+        for (MeshFacetArray::_TConstIterator pF = _aclFacetArray.begin(); pF != _aclFacetArray.end(); ++pF) {
+            const unsigned long* pulPt = pF->_aulPoints;
+            Base::Vector3f Norm = (rPoints[pulPt[1]] - rPoints[pulPt[0]]) % (rPoints[pulPt[2]] - rPoints[pulPt[0]]);
+            normals[pulPt[0]] += Norm;
+            normals[pulPt[1]] += Norm;
+            normals[pulPt[2]] += Norm;
+        }
+        return normals;
     }
 
+    // the facet normals are computed once, then each point gathers the normals of its facets
+    std::vector<Base::Vector3f> facetNormals(CountFacets());
+    MeshRefPointToFacets pt2fa(*this);
+    proto.cpoints = &_aclPointArray[0];
+    proto.facets = &_aclFacetArray[0];
+    proto.pt2fa = &pt2fa;
+    proto.facetNormals = &facetNormals[0];
+    proto.normals = &normals[0];
+    std::vector<KernelHelpers::Job> jobs = MakeJobs(CountFacets(), proto);
+    RunJobs(jobs, KernelHelpers::CalcFacetNormals);
+
+    pointJobs = MakeJobs(CountPoints(), proto);
+    RunJobs(pointJobs, KernelHelpers::GatherFacetNormals);
     return normals;
 }
 
 // Evaluation
 float MeshKernel::GetSurface() const
 {
-    float fSurface = 0.0;
-    MeshFacetIterator cIter(*this);
-    for (cIter.Init(); cIter.More(); cIter.Next())
-        fSurface += cIter->Area();
-
-    return fSurface;
+    if (_aclFacetArray.empty())
+        return 0.0f;
+
+    // the partial sums are added in a fixed order, so the result doesn't depend on the scheduling
+    KernelHelpers::Job proto;
+    proto.cpoints = &_aclPointArray[0];
+    proto.facets = &_aclFacetArray[0];
+    std::vector<KernelHelpers::Job> jobs = MakeJobs(CountFacets(), proto);
+    RunJobs(jobs, KernelHelpers::SumAreas);
+
+    double fSurface = 0.0;
+    for (std::vector<KernelHelpers::Job>::iterator it = jobs.begin(); it != jobs.end(); ++it)
+        fSurface += it->surface;
+    return (float)fSurface;
 }
 
 float MeshKernel::GetSurface( const std::vector<unsigned long>& aSegment ) const
@@ -0,0 +1,398 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cstdlib>
+# include <cstring>
+# include <istream>
+#endif
+
+#include <QFile>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "NastranReader.h"
+
+using namespace MeshCore;
+
+namespace MeshCore {
+
+/// A part of the deck that starts with a card, parsed by one job
+struct NastranReader::Chunk
+{
+    const char* begin;
+    const char* end;
+    std::vector<int> nodeIds;
+    std::vector<double> nodeCoords;
+    std::vector<int> triangles;
+    std::vector<int> quads;
+    std::vector<int> tetras;
+};
+
+}
+
+namespace {
+
+// A field of a card, the characters [begin, end)
+struct Field
+{
+    const char* begin;
+    const char* end;
+};
+
+inline const char* lineEnd(const char* pos, const char* end)
+{
+    const char* nl = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    return nl ? nl : end;
+}
+
+inline bool isLetter(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+// A card starts with its name within the first eight columns, a continuation
+// line starts with '+' or '*' or a blank first field.
+bool isCardStart(const char* line, const char* end)
+{
+    for (int i = 0; i < 8 && line + i < end; i++) {
+        if (line[i] == ' ' || line[i] == '\t')
+            continue;
+        return isLetter(line[i]);
+    }
+    return false;
+}
+
+// Splits a line into its fields after the first one, which is either the name
+// of the card or the continuation mark. A line holds eight fields (four in large
+// field format), missing fields at the end of a short line are left empty so that
+// the fields of a continuation line keep their position.
+void splitLine(const char* line, const char* end, bool large, std::vector<Field>& fields)
+{
+    int count = large ? 4 : 8;
+    std::size_t last = fields.size() + count;
+    const char* comma = static_cast<const char*>(memchr(line, ',', end - line));
+    if (comma) {
+        // free field format
+        const char* pos = comma + 1;
+        while (fields.size() < last) {
+            comma = static_cast<const char*>(memchr(pos, ',', end - pos));
+            Field f = {pos, comma ? comma : end};
+            fields.push_back(f);
+            if (!comma)
+                break;
+            pos = comma + 1;
+        }
+    }
+    else {
+        // fixed format with fields of 8 or 16 columns after the first 8 columns
+        int width = large ? 16 : 8;
+        const char* pos = line + 8;
+        while (fields.size() < last && pos < end) {
+            Field f = {pos, std::min(pos + width, end)};
+            fields.push_back(f);
+            pos += width;
+        }
+    }
+
+    Field empty = {end, end};
+    fields.resize(last, empty);
+}
+
+int toInt(const Field& f)
+{
+    const char* pos = f.begin;
+    while (pos < f.end && (*pos == ' ' || *pos == '\t'))
+        pos++;
+    bool neg = false;
+    if (pos < f.end && (*pos == '-' || *pos == '+')) {
+        neg = (*pos == '-');
+        pos++;
+    }
+    int value = 0;
+    while (pos < f.end && *pos >= '0' && *pos <= '9')
+        value = 10 * value + (*pos++ - '0');
+    return neg ? -value : value;
+}
+
+// Besides the usual formats Nastran allows to omit the 'E' of the exponent
+// (e.g. 1.5-3) and uses 'D' for double precision.
+double toReal(const Field& f)
+{
+    char buf[64];
+    int len = 0;
+    for (const char* pos = f.begin; pos < f.end && len < 60; pos++) {
+        char c = *pos;
+        if (c == ' ' || c == '\t' || c == '\r')
+            continue;
+        if (c == 'D' || c == 'd')
+            c = 'E';
+        if ((c == '-' || c == '+') && len > 0 && buf[len-1] != 'E' && buf[len-1] != 'e')
+            buf[len++] = 'E';
+        buf[len++] = c;
+    }
+    buf[len] = '\0';
+    return strtod(buf, 0);
+}
+
+void addElement(std::vector<int>& elements, const std::vector<Field>& fields, int numNodes, int size)
+{
+    // EID, PID, G1, G2, ...
+    std::size_t pos = elements.size();
+    elements.resize(pos + size, 0);
+    elements[pos] = toInt(fields[0]);
+    for (int i = 0; i < numNodes; i++)
+        elements[pos + 1 + i] = toInt(fields[2 + i]);
+}
+
+void parseCard(NastranReader::Chunk& chunk, const char* name, std::size_t nameLen,
+               const std::vector<Field>& fields)
+{
+    if (nameLen == 4 && strncmp(name, "GRID", 4) == 0) {
+        // ID, CP, X1, X2, X3
+        if (fields.size() < 5)
+            return;
+        chunk.nodeIds.push_back(toInt(fields[0]));
+        chunk.nodeCoords.push_back(toReal(fields[2]));
+        chunk.nodeCoords.push_back(toReal(fields[3]));
+        chunk.nodeCoords.push_back(toReal(fields[4]));
+    }
+    else if (nameLen == 6 && strncmp(name, "CTRIA3", 6) == 0) {
+        if (fields.size() >= 5)
+            addElement(chunk.triangles, fields, 3, NastranReader::TriangleSize);
+    }
+    else if (nameLen == 6 && strncmp(name, "CQUAD4", 6) == 0) {
+        if (fields.size() >= 6)
+            addElement(chunk.quads, fields, 4, NastranReader::QuadSize);
+    }
+    else if (nameLen == 6 && strncmp(name, "CTETRA", 6) == 0) {
+        // the grid points 5 to 10 of a quadratic tetrahedron are optional
+        if (fields.size() >= 6) {
+            int numNodes = std::min<int>(10, (int)fields.size() - 2);
+            addElement(chunk.tetras, fields, numNodes, NastranReader::TetraSize);
+        }
+    }
+}
+
+void parseChunk(NastranReader::Chunk& chunk)
+{
+    char name[9];
+    std::size_t nameLen = 0;
+    bool large = false;
+    std::vector<Field> fields;
+
+    const char* pos = chunk.begin;
+    while (pos < chunk.end) {
+        const char* end = lineEnd(pos, chunk.end);
+        const char* next = end < chunk.end ? end + 1 : end;
+        if (end > pos && end[-1] == '\r')
+            end--;
+        if (pos == end || *pos == '$') {
+            pos = next;
+            continue;
+        }
+
+        if (isCardStart(pos, end)) {
+            if (nameLen > 0)
+                parseCard(chunk, name, nameLen, fields);
+            fields.clear();
+            // the name ends at a blank, a comma or after eight columns
+            nameLen = 0;
+            large = false;
+            const char* c = pos;
+            while (c < end && (*c == ' ' || *c == '\t'))
+                c++;
+            while (c < end && c < pos + 8 && *c != ' ' && *c != ',' && nameLen < 8) {
+                char ch = *c++;
+                if (ch >= 'a' && ch <= 'z')
+                    ch -= 'a' - 'A';
+                name[nameLen++] = ch;
+            }
+            if (nameLen > 0 && name[nameLen-1] == '*') {
+                large = true;
+                nameLen--;
+            }
+        }
+        if (nameLen > 0)
+            splitLine(pos, end, large, fields);
+        pos = next;
+    }
+
+    if (nameLen > 0)
+        parseCard(chunk, name, nameLen, fields);
+}
+
+template <class T>
+void append(std::vector<T>& to, const std::vector<T>& from)
+{
+    to.insert(to.end(), from.begin(), from.end());
+}
+
+}
+
+NastranReader::NastranReader() : minId(0)
+{
+}
+
+NastranReader::~NastranReader()
+{
+}
+
+bool NastranReader::read(const char* fileName)
+{
+    QFile file(QString::fromUtf8(fileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    if (file.size() == 0) {
+        parse(0, 0);
+        return true;
+    }
+    const char* data = reinterpret_cast<const char*>(file.map(0, file.size()));
+    if (data) {
+        parse(data, (std::size_t)file.size());
+        return true;
+    }
+
+    // the file cannot be mapped (e.g. lack of address space), read it at once
+    QByteArray content = file.readAll();
+    parse(content.constData(), (std::size_t)content.size());
+    return true;
+}
+
+bool NastranReader::read(std::istream& str)
+{
+    if (!str || str.bad())
+        return false;
+    std::vector<char> content;
+    std::streambuf* buf = str.rdbuf();
+    std::streamoff cur = buf->pubseekoff(0, std::ios::cur, std::ios::in);
+    std::streamoff end = buf->pubseekoff(0, std::ios::end, std::ios::in);
+    if (cur >= 0 && end >= cur) {
+        buf->pubseekoff(cur, std::ios::beg, std::ios::in);
+        content.resize((std::size_t)(end - cur));
+        if (!content.empty())
+            str.read(&content[0], (std::streamsize)content.size());
+        content.resize((std::size_t)str.gcount());
+    }
+    else {
+        // not seekable
+        char block[65536];
+        while (str.read(block, sizeof(block)) || str.gcount() > 0)
+            content.insert(content.end(), block, block + str.gcount());
+    }
+    parse(content.empty() ? 0 : &content[0], content.size());
+    return true;
+}
+
+void NastranReader::parse(const char* data, std::size_t size)
+{
+    nodeIds.clear();
+    nodeCoords.clear();
+    triangles.clear();
+    quads.clear();
+    tetras.clear();
+    indexTable.clear();
+    sortedIds.clear();
+
+    // split the deck into parts of about 4 MB which begin with a card
+    const std::size_t chunkSize = 4 * 1024 * 1024;
+    const char* end = data + size;
+    std::vector<Chunk> chunks;
+    const char* pos = data;
+    while (pos < end) {
+        Chunk chunk;
+        chunk.begin = pos;
+        const char* split = (std::size_t)(end - pos) > chunkSize ? pos + chunkSize : end;
+        while (split < end) {
+            split = lineEnd(split, end);
+            if (split < end)
+                split++;
+            if (split < end && isCardStart(split, lineEnd(split, end)))
+                break;
+        }
+        chunk.end = split;
+        chunks.push_back(chunk);
+        pos = split;
+    }
+
+    if (chunks.size() > 1 && QThread::idealThreadCount() > 1) {
+        QFuture<void> future = QtConcurrent::map(chunks, parseChunk);
+        future.waitForFinished();
+    }
+    else {
+        for (std::vector<Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+            parseChunk(*it);
+    }
+
+    for (std::vector<Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        append(nodeIds, it->nodeIds);
+        append(nodeCoords, it->nodeCoords);
+        append(triangles, it->triangles);
+        append(quads, it->quads);
+        append(tetras, it->tetras);
+    }
+}
+
+void NastranReader::buildNodeIndex()
+{
+    indexTable.clear();
+    sortedIds.clear();
+    if (nodeIds.empty())
+        return;
+
+    int maxId = *std::max_element(nodeIds.begin(), nodeIds.end());
+    minId = *std::min_element(nodeIds.begin(), nodeIds.end());
+    double range = (double)maxId - (double)minId + 1.0;
+    if (range <= 4.0 * nodeIds.size() + 1024.0) {
+        // the ids are dense enough for a lookup table
+        indexTable.resize((std::size_t)range, -1);
+        for (std::size_t i = 0; i < nodeIds.size(); i++)
+            indexTable[nodeIds[i] - minId] = (long)i;
+    }
+    else {
+        sortedIds.reserve(nodeIds.size());
+        for (std::size_t i = 0; i < nodeIds.size(); i++)
+            sortedIds.push_back(std::make_pair(nodeIds[i], (long)i));
+        std::sort(sortedIds.begin(), sortedIds.end());
+    }
+}
+
+long NastranReader::getNodeIndex(int id) const
+{
+    if (!indexTable.empty()) {
+        if (id < minId || (std::size_t)(id - minId) >= indexTable.size())
+            return -1;
+        return indexTable[id - minId];
+    }
+
+    std::vector<std::pair<int, long> >::const_iterator it = std::lower_bound
+        (sortedIds.begin(), sortedIds.end(), std::make_pair(id, LONG_MIN));
+    if (it == sortedIds.end() || it->first != id)
+        return -1;
+    return it->second;
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MESH_NASTRANREADER_H
+#define MESH_NASTRANREADER_H
+
+#include <iosfwd>
+#include <utility>
+#include <vector>
+
+namespace MeshCore
+{
+
+/**
+ * Parser for the bulk data of Nastran decks. It handles the GRID, CTRIA3, CQUAD4
+ * and CTETRA cards in small field, large field (e.g. GRID*) and free field format,
+ * including continuation lines. All other cards are skipped.
+ * Large decks are split at card boundaries and the parts are parsed in parallel,
+ * the result keeps the order of the file.
+ * The elements are stored as consecutive integers: the element id followed by the
+ * ids of its grid points.
+ * \code
+ * NastranReader reader;
+ * if (reader.read(fileName)) {
+ *   reader.buildNodeIndex();
+ *   const std::vector<int>& tria = reader.getTriangles();
+ *   for (std::size_t i = 0; i < tria.size(); i += NastranReader::TriangleSize)
+ *     ... reader.getNodeIndex(tria[i+1]) ...
+ * }
+ * \endcode
+ */
+class MeshExport NastranReader
+{
+public:
+    /// Number of integers per element
+    enum {
+        TriangleSize = 4,
+        QuadSize = 5,
+        TetraSize = 11 ///< the grid points 5 to 10 are 0 for linear tetrahedra
+    };
+
+    NastranReader();
+    ~NastranReader();
+
+    /// Reads the file, it is memory-mapped if possible
+    bool read(const char* fileName);
+    /// Reads the whole stream
+    bool read(std::istream& str);
+    /// Parses the deck in the memory block \a data of \a size bytes
+    void parse(const char* data, std::size_t size);
+
+    /// The ids of the grid points in the order of the file
+    const std::vector<int>& getNodeIds() const
+    { return nodeIds; }
+    /// The coordinates of the grid points, three per point
+    const std::vector<double>& getNodeCoords() const
+    { return nodeCoords; }
+    const std::vector<int>& getTriangles() const
+    { return triangles; }
+    const std::vector<int>& getQuads() const
+    { return quads; }
+    const std::vector<int>& getTetras() const
+    { return tetras; }
+
+    /// Prepares getNodeIndex()
+    void buildNodeIndex();
+    /// Returns the position of the grid point \a id in getNodeIds() or -1
+    long getNodeIndex(int id) const;
+
+    struct Chunk;
+
+private:
+    std::vector<int> nodeIds;
+    std::vector<double> nodeCoords;
+    std::vector<int> triangles;
+    std::vector<int> quads;
+    std::vector<int> tetras;
+
+    // either a table indexed by id - minId or the (id, index) pairs sorted by id
+    int minId;
+    std::vector<long> indexTable;
+    std::vector<std::pair<int, long> > sortedIds;
+};
+
+} // namespace MeshCore
+
+#endif // MESH_NASTRANREADER_H
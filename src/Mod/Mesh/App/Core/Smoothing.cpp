@@ -74,11 +74,11 @@ void MeshSmoothing::Smooth(unsigned int iterations)
             MeshCore::PlaneFit pf;
             pf.AddPoint(*v_it);
             center = *v_it;
-            const std::set<unsigned long>& cv = vv_it[v_it.Position()];
+            MeshIndexRange cv = vv_it.GetRange(v_it.Position());
             if (cv.size() < 3)
                 continue;
 
-            std::set<unsigned long>::const_iterator cv_it;
+            MeshIndexRange::const_iterator cv_it;
             for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
                 pf.AddPoint(v_beg[*cv_it]);
                 center += v_beg[*cv_it];
@@ -130,10 +130,10 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
 
     unsigned long pos = 0;
     for (v_it = points.begin(); v_it != v_end; ++v_it,++pos) {
-        const std::set<unsigned long>& cv = vv_it[pos];
+        MeshIndexRange cv = vv_it.GetRange(pos);
         if (cv.size() < 3)
             continue;
-        if (cv.size() != vf_it[pos].size()) {
+        if (cv.size() != vf_it.CountIndices(pos)) {
             // do nothing for border points
             continue;
         }
@@ -143,7 +143,7 @@ void LaplaceSmoothing::Umbrella(const MeshRefPointToPoints& vv_it,
         w=1.0/double(n_count);
 
         double delx=0.0,dely=0.0,delz=0.0;
-        std::set<unsigned long>::const_iterator cv_it;
+        MeshIndexRange::const_iterator cv_it;
         for (cv_it = cv.begin(); cv_it !=cv.end(); ++cv_it) {
             delx += w*((v_beg[*cv_it]).x-v_it->x);
             dely += w*((v_beg[*cv_it]).y-v_it->y);
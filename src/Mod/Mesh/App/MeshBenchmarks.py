@@ -0,0 +1,91 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, os, tempfile, Mesh, BenchmarkApp
+from MeshTestsApp import meshTriangles
+
+
+def peakMemory():
+    # peak resident set size in kB, Linux only
+    try:
+        for line in open("/proc/self/status"):
+            if line.startswith("VmHWM:"):
+                return int(line.split()[1])
+    except IOError:
+        pass
+    return 0
+
+def readMesh(name):
+    mesh = Mesh.Mesh()
+    mesh.read(name)
+    return mesh
+
+def benchBuilder():
+    # compares the bulk mode of the builder with adding the facets one by one
+    name = os.path.join(tempfile.gettempdir(), "MeshBenchmark.ast")
+    for s in [500, 1000, 2000]:
+        mesh = Mesh.createSphere(10.0, s)
+        triangles = meshTriangles(mesh)
+        FreeCAD.Console.PrintMessage("%d facets\n" % mesh.CountFacets)
+        bulk = BenchmarkApp.measure("bulk builder", Mesh.Mesh, triangles)
+        mesh.write(name)
+        single = BenchmarkApp.measure("single facets (incl. parsing)", readMesh, name)
+        if bulk.CountPoints != single.CountPoints:
+            FreeCAD.Console.PrintError("different number of points: %d, %d\n"
+                                       % (bulk.CountPoints, single.CountPoints))
+    os.remove(name)
+
+def benchGrid():
+    # building the facet grid of large meshes and querying it
+    planes = [(FreeCAD.Vector(0,0,-9.9 + 0.198 * i), FreeCAD.Vector(0,0,1)) for i in range(100)]
+    for s in [500, 1000, 2250]:
+        mesh = Mesh.createSphere(10.0, s)
+        FreeCAD.Console.PrintMessage("%d facets\n" % mesh.CountFacets)
+        memory = peakMemory()
+        BenchmarkApp.measure("grid and 1 section", mesh.crossSections, planes[50:51])
+        BenchmarkApp.measure("grid and 100 sections", mesh.crossSections, planes)
+        FreeCAD.Console.PrintMessage("peak memory +%d kB\n" % (peakMemory() - memory))
+
+def transformMesh(mesh, mat, count):
+    for i in range(count):
+        mesh.transform(mat)
+
+def meshArea(mesh, count):
+    for i in range(count):
+        mesh.Area
+
+def benchKernel():
+    # the whole-mesh kernels on large meshes, each one called ten times
+    mat = FreeCAD.Matrix()
+    mat.rotateZ(0.5)
+    mat.move(FreeCAD.Vector(1,2,3))
+    for s in [500, 1000, 2250]:
+        mesh = Mesh.createSphere(10.0, s)
+        FreeCAD.Console.PrintMessage("%d facets\n" % mesh.CountFacets)
+        BenchmarkApp.measure("10 x transform and bounding box", transformMesh, mesh, mat, 10)
+        BenchmarkApp.measure("10 x area", meshArea, mesh, 10)
+
+def run():
+    benchBuilder()
+    benchGrid()
+    benchKernel()
@@ -305,20 +305,24 @@ void PropertyMeshKernel::setValuePtr(MeshObject* mesh)
     // before calling hasSetValue()
     Base::Reference<MeshObject> tmp(_meshObject);
     aboutToSetValue();
-    _meshObject = mesh;
+    setMeshObject(mesh);
     hasSetValue();
 }
 
 void PropertyMeshKernel::setValue(const MeshObject& mesh)
 {
     aboutToSetValue();
-    *_meshObject = mesh;
+    if (_meshObject.getRefCount() > 1)
+        setMeshObject(new MeshObject(mesh));
+    else
+        *_meshObject = mesh;
     hasSetValue();
 }
 
 void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
+    detachMesh(false);
     _meshObject->setKernel(mesh);
     hasSetValue();
 }
@@ -326,6 +330,7 @@ void PropertyMeshKernel::setValue(const MeshCore::MeshKernel& mesh)
 void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 {
     aboutToSetValue();
+    detachMesh();
     _meshObject->swap(mesh);
     hasSetValue();
 }
@@ -333,10 +338,29 @@ void PropertyMeshKernel::swapMesh(MeshObject& mesh)
 void PropertyMeshKernel::swapMesh(MeshCore::MeshKernel& mesh)
 {
     aboutToSetValue();
+    detachMesh();
     _meshObject->swap(mesh);
     hasSetValue();
 }
 
+void PropertyMeshKernel::detachMesh(bool copyKernel)
+{
+    if (_meshObject.getRefCount() > 1) {
+        if (copyKernel)
+            setMeshObject(new MeshObject(*_meshObject));
+        else
+            setMeshObject(new MeshObject(MeshCore::MeshKernel(), _meshObject->getTransform()));
+    }
+}
+
+void PropertyMeshKernel::setMeshObject(MeshObject* mesh)
+{
+    _meshObject = mesh;
+    // the Python wrapper must refer to the mesh object of this property
+    if (meshPyObject)
+        meshPyObject->_pcTwinPointer = mesh;
+}
+
 const MeshObject& PropertyMeshKernel::getValue(void)const 
 {
     return *_meshObject;
@@ -375,6 +399,7 @@ unsigned int PropertyMeshKernel::getMemSize (void) const
 MeshObject* PropertyMeshKernel::startEditing()
 {
     aboutToSetValue();
+    detachMesh();
     return (MeshObject*)_meshObject;
 }
 
@@ -386,13 +411,27 @@ void PropertyMeshKernel::finishEditing()
 void PropertyMeshKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
     aboutToSetValue();
+    detachMesh();
     _meshObject->transformGeometry(rclMat);
     hasSetValue();
 }
 
+void PropertyMeshKernel::setTransform(const Base::Matrix4D &rclTrf)
+{
+    detachMesh();
+    _meshObject->setTransform(rclTrf);
+}
+
 void PropertyMeshKernel::setPointIndices(const std::vector<std::pair<unsigned long, Base::Vector3f> >& inds)
 {
-    aboutToSetValue();
+    // announce runs of consecutive indices so that only the moved points are recorded
+    std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it, jt;
+    for (it = inds.begin(); it != inds.end(); it = jt) {
+        for (jt = it + 1; jt != inds.end() && jt->first == (jt-1)->first + 1; ++jt)
+            ;
+        aboutToSetValue(static_cast<int>(it->first), static_cast<int>(jt - it));
+    }
+    detachMesh();
     MeshCore::MeshKernel& kernel = _meshObject->getKernel();
     for (std::vector<std::pair<unsigned long, Base::Vector3f> >::const_iterator it = inds.begin(); it != inds.end(); ++it)
         kernel.SetPoint(it->first, it->second);
@@ -464,6 +503,7 @@ void PropertyMeshKernel::Restore(Base::XMLReader &reader)
         kernel.Adopt(points, facets);
 
         aboutToSetValue();
+        detachMesh(false);
         _meshObject->getKernel().Adopt(points, facets);
         hasSetValue();
     } 
@@ -481,23 +521,61 @@ void PropertyMeshKernel::SaveDocFile (Base::Writer &writer) const
 void PropertyMeshKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    detachMesh(false);
     _meshObject->load(reader);
     hasSetValue();
 }
 
 App::Property *PropertyMeshKernel::Copy(void) const
 {
-    // Note: Copy the content, do NOT reference the same mesh object
+    // Note: Reference the same mesh object, the property that gets modified
+    // first creates its own copy (see detachMesh())
     PropertyMeshKernel *prop = new PropertyMeshKernel();
-    *(prop->_meshObject) = *(this->_meshObject);
+    prop->_meshObject = this->_meshObject;
     return prop;
 }
 
 void PropertyMeshKernel::Paste(const App::Property &from)
 {
-    // Note: Copy the content, do NOT reference the same mesh object
+    // Note: Reference the same mesh object, see Copy()
+    Base::Reference<MeshObject> tmp(_meshObject);
     aboutToSetValue();
     const PropertyMeshKernel& prop = dynamic_cast<const PropertyMeshKernel&>(from);
-    *(this->_meshObject) = *(prop._meshObject);
+    setMeshObject(prop._meshObject);
     hasSetValue();
 }
+
+const void* PropertyMeshKernel::getSharedData(void) const
+{
+    return (MeshObject*)_meshObject;
+}
+
+App::PropertyDelta *PropertyMeshKernel::CopyRange(int start, int count, App::PropertyDelta* delta) const
+{
+    App::PropertyListDelta<Base::Vector3f> *d = delta
+        ? dynamic_cast<App::PropertyListDelta<Base::Vector3f>*>(delta)
+        : new App::PropertyListDelta<Base::Vector3f>();
+    const MeshCore::MeshPointArray& points = _meshObject->getKernel().GetPoints();
+    d->addRange(start, points.begin()+start, points.begin()+start+count);
+    return d;
+}
+
+void PropertyMeshKernel::PasteRange(const App::PropertyDelta &from)
+{
+    const App::PropertyListDelta<Base::Vector3f>& delta = dynamic_cast<const App::PropertyListDelta<Base::Vector3f>&>(from);
+    for (std::size_t i = delta.countRanges(); i-- > 0; ) {
+        aboutToSetValue(delta.getStart(i), delta.getCount(i));
+    }
+    // Note: This may be a copy sharing the mesh object with the document, see
+    // TransactionObject::setProperty()
+    detachMesh();
+    MeshCore::MeshKernel& kernel = _meshObject->getKernel();
+    // the ranges may overlap, so the first recorded values must be written last
+    for (std::size_t i = delta.countRanges(); i-- > 0; ) {
+        unsigned long start = delta.getStart(i);
+        const Base::Vector3f* values = delta.getValues(i);
+        for (int j = 0; j < delta.getCount(i); j++)
+            kernel.SetPoint(start + j, values[j]);
+    }
+    hasSetValue();
+}
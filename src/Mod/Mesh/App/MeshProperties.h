@@ -179,6 +179,11 @@ public:
     void finishEditing();
     /// Transform the real mesh data
     void transformGeometry(const Base::Matrix4D &rclMat);
+    /** Sets the placement of the mesh object without touching the property,
+     * a mesh object shared with a copy of this property gets detached first.
+     */
+    void setTransform(const Base::Matrix4D &rclTrf);
+    /// Moves some points, only their old positions are recorded for undo
     void setPointIndices( const std::vector<std::pair<unsigned long, Base::Vector3f> >& );
     //@}
 
@@ -206,11 +211,27 @@ public:
 
     void SaveDocFile (Base::Writer &writer) const;
     void RestoreDocFile(Base::Reader &reader);
+    bool canSaveDocFileInThread() const {return true;}
 
+    /** The copy shares the mesh object with this property until one of
+     * them gets modified (copy-on-write).
+     */
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
+    const void* getSharedData(void) const;
+    /// The range refers to point indices, see setPointIndices()
+    App::PropertyDelta *CopyRange(int start, int count, App::PropertyDelta* delta=0) const;
+    void PasteRange(const App::PropertyDelta &from);
     //@}
 
+private:
+    /** Makes sure that the mesh object is not shared with a copy of this
+     * property before it gets modified in place. If \a copyKernel is false
+     * the caller replaces the mesh structure anyway and it is not copied.
+     */
+    void detachMesh(bool copyKernel=true);
+    void setMeshObject(MeshObject* mesh);
+
 private:
     Base::Reference<MeshObject> _meshObject;
     MeshPy* meshPyObject;
@@ -38,6 +38,7 @@
 #include "Core/Iterator.h"
 #include "Core/Degeneration.h"
 #include "Core/Elements.h"
+#include "Core/FacetTree.h"
 #include "Core/Grid.h"
 #include "Core/MeshKernel.h"
 #include "Core/Triangulation.h"
@@ -611,6 +612,52 @@ PyObject* MeshPy::getInternalFacets(PyObject *args)
     return Py::new_reference_to(ary);
 }
 
+static Py::List indexTableToList(const MeshCore::MeshIndexTable& table, unsigned long count)
+{
+    Py::List list(count);
+    for (unsigned long i = 0; i < count; i++) {
+        MeshCore::MeshIndexRange range = table.GetRange(i);
+        Py::Tuple tuple(range.size());
+        Py::Tuple::size_type pos=0;
+        for (MeshCore::MeshIndexRange::const_iterator it = range.begin(); it != range.end(); ++it)
+            tuple.setItem(pos++, Py::Long(*it));
+        list[i] = tuple;
+    }
+    return list;
+}
+
+PyObject* MeshPy::getNeighbourTables(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+
+    const MeshCore::MeshKernel& kernel = getMeshObjectPtr()->getKernel();
+    MeshCore::MeshRefPointToFacets pt2fa(kernel);
+    MeshCore::MeshRefPointToPoints pt2pt(kernel);
+    MeshCore::MeshRefFacetToFacets fa2fa(kernel);
+
+    Py::Tuple tuple(3);
+    tuple.setItem(0, indexTableToList(pt2fa, kernel.CountPoints()));
+    tuple.setItem(1, indexTableToList(pt2pt, kernel.CountPoints()));
+    tuple.setItem(2, indexTableToList(fa2fa, kernel.CountFacets()));
+    return Py::new_reference_to(tuple);
+}
+
+PyObject* MeshPy::getPointNormals(PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, ""))
+        return 0;
+
+    std::vector<Base::Vector3d> normals = getMeshObjectPtr()->getPointNormals();
+    Py::Tuple ary(normals.size());
+    std::size_t numNormals = normals.size();
+    for (std::size_t i = 0; i < numNormals; i++) {
+        ary.setItem(i, Py::Object(new Base::VectorPy(normals[i])));
+    }
+
+    return Py::new_reference_to(ary);
+}
+
 PyObject* MeshPy::rebuildNeighbourHood(PyObject *args)
 {
     if (!PyArg_ParseTuple(args, ""))
@@ -1299,7 +1346,8 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
 {
     PyObject* pnt_p;
     PyObject* dir_p;
-    if (!PyArg_ParseTuple(args, "OO", &pnt_p, &dir_p))
+    PyObject* tree_p = Py_False;
+    if (!PyArg_ParseTuple(args, "OO|O!", &pnt_p, &dir_p, &PyBool_Type, &tree_p))
         return NULL;
 
     try {
@@ -1316,6 +1364,14 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
         unsigned long index = 0;
         Base::Vector3f res;
         MeshCore::MeshAlgorithm alg(getMeshObjectPtr()->getKernel());
+        bool found;
+        if (PyObject_IsTrue(tree_p)) {
+            MeshCore::MeshFacetTree tree(getMeshObjectPtr()->getKernel());
+            found = alg.NearestFacetOnRay(pnt, dir, tree, res, index);
+        }
+        else {
+            found = alg.NearestFacetOnRay(pnt, dir, res, index);
+        }
 
 #if 0 // for testing only
         MeshCore::MeshFacetGrid grid(getMeshObjectPtr()->getKernel(),10);
@@ -1323,7 +1379,7 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
         if (alg.NearestFacetOnRay(pnt,  dir, grid, res, index) ||
             alg.NearestFacetOnRay(pnt, -dir, grid, res, index)) {
 #else
-        if (alg.NearestFacetOnRay(pnt, dir, res, index)) {
+        if (found) {
 #endif
             Py::Tuple tuple(3);
             tuple.setItem(0, Py::Float(res.x));
@@ -1358,6 +1414,100 @@ PyObject* MeshPy::nearestFacetOnRay(PyObject *args)
     }
 }
 
+PyObject* MeshPy::nearestFacetsOnRays(PyObject *args)
+{
+    PyObject* pnts_p;
+    PyObject* dirs_p;
+    if (!PyArg_ParseTuple(args, "O!O!", &PyList_Type, &pnts_p, &PyList_Type, &dirs_p))
+        return NULL;
+
+    try {
+        Py::List pnts_l(pnts_p);
+        Py::List dirs_l(dirs_p);
+        std::vector<Base::Vector3f> pnts, dirs;
+        for (Py::List::iterator it = pnts_l.begin(); it != pnts_l.end(); ++it) {
+            Py::Tuple pnt_t(*it);
+            pnts.push_back(Base::Vector3f((float)Py::Float(pnt_t.getItem(0)),
+                                          (float)Py::Float(pnt_t.getItem(1)),
+                                          (float)Py::Float(pnt_t.getItem(2))));
+        }
+        for (Py::List::iterator it = dirs_l.begin(); it != dirs_l.end(); ++it) {
+            Py::Tuple dir_t(*it);
+            dirs.push_back(Base::Vector3f((float)Py::Float(dir_t.getItem(0)),
+                                          (float)Py::Float(dir_t.getItem(1)),
+                                          (float)Py::Float(dir_t.getItem(2))));
+        }
+        if (pnts.size() != dirs.size()) {
+            PyErr_SetString(PyExc_ValueError, "Number of points and directions differ");
+            return 0;
+        }
+
+        std::vector<unsigned long> indices;
+        std::vector<Base::Vector3f> res;
+        MeshCore::MeshFacetTree tree(getMeshObjectPtr()->getKernel());
+        tree.NearestFacetsOnRays(pnts, dirs, indices, res);
+
+        Py::List list;
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            Py::Dict dict;
+            if (indices[i] != ULONG_MAX) {
+                Py::Tuple tuple(3);
+                tuple.setItem(0, Py::Float(res[i].x));
+                tuple.setItem(1, Py::Float(res[i].y));
+                tuple.setItem(2, Py::Float(res[i].z));
+                dict.setItem(Py::Int((int)indices[i]), tuple);
+            }
+            list.append(dict);
+        }
+
+        return Py::new_reference_to(list);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
+PyObject* MeshPy::nearestFacetToPoint(PyObject *args)
+{
+    PyObject* pnt_p;
+    PyObject* tree_p = Py_False;
+    if (!PyArg_ParseTuple(args, "O|O!", &pnt_p, &PyBool_Type, &tree_p))
+        return NULL;
+
+    try {
+        Py::Tuple pnt_t(pnt_p);
+        Py::Dict dict;
+        Base::Vector3f pnt((float)Py::Float(pnt_t.getItem(0)),
+                           (float)Py::Float(pnt_t.getItem(1)),
+                           (float)Py::Float(pnt_t.getItem(2)));
+
+        unsigned long index = 0;
+        Base::Vector3f res;
+        MeshCore::MeshAlgorithm alg(getMeshObjectPtr()->getKernel());
+        bool found;
+        if (PyObject_IsTrue(tree_p)) {
+            MeshCore::MeshFacetTree tree(getMeshObjectPtr()->getKernel());
+            found = alg.NearestPointFromPoint(pnt, tree, index, res);
+        }
+        else {
+            found = alg.NearestPointFromPoint(pnt, index, res);
+        }
+
+        if (found) {
+            Py::Tuple tuple(3);
+            tuple.setItem(0, Py::Float(res.x));
+            tuple.setItem(1, Py::Float(res.y));
+            tuple.setItem(2, Py::Float(res.z));
+            dict.setItem(Py::Int((int)index), tuple);
+        }
+
+        return Py::new_reference_to(dict);
+    }
+    catch (const Py::Exception&) {
+        return 0;
+    }
+}
+
 PyObject*  MeshPy::getPlanarSegments(PyObject *args)
 {
     float dev;
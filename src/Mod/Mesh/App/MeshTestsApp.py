@@ -1,7 +1,7 @@
 #   (c) Juergen Riegel (juergen.riegel@web.de) 2007      LGPL
 
 import FreeCAD, os, sys, unittest, Mesh
-import thread, time, tempfile
+import thread, time, tempfile, math, random
 
 
 #---------------------------------------------------------------------------
@@ -163,3 +163,314 @@ class LoadMeshInThreadsCases(unittest.TestCase):
 
     def tearDown(self):
         pass
+
+# Building a mesh from a list of triangles
+
+def meshTriangles(mesh):
+    return [p for f in mesh.Facets for p in f.Points]
+
+class MeshBuilderTestCases(unittest.TestCase):
+    def setUp(self):
+        self.sphere = Mesh.createSphere(10.0, 50)
+        self.name = tempfile.gettempdir() + os.sep + "mesh.ast"
+
+    def testBulkBuilder(self):
+        # Mesh.Mesh() with a list of triangles uses the bulk mode of the builder while
+        # reading an ASCII STL file adds the facets one by one
+        bulk = Mesh.Mesh(meshTriangles(self.sphere))
+        self.sphere.write(self.name)
+        single = Mesh.Mesh()
+        single.read(self.name)
+        self.failUnless(bulk.CountPoints == single.CountPoints)
+        self.failUnless(bulk.CountFacets == single.CountFacets)
+        self.failUnless(bulk.Topology[1] == single.Topology[1])
+        self.failUnless(bulk.isSolid())
+
+    def tearDown(self):
+        if os.path.exists(self.name):
+            os.remove(self.name)
+
+# Reading Nastran decks
+
+class MeshNastranTestCases(unittest.TestCase):
+    def setUp(self):
+        self.name = tempfile.gettempdir() + os.sep + "mesh.nas"
+
+    def testRoundTrip(self):
+        sphere = Mesh.createSphere(10.0, 50)
+        sphere.write(self.name)
+        mesh = Mesh.Mesh(self.name)
+        self.failUnless(mesh.CountPoints == sphere.CountPoints)
+        self.failUnless(mesh.CountFacets == sphere.CountFacets)
+        self.failUnless(mesh.isSolid())
+
+    def testCardFormats(self):
+        # small, large and free field cards with continuation lines
+        deck = ("$ a unit square and a triangle on top of it\n"
+                "GRID           1              0.      0.      0.\n"
+                "GRID,2,,1.0,0.,0.\n"
+                "GRID*                  3                             1.0             1.0+G3\n"
+                "*G3                   0.\n"
+                "GRID           4              0.      1.  0.+0  \n"
+                "GRID           5              .5    15.-1      0.\n"
+                "CQUAD4       100       1       1       2       3       4\n"
+                "CTRIA3       101       1       4       3       5\n")
+        file = open(self.name, "w")
+        file.write(deck)
+        file.close()
+        mesh = Mesh.Mesh(self.name)
+        self.failUnless(mesh.CountPoints == 5)
+        self.failUnless(mesh.CountFacets == 3)
+        self.failUnless(abs(mesh.Area - 1.25) < 1e-6)
+
+    def tearDown(self):
+        if os.path.exists(self.name):
+            os.remove(self.name)
+
+# Spatial grids of facets
+
+def sectionPoints(sections):
+    return sorted([(p.x, p.y, p.z) for section in sections for polyline in section for p in polyline])
+
+class MeshGridTestCases(unittest.TestCase):
+    def testCrossSections(self):
+        # the sections use a facet grid to find the cut facets
+        mesh = Mesh.createSphere(10.0, 100)
+        planes = [(FreeCAD.Vector(0,0,z), FreeCAD.Vector(0,0,1)) for z in [-5.0, 0.0, 5.0]]
+        sections = mesh.crossSections(planes)
+        self.failUnless(len(sections) == 3)
+        for (base, normal), section in zip(planes, sections):
+            self.failUnless(len(section) > 0)
+            radius = (100.0 - base.z * base.z) ** 0.5
+            for polyline in section:
+                for p in polyline:
+                    self.failUnless(abs(p.z - base.z) < 1e-4)
+                    self.failUnless(abs((p.x * p.x + p.y * p.y) ** 0.5 - radius) < 0.1)
+
+    def testCrossSectionsParallel(self):
+        # the grid of the sphere is filled by several threads, the one of the band
+        # around the planes by a single thread and both must find the same facets
+        mesh = Mesh.createSphere(10.0, 300)
+        self.failUnless(mesh.CountFacets > 100000)
+        planes = [(FreeCAD.Vector(0,0,z), FreeCAD.Vector(0,0,1)) for z in [-4.13, 0.37, 6.29]]
+        points, facets = mesh.Topology
+        band = []
+        for i, f in enumerate(facets):
+            zs = [points[j].z for j in f]
+            for base, normal in planes:
+                if min(zs) <= base.z + 0.5 and max(zs) >= base.z - 0.5:
+                    band.append(i)
+                    break
+        part = mesh.meshFromSegment(band)
+        self.failUnless(part.CountFacets < 100000)
+        points1 = sectionPoints(mesh.crossSections(planes))
+        points2 = sectionPoints(part.crossSections(planes))
+        self.failUnless(len(points1) > 0 and len(points1) == len(points2))
+        for p, q in zip(points1, points2):
+            self.failUnless(max([abs(a - b) for a, b in zip(p, q)]) < 1e-4)
+
+# Neighbourhood tables
+
+class MeshIndexTableTestCases(unittest.TestCase):
+    def testNeighbourTables(self):
+        # large enough to build the tables in several threads
+        mesh = Mesh.createSphere(10.0, 400)
+        points = mesh.Points
+        p0, p1, p2 = points[0].Vector, points[1].Vector, points[2].Vector
+        # degenerated facets with two or three equal points and one with three points on a line
+        mesh.addFacet(p0, p0, p1)
+        mesh.addFacet(p2, p2, p2)
+        mesh.addFacet(p0, p1, (p0 + p1) * 0.5)
+        points, facets = mesh.Topology
+        self.failUnless(len(points) > 100000)
+        self.failUnless(facets[-3][0] == facets[-3][1] or facets[-3][1] == facets[-3][2] or facets[-3][0] == facets[-3][2])
+
+        pt2fa = [set() for p in points]
+        for i, f in enumerate(facets):
+            for j in f:
+                pt2fa[j].add(i)
+        pt2pt = [set() for p in points]
+        for f in facets:
+            for j in f:
+                pt2pt[j].update(f)
+        for j, s in enumerate(pt2pt):
+            s.discard(j)
+        fa2fa = []
+        for f in facets:
+            fa2fa.append(pt2fa[f[0]] | pt2fa[f[1]] | pt2fa[f[2]])
+
+        tables = mesh.getNeighbourTables()
+        self.failUnless(len(tables[0]) == len(points) and len(tables[1]) == len(points))
+        self.failUnless(len(tables[2]) == len(facets))
+        for hand, table in zip([pt2fa, pt2pt, fa2fa], tables):
+            for s, t in zip(hand, table):
+                self.failUnless(list(t) == sorted(s))
+
+# Bounding volume hierarchy of facets
+
+def heightField():
+    # the facet sizes grow from the center outwards by a factor of 1.15
+    coords = [0.0]
+    step = 0.005
+    while coords[-1] < 10.0:
+        coords.append(coords[-1] + step)
+        step = step * 1.15
+    coords = [-c for c in reversed(coords[1:])] + coords
+    def point(x, y):
+        return (x, y, math.sin(x) * math.cos(y))
+    triangles = []
+    for i in range(len(coords) - 1):
+        for j in range(len(coords) - 1):
+            x0, x1, y0, y1 = coords[i], coords[i+1], coords[j], coords[j+1]
+            triangles.append((point(x0,y0), point(x1,y0), point(x1,y1)))
+            triangles.append((point(x0,y0), point(x1,y1), point(x0,y1)))
+    return Mesh.Mesh(triangles)
+
+class MeshFacetTreeTestCases(unittest.TestCase):
+    def setUp(self):
+        self.mesh = heightField()
+        rand = random.Random(42)
+        self.pnts = []
+        self.dirs = []
+        for i in range(50):
+            self.pnts.append((rand.uniform(-9,9), rand.uniform(-9,9), rand.uniform(5,15)))
+            self.dirs.append((rand.uniform(-0.5,0.5), rand.uniform(-0.5,0.5), -1.0))
+        # parallel to the z axis
+        self.pnts.append((0.37, -2.11, 40.0))
+        self.dirs.append((0.0, 0.0, -1.0))
+        # misses the mesh
+        self.pnts.append((0.0, 0.0, 5.0))
+        self.dirs.append((1.0, 0.0, 0.0))
+
+    def samePoint(self, hit1, hit2):
+        if len(hit1) != len(hit2):
+            return False
+        if len(hit1) == 0:
+            return True
+        p = hit1.values()[0]
+        q = hit2.values()[0]
+        return max([abs(a - b) for a, b in zip(p, q)]) < 1e-3
+
+    def testNearestFacetOnRay(self):
+        # the rays start above the mesh so that the search behind the base point
+        # of the brute-force method doesn't matter
+        hits = self.mesh.nearestFacetsOnRays(self.pnts, self.dirs)
+        self.failUnless(len(hits) == len(self.pnts))
+        self.failUnless(len(hits[-1]) == 0 and len(hits[-2]) == 1)
+        for pnt, dir, hit in zip(self.pnts, self.dirs, hits):
+            brute = self.mesh.nearestFacetOnRay(pnt, dir)
+            tree = self.mesh.nearestFacetOnRay(pnt, dir, True)
+            self.failUnless(self.samePoint(brute, tree))
+            self.failUnless(self.samePoint(brute, hit))
+
+    def testSearchNearestFromPoint(self):
+        for pnt in self.pnts:
+            brute = self.mesh.nearestFacetToPoint(pnt)
+            tree = self.mesh.nearestFacetToPoint(pnt, True)
+            self.failUnless(len(brute) == 1 and len(tree) == 1)
+            d1 = math.sqrt(sum([(a - b) ** 2 for a, b in zip(pnt, brute.values()[0])]))
+            d2 = math.sqrt(sum([(a - b) ** 2 for a, b in zip(pnt, tree.values()[0])]))
+            self.failUnless(abs(d1 - d2) < 1e-4)
+
+    def testEmptyMesh(self):
+        mesh = Mesh.Mesh()
+        self.failUnless(len(mesh.nearestFacetOnRay((0,0,1), (0,0,-1), True)) == 0)
+        self.failUnless(mesh.nearestFacetsOnRays([(0,0,1)], [(0,0,-1)]) == [{}])
+        self.failUnless(len(mesh.nearestFacetToPoint((0,0,0), True)) == 0)
+        self.failUnless(len(mesh.nearestFacetToPoint((0,0,0))) == 0)
+
+# Whole-mesh kernels
+
+def crossProduct(a, b):
+    return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+
+class MeshKernelTestCases(unittest.TestCase):
+    def setUp(self):
+        # large enough to split the points and facets into several threads
+        self.mesh = Mesh.createSphere(10.0, 400)
+        self.failUnless(self.mesh.CountPoints > 100000)
+
+    def facetNormals(self):
+        # the normals of the facets as computed by a single thread, their length is twice the area
+        points, facets = self.mesh.Topology
+        normals = []
+        for f in facets:
+            p0, p1, p2 = points[f[0]], points[f[1]], points[f[2]]
+            normals.append(crossProduct((p1.x - p0.x, p1.y - p0.y, p1.z - p0.z),
+                                        (p2.x - p0.x, p2.y - p0.y, p2.z - p0.z)))
+        return points, facets, normals
+
+    def testTransform(self):
+        mesh = self.mesh
+        area = mesh.Area
+        mat = FreeCAD.Matrix()
+        mat.rotateZ(0.5)
+        mat.move(FreeCAD.Vector(1,2,3))
+        mesh.transform(mat)
+        self.failUnless(abs(mesh.Area - area) <= 1)
+        box = mesh.BoundBox
+        points = mesh.Points
+        xs = [p.x for p in points]
+        ys = [p.y for p in points]
+        zs = [p.z for p in points]
+        self.failUnless(box.XMin == min(xs) and box.XMax == max(xs))
+        self.failUnless(box.YMin == min(ys) and box.YMax == max(ys))
+        self.failUnless(box.ZMin == min(zs) and box.ZMax == max(zs))
+        self.failUnless(abs(box.Center.x - 1.0) < 0.01 and abs(box.Center.y - 2.0) < 0.01 and abs(box.Center.z - 3.0) < 0.01)
+
+    def testArea(self):
+        points, facets, normals = self.facetNormals()
+        area = sum([math.sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) for n in normals]) / 2.0
+        self.failUnless(abs(self.mesh.Area - area) < 1e-5 * area)
+
+    def testVertexNormals(self):
+        points, facets, normals = self.facetNormals()
+        sums = [[0.0, 0.0, 0.0] for p in points]
+        for f, n in zip(facets, normals):
+            for i in f:
+                for j in range(3):
+                    sums[i][j] += n[j]
+        pointNormals = self.mesh.getPointNormals()
+        self.failUnless(len(pointNormals) == len(points))
+        for s, n in zip(sums, pointNormals):
+            length = math.sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2])
+            self.failUnless(max([abs(a / length - b) for a, b in zip(s, n)]) < 1e-4)
+
+# Undo/redo of mesh features
+
+class MeshUndoTestCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("MeshUndoTest")
+        self.doc.UndoMode = 1
+        self.feature = self.doc.addObject("Mesh::Feature","Sphere")
+        self.feature.Mesh = Mesh.createSphere(10.0, 50)
+
+    def testUndoEditing(self):
+        # the undo copy shares the mesh until it gets modified in place
+        area = self.feature.Mesh.Area
+        wrapper = self.feature.Mesh
+        self.doc.openTransaction("Smooth")
+        self.feature.smooth(3)
+        self.doc.commitTransaction()
+        self.failUnless(self.feature.Mesh.Area != area)
+        self.failUnless(wrapper.Area != area)
+        self.doc.undo()
+        self.failUnless(self.feature.Mesh.Area == area)
+        self.doc.redo()
+        self.failUnless(self.feature.Mesh.Area != area)
+
+    def testUndoMemSize(self):
+        # replacing the mesh keeps only one copy of the old mesh
+        count = self.feature.Mesh.CountFacets
+        self.doc.openTransaction("Replace")
+        self.feature.Mesh = Mesh.createBox(1.0, 1.0, 1.0)
+        self.doc.commitTransaction()
+        replaced = self.doc.UndoRedoMemSize
+        self.failUnless(replaced > 0)
+        self.doc.undo()
+        self.failUnless(self.feature.Mesh.CountFacets == count)
+        # the redo copy is the box only
+        self.failUnless(self.doc.UndoRedoMemSize < replaced)
+
+    def tearDown(self):
+        FreeCAD.closeDocument("MeshUndoTest")
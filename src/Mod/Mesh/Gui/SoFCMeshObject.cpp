@@ -56,6 +56,7 @@
 #include <Mod/Mesh/App/Core/MeshKernel.h>
 #include <Mod/Mesh/App/Core/Elements.h>
 #include <Mod/Mesh/App/Core/Grid.h>
+#include <Mod/Mesh/App/Core/FacetTree.h>
 
 using namespace MeshGui;
 
@@ -332,7 +333,7 @@ SO_NODE_SOURCE(SoFCMeshPickNode);
 /*!
   Constructor.
 */
-SoFCMeshPickNode::SoFCMeshPickNode(void) : meshGrid(0)
+SoFCMeshPickNode::SoFCMeshPickNode(void) : meshTree(0)
 {
     SO_NODE_CONSTRUCTOR(SoFCMeshPickNode);
 
@@ -344,7 +345,7 @@ SoFCMeshPickNode::SoFCMeshPickNode(void) : meshGrid(0)
 */
 SoFCMeshPickNode::~SoFCMeshPickNode()
 {
-    delete meshGrid;
+    delete meshTree;
 }
 
 // Doc from superclass.
@@ -359,10 +360,8 @@ void SoFCMeshPickNode::notify(SoNotList *list)
     if (f == &mesh) {
         const Mesh::MeshObject* meshObject = mesh.getValue();
         if (meshObject) {
-            MeshCore::MeshAlgorithm alg(meshObject->getKernel());
-            float fAvgLen = alg.GetAverageEdgeLength();
-            delete meshGrid;
-            meshGrid = new MeshCore::MeshFacetGrid(meshObject->getKernel(), 5.0f * fAvgLen);
+            delete meshTree;
+            meshTree = new MeshCore::MeshFacetTree(meshObject->getKernel());
         }
     }
 }
@@ -387,7 +386,7 @@ void SoFCMeshPickNode::pick(SoPickAction * action)
     Base::Vector3f pt(pos[0],pos[1],pos[2]);
     Base::Vector3f dr(dir[0],dir[1],dir[2]);
     unsigned long index;
-    if (alg.NearestFacetOnRay(pt, dr, *meshGrid, pt, index)) {
+    if (meshTree && alg.NearestFacetOnRay(pt, dr, *meshTree, pt, index)) {
         SoPickedPoint* pp = raypick->addIntersection(SbVec3f(pt.x,pt.y,pt.z));
         if (pp) {
             SoFaceDetail* det = new SoFaceDetail();
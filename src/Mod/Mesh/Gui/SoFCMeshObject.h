@@ -38,7 +38,7 @@ typedef unsigned int GLuint;
 typedef int GLint;
 typedef float GLfloat;
 
-namespace MeshCore { class MeshFacetGrid; }
+namespace MeshCore { class MeshFacetTree; }
 
 namespace MeshGui {
 
@@ -93,7 +93,7 @@ protected:
     virtual ~SoFCMeshPickNode();
 
 private:
-    MeshCore::MeshFacetGrid* meshGrid;
+    MeshCore::MeshFacetTree* meshTree;
 };
 
 // -------------------------------------------------------
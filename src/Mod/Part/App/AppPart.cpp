@@ -13,8 +13,12 @@
 #ifndef _PreComp_
 # include <Python.h>
 # include <Interface_Static.hxx>
+# include <Standard.hxx>
+# include <BRepMesh_IncrementalMesh.hxx>
 #endif
 
+#include <Standard_Version.hxx>
+
 #include <Base/Console.h>
 #include <Base/Interpreter.h>
 #include <Base/Parameter.h>
@@ -89,6 +93,14 @@ void PartExport initPart()
     PyObject* partModule = Py_InitModule3("Part", Part_methods, module_part_doc);   /* mod name, table ptr */
     Base::Console().Log("Loading Part module... done\n");
 
+    // shapes are also built and processed in worker threads (parallel recompute,
+    // saving, tessellation), so OCC must use a thread-safe memory manager
+    Standard::SetReentrant(Standard_True);
+#if OCC_VERSION_HEX >= 0x060503
+    // mesh the faces of a shape in parallel, too
+    BRepMesh_IncrementalMesh::SetParallelDefault(Standard_True);
+#endif
+
     // Add Types to module
     Base::Interpreter().addType(&Part::TopoShapePy          ::Type,partModule,"Shape");
     Base::Interpreter().addType(&Part::TopoShapeVertexPy    ::Type,partModule,"Vertex");
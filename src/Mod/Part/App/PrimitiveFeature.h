@@ -43,6 +43,9 @@ public:
     /// recalculate the feature
     App::DocumentObjectExecReturn *execute(void) = 0;
     short mustExecute() const;
+    /// primitives only build a shape from their own properties
+    bool canRecomputeInThread() const
+    { return true; }
     //@}
 
 protected:
@@ -51,6 +51,7 @@
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
 #include <Base/Stream.h>
+#include <App/Application.h>
 #include <App/DocumentObject.h>
 
 #include "PropertyTopoShape.h"
@@ -68,7 +69,17 @@ using namespace Part;
 
 TYPESYSTEM_SOURCE(Part::PropertyPartShape , App::PropertyComplexGeoData);
 
-PropertyPartShape::PropertyPartShape()
+namespace Part {
+// The binary format is much faster to write and read but cannot be
+// loaded by older versions. Therefore it must be enabled explicitly.
+static bool writeBinaryBRep()
+{
+    return App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part/General")->GetBool("WriteBinaryBRep", false);
+}
+}
+
+PropertyPartShape::PropertyPartShape() : _binary(false)
 {
 }
 
@@ -198,13 +209,10 @@ void PropertyPartShape::setPyObject(PyObject *value)
 
 App::Property *PropertyPartShape::Copy(void) const
 {
+    // Note: The copy shares the underlying shape data. This is safe because the
+    // methods of TopoShape that would modify it in place work on a copy.
     PropertyPartShape *prop = new PropertyPartShape();
     prop->_Shape = this->_Shape;
-    if (!_Shape._Shape.IsNull()) {
-        BRepBuilderAPI_Copy copy(_Shape._Shape);
-        prop->_Shape._Shape = copy.Shape();
-    }
-
     return prop;
 }
 
@@ -220,12 +228,19 @@ unsigned int PropertyPartShape::getMemSize (void) const
     return _Shape.getMemSize();
 }
 
+const void* PropertyPartShape::getSharedData(void) const
+{
+    if (_Shape._Shape.IsNull())
+        return 0;
+    return _Shape._Shape.TShape().operator->();
+}
+
 void PropertyPartShape::Save (Base::Writer &writer) const
 {
     if(!writer.isForceXML()) {
         //See SaveDocFile(), RestoreDocFile()
         writer.Stream() << writer.ind() << "<Part file=\"" 
-                        << writer.addFile("PartShape.brp", this)
+                        << writer.addFile(writeBinaryBRep() ? "PartShape.bin" : "PartShape.brp", this)
                         << "\"/>" << std::endl;
     }
 }
@@ -238,6 +253,7 @@ void PropertyPartShape::Restore(Base::XMLReader &reader)
     if (!file.empty()) {
         // initate a file read
         reader.addFile(file.c_str(),this);
+        _binary = Base::FileInfo(file).hasExtension("bin");
     }
 }
 
@@ -253,91 +269,60 @@ void PropertyPartShape::SaveDocFile (Base::Writer &writer) const
     const TopoDS_Shape& myShape = copy.Shape();
     BRepTools::Clean(myShape); // remove triangulation
 
-    // create a temporary file and copy the content to the zip stream
-    // once the tmp. filename is known use always the same because otherwise
-    // we may run into some problems on the Linux platform
-    static Base::FileInfo fi(Base::FileInfo::getTempFileName());
-
-    if (!BRepTools::Write(myShape,(const Standard_CString)fi.filePath().c_str())) {
-        // Note: Do NOT throw an exception here because if the tmp. file could
-        // not be created we should not abort.
+    // The shape is written directly into the zip stream without a temp. file
+    TopoShape shape(myShape);
+    try {
+        if (writeBinaryBRep())
+            shape.exportBinary(writer.Stream());
+        else
+            shape.exportBrep(writer.Stream());
+    }
+    catch (const Base::Exception& e) {
+        // Note: Do NOT throw an exception here because if the shape could not be
+        // written we should not abort.
         // We only print an error message but continue writing the next files to the
         // stream...
         App::PropertyContainer* father = this->getContainer();
         if (father && father->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
             App::DocumentObject* obj = static_cast<App::DocumentObject*>(father);
-            Base::Console().Error("Shape of '%s' cannot be written to BRep file '%s'\n", 
-                obj->Label.getValue(),fi.filePath().c_str());
+            Base::Console().Error("Shape of '%s' cannot be written: %s\n", 
+                obj->Label.getValue(), e.what());
         }
         else {
-            Base::Console().Error("Cannot save BRep file '%s'\n", fi.filePath().c_str());
-        }
-    }
-
-    Base::ifstream file(fi, std::ios::in | std::ios::binary);
-    if (file){
-        unsigned long ulSize = 0; 
-        std::streambuf* buf = file.rdbuf();
-        if (buf) {
-            unsigned long ulCurr;
-            ulCurr = buf->pubseekoff(0, std::ios::cur, std::ios::in);
-            ulSize = buf->pubseekoff(0, std::ios::end, std::ios::in);
-            buf->pubseekoff(ulCurr, std::ios::beg, std::ios::in);
+            Base::Console().Error("Cannot save shape: %s\n", e.what());
         }
-
-        // read in the ASCII file and write back to the stream
-        std::strstreambuf sbuf(ulSize);
-        file >> &sbuf;
-        writer.Stream() << &sbuf;
     }
-
-    file.close();
-    // remove temp file
-    fi.deleteFile();
 }
 
 void PropertyPartShape::RestoreDocFile(Base::Reader &reader)
 {
-    BRep_Builder builder;
-
-    // create a temporary file and copy the content from the zip stream
-    Base::FileInfo fi(Base::FileInfo::getTempFileName());
-
-    // read in the ASCII file and write back to the file stream
-    Base::ofstream file(fi, std::ios::out | std::ios::binary);
-    unsigned long ulSize = 0; 
-    if (reader) {
-        std::streambuf* buf = file.rdbuf();
-        reader >> buf;
-        file.flush();
-        ulSize = buf->pubseekoff(0, std::ios::cur, std::ios::in);
-    }
-    file.close();
-
-    // Read the shape from the temp file, if the file is empty the stored shape was already empty.
-    // If it's still empty after reading the (non-empty) file there must occurred an error.
-    TopoDS_Shape shape;
-    if (ulSize > 0) {
-        if (!BRepTools::Read(shape, (const Standard_CString)fi.filePath().c_str(), builder)) {
-            // Note: Do NOT throw an exception here because if the tmp. created file could
-            // not be read it's NOT an indication for an invalid input stream 'reader'.
-            // We only print an error message but continue reading the next files from the
-            // stream...
+    // Read the shape directly from the zip stream. If the stream is empty the stored
+    // shape was already empty.
+    TopoShape shape;
+    if (reader && reader.peek() != std::char_traits<char>::eof()) {
+        try {
+            if (_binary)
+                shape.importBinary(reader);
+            else // the document restore already reports the progress per file
+                shape.importBrep(reader, false);
+        }
+        catch (const Base::Exception& e) {
+            // Note: Do NOT throw an exception here because if the shape could not be
+            // read we only print an error message but continue reading the next files
+            // from the stream...
             App::PropertyContainer* father = this->getContainer();
             if (father && father->isDerivedFrom(App::DocumentObject::getClassTypeId())) {
                 App::DocumentObject* obj = static_cast<App::DocumentObject*>(father);
-                Base::Console().Error("BRep file '%s' with shape of '%s' seems to be empty\n", 
-                    fi.filePath().c_str(),obj->Label.getValue());
+                Base::Console().Error("Shape of '%s' cannot be read: %s\n", 
+                    obj->Label.getValue(), e.what());
             }
             else {
-                Base::Console().Warning("Loaded BRep file '%s' seems to be empty\n", fi.filePath().c_str());
+                Base::Console().Warning("Loaded shape seems to be empty: %s\n", e.what());
             }
         }
     }
 
-    // delete the temp file
-    fi.deleteFile();
-
+    _binary = false;
     setValue(shape);
 }
 
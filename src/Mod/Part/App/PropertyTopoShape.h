@@ -92,10 +92,12 @@ public:
     App::Property *Copy(void) const;
     void Paste(const App::Property &from);
     unsigned int getMemSize (void) const;
+    const void* getSharedData(void) const;
     //@}
 
 private:
     TopoShape _Shape;
+    bool _binary;
 };
 
 struct PartExport ShapeHistory {
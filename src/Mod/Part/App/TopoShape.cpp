@@ -72,6 +72,7 @@
 # include <BRepTools.hxx>
 # include <BRepTools_ReShape.hxx>
 # include <BRepTools_ShapeSet.hxx>
+# include <BinTools_ShapeSet.hxx>
 # include <GCE2d_MakeSegment.hxx>
 # include <Geom2d_Line.hxx>
 # include <Geom2d_TrimmedCurve.hxx>
@@ -619,18 +620,23 @@ void TopoShape::importBrep(const char *FileName)
     }
 }
 
-void TopoShape::importBrep(std::istream& str)
+void TopoShape::importBrep(std::istream& str, bool progress)
 {
     try {
         // read brep-file
         BRep_Builder aBuilder;
         TopoDS_Shape aShape;
 #if OCC_HEX_VERSION >= 0x060300
-        Handle_Message_ProgressIndicator pi = new ProgressIndicator(100);
-        pi->NewScope(100, "Reading BREP file...");
-        pi->Show();
-        BRepTools::Read(aShape,str,aBuilder,pi);
-        pi->EndScope();
+        if (progress) {
+            Handle_Message_ProgressIndicator pi = new ProgressIndicator(100);
+            pi->NewScope(100, "Reading BREP file...");
+            pi->Show();
+            BRepTools::Read(aShape,str,aBuilder,pi);
+            pi->EndScope();
+        }
+        else {
+            BRepTools::Read(aShape,str,aBuilder);
+        }
 #else
         BRepTools::Read(aShape,str,aBuilder);
 #endif
@@ -725,12 +731,61 @@ void TopoShape::exportBrep(const char *filename) const
         throw Base::Exception("Writing of BREP failed");
 }
 
+void TopoShape::exportBrep(std::ostream& out) const
+{
+    try {
+        BRepTools::Write(this->_Shape, out);
+    }
+    catch (Standard_Failure) {
+        Handle(Standard_Failure) aFail = Standard_Failure::Caught();
+        throw Base::Exception(aFail->GetMessageString());
+    }
+    if (out.fail())
+        throw Base::Exception("Writing of BREP failed");
+}
+
+void TopoShape::importBinary(std::istream& str)
+{
+    try {
+        // the same as BinTools::Read() which is not available in all OCC versions
+        BinTools_ShapeSet theShapeSet;
+        theShapeSet.Read(str);
+        TopoDS_Shape aShape;
+        theShapeSet.Read(aShape, str, theShapeSet.NbShapes());
+        this->_Shape = aShape;
+    }
+    catch (Standard_Failure) {
+        Handle(Standard_Failure) aFail = Standard_Failure::Caught();
+        throw Base::Exception(aFail->GetMessageString());
+    }
+    catch (const std::exception& e) {
+        throw Base::Exception(e.what());
+    }
+}
+
+void TopoShape::exportBinary(std::ostream& out) const
+{
+    try {
+        // the same as BinTools::Write() which is not available in all OCC versions
+        BinTools_ShapeSet theShapeSet;
+        theShapeSet.Add(this->_Shape);
+        theShapeSet.Write(out);
+        theShapeSet.Write(this->_Shape, out);
+    }
+    catch (Standard_Failure) {
+        Handle(Standard_Failure) aFail = Standard_Failure::Caught();
+        throw Base::Exception(aFail->GetMessageString());
+    }
+}
+
 void TopoShape::exportStl(const char *filename) const
 {
     StlAPI_Writer writer;
     //writer.RelativeMode() = false;
     //writer.SetDeflection(0.1);
-    writer.Write(this->_Shape,(const Standard_CString)filename);
+    // the writer meshes the shape in place, which may be shared with undo copies
+    BRepBuilderAPI_Copy copy(this->_Shape);
+    writer.Write(copy.Shape(),(const Standard_CString)filename);
 }
 
 void TopoShape::exportFaceSet(double dev, double ca, std::ostream& str) const
@@ -738,8 +793,11 @@ void TopoShape::exportFaceSet(double dev, double ca, std::ostream& str) const
     Base::InventorBuilder builder(str);
     TopExp_Explorer ex;
 
-    BRepMesh_IncrementalMesh MESH(this->_Shape,dev);
-    for (ex.Init(this->_Shape, TopAbs_FACE); ex.More(); ex.Next()) {
+    // the triangulation is stored in the shape, which may be shared with undo copies
+    BRepBuilderAPI_Copy copy(this->_Shape);
+    const TopoDS_Shape& shape = copy.Shape();
+    BRepMesh_IncrementalMesh MESH(shape,dev);
+    for (ex.Init(shape, TopAbs_FACE); ex.More(); ex.Next()) {
         // get the shape and mesh it
         const TopoDS_Face& aFace = TopoDS::Face(ex.Current());
         Standard_Integer nbNodesInFace,nbTriInFace;
@@ -1753,7 +1811,10 @@ bool TopoShape::fix(double precision, double mintol, double maxtol)
 
     TopAbs_ShapeEnum type = this->_Shape.ShapeType();
 
-    ShapeFix_Shape fix(this->_Shape);
+    // the fix tools change tolerances of the sub-shapes in place, so work on
+    // a copy of the shape which may be shared with undo copies
+    BRepBuilderAPI_Copy copy(this->_Shape);
+    ShapeFix_Shape fix(copy.Shape());
     fix.SetPrecision(precision);
     fix.SetMaxTolerance(mintol);
     fix.SetMaxTolerance(maxtol);
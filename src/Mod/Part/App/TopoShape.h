@@ -122,10 +122,14 @@ public:
     void importIges(const char *FileName);
     void importStep(const char *FileName);
     void importBrep(const char *FileName);
-    void importBrep(std::istream&);
+    /// reads a BREP stream, if \a progress is false no progress indicator is shown
+    void importBrep(std::istream&, bool progress=true);
     void exportIges(const char *FileName) const;
     void exportStep(const char *FileName) const;
     void exportBrep(const char *FileName) const;
+    void exportBrep(std::ostream&) const;
+    void importBinary(std::istream&);
+    void exportBinary(std::ostream&) const;
     void exportStl (const char *FileName) const;
     void exportFaceSet(double, double, std::ostream&) const;
     void exportLineSet(std::ostream&) const;
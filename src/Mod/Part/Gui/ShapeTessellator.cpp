@@ -0,0 +1,506 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#include "PreCompiled.h"
+
+#ifndef _PreComp_
+# include <climits>
+# include <list>
+# include <map>
+# include <set>
+# include <Bnd_Box.hxx>
+# include <BRep_Tool.hxx>
+# include <BRepBndLib.hxx>
+# include <BRepBuilderAPI_Copy.hxx>
+# include <BRepMesh_IncrementalMesh.hxx>
+# include <gp_Trsf.hxx>
+# include <Poly_Array1OfTriangle.hxx>
+# include <Poly_Polygon3D.hxx>
+# include <Poly_PolygonOnTriangulation.hxx>
+# include <Poly_Triangulation.hxx>
+# include <TColgp_Array1OfPnt.hxx>
+# include <TColStd_Array1OfInteger.hxx>
+# include <TopExp.hxx>
+# include <TopExp_Explorer.hxx>
+# include <TopoDS.hxx>
+# include <TopoDS_Edge.hxx>
+# include <TopoDS_Face.hxx>
+# include <TopoDS_Shape.hxx>
+# include <TopoDS_Vertex.hxx>
+# include <TopTools_IndexedMapOfShape.hxx>
+# include <QFuture>
+# include <QFutureWatcher>
+# include <QThread>
+# include <QtConcurrentRun>
+# include <Inventor/nodes/SoIndexedFaceSet.h>
+#endif
+
+#include <Base/Console.h>
+#include <Base/TimeInfo.h>
+#include <Mod/Part/App/TopoShape.h>
+
+#include "ShapeTessellator.h"
+#include "ViewProviderExt.h"
+
+using namespace PartGui;
+
+namespace {
+
+// shapes with up to this number of faces are tessellated at once
+const int maxSyncFaces = 32;
+// upper limit of the memory used by the cached visuals and the shapes they keep alive
+const std::size_t maxCacheSize = 128 * 1024 * 1024;
+
+}
+
+std::size_t ShapeVisual::getMemSize() const
+{
+    return (points.size() + normals.size()) * sizeof(SbVec3f) +
+           (faceIndex.size() + partIndex.size() + lineIndex.size()) * sizeof(int32_t);
+}
+
+// ----------------------------------------------------------------------------
+
+class ShapeTessellator::Private
+{
+public:
+    struct CacheEntry
+    {
+        TopoDS_Shape shape;
+        double deviation;
+        ShapeVisualPtr visual;
+        std::size_t memSize;
+    };
+    typedef std::list<CacheEntry> CacheList;
+    typedef std::multimap<int, CacheList::iterator> CacheIndex;
+
+    struct Job
+    {
+        ViewProviderPartExt* vp; // 0 if superseded or cancelled
+        TopoDS_Shape shape;
+        double deviation;
+    };
+    typedef QFutureWatcher<ShapeVisualPtr> Watcher;
+
+    Private() : cacheSize(0)
+    {
+    }
+
+    // the most recently used entry comes first
+    CacheList cache;
+    CacheIndex cacheIndex;
+    std::size_t cacheSize;
+    std::map<Watcher*, Job> jobs;
+};
+
+ShapeTessellator& ShapeTessellator::instance()
+{
+    static ShapeTessellator tessellator;
+    return tessellator;
+}
+
+ShapeTessellator::ShapeTessellator() : d(new Private())
+{
+}
+
+ShapeTessellator::~ShapeTessellator()
+{
+    // the watchers are children of this object, running jobs just finish
+    delete d;
+}
+
+ShapeVisualPtr ShapeTessellator::request(ViewProviderPartExt* vp, const TopoDS_Shape& shape, double deviation)
+{
+    cancel(vp);
+
+    // the visual doesn't depend on the placement of the shape
+    TopoDS_Shape key(shape);
+    key.Location(TopLoc_Location());
+    ShapeVisualPtr visual = findCached(key, deviation);
+    if (visual)
+        return visual;
+
+    TopTools_IndexedMapOfShape faces;
+    TopExp::MapShapes(shape, TopAbs_FACE, faces);
+    if (faces.Extent() <= maxSyncFaces || QThread::idealThreadCount() < 2) {
+        visual = compute(shape, deviation);
+        addCached(key, deviation, visual);
+        return visual;
+    }
+
+    Private::Job job;
+    job.vp = vp;
+    job.shape = key;
+    job.deviation = deviation;
+    Private::Watcher* watcher = new Private::Watcher(this);
+    d->jobs[watcher] = job;
+    connect(watcher, SIGNAL(finished()), this, SLOT(onFinished()));
+    watcher->setFuture(QtConcurrent::run(&ShapeTessellator::compute, shape, deviation));
+    return ShapeVisualPtr();
+}
+
+void ShapeTessellator::cancel(ViewProviderPartExt* vp)
+{
+    for (std::map<Private::Watcher*, Private::Job>::iterator it = d->jobs.begin(); it != d->jobs.end(); ++it) {
+        if (it->second.vp == vp)
+            it->second.vp = 0;
+    }
+}
+
+void ShapeTessellator::onFinished()
+{
+    Private::Watcher* watcher = static_cast<Private::Watcher*>(sender());
+    std::map<Private::Watcher*, Private::Job>::iterator it = d->jobs.find(watcher);
+    if (it != d->jobs.end()) {
+        ShapeVisualPtr visual = watcher->result();
+        // keep the result even if nobody waits for it anymore
+        addCached(it->second.shape, it->second.deviation, visual);
+        ViewProviderPartExt* vp = it->second.vp;
+        d->jobs.erase(it);
+        if (vp)
+            vp->applyVisual(*visual);
+    }
+    watcher->deleteLater();
+}
+
+ShapeVisualPtr ShapeTessellator::findCached(const TopoDS_Shape& shape, double deviation)
+{
+    std::pair<Private::CacheIndex::iterator, Private::CacheIndex::iterator> range =
+        d->cacheIndex.equal_range(shape.HashCode(INT_MAX));
+    for (Private::CacheIndex::iterator it = range.first; it != range.second; ++it) {
+        Private::CacheList::iterator entry = it->second;
+        if (entry->deviation == deviation && entry->shape.IsEqual(shape)) {
+            d->cache.splice(d->cache.begin(), d->cache, entry);
+            return entry->visual;
+        }
+    }
+    return ShapeVisualPtr();
+}
+
+void ShapeTessellator::addCached(const TopoDS_Shape& shape, double deviation, ShapeVisualPtr visual)
+{
+    if (visual->failed || findCached(shape, deviation))
+        return;
+
+    Private::CacheEntry entry;
+    entry.shape = shape;
+    entry.deviation = deviation;
+    entry.visual = visual;
+    // the key keeps the shape alive, so its memory counts as well
+    entry.memSize = visual->getMemSize() + Part::TopoShape(shape).getMemSize();
+    d->cache.push_front(entry);
+    d->cacheIndex.insert(std::make_pair(shape.HashCode(INT_MAX), d->cache.begin()));
+    d->cacheSize += entry.memSize;
+
+    // drop the least recently used entries
+    while (d->cacheSize > maxCacheSize && d->cache.size() > 1) {
+        Private::CacheList::iterator last = --d->cache.end();
+        std::pair<Private::CacheIndex::iterator, Private::CacheIndex::iterator> range =
+            d->cacheIndex.equal_range(last->shape.HashCode(INT_MAX));
+        for (Private::CacheIndex::iterator it = range.first; it != range.second; ++it) {
+            if (it->second == last) {
+                d->cacheIndex.erase(it);
+                break;
+            }
+        }
+        d->cacheSize -= last->memSize;
+        d->cache.erase(last);
+    }
+}
+
+ShapeVisualPtr ShapeTessellator::compute(const TopoDS_Shape& inputShape, double deviation)
+{
+    boost::shared_ptr<ShapeVisual> visual(new ShapeVisual());
+    if (inputShape.IsNull())
+        return visual;
+
+    // time measurement and book keeping
+    Base::TimeInfo start_time;
+    int nbrTriangles=0,nbrNodes=0,nbrNorms=0,nbrFaces=0,nbrEdges=0;
+    std::set<int> faceEdges;
+
+    try {
+        // BRepMesh stores the triangulation in the sub-shapes, which may be shared
+        // with other shapes, e.g. the result of a boolean operation and its
+        // arguments. So, a copy is meshed which no other thread can access.
+        TopoDS_Shape cShape = BRepBuilderAPI_Copy(inputShape).Shape();
+
+        // calculating the deflection value
+        Bnd_Box bounds;
+        BRepBndLib::Add(cShape, bounds);
+        bounds.SetGap(0.0);
+        Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+        bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+        Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
+            deviation;
+
+        // create the mesh on the data structure
+        BRepMesh_IncrementalMesh myMesh(cShape,deflection);
+        // We must reset the location here because the transformation data
+        // are set in the placement property
+        TopLoc_Location aLoc;
+        cShape.Location(aLoc);
+
+        // count triangles and nodes in the mesh
+        TopExp_Explorer Ex;
+        for (Ex.Init(cShape,TopAbs_FACE);Ex.More();Ex.Next()) {
+            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(Ex.Current()), aLoc);
+            // Note: we must also count empty faces
+            if (!mesh.IsNull()) {
+                nbrTriangles += mesh->NbTriangles();
+                nbrNodes     += mesh->NbNodes();
+                nbrNorms     += mesh->NbNodes();
+            }
+
+            TopExp_Explorer xp;
+            for (xp.Init(Ex.Current(),TopAbs_EDGE);xp.More();xp.Next())
+                faceEdges.insert(xp.Current().HashCode(INT_MAX));
+            nbrFaces++;
+        }
+
+        // get an indexed map of edges
+        TopTools_IndexedMapOfShape M;
+        TopExp::MapShapes(cShape, TopAbs_EDGE, M);
+
+        std::set<int>         edgeIdxSet;
+        std::vector<int32_t>& indxVector = visual->lineIndex;
+
+        // count and index the edges
+        for (int i=1; i <= M.Extent(); i++) {
+            edgeIdxSet.insert(i);
+            nbrEdges++;
+
+            const TopoDS_Edge& aEdge = TopoDS::Edge(M(i));
+            TopLoc_Location aLoc;
+
+            // handling of the free edge that are not associated to a face
+            // Note: The assumption that if for an edge BRep_Tool::Polygon3D
+            // returns a valid object is wrong. This e.g. happens for ruled
+            // surfaces which gets created by two edges or wires.
+            // So, we have to store the hashes of the edges associated to a face.
+            // If the hash of a given edge is not in this list we know it's really
+            // a free edge.
+            int hash = aEdge.HashCode(INT_MAX);
+            if (faceEdges.find(hash) == faceEdges.end()) {
+                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
+                if (!aPoly.IsNull()) {
+                    int nbNodesInEdge = aPoly->NbNodes();
+                    nbrNodes += nbNodesInEdge;
+                }
+            }
+        }
+        // reserve some memory
+        indxVector.reserve(nbrEdges*8);
+
+        // handling of the vertices
+        TopTools_IndexedMapOfShape V;
+        TopExp::MapShapes(cShape, TopAbs_VERTEX, V);
+        nbrNodes += V.Extent();
+
+        // create memory for the nodes and indexes, the normals are preset
+        // with the null vector
+        visual->points   .resize(nbrNodes);
+        visual->normals  .resize(nbrNorms, SbVec3f(0.0f,0.0f,0.0f));
+        visual->faceIndex.resize(nbrTriangles*4);
+        visual->partIndex.resize(nbrFaces);
+        SbVec3f* verts = nbrNodes > 0 ? &visual->points[0] : 0;
+        SbVec3f* norms = nbrNorms > 0 ? &visual->normals[0] : 0;
+        int32_t* index = nbrTriangles > 0 ? &visual->faceIndex[0] : 0;
+        std::vector<int32_t>& parts = visual->partIndex;
+
+        int ii = 0,FaceNodeOffset=0,FaceTriaOffset=0;
+        for (Ex.Init(cShape, TopAbs_FACE); Ex.More(); Ex.Next(),ii++) {
+            TopLoc_Location aLoc;
+            const TopoDS_Face &actFace = TopoDS::Face(Ex.Current());
+            // get the mesh of the shape
+            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
+            if (mesh.IsNull()) continue;
+
+            // getting the transformation of the shape/face
+            gp_Trsf myTransf;
+            Standard_Boolean identity = true;
+            if (!aLoc.IsIdentity()) {
+                identity = false;
+                myTransf = aLoc.Transformation();
+            }
+
+            // getting size of node and triangle array of this face
+            int nbNodesInFace = mesh->NbNodes();
+            int nbTriInFace   = mesh->NbTriangles();
+            // check orientation
+            TopAbs_Orientation orient = actFace.Orientation();
+
+
+            // cycling through the poly mesh
+            const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
+            const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
+            for (int g=1;g<=nbTriInFace;g++) {
+                // Get the triangle
+                Standard_Integer N1,N2,N3;
+                Triangles(g).Get(N1,N2,N3);
+
+                // change orientation of the triangle if the face is reversed
+                if ( orient != TopAbs_FORWARD ) {
+                    Standard_Integer tmp = N1;
+                    N1 = N2;
+                    N2 = tmp;
+                }
+
+                // get the 3 points of this triangle
+                gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
+
+                // transform the vertices to the place of the face
+                if (!identity) {
+                    V1.Transform(myTransf);
+                    V2.Transform(myTransf);
+                    V3.Transform(myTransf);
+                }
+                
+                // calculating per vertex normals                    
+                // Calculate triangle normal
+                gp_Vec v1(V1.X(),V1.Y(),V1.Z()),v2(V2.X(),V2.Y(),V2.Z()),v3(V3.X(),V3.Y(),V3.Z());
+                gp_Vec Normal = (v2-v1)^(v3-v1); 
+
+                // add the triangle normal to the vertex normal for all points of this triangle
+                norms[FaceNodeOffset+N1-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
+                norms[FaceNodeOffset+N2-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
+                norms[FaceNodeOffset+N3-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());                 
+
+                // set the vertices
+                verts[FaceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
+                verts[FaceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
+                verts[FaceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
+
+                // set the index vector with the 3 point indexes and the end delimiter
+                index[FaceTriaOffset*4+4*(g-1)]   = FaceNodeOffset+N1-1; 
+                index[FaceTriaOffset*4+4*(g-1)+1] = FaceNodeOffset+N2-1; 
+                index[FaceTriaOffset*4+4*(g-1)+2] = FaceNodeOffset+N3-1; 
+                index[FaceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
+            }
+
+            parts[ii] = nbTriInFace; // new part
+
+            // handling the edges lying on this face
+            TopExp_Explorer Exp;
+            for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
+                const TopoDS_Edge &actEdge = TopoDS::Edge(Exp.Current());
+                // get the overall index of this edge
+                int idx = M.FindIndex(actEdge);
+                // already processed this index ?
+                if (edgeIdxSet.find(idx)!=edgeIdxSet.end()) {
+                    
+                    // this holds the indices of the edge's triangulation to the current polygon
+                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(actEdge, mesh, aLoc);
+                    if (aPoly.IsNull())
+                        continue; // polygon does not exist
+                    
+                    // getting the indexes of the edge polygon
+                    const TColStd_Array1OfInteger& indices = aPoly->Nodes();
+                    for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
+                        int inx = indices(i);
+                        indxVector.push_back(FaceNodeOffset+inx-1);
+
+                        // usually the coordinates for this edge are already set by the
+                        // triangles of the face this edge belongs to. However, there are
+                        // rare cases where some points are only referenced by the polygon
+                        // but not by any triangle. Thus, we must apply the coordinates to
+                        // make sure that everything is properly set.
+                        gp_Pnt p(Nodes(inx));
+                        if (!identity)
+                            p.Transform(myTransf);
+                        verts[FaceNodeOffset+inx-1].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
+                    }
+                    indxVector.push_back(-1);
+
+                    // remove the handled edge index from the set
+                    edgeIdxSet.erase(idx);
+                }
+            }
+
+            // counting up the per Face offsets
+            FaceNodeOffset += nbNodesInFace;
+            FaceTriaOffset += nbTriInFace;
+        }
+
+        // handling of the free edges
+        for (int i=1; i <= M.Extent(); i++) {
+            const TopoDS_Edge& aEdge = TopoDS::Edge(M(i));
+            Standard_Boolean identity = true;
+            gp_Trsf myTransf;
+            TopLoc_Location aLoc;
+
+            // handling of the free edge that are not associated to a face
+            int hash = aEdge.HashCode(INT_MAX);
+            if (faceEdges.find(hash) == faceEdges.end()) {
+                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
+                if (!aPoly.IsNull()) {
+                    if (!aLoc.IsIdentity()) {
+                        identity = false;
+                        myTransf = aLoc.Transformation();
+                    }
+
+                    const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
+                    int nbNodesInEdge = aPoly->NbNodes();
+
+                    gp_Pnt pnt;
+                    for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
+                        pnt = aNodes(j);
+                        if (!identity)
+                            pnt.Transform(myTransf);
+                        verts[FaceNodeOffset+j-1].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+                        indxVector.push_back(FaceNodeOffset+j-1);
+                    }
+
+                    indxVector.push_back(-1);
+                    FaceNodeOffset += nbNodesInEdge;
+                }
+            }
+        }
+
+        visual->vertexStart = FaceNodeOffset;
+        for (int i=0; i<V.Extent(); i++) {
+            const TopoDS_Vertex& aVertex = TopoDS::Vertex(V(i+1));
+            gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
+            verts[FaceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
+        }
+
+        // normalize all normals 
+        for (int i = 0; i< nbrNorms ;i++)
+            norms[i].normalize();
+    }
+    catch (...) {
+        visual->failed = true;
+    }
+
+    visual->nbrFaces = nbrFaces;
+    visual->nbrEdges = nbrEdges;
+
+    // printing some informations
+    Base::Console().Log("Shape tessellation time: %f s\n",Base::TimeInfo::diffTimeF(start_time,Base::TimeInfo()));
+    Base::Console().Log("Shape tria info: Faces:%d Edges:%d Nodes:%d Triangles:%d IdxVec:%d\n",
+        nbrFaces,nbrEdges,nbrNodes,nbrTriangles,(int)visual->lineIndex.size());
+    return visual;
+}
+
+#include "moc_ShapeTessellator.cpp"
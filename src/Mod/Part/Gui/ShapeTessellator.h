@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+
+#ifndef PARTGUI_SHAPETESSELLATOR_H
+#define PARTGUI_SHAPETESSELLATOR_H
+
+#include <QObject>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <Inventor/SbVec3f.h>
+
+class TopoDS_Shape;
+
+namespace PartGui {
+
+class ViewProviderPartExt;
+
+/** The triangulation of a shape in the layout of the Coin nodes of
+ * ViewProviderPartExt. It doesn't depend on Coin nodes so that it can be
+ * computed in a worker thread.
+ */
+struct ShapeVisual
+{
+    /// the nodes of the faces, then the nodes of the free edges, then the vertices
+    std::vector<SbVec3f> points;
+    /// one normal per face node
+    std::vector<SbVec3f> normals;
+    std::vector<int32_t> faceIndex;
+    /// the number of triangles per face
+    std::vector<int32_t> partIndex;
+    std::vector<int32_t> lineIndex;
+    /// position of the first vertex in points
+    int vertexStart;
+    int nbrFaces;
+    int nbrEdges;
+    bool failed;
+
+    ShapeVisual() : vertexStart(0), nbrFaces(0), nbrEdges(0), failed(false) {}
+    std::size_t getMemSize() const;
+};
+
+typedef boost::shared_ptr<const ShapeVisual> ShapeVisualPtr;
+
+/** Computes the visuals of shapes in worker threads and keeps them in a cache.
+ * The cache is keyed by the shape without its placement and by the deviation,
+ * so moving a shape or toggling its visibility doesn't tessellate it again.
+ * A copy of the shape is tessellated because OCC stores the triangulation in
+ * the sub-shapes, which may be shared with other shapes.
+ */
+class ShapeTessellator : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ShapeTessellator& instance();
+
+    /** Returns the visual of \a shape if it is in the cache or cheap enough to
+     * be computed at once. Otherwise a null pointer is returned, the visual is
+     * computed in a worker thread and passed to ViewProviderPartExt::applyVisual()
+     * once it is ready. A pending request of \a vp is superseded.
+     */
+    ShapeVisualPtr request(ViewProviderPartExt* vp, const TopoDS_Shape& shape, double deviation);
+    /// Drops the pending request of \a vp, e.g. if it gets destroyed
+    void cancel(ViewProviderPartExt* vp);
+
+    /// Tessellates \a shape and computes its visual, can be called from any thread
+    static ShapeVisualPtr compute(const TopoDS_Shape& shape, double deviation);
+
+private Q_SLOTS:
+    void onFinished();
+
+private:
+    ShapeTessellator();
+    ~ShapeTessellator();
+
+    ShapeVisualPtr findCached(const TopoDS_Shape& shape, double deviation);
+    void addCached(const TopoDS_Shape& shape, double deviation, ShapeVisualPtr visual);
+
+private:
+    class Private;
+    Private* d;
+};
+
+} // namespace PartGui
+
+#endif // PARTGUI_SHAPETESSELLATOR_H
@@ -101,6 +101,7 @@
 #include <Gui/Control.h>
 
 #include "ViewProviderExt.h"
+#include "ShapeTessellator.h"
 #include "SoBrepShape.h"
 #include "TaskFaceColors.h"
 
@@ -196,6 +197,7 @@ ViewProviderPartExt::ViewProviderPartExt()
 
 ViewProviderPartExt::~ViewProviderPartExt()
 {
+    ShapeTessellator::instance().cancel(this);
     pcShapeBind->unref();
     pcLineMaterial->unref();
     pcPointMaterial->unref();
@@ -443,14 +445,37 @@ std::vector<Base::Vector3d> ViewProviderPartExt::getSelectionShape(const char* E
     return std::vector<Base::Vector3d>();
 }
 
+namespace {
+// The parameters are bound once for all view providers, reading them is
+// then only a member access.
+struct PartParameters
+{
+    PartParameters(ParameterGrp::handle hGrp)
+      : deviation(hGrp, "MeshDeviation", 0.2)
+      , noPerVertexNormals(hGrp, "NoPerVertexNormals", false)
+      , qualityNormals(hGrp, "QualityNormals", false)
+    {
+    }
+    Base::ParameterFloat deviation;
+    Base::ParameterBool noPerVertexNormals;
+    Base::ParameterBool qualityNormals;
+};
+
+const PartParameters& partParameters()
+{
+    static PartParameters params(App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Part"));
+    return params;
+}
+}
+
 bool ViewProviderPartExt::loadParameter()
 {
     bool changed = false;
-    ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
-        ("User parameter:BaseApp/Preferences/Mod/Part");
-    float deviation = hGrp->GetFloat("MeshDeviation",0.2);
-    bool novertexnormals = hGrp->GetBool("NoPerVertexNormals",false);
-    bool qualitynormals = hGrp->GetBool("QualityNormals",false);
+    const PartParameters& params = partParameters();
+    float deviation = params.deviation.getValue();
+    bool novertexnormals = params.noPerVertexNormals.getValue();
+    bool qualitynormals = params.qualityNormals.getValue();
 
     if (Deviation.getValue() != deviation) {
         Deviation.setValue(deviation);
@@ -537,14 +562,13 @@ void ViewProviderPartExt::unsetEdit(int ModNum)
 
 void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
 {
-    // Clear selection
-    Gui::SoSelectionElementAction action(Gui::SoSelectionElementAction::None);
-    action.apply(this->faceset);
-    action.apply(this->lineset);
-    action.apply(this->nodeset);
+    if (inputShape.IsNull()) {
+        // Clear selection
+        Gui::SoSelectionElementAction action(Gui::SoSelectionElementAction::None);
+        action.apply(this->faceset);
+        action.apply(this->lineset);
+        action.apply(this->nodeset);
 
-    TopoDS_Shape cShape(inputShape);
-    if (cShape.IsNull()) {
         coords  ->point      .setNum(0);
         norm    ->vector     .setNum(0);
         faceset ->coordIndex .setNum(0);
@@ -554,286 +578,43 @@ void ViewProviderPartExt::updateVisual(const TopoDS_Shape& inputShape)
         return;
     }
 
-    // time measurement and book keeping
-    Base::TimeInfo start_time;
-    int nbrTriangles=0,nbrNodes=0,nbrNorms=0,nbrFaces=0,nbrEdges=0,nbrLines=0;
-    std::set<int> faceEdges;
-
-    try {
-        // calculating the deflection value
-        Bnd_Box bounds;
-        BRepBndLib::Add(cShape, bounds);
-        bounds.SetGap(0.0);
-        Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
-        bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
-        Standard_Real deflection = ((xMax-xMin)+(yMax-yMin)+(zMax-zMin))/300.0 *
-            Deviation.getValue();
-
-        // create or use the mesh on the data structure
-        BRepMesh_IncrementalMesh myMesh(cShape,deflection);
-        // We must reset the location here because the transformation data
-        // are set in the placement property
-        TopLoc_Location aLoc;
-        cShape.Location(aLoc);
-
-        // count triangles and nodes in the mesh
-        TopExp_Explorer Ex;
-        for (Ex.Init(cShape,TopAbs_FACE);Ex.More();Ex.Next()) {
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(TopoDS::Face(Ex.Current()), aLoc);
-            // Note: we must also count empty faces
-            if (!mesh.IsNull()) {
-                nbrTriangles += mesh->NbTriangles();
-                nbrNodes     += mesh->NbNodes();
-                nbrNorms     += mesh->NbNodes();
-            }
-
-            TopExp_Explorer xp;
-            for (xp.Init(Ex.Current(),TopAbs_EDGE);xp.More();xp.Next())
-                faceEdges.insert(xp.Current().HashCode(INT_MAX));
-            nbrFaces++;
-        }
-
-        // get an indexed map of edges
-        TopTools_IndexedMapOfShape M;
-        TopExp::MapShapes(cShape, TopAbs_EDGE, M);
-
-        std::set<int>         edgeIdxSet;
-        std::vector<int32_t>  indxVector;
-        std::vector<int32_t>  edgeVector;
-
-        // count and index the edges
-        for (int i=1; i <= M.Extent(); i++) {
-            edgeIdxSet.insert(i);
-            nbrEdges++;
-
-            const TopoDS_Edge& aEdge = TopoDS::Edge(M(i));
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            // Note: The assumption that if for an edge BRep_Tool::Polygon3D
-            // returns a valid object is wrong. This e.g. happens for ruled
-            // surfaces which gets created by two edges or wires.
-            // So, we have to store the hashes of the edges associated to a face.
-            // If the hash of a given edge is not in this list we know it's really
-            // a free edge.
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    int nbNodesInEdge = aPoly->NbNodes();
-                    nbrNodes += nbNodesInEdge;
-                }
-            }
-        }
-        // reserve some memory
-        indxVector.reserve(nbrEdges*8);
-
-        // handling of the vertices
-        TopTools_IndexedMapOfShape V;
-        TopExp::MapShapes(cShape, TopAbs_VERTEX, V);
-        nbrNodes += V.Extent();
-
-        // create memory for the nodes and indexes
-        coords  ->point      .setNum(nbrNodes);
-        norm    ->vector     .setNum(nbrNorms);
-        faceset ->coordIndex .setNum(nbrTriangles*4);
-        faceset ->partIndex  .setNum(nbrFaces);
-        // get the raw memory for fast fill up
-        SbVec3f* verts = coords  ->point       .startEditing();
-        SbVec3f* norms = norm    ->vector      .startEditing();
-        int32_t* index = faceset ->coordIndex  .startEditing();
-        int32_t* parts = faceset ->partIndex   .startEditing();
-
-        // preset the normal vector with null vector
-        for (int i=0;i < nbrNorms;i++) 
-            norms[i]= SbVec3f(0.0,0.0,0.0);
-
-        int ii = 0,FaceNodeOffset=0,FaceTriaOffset=0;
-        for (Ex.Init(cShape, TopAbs_FACE); Ex.More(); Ex.Next(),ii++) {
-            TopLoc_Location aLoc;
-            const TopoDS_Face &actFace = TopoDS::Face(Ex.Current());
-            // get the mesh of the shape
-            Handle (Poly_Triangulation) mesh = BRep_Tool::Triangulation(actFace,aLoc);
-            if (mesh.IsNull()) continue;
-
-            // getting the transformation of the shape/face
-            gp_Trsf myTransf;
-            Standard_Boolean identity = true;
-            if (!aLoc.IsIdentity()) {
-                identity = false;
-                myTransf = aLoc.Transformation();
-            }
-
-            // getting size of node and triangle array of this face
-            int nbNodesInFace = mesh->NbNodes();
-            int nbTriInFace   = mesh->NbTriangles();
-            // check orientation
-            TopAbs_Orientation orient = actFace.Orientation();
-
-
-            // cycling through the poly mesh
-            const Poly_Array1OfTriangle& Triangles = mesh->Triangles();
-            const TColgp_Array1OfPnt& Nodes = mesh->Nodes();
-            for (int g=1;g<=nbTriInFace;g++) {
-                // Get the triangle
-                Standard_Integer N1,N2,N3;
-                Triangles(g).Get(N1,N2,N3);
-
-                // change orientation of the triangle if the face is reversed
-                if ( orient != TopAbs_FORWARD ) {
-                    Standard_Integer tmp = N1;
-                    N1 = N2;
-                    N2 = tmp;
-                }
-
-                // get the 3 points of this triangle
-                gp_Pnt V1(Nodes(N1)), V2(Nodes(N2)), V3(Nodes(N3));
-
-                // transform the vertices to the place of the face
-                if (!identity) {
-                    V1.Transform(myTransf);
-                    V2.Transform(myTransf);
-                    V3.Transform(myTransf);
-                }
-                
-                // calculating per vertex normals                    
-                // Calculate triangle normal
-                gp_Vec v1(V1.X(),V1.Y(),V1.Z()),v2(V2.X(),V2.Y(),V2.Z()),v3(V3.X(),V3.Y(),V3.Z());
-                gp_Vec Normal = (v2-v1)^(v3-v1); 
-
-                // add the triangle normal to the vertex normal for all points of this triangle
-                norms[FaceNodeOffset+N1-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-                norms[FaceNodeOffset+N2-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());
-                norms[FaceNodeOffset+N3-1] += SbVec3f(Normal.X(),Normal.Y(),Normal.Z());                 
-
-                // set the vertices
-                verts[FaceNodeOffset+N1-1].setValue((float)(V1.X()),(float)(V1.Y()),(float)(V1.Z()));
-                verts[FaceNodeOffset+N2-1].setValue((float)(V2.X()),(float)(V2.Y()),(float)(V2.Z()));
-                verts[FaceNodeOffset+N3-1].setValue((float)(V3.X()),(float)(V3.Y()),(float)(V3.Z()));
-
-                // set the index vector with the 3 point indexes and the end delimiter
-                index[FaceTriaOffset*4+4*(g-1)]   = FaceNodeOffset+N1-1; 
-                index[FaceTriaOffset*4+4*(g-1)+1] = FaceNodeOffset+N2-1; 
-                index[FaceTriaOffset*4+4*(g-1)+2] = FaceNodeOffset+N3-1; 
-                index[FaceTriaOffset*4+4*(g-1)+3] = SO_END_FACE_INDEX;
-            }
-
-            parts[ii] = nbTriInFace; // new part
-
-            // handling the edges lying on this face
-            TopExp_Explorer Exp;
-            for(Exp.Init(actFace,TopAbs_EDGE);Exp.More();Exp.Next()) {
-                const TopoDS_Edge &actEdge = TopoDS::Edge(Exp.Current());
-                // get the overall index of this edge
-                int idx = M.FindIndex(actEdge);
-                edgeVector.push_back((int32_t)idx-1);
-                // already processed this index ?
-                if (edgeIdxSet.find(idx)!=edgeIdxSet.end()) {
-                    
-                    // this holds the indices of the edge's triangulation to the current polygon
-                    Handle(Poly_PolygonOnTriangulation) aPoly = BRep_Tool::PolygonOnTriangulation(actEdge, mesh, aLoc);
-                    if (aPoly.IsNull())
-                        continue; // polygon does not exist
-                    
-                    // getting the indexes of the edge polygon
-                    const TColStd_Array1OfInteger& indices = aPoly->Nodes();
-                    for (Standard_Integer i=indices.Lower();i <= indices.Upper();i++) {
-                        int inx = indices(i);
-                        indxVector.push_back(FaceNodeOffset+inx-1);
-
-                        // usually the coordinates for this edge are already set by the
-                        // triangles of the face this edge belongs to. However, there are
-                        // rare cases where some points are only referenced by the polygon
-                        // but not by any triangle. Thus, we must apply the coordinates to
-                        // make sure that everything is properly set.
-                        gp_Pnt p(Nodes(inx));
-                        if (!identity)
-                            p.Transform(myTransf);
-                        verts[FaceNodeOffset+inx-1].setValue((float)(p.X()),(float)(p.Y()),(float)(p.Z()));
-                    }
-                    indxVector.push_back(-1);
-
-                    // remove the handled edge index from the set
-                    edgeIdxSet.erase(idx);
-                }
-            }
-
-            edgeVector.push_back(-1);
-            
-            // counting up the per Face offsets
-            FaceNodeOffset += nbNodesInFace;
-            FaceTriaOffset += nbTriInFace;
-        }
-
-        // handling of the free edges
-        for (int i=1; i <= M.Extent(); i++) {
-            const TopoDS_Edge& aEdge = TopoDS::Edge(M(i));
-            Standard_Boolean identity = true;
-            gp_Trsf myTransf;
-            TopLoc_Location aLoc;
-
-            // handling of the free edge that are not associated to a face
-            int hash = aEdge.HashCode(INT_MAX);
-            if (faceEdges.find(hash) == faceEdges.end()) {
-                Handle(Poly_Polygon3D) aPoly = BRep_Tool::Polygon3D(aEdge, aLoc);
-                if (!aPoly.IsNull()) {
-                    if (!aLoc.IsIdentity()) {
-                        identity = false;
-                        myTransf = aLoc.Transformation();
-                    }
-
-                    const TColgp_Array1OfPnt& aNodes = aPoly->Nodes();
-                    int nbNodesInEdge = aPoly->NbNodes();
-
-                    gp_Pnt pnt;
-                    for (Standard_Integer j=1;j <= nbNodesInEdge;j++) {
-                        pnt = aNodes(j);
-                        if (!identity)
-                            pnt.Transform(myTransf);
-                        verts[FaceNodeOffset+j-1].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
-                        indxVector.push_back(FaceNodeOffset+j-1);
-                    }
-
-                    indxVector.push_back(-1);
-                    FaceNodeOffset += nbNodesInEdge;
-                }
-            }
-        }
+    // a large shape is tessellated in the background and applied later
+    ShapeVisualPtr visual = ShapeTessellator::instance().request(this, inputShape, Deviation.getValue());
+    if (visual)
+        applyVisual(*visual);
+    VisualTouched = false;
+}
 
-        nodeset->startIndex.setValue(FaceNodeOffset);
-        for (int i=0; i<V.Extent(); i++) {
-            const TopoDS_Vertex& aVertex = TopoDS::Vertex(V(i+1));
-            gp_Pnt pnt = BRep_Tool::Pnt(aVertex);
-            verts[FaceNodeOffset+i].setValue((float)(pnt.X()),(float)(pnt.Y()),(float)(pnt.Z()));
-        }
+void ViewProviderPartExt::applyVisual(const ShapeVisual& visual)
+{
+    // Clear selection
+    Gui::SoSelectionElementAction action(Gui::SoSelectionElementAction::None);
+    action.apply(this->faceset);
+    action.apply(this->lineset);
+    action.apply(this->nodeset);
 
-        // normalize all normals 
-        for (int i = 0; i< nbrNorms ;i++)
-            norms[i].normalize();
-        
-        // preset the index vector size
-        nbrLines =  indxVector.size();
-        lineset ->coordIndex .setNum(nbrLines);
-        int32_t* lines = lineset ->coordIndex  .startEditing();
-
-        int l=0;
-        for (std::vector<int32_t>::const_iterator it=indxVector.begin();it!=indxVector.end();++it,l++)
-            lines[l] = *it;
-
-        // end the editing of the nodes
-        coords  ->point       .finishEditing();
-        norm    ->vector      .finishEditing();
-        faceset ->coordIndex  .finishEditing();
-        faceset ->partIndex   .finishEditing();
-        lineset ->coordIndex  .finishEditing();
-    }
-    catch (...) {
+    if (visual.failed) {
         Base::Console().Error("Cannot compute Inventor representation for the shape of %s.\n",pcObject->getNameInDocument());
+        return;
     }
 
-    // printing some informations
-    Base::Console().Log("ViewProvider update time: %f s\n",Base::TimeInfo::diffTimeF(start_time,Base::TimeInfo()));
-    Base::Console().Log("Shape tria info: Faces:%d Edges:%d Nodes:%d Triangles:%d IdxVec:%d\n",nbrFaces,nbrEdges,nbrNodes,nbrTriangles,nbrLines);
-
-    VisualTouched = false;
+    coords  ->point       .setValues(0, (int)visual.points.size(), visual.points.empty() ? 0 : &visual.points[0]);
+    coords  ->point       .setNum((int)visual.points.size());
+    norm    ->vector      .setValues(0, (int)visual.normals.size(), visual.normals.empty() ? 0 : &visual.normals[0]);
+    norm    ->vector      .setNum((int)visual.normals.size());
+    faceset ->coordIndex  .setValues(0, (int)visual.faceIndex.size(), visual.faceIndex.empty() ? 0 : &visual.faceIndex[0]);
+    faceset ->coordIndex  .setNum((int)visual.faceIndex.size());
+    faceset ->partIndex   .setValues(0, (int)visual.partIndex.size(), visual.partIndex.empty() ? 0 : &visual.partIndex[0]);
+    faceset ->partIndex   .setNum((int)visual.partIndex.size());
+    lineset ->coordIndex  .setValues(0, (int)visual.lineIndex.size(), visual.lineIndex.empty() ? 0 : &visual.lineIndex[0]);
+    lineset ->coordIndex  .setNum((int)visual.lineIndex.size());
+    nodeset ->startIndex  .setValue(visual.vertexStart);
+
+    // the per face colors can only be applied once the faces are known
+    if (DiffuseColor.getSize() > 1)
+        onChanged(&DiffuseColor);
+    if (this->faceset->partIndex.getNum() > 
+        this->pcShapeMaterial->diffuseColor.getNum()) {
+        this->pcShapeBind->value = SoMaterialBinding::OVERALL;
+    }
 }
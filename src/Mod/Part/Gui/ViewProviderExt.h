@@ -56,6 +56,8 @@ namespace PartGui {
 class SoBrepFaceSet;
 class SoBrepEdgeSet;
 class SoBrepPointSet;
+class ShapeTessellator;
+struct ShapeVisual;
 
 class PartGuiExport ViewProviderPartExt : public Gui::ViewProviderGeometryObject
 {
@@ -119,6 +121,8 @@ protected:
     virtual void onChanged(const App::Property* prop);
     bool loadParameter();
     void updateVisual(const TopoDS_Shape &);
+    /// Applies the tessellation of the shape to the Coin nodes
+    void applyVisual(const ShapeVisual &);
 
     // nodes for the data representation
     SoMaterialBinding * pcShapeBind;
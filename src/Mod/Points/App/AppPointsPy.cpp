@@ -57,7 +57,7 @@ open(PyObject *self, PyObject *args)
         if (file.extension() == "")
             Py_Error(PyExc_Exception,"no file ending");
 
-        if (file.hasExtension("asc")) {
+        if (file.hasExtension("asc") || file.hasExtension("ply")) {
             // create new document and add Import feature
             App::Document *pcDoc = App::GetApplication().newDocument("Unnamed");
             Points::Feature *pcFeature = (Points::Feature *)pcDoc->addObject("Points::Feature", file.fileNamePure().c_str());
@@ -90,7 +90,7 @@ insert(PyObject *self, PyObject *args)
         if (file.extension() == "")
             Py_Error(PyExc_Exception,"no file ending");
 
-        if (file.hasExtension("asc")) {
+        if (file.hasExtension("asc") || file.hasExtension("ply")) {
             // add Import feature
             App::Document *pcDoc = App::GetApplication().getDocument(DocName);
             if (!pcDoc) {
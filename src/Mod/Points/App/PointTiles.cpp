@@ -0,0 +1,577 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "PreCompiled.h"
+#ifndef _PreComp_
+# include <algorithm>
+# include <climits>
+# include <cmath>
+# include <cstring>
+#endif
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+
+#include "PointTiles.h"
+
+#include <Base/Exception.h>
+#include <Base/FileInfo.h>
+#include <Base/Sequencer.h>
+#include <Base/Stream.h>
+#include <App/Application.h>
+
+using namespace Points;
+
+namespace {
+
+// Layout of a tile file. As it is only a local swap file the data is stored
+// in the byte order of the machine:
+//   header:  char[8] magic, uint32 version, uint32 reserved, uint64 number of points,
+//            uint64 number of tiles, float[6] bounding box
+//   tiles:   uint64 index of first point, uint64 number of points, float[6] bounding box
+//   data:    float[3] for each point
+const char tileMagic[8] = {'F','C','T','I','L','E','S','\0'};
+const uint32_t tileVersion = 1;
+const int64_t headerSize = 8 + 4 + 4 + 8 + 8 + 6 * 4;
+const int64_t tileInfoSize = 8 + 8 + 6 * 4;
+const unsigned long chunkSize = 1024 * 1024;
+
+template <class T>
+inline void putValue(char*& p, T value)
+{
+    memcpy(p, &value, sizeof(T));
+    p += sizeof(T);
+}
+
+template <class T>
+inline T getValue(const char*& p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+inline void putBox(char*& p, const Base::BoundBox3f& box)
+{
+    putValue<float>(p, box.MinX); putValue<float>(p, box.MinY); putValue<float>(p, box.MinZ);
+    putValue<float>(p, box.MaxX); putValue<float>(p, box.MaxY); putValue<float>(p, box.MaxZ);
+}
+
+inline Base::BoundBox3f getBox(const char*& p)
+{
+    Base::BoundBox3f box;
+    box.MinX = getValue<float>(p); box.MinY = getValue<float>(p); box.MinZ = getValue<float>(p);
+    box.MaxX = getValue<float>(p); box.MaxY = getValue<float>(p); box.MaxZ = getValue<float>(p);
+    return box;
+}
+
+void writeHeader(QFile& file, unsigned long numPoints, const Base::BoundBox3f& box,
+                 const std::vector<PointTileStorage::TileInfo>& tiles)
+{
+    std::vector<char> buffer((std::size_t)(headerSize + tileInfoSize * (int64_t)tiles.size()));
+    char* p = &buffer[0];
+    memcpy(p, tileMagic, sizeof(tileMagic));
+    p += sizeof(tileMagic);
+    putValue<uint32_t>(p, tileVersion);
+    putValue<uint32_t>(p, 0);
+    putValue<uint64_t>(p, numPoints);
+    putValue<uint64_t>(p, tiles.size());
+    putBox(p, box);
+    for (std::vector<PointTileStorage::TileInfo>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+        putValue<uint64_t>(p, it->start);
+        putValue<uint64_t>(p, it->count);
+        putBox(p, it->box);
+    }
+
+    if (!file.seek(0) || file.write(&buffer[0], buffer.size()) != (qint64)buffer.size())
+        throw Base::FileException("Cannot write tile file", file.fileName().toUtf8().constData());
+}
+
+struct TileStartLess {
+    bool operator()(unsigned long index, const PointTileStorage::TileInfo& tile) const
+    { return index < tile.start; }
+};
+
+/// Simple and fast random generator to shuffle the points of a tile
+inline uint32_t xorshift(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+ParameterGrp::handle getParameter()
+{
+    return App::GetApplication().GetParameterGroupByPath
+        ("User parameter:BaseApp/Preferences/Mod/Points");
+}
+
+}
+
+PointTileStorage::PointTileStorage(const std::string& fileName, bool temporary)
+  : _fileName(fileName), _temporary(temporary), _file(0), _data(0), _mutex(new QMutex())
+  , _numPoints(0), _dataOffset(0), _cachedPoints(0)
+{
+    _file = new QFile(QString::fromUtf8(fileName.c_str()));
+    try {
+        if (!_file->open(QIODevice::ReadOnly))
+            throw Base::FileException("Cannot open tile file", fileName.c_str());
+
+        QByteArray header = _file->read(headerSize);
+        if (header.size() != headerSize || memcmp(header.constData(), tileMagic, sizeof(tileMagic)) != 0)
+            throw Base::FileException("Invalid tile file", fileName.c_str());
+        const char* p = header.constData() + sizeof(tileMagic);
+        if (getValue<uint32_t>(p) != tileVersion)
+            throw Base::FileException("Unsupported tile file version", fileName.c_str());
+        getValue<uint32_t>(p);
+        uint64_t numPoints = getValue<uint64_t>(p);
+        uint64_t numTiles = getValue<uint64_t>(p);
+        if (numPoints > ULONG_MAX || numTiles > numPoints + 1)
+            throw Base::FileException("Invalid tile file", fileName.c_str());
+        _numPoints = (unsigned long)numPoints;
+        _box = getBox(p);
+
+        QByteArray table = _file->read(tileInfoSize * (int64_t)numTiles);
+        if (table.size() != tileInfoSize * (int64_t)numTiles)
+            throw Base::FileException("Invalid tile file", fileName.c_str());
+        p = table.constData();
+        _tiles.resize((std::size_t)numTiles);
+        unsigned long next = 0;
+        for (std::vector<TileInfo>::iterator it = _tiles.begin(); it != _tiles.end(); ++it) {
+            it->start = (unsigned long)getValue<uint64_t>(p);
+            it->count = (unsigned long)getValue<uint64_t>(p);
+            it->box = getBox(p);
+            if (it->start != next || it->count > _numPoints - next)
+                throw Base::FileException("Invalid tile file", fileName.c_str());
+            next += it->count;
+        }
+        if (next != _numPoints)
+            throw Base::FileException("Invalid tile file", fileName.c_str());
+
+        _dataOffset = headerSize + tileInfoSize * (int64_t)numTiles;
+        int64_t dataSize = (int64_t)_numPoints * (int64_t)sizeof(Base::Vector3f);
+        if (_file->size() < _dataOffset + dataSize)
+            throw Base::FileException("Unexpected end of tile file", fileName.c_str());
+        // tiles are copied from the mapped file, if it cannot be mapped
+        // (e.g. lack of address space) they are read from it
+        if (dataSize > 0)
+            _data = _file->map(_dataOffset, dataSize);
+    }
+    catch (...) {
+        delete _file;
+        delete _mutex;
+        if (_temporary)
+            Base::FileInfo(_fileName).deleteFile();
+        throw;
+    }
+
+    long cacheSize = std::max<long>(1, getParameter()->GetInt("TileCacheSize", 256));
+    _maxCachedPoints = (unsigned long)(double(cacheSize) * 1024.0 * 1024.0 / sizeof(Base::Vector3f));
+}
+
+PointTileStorage::~PointTileStorage()
+{
+    if (_data)
+        _file->unmap(_data);
+    _file->close();
+    delete _file;
+    delete _mutex;
+    if (_temporary)
+        Base::FileInfo(_fileName).deleteFile();
+}
+
+unsigned long PointTileStorage::getOutOfCoreLimit()
+{
+    long limit = getParameter()->GetInt("OutOfCoreLimit", 2048);
+    if (limit <= 0)
+        return ULONG_MAX;
+    double points = double(limit) * 1024.0 * 1024.0 / sizeof(Base::Vector3f);
+    return points < double(ULONG_MAX) ? (unsigned long)points : ULONG_MAX;
+}
+
+unsigned long PointTileStorage::findTile(unsigned long index) const
+{
+    std::vector<TileInfo>::const_iterator it = std::upper_bound
+        (_tiles.begin(), _tiles.end(), index, TileStartLess());
+    return (unsigned long)(it - _tiles.begin()) - 1;
+}
+
+void PointTileStorage::readPoints(unsigned long start, unsigned long count, Base::Vector3f* points) const
+{
+    // the mutex must be locked by the caller
+    int64_t bytes = (int64_t)count * (int64_t)sizeof(Base::Vector3f);
+    if (_data) {
+        memcpy(points, _data + (int64_t)start * (int64_t)sizeof(Base::Vector3f), (std::size_t)bytes);
+        return;
+    }
+    if (!_file->seek(_dataOffset + (int64_t)start * (int64_t)sizeof(Base::Vector3f)) ||
+        _file->read(reinterpret_cast<char*>(points), bytes) != bytes)
+        throw Base::FileException("Cannot read tile file", _fileName.c_str());
+}
+
+PointTilePtr PointTileStorage::getTile(unsigned long tile) const
+{
+    QMutexLocker locker(_mutex);
+
+    // most of the time the same tile is accessed again
+    if (!_lru.empty() && _lru.front() == tile)
+        return _cache[tile].tile;
+
+    std::map<unsigned long, CacheEntry>::iterator it = _cache.find(tile);
+    if (it != _cache.end()) {
+        _lru.splice(_lru.begin(), _lru, it->second.pos);
+        return it->second.tile;
+    }
+
+    const TileInfo& info = _tiles[tile];
+    boost::shared_ptr<PointTile> points(new PointTile(info.count));
+    if (info.count > 0)
+        readPoints(info.start, info.count, &(*points)[0]);
+
+    // drop the least recently used tiles to make room for the new one
+    while (!_lru.empty() && _cachedPoints + info.count > _maxCachedPoints) {
+        unsigned long last = _lru.back();
+        _cachedPoints -= _tiles[last].count;
+        _cache.erase(last);
+        _lru.pop_back();
+    }
+
+    _lru.push_front(tile);
+    CacheEntry& entry = _cache[tile];
+    entry.tile = points;
+    entry.pos = _lru.begin();
+    _cachedPoints += info.count;
+    return entry.tile;
+}
+
+Base::Vector3f PointTileStorage::getPoint(unsigned long index) const
+{
+    unsigned long tile = findTile(index);
+    PointTilePtr points = getTile(tile);
+    return (*points)[index - _tiles[tile].start];
+}
+
+void PointTileStorage::getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points) const
+{
+    getLevelOfDetail(maxPoints, 0, points, 0);
+}
+
+void PointTileStorage::getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points,
+                                        std::vector<unsigned long>& indices) const
+{
+    getLevelOfDetail(maxPoints, 0, points, &indices);
+}
+
+void PointTileStorage::getLevelOfDetail(unsigned long maxPoints, const Base::BoundBox3f& box,
+                                        std::vector<Base::Vector3f>& points) const
+{
+    getLevelOfDetail(maxPoints, &box, points, 0);
+}
+
+void PointTileStorage::getLevelOfDetail(unsigned long maxPoints, const Base::BoundBox3f* box,
+                                        std::vector<Base::Vector3f>& points,
+                                        std::vector<unsigned long>* indices) const
+{
+    points.clear();
+    if (indices)
+        indices->clear();
+
+    std::vector<unsigned long> selection;
+    unsigned long total = 0;
+    for (unsigned long i = 0; i < _tiles.size(); i++) {
+        if (!box || (*box && _tiles[i].box)) {
+            selection.push_back(i);
+            total += _tiles[i].count;
+        }
+    }
+
+    // as the points of a tile are shuffled a prefix of each tile gives a uniform subsample
+    double ratio = (total > maxPoints) ? double(maxPoints) / double(total) : 1.0;
+    points.reserve(std::min<unsigned long>(total, maxPoints) + selection.size());
+    if (indices)
+        indices->reserve(points.capacity());
+
+    std::vector<Base::Vector3f> buffer;
+    QMutexLocker locker(_mutex);
+    for (std::vector<unsigned long>::iterator it = selection.begin(); it != selection.end(); ++it) {
+        const TileInfo& info = _tiles[*it];
+        unsigned long count = std::min<unsigned long>(info.count,
+            (unsigned long)std::ceil(double(info.count) * ratio));
+        if (count == 0)
+            continue;
+
+        const Base::Vector3f* data;
+        std::map<unsigned long, CacheEntry>::const_iterator jt = _cache.find(*it);
+        if (jt != _cache.end()) {
+            data = &(*jt->second.tile)[0];
+        }
+        else {
+            buffer.resize(count);
+            readPoints(info.start, count, &buffer[0]);
+            data = &buffer[0];
+        }
+
+        if (box && !box->IsInBox(info.box)) {
+            for (unsigned long i = 0; i < count; i++) {
+                if (box->IsInBox(data[i])) {
+                    points.push_back(data[i]);
+                    if (indices)
+                        indices->push_back(info.start + i);
+                }
+            }
+        }
+        else {
+            points.insert(points.end(), data, data + count);
+            if (indices) {
+                for (unsigned long i = 0; i < count; i++)
+                    indices->push_back(info.start + i);
+            }
+        }
+    }
+}
+
+boost::shared_ptr<PointTileStorage> PointTileStorage::transformed(const Base::Matrix4D& mat) const
+{
+    std::string fileName = Base::FileInfo::getTempFileName("PointTiles");
+    std::vector<TileInfo> tiles = _tiles;
+    Base::BoundBox3f box;
+
+    QFile file(QString::fromUtf8(fileName.c_str()));
+    try {
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            throw Base::FileException("Cannot create tile file", fileName.c_str());
+        // reserve the space of the header
+        writeHeader(file, _numPoints, box, tiles);
+
+        Base::SequencerLauncher seq("Transforming points...", (unsigned long)tiles.size());
+        std::vector<Base::Vector3f> buffer;
+        for (std::vector<TileInfo>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+            buffer.resize(it->count);
+            if (it->count > 0) {
+                QMutexLocker locker(_mutex);
+                readPoints(it->start, it->count, &buffer[0]);
+            }
+
+            it->box = Base::BoundBox3f();
+            for (std::vector<Base::Vector3f>::iterator jt = buffer.begin(); jt != buffer.end(); ++jt) {
+                *jt = mat * (*jt);
+                it->box.Add(*jt);
+            }
+            box.Add(it->box);
+
+            int64_t bytes = (int64_t)buffer.size() * (int64_t)sizeof(Base::Vector3f);
+            if (bytes > 0 && file.write(reinterpret_cast<const char*>(&buffer[0]), bytes) != bytes)
+                throw Base::FileException("Cannot write tile file", fileName.c_str());
+            seq.next(true); // allow to cancel
+        }
+
+        writeHeader(file, _numPoints, box, tiles);
+        file.close();
+    }
+    catch (...) {
+        file.close();
+        Base::FileInfo(fileName).deleteFile();
+        throw;
+    }
+
+    return boost::shared_ptr<PointTileStorage>(new PointTileStorage(fileName, true));
+}
+
+unsigned int PointTileStorage::getMemSize() const
+{
+    QMutexLocker locker(_mutex);
+    return (unsigned int)(_cachedPoints * sizeof(Base::Vector3f));
+}
+
+// ----------------------------------------------------------------------------
+
+PointTileBuilder::PointTileBuilder()
+  : _spill(0), _numPoints(0)
+{
+    _spillName = Base::FileInfo::getTempFileName("PointSpill");
+    _spill = new Base::ofstream(Base::FileInfo(_spillName), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!*_spill)
+        throw Base::FileException("Cannot create temporary file", _spillName.c_str());
+}
+
+PointTileBuilder::~PointTileBuilder()
+{
+    delete _spill;
+    Base::FileInfo(_spillName).deleteFile();
+}
+
+void PointTileBuilder::addPoints(const std::vector<Base::Vector3f>& points)
+{
+    if (!points.empty())
+        addPoints(&points[0], (unsigned long)points.size());
+}
+
+void PointTileBuilder::addPoints(const Base::Vector3f* points, unsigned long count)
+{
+    if (!_spill)
+        throw Base::Exception("Tile builder is already finished");
+    for (unsigned long i = 0; i < count; i++)
+        _box.Add(points[i]);
+    _spill->write(reinterpret_cast<const char*>(points), count * sizeof(Base::Vector3f));
+    if (!*_spill)
+        throw Base::FileException("Cannot write temporary file", _spillName.c_str());
+    _numPoints += count;
+}
+
+boost::shared_ptr<PointTileStorage> PointTileBuilder::finish(unsigned long tileSize)
+{
+    if (!_spill)
+        throw Base::Exception("Tile builder is already finished");
+    _spill->close();
+    delete _spill;
+    _spill = 0;
+
+    tileSize = std::max<unsigned long>(1, tileSize);
+
+    // choose a grid with about one cell per tile, flat dimensions get only one cell
+    double length[3] = {0.0, 0.0, 0.0};
+    if (_numPoints > 0) {
+        length[0] = _box.LengthX();
+        length[1] = _box.LengthY();
+        length[2] = _box.LengthZ();
+    }
+    double maxLength = std::max<double>(length[0], std::max<double>(length[1], length[2]));
+    double volume = 1.0;
+    int dimension = 0;
+    for (int i = 0; i < 3; i++) {
+        if (length[i] > maxLength * 1.0e-6) {
+            volume *= length[i];
+            dimension++;
+        }
+    }
+
+    double numCells = std::min<double>(double(_numPoints / tileSize) + 1.0, 4194304.0);
+    double edge = dimension > 0 ? std::pow(volume / numCells, 1.0 / dimension) : 1.0;
+    unsigned long cells[3];
+    double scale[3];
+    for (int i = 0; i < 3; i++) {
+        if (dimension > 0 && length[i] > maxLength * 1.0e-6) {
+            cells[i] = (unsigned long)std::max<double>(1.0, std::min<double>(length[i] / edge + 0.5, 65536.0));
+            scale[i] = double(cells[i]) / length[i];
+        }
+        else {
+            cells[i] = 1;
+            scale[i] = 0.0;
+        }
+    }
+
+    std::string fileName = Base::FileInfo::getTempFileName("PointTiles");
+    QFile file(QString::fromUtf8(fileName.c_str()));
+    try {
+        Base::SequencerLauncher seq("Creating point tiles...", 2 * (_numPoints / chunkSize + 1) + 1);
+        std::vector<Base::Vector3f> buffer(chunkSize);
+        std::vector<unsigned long> cellOfPoint;
+
+        // count the points of each cell
+        std::vector<unsigned long> counts(cells[0] * cells[1] * cells[2], 0);
+        Base::ifstream spill(Base::FileInfo(_spillName), std::ios::in | std::ios::binary);
+        while (spill) {
+            spill.read(reinterpret_cast<char*>(&buffer[0]), chunkSize * sizeof(Base::Vector3f));
+            unsigned long num = (unsigned long)(spill.gcount() / sizeof(Base::Vector3f));
+            for (unsigned long i = 0; i < num; i++) {
+                const Base::Vector3f& p = buffer[i];
+                unsigned long x = std::min<unsigned long>(cells[0] - 1, (unsigned long)((p.x - _box.MinX) * scale[0]));
+                unsigned long y = std::min<unsigned long>(cells[1] - 1, (unsigned long)((p.y - _box.MinY) * scale[1]));
+                unsigned long z = std::min<unsigned long>(cells[2] - 1, (unsigned long)((p.z - _box.MinZ) * scale[2]));
+                counts[x + cells[0] * (y + cells[1] * z)]++;
+            }
+            seq.next(true); // allow to cancel
+        }
+        spill.close();
+
+        // cells with too many points are split into several tiles
+        std::vector<PointTileStorage::TileInfo> tiles;
+        unsigned long start = 0;
+        for (std::vector<unsigned long>::iterator it = counts.begin(); it != counts.end(); ++it) {
+            unsigned long count = *it;
+            *it = start; // from now on the position where to write the next point of the cell
+            unsigned long parts = (count + tileSize - 1) / tileSize;
+            for (unsigned long i = 0; i < parts; i++) {
+                PointTileStorage::TileInfo info;
+                info.start = start + i * tileSize;
+                info.count = std::min<unsigned long>(tileSize, count - i * tileSize);
+                tiles.push_back(info);
+            }
+            start += count;
+        }
+
+        int64_t dataOffset = headerSize + tileInfoSize * (int64_t)tiles.size();
+        int64_t dataSize = (int64_t)_numPoints * (int64_t)sizeof(Base::Vector3f);
+        if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(dataOffset + dataSize))
+            throw Base::FileException("Cannot create tile file", fileName.c_str());
+
+        if (_numPoints > 0) {
+            Base::Vector3f* data = reinterpret_cast<Base::Vector3f*>(file.map(dataOffset, dataSize));
+            if (!data)
+                throw Base::FileException("Cannot map tile file", fileName.c_str());
+
+            // sort the points into the cells
+            Base::ifstream spill(Base::FileInfo(_spillName), std::ios::in | std::ios::binary);
+            while (spill) {
+                spill.read(reinterpret_cast<char*>(&buffer[0]), chunkSize * sizeof(Base::Vector3f));
+                unsigned long num = (unsigned long)(spill.gcount() / sizeof(Base::Vector3f));
+                for (unsigned long i = 0; i < num; i++) {
+                    const Base::Vector3f& p = buffer[i];
+                    unsigned long x = std::min<unsigned long>(cells[0] - 1, (unsigned long)((p.x - _box.MinX) * scale[0]));
+                    unsigned long y = std::min<unsigned long>(cells[1] - 1, (unsigned long)((p.y - _box.MinY) * scale[1]));
+                    unsigned long z = std::min<unsigned long>(cells[2] - 1, (unsigned long)((p.z - _box.MinZ) * scale[2]));
+                    data[counts[x + cells[0] * (y + cells[1] * z)]++] = p;
+                }
+                seq.next(true); // allow to cancel
+            }
+            spill.close();
+
+            // shuffle the points of each tile for the level-of-detail access
+            uint32_t state = 2463534242u;
+            for (std::vector<PointTileStorage::TileInfo>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+                Base::Vector3f* pts = data + it->start;
+                for (unsigned long i = it->count; i > 1; i--)
+                    std::swap(pts[i - 1], pts[xorshift(state) % i]);
+                for (unsigned long i = 0; i < it->count; i++)
+                    it->box.Add(pts[i]);
+            }
+            file.unmap(reinterpret_cast<uchar*>(data));
+        }
+        seq.next();
+
+        writeHeader(file, _numPoints, _box, tiles);
+        file.close();
+    }
+    catch (...) {
+        file.close();
+        Base::FileInfo(fileName).deleteFile();
+        throw;
+    }
+
+    Base::FileInfo(_spillName).deleteFile();
+    return boost::shared_ptr<PointTileStorage>(new PointTileStorage(fileName, true));
+}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (c) 2026 FreeCAD contributors                               *
+ *                                                                         *
+ *   This file is part of the FreeCAD CAx development system.              *
+ *                                                                         *
+ *   This library is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU Library General Public           *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2 of the License, or (at your option) any later version.      *
+ *                                                                         *
+ *   This library  is distributed in the hope that it will be useful,      *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU Library General Public License for more details.                  *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this library; see the file COPYING.LIB. If not,    *
+ *   write to the Free Software Foundation, Inc., 59 Temple Place,         *
+ *   Suite 330, Boston, MA  02111-1307, USA                                *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef POINTS_POINTTILES_H
+#define POINTS_POINTTILES_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include <Base/BoundBox.h>
+#include <Base/Matrix.h>
+#include <Base/Vector3D.h>
+
+class QFile;
+class QMutex;
+
+namespace Base {
+class ofstream;
+}
+
+namespace Points
+{
+
+typedef std::vector<Base::Vector3f> PointTile;
+typedef boost::shared_ptr<const PointTile> PointTilePtr;
+
+/** Point storage on disk for point clouds that don't fit into memory.
+ * The points are sorted into the cells of a regular grid and each cell is
+ * stored as one or more tiles of consecutive points. Tiles are paged in on
+ * demand and the most recently used ones are kept in a cache whose size is
+ * set by the parameter \a TileCacheSize (in MB).
+ * Inside a tile the points are randomly shuffled, so that the first \a n
+ * points of a tile are a uniform subsample of it which is used for the
+ * level-of-detail access.
+ * A storage is never modified after it has been created, so it can be
+ * shared between several point kernels.
+ */
+class PointsExport PointTileStorage
+{
+public:
+    struct TileInfo {
+        unsigned long start; /**< index of the first point of the tile */
+        unsigned long count; /**< number of points of the tile */
+        Base::BoundBox3f box;
+    };
+
+    /// Opens the tile file \a fileName, if \a temporary is true the file is removed when closing it
+    PointTileStorage(const std::string& fileName, bool temporary);
+    ~PointTileStorage();
+
+    const std::string& getFileName() const
+    { return _fileName; }
+    /// number of points stored
+    unsigned long size() const
+    { return _numPoints; }
+    const Base::BoundBox3f& getBoundBox() const
+    { return _box; }
+    unsigned long countTiles() const
+    { return (unsigned long)_tiles.size(); }
+    const TileInfo& getTileInfo(unsigned long tile) const
+    { return _tiles[tile]; }
+    /// the tile containing the point with index \a index
+    unsigned long findTile(unsigned long index) const;
+    /// returns the points of the tile, the tile stays valid if it gets evicted from the cache
+    PointTilePtr getTile(unsigned long tile) const;
+    Base::Vector3f getPoint(unsigned long index) const;
+    /** Returns a uniform subsample with about \a maxPoints points of all
+     * points. Only the needed part of each tile is read from disk.
+     */
+    void getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points) const;
+    /** Same as above but also returns the index of each point of the subsample,
+     * e.g. to pick the matching values of per-point properties.
+     */
+    void getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points,
+                          std::vector<unsigned long>& indices) const;
+    /** Returns a uniform subsample with about \a maxPoints points of the
+     * points inside \a box. Only tiles intersecting the box are read.
+     */
+    void getLevelOfDetail(unsigned long maxPoints, const Base::BoundBox3f& box,
+                          std::vector<Base::Vector3f>& points) const;
+    /// Writes a new storage whose points are transformed with \a mat
+    boost::shared_ptr<PointTileStorage> transformed(const Base::Matrix4D& mat) const;
+    /// memory used by the cached tiles
+    unsigned int getMemSize() const;
+
+    /// Number of points above which point clouds are kept on disk, set by the parameter \a OutOfCoreLimit (in MB)
+    static unsigned long getOutOfCoreLimit();
+
+private:
+    void readPoints(unsigned long start, unsigned long count, Base::Vector3f* points) const;
+    void getLevelOfDetail(unsigned long maxPoints, const Base::BoundBox3f* box,
+                          std::vector<Base::Vector3f>& points,
+                          std::vector<unsigned long>* indices) const;
+
+private:
+    PointTileStorage(const PointTileStorage&);
+    PointTileStorage& operator=(const PointTileStorage&);
+
+    struct CacheEntry {
+        PointTilePtr tile;
+        std::list<unsigned long>::iterator pos;
+    };
+
+    std::string _fileName;
+    bool _temporary;
+    QFile* _file;
+    // the point data mapped into memory, 0 if the file is read instead
+    unsigned char* _data;
+    QMutex* _mutex;
+    unsigned long _numPoints;
+    Base::BoundBox3f _box;
+    std::vector<TileInfo> _tiles;
+    int64_t _dataOffset;
+
+    // LRU cache with the most recently used tile at the front of the list
+    mutable std::list<unsigned long> _lru;
+    mutable std::map<unsigned long, CacheEntry> _cache;
+    mutable unsigned long _cachedPoints;
+    unsigned long _maxCachedPoints;
+};
+
+/** Creates the tile file of a point cloud.
+ * The points are added in chunks and spilled to a temporary file, so that the
+ * required memory doesn't depend on the number of points. finish() sorts them
+ * into the tiles of a new PointTileStorage.
+ */
+class PointsExport PointTileBuilder
+{
+public:
+    PointTileBuilder();
+    ~PointTileBuilder();
+
+    void addPoints(const Base::Vector3f* points, unsigned long count);
+    void addPoints(const std::vector<Base::Vector3f>& points);
+    unsigned long size() const
+    { return _numPoints; }
+    /// Creates the tile storage with a temporary tile file. Tiles have at most \a tileSize points.
+    boost::shared_ptr<PointTileStorage> finish(unsigned long tileSize = 65536);
+
+private:
+    PointTileBuilder(const PointTileBuilder&);
+    PointTileBuilder& operator=(const PointTileBuilder&);
+
+    std::string _spillName;
+    Base::ofstream* _spill;
+    unsigned long _numPoints;
+    Base::BoundBox3f _box;
+};
+
+} // namespace Points
+
+
+#endif // POINTS_POINTTILES_H
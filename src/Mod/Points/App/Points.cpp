@@ -25,6 +25,7 @@
 #ifndef _PreComp_
 # include <math.h>
 # include <iostream>
+# include <algorithm>
 #endif
 
 #include <Base/Exception.h>
@@ -70,6 +71,12 @@ Data::Segment* PointKernel::getSubElement(const char* Type, unsigned long n) con
 
 void PointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
+    if (_Tiles) {
+        // the storage may be shared with other kernels, so write a new one
+        _Tiles = _Tiles->transformed(rclMat);
+        return;
+    }
+
     std::vector<Base::Vector3f>& kernel = getBasicPoints();
     for (std::vector<Base::Vector3f>::iterator it = kernel.begin(); it != kernel.end(); ++it)
         *it = rclMat * (*it);
@@ -78,6 +85,19 @@ void PointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 Base::BoundBox3d PointKernel::getBoundBox(void)const
 {
     Base::BoundBox3d bnd;
+    if (_Tiles) {
+        // use the bounding boxes of the tiles instead of reading in all points,
+        // with a rotation the box of their transformed corners is too large
+        for (unsigned long i = 0; i < _Tiles->countTiles(); i++) {
+            const Base::BoundBox3f& box = _Tiles->getTileInfo(i).box;
+            if (box.IsValid()) {
+                Base::BoundBox3f tbox = box.Transformed(_Mtrx);
+                bnd.Add(Base::BoundBox3d(tbox.MinX, tbox.MinY, tbox.MinZ, tbox.MaxX, tbox.MaxY, tbox.MaxZ));
+            }
+        }
+        return bnd;
+    }
+
     for (const_point_iterator it = begin(); it != end(); ++it)
         bnd.Add(*it);
     return bnd;
@@ -89,14 +109,91 @@ void PointKernel::operator = (const PointKernel& Kernel)
         // copy the mesh structure
         setTransform(Kernel._Mtrx);
         this->_Points = Kernel._Points;
+        // the tile storage is read-only and thus can be shared
+        this->_Tiles = Kernel._Tiles;
     }
 }
 
 unsigned int PointKernel::getMemSize (void) const
 {
+    if (_Tiles)
+        return _Tiles->getMemSize();
     return _Points.size() * sizeof(Base::Vector3f);
 }
 
+void PointKernel::setTiles(const boost::shared_ptr<PointTileStorage>& tiles)
+{
+    std::vector<Base::Vector3f>().swap(_Points);
+    _Tiles = tiles;
+}
+
+void PointKernel::makeResident()
+{
+    boost::shared_ptr<PointTileStorage> tiles = _Tiles;
+    _Tiles.reset();
+    _Points.clear();
+    _Points.reserve(tiles->size());
+    for (unsigned long i = 0; i < tiles->countTiles(); i++) {
+        PointTilePtr tile = tiles->getTile(i);
+        _Points.insert(_Points.end(), tile->begin(), tile->end());
+    }
+}
+
+std::vector<Base::Vector3f>& PointKernel::getBasicPoints()
+{
+    if (_Tiles)
+        throw Base::Exception("Point cloud is out-of-core, load it with makeResident() first");
+    return this->_Points;
+}
+
+void PointKernel::getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points) const
+{
+    getLevelOfDetail(maxPoints, points, 0);
+}
+
+void PointKernel::getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points,
+                                   std::vector<unsigned long>& indices) const
+{
+    getLevelOfDetail(maxPoints, points, &indices);
+}
+
+void PointKernel::getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points,
+                                   std::vector<unsigned long>* indices) const
+{
+    if (_Tiles) {
+        if (indices)
+            _Tiles->getLevelOfDetail(maxPoints, points, *indices);
+        else
+            _Tiles->getLevelOfDetail(maxPoints, points);
+        return;
+    }
+
+    points.clear();
+    if (indices)
+        indices->clear();
+    unsigned long count = (unsigned long)_Points.size();
+    if (count <= maxPoints) {
+        points = _Points;
+        if (indices) {
+            indices->reserve(count);
+            for (unsigned long i = 0; i < count; i++)
+                indices->push_back(i);
+        }
+    }
+    else if (maxPoints > 0) {
+        double step = double(count) / double(maxPoints);
+        points.reserve(maxPoints);
+        if (indices)
+            indices->reserve(maxPoints);
+        for (unsigned long i = 0; i < maxPoints; i++) {
+            unsigned long index = (unsigned long)(double(i) * step);
+            points.push_back(_Points[index]);
+            if (indices)
+                indices->push_back(index);
+        }
+    }
+}
+
 void PointKernel::Save (Base::Writer &writer) const
 {
     if (!writer.isForceXML()) {
@@ -112,9 +209,19 @@ void PointKernel::SaveDocFile (Base::Writer &writer) const
     uint32_t uCt = (uint32_t)size();
     str << uCt;
     // store the data without transforming it and save as float, not double
-    for (std::vector<Base::Vector3f>::const_iterator it = _Points.begin(); it != _Points.end(); ++it) {
-        str << it->x << it->y << it->z;
+    if (_Tiles) {
+        // write tile by tile, so only one tile at a time must be held in memory
+        for (unsigned long i = 0; i < _Tiles->countTiles(); i++) {
+            PointTilePtr tile = _Tiles->getTile(i);
+            if (!tile->empty())
+                str.write(&(*tile)[0].x, 3 * tile->size());
+        }
+        return;
     }
+
+    // a Base::Vector3f consists of three consecutive floats
+    if (!_Points.empty())
+        str.write(&_Points[0].x, 3 * _Points.size());
 }
 
 void PointKernel::Restore(Base::XMLReader &reader)
@@ -139,18 +246,30 @@ void PointKernel::RestoreDocFile(Base::Reader &reader)
     Base::InputStream str(reader);
     uint32_t uCt = 0;
     str >> uCt;
-    _Points.resize(uCt);
-    for (unsigned long i=0; i < uCt; i++) {
-        float x, y, z;
-        str >> x >> y >> z;
-        _Points[i].Set(x,y,z);
+
+    if (uCt > PointTileStorage::getOutOfCoreLimit()) {
+        // too many points to keep them in memory
+        clear();
+        PointTileBuilder builder;
+        std::vector<Base::Vector3f> chunk;
+        for (unsigned long i=0; i < uCt; i += chunk.size()) {
+            chunk.resize(std::min<unsigned long>(uCt - i, 1024 * 1024));
+            str.read(&chunk[0].x, 3 * chunk.size());
+            builder.addPoints(chunk);
+        }
+        setTiles(builder.finish());
+        return;
     }
+
+    _Tiles.reset();
+    _Points.resize(uCt);
+    if (uCt > 0)
+        str.read(&_Points[0].x, 3 * _Points.size());
 }
 
 void PointKernel::save(const char* file) const
 {
-    //MeshCore::MeshOutput aWriter(_kernel);
-    //aWriter.SaveAny(file);
+    PointsAlgos::Save(*this,file);
 }
 
 void PointKernel::load(const char* file) 
@@ -166,7 +285,7 @@ void PointKernel::save(std::ostream& out) const
 void PointKernel::getFaces(std::vector<Base::Vector3d> &Points,std::vector<Facet> &Topo,
                            float Accuracy, uint16_t flags) const
 {
-    unsigned long ctpoints = _Points.size();
+    unsigned long ctpoints = size();
     Points.reserve(ctpoints);
     for (unsigned long i=0; i<ctpoints; i++) {
         Points.push_back(this->getPoint(i));
@@ -176,19 +295,15 @@ void PointKernel::getFaces(std::vector<Base::Vector3d> &Points,std::vector<Facet
 // ----------------------------------------------------------------------------
 
 PointKernel::const_point_iterator::const_point_iterator
-(const PointKernel* kernel, std::vector<Base::Vector3f>::const_iterator index)
-  : _kernel(kernel), _p_it(index)
+(const PointKernel* kernel, size_type index)
+  : _kernel(kernel), _index(index), _tileBegin(0), _tileEnd(0)
 {
-    if(_p_it != kernel->_Points.end())
-    {
-        Base::Vector3d vertd(_p_it->x, _p_it->y, _p_it->z);
-        this->_point = _kernel->_Mtrx * vertd;
-    }
 }
 
 PointKernel::const_point_iterator::const_point_iterator
 (const PointKernel::const_point_iterator& fi)
-  : _kernel(fi._kernel), _point(fi._point), _p_it(fi._p_it)
+  : _kernel(fi._kernel), _point(fi._point), _index(fi._index)
+  , _tile(fi._tile), _tileBegin(fi._tileBegin), _tileEnd(fi._tileEnd)
 {
 }
 
@@ -201,13 +316,33 @@ PointKernel::const_point_iterator::operator=(const PointKernel::const_point_iter
 {
     this->_kernel  = pi._kernel;
     this->_point = pi._point;
-    this->_p_it  = pi._p_it;
+    this->_index = pi._index;
+    this->_tile = pi._tile;
+    this->_tileBegin = pi._tileBegin;
+    this->_tileEnd = pi._tileEnd;
     return *this;
 }
 
 void PointKernel::const_point_iterator::dereference()
 {
-    Base::Vector3d vertd(_p_it->x, _p_it->y, _p_it->z);
+    const Base::Vector3f* vert;
+    const boost::shared_ptr<PointTileStorage>& tiles = _kernel->_Tiles;
+    if (tiles) {
+        // page in the tile of the point only when leaving the current one
+        if (!_tile || _index < _tileBegin || _index >= _tileEnd) {
+            unsigned long tile = tiles->findTile(_index);
+            const PointTileStorage::TileInfo& info = tiles->getTileInfo(tile);
+            _tile = tiles->getTile(tile);
+            _tileBegin = info.start;
+            _tileEnd = info.start + info.count;
+        }
+        vert = &(*_tile)[_index - _tileBegin];
+    }
+    else {
+        vert = &_kernel->_Points[_index];
+    }
+
+    Base::Vector3d vertd(vert->x, vert->y, vert->z);
     this->_point = _kernel->_Mtrx * vertd;
 }
 
@@ -225,7 +360,7 @@ const Base::Vector3d* PointKernel::const_point_iterator::operator->()
 
 bool PointKernel::const_point_iterator::operator==(const PointKernel::const_point_iterator& pi) const
 {
-    return (this->_kernel == pi._kernel) && (this->_p_it == pi._p_it);
+    return (this->_kernel == pi._kernel) && (this->_index == pi._index);
 }
 
 bool PointKernel::const_point_iterator::operator!=(const PointKernel::const_point_iterator& pi) const
@@ -236,7 +371,7 @@ bool PointKernel::const_point_iterator::operator!=(const PointKernel::const_poin
 PointKernel::const_point_iterator&
 PointKernel::const_point_iterator::operator++()
 {
-    ++(this->_p_it);
+    ++(this->_index);
     return *this;
 }
 
@@ -244,14 +379,14 @@ PointKernel::const_point_iterator
 PointKernel::const_point_iterator::operator++(int)
 {
     PointKernel::const_point_iterator tmp = *this;
-    ++(this->_p_it);
+    ++(this->_index);
     return tmp;
 }
 
 PointKernel::const_point_iterator&
 PointKernel::const_point_iterator::operator--()
 {
-    --(this->_p_it);
+    --(this->_index);
     return *this;
 }
 
@@ -259,7 +394,7 @@ PointKernel::const_point_iterator
 PointKernel::const_point_iterator::operator--(int)
 {
     PointKernel::const_point_iterator tmp = *this;
-    --(this->_p_it);
+    --(this->_index);
     return tmp;
 }
 
@@ -280,19 +415,19 @@ PointKernel::const_point_iterator::operator- (difference_type off) const
 PointKernel::const_point_iterator&
 PointKernel::const_point_iterator::operator+=(difference_type off)
 {
-    (this->_p_it) += off;
+    (this->_index) += off;
     return *this;
 }
 
 PointKernel::const_point_iterator&
 PointKernel::const_point_iterator::operator-=(difference_type off)
 {
-    (this->_p_it) -= off;
+    (this->_index) -= off;
     return *this;
 }
 
 PointKernel::difference_type
 PointKernel::const_point_iterator::operator- (const PointKernel::const_point_iterator& right) const
 {
-    return this->_p_it - right._p_it;
+    return (difference_type)this->_index - (difference_type)right._index;
 }
@@ -35,11 +35,16 @@
 #include <App/PropertyStandard.h>
 #include <App/PropertyGeo.h>
 
+#include "PointTiles.h"
+
 namespace Points
 {
 
 
 /** Point kernel
+ * The points are either kept in memory or, for point clouds that don't fit
+ * into memory, in a PointTileStorage on disk. The out-of-core storage is
+ * read-only, functions modifying single points load all points into memory.
  */
 class PointsExport PointKernel : public Data::ComplexGeoData
 {
@@ -73,14 +78,23 @@ public:
 
     inline void setTransform(const Base::Matrix4D& rclTrf){_Mtrx = rclTrf;}
     inline Base::Matrix4D getTransform(void) const{return _Mtrx;}
-    std::vector<Base::Vector3f>& getBasicPoints()
-    { return this->_Points; }
+    /** the modifiable points, for an out-of-core kernel makeResident() must be
+     * called before, otherwise an exception is thrown
+     */
+    std::vector<Base::Vector3f>& getBasicPoints();
+    /// the points kept in memory, this is empty for an out-of-core kernel
     const std::vector<Base::Vector3f>& getBasicPoints() const
     { return this->_Points; }
     void getFaces(std::vector<Base::Vector3d> &Points,std::vector<Facet> &Topo,
         float Accuracy, uint16_t flags=0) const;
 
     virtual void transformGeometry(const Base::Matrix4D &rclMat);
+    /** Returns the bounding box of the transformed points.
+     * For an out-of-core kernel it is built from the transformed corners of the
+     * tile boxes, so that no points must be read. If the placement rotates the
+     * points the box may therefore be larger than the exact one, but it always
+     * contains all points.
+     */
     virtual Base::BoundBox3d getBoundBox(void)const;
 
     /** @name I/O */
@@ -91,55 +105,81 @@ public:
     void SaveDocFile (Base::Writer &writer) const;
     void Restore(Base::XMLReader &reader);
     void RestoreDocFile(Base::Reader &reader);
+    bool canSaveDocFileInThread() const {return true;}
     void save(const char* file) const;
     void save(std::ostream&) const;
     void load(const char* file);
     void load(std::istream&);
     //@}
 
+    /** @name Out-of-core storage */
+    //@{
+    /// replaces the points with the points of the tile storage
+    void setTiles(const boost::shared_ptr<PointTileStorage>&);
+    const boost::shared_ptr<PointTileStorage>& getTiles() const
+    { return this->_Tiles; }
+    bool isOutOfCore() const
+    { return this->_Tiles.get() != 0; }
+    /// loads the points of an out-of-core kernel into memory
+    void makeResident();
+    /** Returns a uniform subsample with about \a maxPoints untransformed points
+     * which is meant for visualization and quick inspection of large clouds.
+     */
+    void getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points) const;
+    /// Same as above but also returns the index of each point of the subsample
+    void getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points,
+                          std::vector<unsigned long>& indices) const;
+    //@}
+
 private:
+    void getLevelOfDetail(unsigned long maxPoints, std::vector<Base::Vector3f>& points,
+                          std::vector<unsigned long>* indices) const;
+
     Base::Matrix4D _Mtrx;
     std::vector<Base::Vector3f> _Points;
+    boost::shared_ptr<PointTileStorage> _Tiles;
 
 public:
     typedef std::vector<Base::Vector3f>::difference_type difference_type;
     typedef std::vector<Base::Vector3f>::size_type size_type;
 
     /// number of points stored 
-    size_type size(void) const {return this->_Points.size();}
-    void resize(unsigned int n){_Points.resize(n);}
-    void reserve(unsigned int n){_Points.reserve(n);}
+    size_type size(void) const {return _Tiles ? _Tiles->size() : this->_Points.size();}
+    void resize(unsigned int n){if (_Tiles) makeResident(); _Points.resize(n);}
+    void reserve(unsigned int n){if (_Tiles) makeResident(); _Points.reserve(n);}
     inline void erase(unsigned long first, unsigned long last) {
+        if (_Tiles) makeResident();
         _Points.erase(_Points.begin()+first,_Points.begin()+last);
     }
 
-    void clear(void){_Points.clear();}
+    void clear(void){_Points.clear(); _Tiles.reset();}
 
 
     /// get the points
     inline const Base::Vector3d getPoint(const int idx) const {
-        return transformToOutside(_Points[idx]);
+        return transformToOutside(_Tiles ? _Tiles->getPoint(idx) : _Points[idx]);
     }
     /// set the points
     inline void setPoint(const int idx,const Base::Vector3d& point) {
+        if (_Tiles) makeResident();
         _Points[idx] = transformToInside(point);
     }
     /// insert the points
     inline void push_back(const Base::Vector3d& point) {
+        if (_Tiles) makeResident();
         _Points.push_back(transformToInside(point));
     }
 
     class PointsExport const_point_iterator
     {
     public:
-        typedef std::vector<Base::Vector3f>::const_iterator iter_type;
-        typedef iter_type::difference_type difference_type;
-        typedef iter_type::iterator_category iterator_category;
+        typedef PointKernel::difference_type difference_type;
+        typedef std::random_access_iterator_tag iterator_category;
         typedef const Base::Vector3d* pointer;
         typedef const Base::Vector3d& reference;
         typedef Base::Vector3d value_type;
 
-        const_point_iterator(const PointKernel*, std::vector<Base::Vector3f>::const_iterator index);
+        const_point_iterator(const PointKernel*, size_type index);
         const_point_iterator(const const_point_iterator& pi);
         //~const_point_iterator();
 
@@ -161,7 +201,10 @@ public:
         void dereference();
         const PointKernel* _kernel;
         Base::Vector3d _point;
-        std::vector<Base::Vector3f>::const_iterator _p_it;
+        size_type _index;
+        // for an out-of-core kernel the tile of the current point is kept
+        PointTilePtr _tile;
+        size_type _tileBegin, _tileEnd;
     };
 
     typedef const_point_iterator const_iterator;
@@ -170,9 +213,9 @@ public:
     /** @name Iterator */
     //@{
     const_point_iterator begin() const
-    { return const_point_iterator(this, _Points.begin()); }
+    { return const_point_iterator(this, 0); }
     const_point_iterator end() const
-    { return const_point_iterator(this, _Points.end()); }
+    { return const_point_iterator(this, size()); }
     const_reverse_iterator rbegin() const
     { return const_reverse_iterator(end()); }
     const_reverse_iterator rend() const
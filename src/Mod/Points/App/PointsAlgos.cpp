@@ -26,23 +26,173 @@
 #ifdef FC_OS_LINUX
 # include <unistd.h>
 #endif
+# include <algorithm>
+# include <cmath>
+# include <cstring>
 # include <sstream>
 #endif
 
+#include <QFile>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "PointsAlgos.h"
 #include "Points.h"
+#include "PointTiles.h"
 
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
+#include <Base/PlyTypes.h>
 #include <Base/Console.h>
 #include <Base/Sequencer.h>
 #include <Base/Stream.h>
-
-#include <boost/regex.hpp>
+#include <Base/Swap.h>
 
 using namespace Points;
 
+namespace {
+
+typedef std::pair<const char*, const char*> Block;
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/** Parses a floating point number in the format [+-][digits][.digits][(e|E)[+-]digits]
+ * starting at \a p. A decimal point must be followed by a digit, so e.g. "5." is
+ * rejected. On success \a p points behind the number.
+ * This is much faster than strtod or a stream as it doesn't depend on the locale.
+ */
+bool parseNumber(const char*& p, const char* end, double& value)
+{
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char* s = p;
+    bool negative = false;
+    if (s < end && (*s == '+' || *s == '-')) {
+        negative = (*s == '-');
+        s++;
+    }
+
+    double mantissa = 0.0;
+    int digits = 0;
+    int exponent = 0;
+    while (s < end && isDigit(*s)) {
+        mantissa = mantissa * 10.0 + (*s - '0');
+        digits++;
+        s++;
+    }
+    if (s < end && *s == '.') {
+        s++;
+        if (s >= end || !isDigit(*s))
+            return false;
+        while (s < end && isDigit(*s)) {
+            mantissa = mantissa * 10.0 + (*s - '0');
+            exponent--;
+            digits++;
+            s++;
+        }
+    }
+    if (digits == 0)
+        return false;
+
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negExp = false;
+        if (e < end && (*e == '+' || *e == '-')) {
+            negExp = (*e == '-');
+            e++;
+        }
+        if (e >= end || !isDigit(*e))
+            return false;
+        int exp = 0;
+        while (e < end && isDigit(*e)) {
+            if (exp < 10000)
+                exp = exp * 10 + (*e - '0');
+            e++;
+        }
+        exponent += negExp ? -exp : exp;
+        s = e;
+    }
+
+    if (exponent < 0)
+        value = (exponent >= -22) ? mantissa / pow10[-exponent] : mantissa * std::pow(10.0, exponent);
+    else
+        value = (exponent <= 22) ? mantissa * pow10[exponent] : mantissa * std::pow(10.0, exponent);
+    if (negative)
+        value = -value;
+    p = s;
+    return true;
+}
+
+/** Parses all lines of the block with exactly three coordinates. All other lines
+ * e.g. comments are ignored. The points are transformed with \a mat.
+ */
+std::vector<Base::Vector3f> parseAsciiBlock(const Block& block, const Base::Matrix4D& mat)
+{
+    std::vector<Base::Vector3f> pts;
+    const char* p = block.first;
+    const char* end = block.second;
+    pts.reserve((end - p) / 24);
+
+    double coord[3];
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol)
+            eol = end;
+
+        const char* s = p;
+        bool ok = true;
+        for (int i = 0; i < 3 && ok; i++) {
+            const char* start = s;
+            while (s < eol && isBlank(*s))
+                s++;
+            // the coordinates must be separated by white spaces
+            if (i > 0 && s == start)
+                ok = false;
+            else
+                ok = parseNumber(s, eol, coord[i]);
+        }
+        if (ok) {
+            while (s < eol && isBlank(*s))
+                s++;
+            ok = (s == eol);
+        }
+        if (ok) {
+            Base::Vector3d pt = mat * Base::Vector3d(coord[0], coord[1], coord[2]);
+            pts.push_back(Base::Vector3f((float)pt.x, (float)pt.y, (float)pt.z));
+        }
+
+        p = eol + 1;
+    }
+
+    return pts;
+}
+
+/// Appends the points to the kernel or, when loading out-of-core, to the tile builder
+void appendPoints(std::vector<Base::Vector3f>& kernel, PointTileBuilder* tiles,
+                  const std::vector<Base::Vector3f>& pts)
+{
+    if (tiles)
+        tiles->addPoints(pts);
+    else
+        kernel.insert(kernel.end(), pts.begin(), pts.end());
+}
+
+}
+
 void PointsAlgos::Load(PointKernel &points, const char *FileName)
 {
     Base::FileInfo File(FileName);
@@ -51,63 +201,308 @@ void PointsAlgos::Load(PointKernel &points, const char *FileName)
     if (!File.isReadable())
         throw Base::FileException("File to load not existing or not readable", FileName);
 
-    if (File.extension() == "asc" ||File.extension() == "ASC")
+    if (File.hasExtension("asc"))
         LoadAscii(points,FileName);
+    else if (File.hasExtension("ply"))
+        LoadPly(points,FileName);
     else
         throw Base::Exception("Unknown ending");
 }
 
 void PointsAlgos::LoadAscii(PointKernel &points, const char *FileName)
 {
-    boost::regex rx("^\\s*([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)"
-                     "\\s+([-+]?[0-9]*)\\.?([0-9]+([eE][-+]?[0-9]+)?)\\s*$");
-    //boost::regex rx("(\\b[0-9]+\\.([0-9]+\\b)?|\\.[0-9]+\\b)");
-    //boost::regex rx("^\\s*(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s+(-?[0-9]*)\\.([0-9]+)\\s*$");
-    boost::cmatch what;
-
-    Base::Vector3d pt;
-    int LineCnt=0;
-    std::string line;
     Base::FileInfo fi(FileName);
+    Base::ifstream file(fi, std::ios::in | std::ios::binary);
+
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    // The file is read in blocks which are split at line ends into one chunk per thread.
+    // So, the needed memory apart from the points doesn't depend on the file size.
+    const std::size_t chunkSize = 4 * 1024 * 1024;
+    std::size_t numThreads = (std::size_t)std::max<int>(1, QThread::idealThreadCount());
+    std::size_t blockSize = numThreads * chunkSize;
+
+    // the points are stored untransformed
+    Base::Matrix4D mat = points.getTransform();
+    mat.inverse();
+
+    points.clear();
+    std::vector<Base::Vector3f>& kernel = points.getBasicPoints();
+    boost::scoped_ptr<PointTileBuilder> tiles;
+    Base::SequencerLauncher seq("Loading points...", (unsigned long)(fileSize / blockSize) + 1);
+
+    try {
+        std::vector<char> buffer;
+        bool firstBlock = true;
+        while (file) {
+            // the buffer still contains the incomplete last line of the previous block
+            std::size_t carry = buffer.size();
+            buffer.resize(carry + blockSize);
+            file.read(&buffer[carry], blockSize);
+            buffer.resize(carry + (std::size_t)file.gcount());
+            if (buffer.empty())
+                break;
+
+            const char* begin = &buffer[0];
+            const char* end = begin + buffer.size();
+            const char* last = end;
+            if (file) {
+                // not yet at the end of the file, so parse only complete lines
+                while (last > begin && *(last - 1) != '\n')
+                    last--;
+            }
 
-    Base::ifstream tmp_str(fi, std::ios::in);
+            std::vector<Block> chunks;
+            const char* p = begin;
+            while (p < last) {
+                const char* q = std::min<const char*>(p + chunkSize, last);
+                if (q < last) {
+                    q = static_cast<const char*>(memchr(q, '\n', last - q));
+                    q = q ? q + 1 : last;
+                }
+                chunks.push_back(Block(p, q));
+                p = q;
+            }
+
+            if (chunks.size() > 1) {
+                QFuture< std::vector<Base::Vector3f> > future = QtConcurrent::mapped
+                    (chunks, boost::bind(&parseAsciiBlock, _1, mat));
+                future.waitForFinished();
+                for (QFuture< std::vector<Base::Vector3f> >::const_iterator it = future.begin(); it != future.end(); ++it)
+                    appendPoints(kernel, tiles.get(), *it);
+            }
+            else if (chunks.size() == 1) {
+                appendPoints(kernel, tiles.get(), parseAsciiBlock(chunks.front(), mat));
+            }
 
-    // estimating size
-    while (std::getline(tmp_str,line))
-        LineCnt++;
+            // estimate the number of points from the first block to avoid reallocations
+            if (firstBlock && last > begin && fileSize > 0) {
+                double ratio = double(fileSize) / double(last - begin);
+                double estimate = double(kernel.size()) * ratio * 1.05;
+                if (estimate > double(PointTileStorage::getOutOfCoreLimit())) {
+                    // the points don't fit into memory, so sort them into tiles on disk
+                    tiles.reset(new PointTileBuilder());
+                    tiles->addPoints(kernel);
+                    std::vector<Base::Vector3f>().swap(kernel);
+                }
+                else {
+                    kernel.reserve((std::size_t)estimate);
+                }
+                firstBlock = false;
+            }
+
+            buffer.erase(buffer.begin(), buffer.begin() + (last - begin));
+            seq.next(true); // allow to cancel
+        }
+
+        if (tiles)
+            points.setTiles(tiles->finish());
+    }
+    catch (...) {
+        points.clear();
+        throw Base::Exception("Reading in points failed.");
+    }
+}
+
+void PointsAlgos::LoadPly(PointKernel &points, const char *FileName)
+{
+    QFile file(QString::fromUtf8(FileName));
+    if (!file.open(QIODevice::ReadOnly))
+        throw Base::FileException("Cannot open file", FileName);
+    std::size_t size = (std::size_t)file.size();
+    const char* data = size > 0 ? reinterpret_cast<const char*>(file.map(0, file.size())) : 0;
+    if (!data)
+        throw Base::FileException("Cannot map file", FileName);
+    const char* end = data + size;
+
+    if (size < 4 || strncmp(data, "ply", 3) != 0)
+        throw Base::FileException("Not a PLY file", FileName);
+    const char* tag = "end_header";
+    const char* body = std::search(data, end, tag, tag + strlen(tag));
+    body = std::find(body, end, '\n');
+    if (body == end)
+        throw Base::FileException("Invalid PLY header", FileName);
+    body++;
+
+    // parse the header, the vertex element must be the first element
+    std::istringstream header(std::string(data, body));
+    std::string line;
+    bool swap = false, format = false, vertex = false;
+    unsigned long count = 0;
+    std::size_t stride = 0;
+    std::size_t offset[3] = {0, 0, 0};
+    Base::PlyType types[3] = {Base::PlyNone, Base::PlyNone, Base::PlyNone};
+    while (std::getline(header, line)) {
+        std::istringstream str(line);
+        std::string kw;
+        str >> kw;
+        if (kw == "format") {
+            std::string fmt;
+            str >> fmt;
+            if (fmt == "binary_little_endian")
+                swap = !Base::isLittleEndian();
+            else if (fmt == "binary_big_endian")
+                swap = Base::isLittleEndian();
+            else
+                throw Base::FileException("Only binary PLY files are supported", FileName);
+            format = true;
+        }
+        else if (kw == "element") {
+            std::string name;
+            str >> name;
+            if (!vertex && name == "vertex") {
+                str >> count;
+                vertex = true;
+            }
+            else if (!vertex) {
+                throw Base::FileException("No vertex element at the beginning of the PLY file", FileName);
+            }
+            else {
+                break; // the following elements are not needed
+            }
+        }
+        else if (kw == "property" && vertex) {
+            std::string type, name;
+            str >> type >> name;
+            Base::PlyType t = Base::plyType(type);
+            if (t == Base::PlyNone)
+                throw Base::FileException("Unsupported property in PLY file", FileName);
+            int index = (name == "x") ? 0 : (name == "y") ? 1 : (name == "z") ? 2 : -1;
+            if (index >= 0) {
+                offset[index] = stride;
+                types[index] = t;
+            }
+            stride += Base::plySize(t);
+        }
+    }
 
-    // resize the PointKernel
-    points.resize(LineCnt);
+    if (!format || !vertex || types[0] == Base::PlyNone || types[1] == Base::PlyNone || types[2] == Base::PlyNone)
+        throw Base::FileException("Invalid PLY header", FileName);
+    if (count > std::size_t(end - body) / stride)
+        throw Base::FileException("Unexpected end of PLY file", FileName);
 
-    Base::SequencerLauncher seq( "Loading points...", LineCnt );
+    Base::Matrix4D mat = points.getTransform();
+    mat.inverse();
+    bool identity = (mat == Base::Matrix4D());
+    bool rawFloats = !swap && types[0] == Base::PlyFloat32 && types[1] == Base::PlyFloat32 && types[2] == Base::PlyFloat32 &&
+                     offset[1] == offset[0] + 4 && offset[2] == offset[1] + 4;
 
-    // again to the beginning
-    Base::ifstream file(fi, std::ios::in);
-    LineCnt = 0;
+    // copy the points in chunks to report the progress
+    const unsigned long chunkSize = 1024 * 1024;
+    points.clear();
+    std::vector<Base::Vector3f>& kernel = points.getBasicPoints();
+    std::vector<Base::Vector3f> chunk;
+    boost::scoped_ptr<PointTileBuilder> tiles;
+    if (count > PointTileStorage::getOutOfCoreLimit()) {
+        // the points don't fit into memory, so sort them into tiles on disk
+        tiles.reset(new PointTileBuilder());
+        chunk.resize(chunkSize);
+    }
+    else {
+        kernel.resize(count);
+    }
 
+    Base::SequencerLauncher seq("Loading points...", count / chunkSize + 1);
     try {
-        // read file
-        while (std::getline(file, line)) {
-            if (boost::regex_match(line.c_str(), what, rx)) {
-                pt.x = std::atof(what[1].first);
-                pt.y = std::atof(what[4].first);
-                pt.z = std::atof(what[7].first);
-
-                points.setPoint(LineCnt,pt);
-                seq.next();
-                LineCnt++;
+        const char* record = body;
+        for (unsigned long start = 0; start < count; start += chunkSize) {
+            unsigned long stop = std::min<unsigned long>(count, start + chunkSize);
+            Base::Vector3f* dest = tiles ? &chunk[0] : &kernel[start];
+            for (unsigned long i = start; i < stop; i++, record += stride) {
+                Base::Vector3f& pt = dest[i - start];
+                if (rawFloats && identity) {
+                    memcpy(&pt.x, record + offset[0], 3 * sizeof(float));
+                }
+                else {
+                    Base::Vector3d pd(Base::readPly(types[0], record + offset[0], swap),
+                                      Base::readPly(types[1], record + offset[1], swap),
+                                      Base::readPly(types[2], record + offset[2], swap));
+                    if (!identity)
+                        pd = mat * pd;
+                    pt.Set((float)pd.x, (float)pd.y, (float)pd.z);
+                }
             }
+            if (tiles)
+                tiles->addPoints(&chunk[0], stop - start);
+            seq.next(true); // allow to cancel
         }
+
+        if (tiles)
+            points.setTiles(tiles->finish());
     }
     catch (...) {
         points.clear();
         throw Base::Exception("Reading in points failed.");
     }
+}
 
-    // now remove the last points from the kernel
-    // Note: first we allocate memory corresponding to the number of lines (points and comments)
-    //       and read in the file twice. But then the size of the kernel is too high
-    if (LineCnt < (int)points.size())
-        points.erase(LineCnt, points.size());
+void PointsAlgos::Save(const PointKernel &points, const char *FileName)
+{
+    Base::FileInfo File(FileName);
+
+    if (File.hasExtension("asc"))
+        SaveAscii(points,FileName);
+    else if (File.hasExtension("ply"))
+        SavePly(points,FileName);
+    else
+        throw Base::Exception("Unknown ending");
+}
+
+void PointsAlgos::SavePly(const PointKernel &points, const char *FileName)
+{
+    Base::FileInfo fi(FileName);
+    Base::ofstream file(fi, std::ios::out | std::ios::binary);
+    if (!file)
+        throw Base::FileException("Cannot open file", FileName);
+
+    unsigned long count = points.size();
+    file << "ply\n"
+         << "format binary_little_endian 1.0\n"
+         << "comment FreeCAD point cloud\n"
+         << "element vertex " << count << "\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "property float z\n"
+         << "end_header\n";
+
+    // write the points in chunks to report the progress
+    const unsigned long chunkSize = 1024 * 1024;
+    bool swap = !Base::isLittleEndian();
+    std::vector<float> buffer;
+    buffer.reserve(3 * std::min<unsigned long>(count, chunkSize));
+    Base::SequencerLauncher seq("Saving points...", count / chunkSize + 1);
+    PointKernel::const_point_iterator it = points.begin();
+    for (unsigned long start = 0; start < count; start += chunkSize) {
+        unsigned long stop = std::min<unsigned long>(count, start + chunkSize);
+        buffer.clear();
+        for (unsigned long i = start; i < stop; i++, ++it) {
+            buffer.push_back((float)it->x);
+            buffer.push_back((float)it->y);
+            buffer.push_back((float)it->z);
+        }
+        if (swap) {
+            for (std::vector<float>::iterator jt = buffer.begin(); jt != buffer.end(); ++jt)
+                Base::SwapEndian<float>(*jt);
+        }
+        file.write(reinterpret_cast<const char*>(&buffer[0]), buffer.size() * sizeof(float));
+        seq.next();
+    }
+}
+
+void PointsAlgos::SaveAscii(const PointKernel &points, const char *FileName)
+{
+    Base::FileInfo fi(FileName);
+    Base::ofstream file(fi, std::ios::out | std::ios::binary);
+    if (!file)
+        throw Base::FileException("Cannot open file", FileName);
+
+    file.precision(9);
+    unsigned long count = points.size();
+    Base::SequencerLauncher seq("Saving points...", count);
+    for (PointKernel::const_point_iterator it = points.begin(); it != points.end(); ++it) {
+        file << it->x << " " << it->y << " " << it->z << "\n";
+        seq.next();
+    }
 }
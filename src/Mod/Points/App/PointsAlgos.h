@@ -40,7 +40,20 @@ public:
   /** Load a point cloud
    */
   static void LoadAscii(PointKernel&, const char *FileName);
+  /** Load a point cloud from a PLY file in binary format. The file is
+   * memory-mapped and the vertices are copied in chunks into the kernel.
+   */
+  static void LoadPly(PointKernel&, const char *FileName);
 
+  /** Save a point cloud
+   */
+  static void Save(const PointKernel&, const char *FileName);
+  /** Save a point cloud as binary PLY file (little endian floats)
+   */
+  static void SavePly(const PointKernel&, const char *FileName);
+  /** Save a point cloud as ASCII file with one point per line
+   */
+  static void SaveAscii(const PointKernel&, const char *FileName);
 };
 
 } // namespace Points
@@ -42,22 +42,45 @@ using namespace Points;
 TYPESYSTEM_SOURCE(Points::PropertyPointKernel , App::PropertyComplexGeoData);
 
 PropertyPointKernel::PropertyPointKernel()
-    : _cPoints(new PointKernel())
+    : _cPoints(new PointKernel()), pointsPyObject(0)
 {
 
 }
 
 PropertyPointKernel::~PropertyPointKernel()
 {
+    if (pointsPyObject)
+        Py_DECREF(pointsPyObject);
 }
 
 void PropertyPointKernel::setValue(const PointKernel& m)
 {
     aboutToSetValue();
+    detachPoints(false);
     *_cPoints = m;
     hasSetValue();
 }
 
+void PropertyPointKernel::detachPoints(bool copyPoints)
+{
+    if (_cPoints.getRefCount() > 1) {
+        PointKernel* kernel = new PointKernel();
+        if (copyPoints)
+            *kernel = *_cPoints;
+        else
+            kernel->setTransform(_cPoints->getTransform());
+        setPointKernel(kernel);
+    }
+}
+
+void PropertyPointKernel::setPointKernel(PointKernel* kernel)
+{
+    _cPoints = kernel;
+    // the Python wrapper must refer to the point kernel of this property
+    if (pointsPyObject)
+        pointsPyObject->_pcTwinPointer = kernel;
+}
+
 const PointKernel& PropertyPointKernel::getValue(void) const 
 {
     return *_cPoints;
@@ -70,10 +93,7 @@ const Data::ComplexGeoData* PropertyPointKernel::getComplexData() const
 
 Base::BoundBox3d PropertyPointKernel::getBoundingBox() const
 {
-    Base::BoundBox3d box;
-    for (PointKernel::const_iterator it = _cPoints->begin(); it != _cPoints->end(); ++it)
-        box.Add(*it);
-    return box;
+    return _cPoints->getBoundBox();
 }
 
 void PropertyPointKernel::getFaces(std::vector<Base::Vector3d> &Points,
@@ -85,9 +105,13 @@ void PropertyPointKernel::getFaces(std::vector<Base::Vector3d> &Points,
 
 PyObject *PropertyPointKernel::getPyObject(void)
 {
-    PointsPy* points = new PointsPy(&*_cPoints);
-    points->setConst(); // set immutable
-    return points;
+    if (!pointsPyObject) {
+        pointsPyObject = new PointsPy(&*_cPoints);
+        pointsPyObject->setConst(); // set immutable
+    }
+
+    Py_INCREF(pointsPyObject);
+    return pointsPyObject;
 }
 
 void PropertyPointKernel::setPyObject(PyObject *value)
@@ -124,6 +148,7 @@ void PropertyPointKernel::Restore(Base::XMLReader &reader)
         mtrx.fromString(Matrix);
 
         aboutToSetValue();
+        detachPoints();
         _cPoints->setTransform(mtrx);
         hasSetValue();
     }
@@ -137,28 +162,38 @@ void PropertyPointKernel::SaveDocFile (Base::Writer &writer) const
 void PropertyPointKernel::RestoreDocFile(Base::Reader &reader)
 {
     aboutToSetValue();
+    detachPoints(false);
     _cPoints->RestoreDocFile(reader);
     hasSetValue();
 }
 
 App::Property *PropertyPointKernel::Copy(void) const 
 {
+    // Note: Reference the same point kernel, the property that gets modified
+    // first creates its own copy (see detachPoints())
     PropertyPointKernel* prop = new PropertyPointKernel();
-    (*prop->_cPoints) = (*this->_cPoints);
+    prop->_cPoints = this->_cPoints;
     return prop;
 }
 
 void PropertyPointKernel::Paste(const App::Property &from)
 {
+    // Note: Reference the same point kernel, see Copy()
+    Base::Reference<PointKernel> tmp(_cPoints);
     aboutToSetValue();
     const PropertyPointKernel& prop = dynamic_cast<const PropertyPointKernel&>(from);
-    *(this->_cPoints) = *(prop._cPoints);
+    setPointKernel(prop._cPoints);
     hasSetValue();
 }
 
 unsigned int PropertyPointKernel::getMemSize (void) const
 {
-    return sizeof(Base::Vector3f) * this->_cPoints->size();
+    return this->_cPoints->getMemSize();
+}
+
+const void* PropertyPointKernel::getSharedData(void) const
+{
+    return (PointKernel*)_cPoints;
 }
 
 void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndices )
@@ -192,6 +227,13 @@ void PropertyPointKernel::removeIndices( const std::vector<unsigned long>& uIndi
 void PropertyPointKernel::transformGeometry(const Base::Matrix4D &rclMat)
 {
     aboutToSetValue();
+    detachPoints();
     _cPoints->transformGeometry(rclMat);
     hasSetValue();
 }
+
+void PropertyPointKernel::setTransform(const Base::Matrix4D &rclTrf)
+{
+    detachPoints();
+    _cPoints->setTransform(rclTrf);
+}
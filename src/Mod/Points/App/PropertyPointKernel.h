@@ -29,6 +29,8 @@
 namespace Points
 {
 
+class PointsPy;
+
 /** The point kernel property
  */
 class PointsExport PropertyPointKernel : public App::PropertyComplexGeoData
@@ -71,6 +73,7 @@ public:
     /// paste the value from the property (mainly for Undo/Redo and transactions)
     void Paste(const App::Property &from);
     unsigned int getMemSize (void) const;
+    const void* getSharedData(void) const;
     //@}
 
     /** @name Save/restore */
@@ -85,11 +88,21 @@ public:
     //@{
     /// Transform the real 3d point kernel
     void transformGeometry(const Base::Matrix4D &rclMat);
+    /** Sets the placement of the points without notifying the container, a point
+     * kernel shared with a copy of this property gets detached first.
+     */
+    void setTransform(const Base::Matrix4D &rclTrf);
     void removeIndices( const std::vector<unsigned long>& );
     //@}
 
+private:
+    /// Gives this property its own point kernel if it is shared with a copy
+    void detachPoints(bool copyPoints=true);
+    void setPointKernel(PointKernel*);
+
 private:
     Base::Reference<PointKernel> _cPoints;
+    PointsPy* pointsPyObject;
 };
 
 } // namespace Points
@@ -69,7 +69,7 @@ CmdPointsImport::CmdPointsImport()
 void CmdPointsImport::activated(int iMsg)
 {
   QString fn = Gui::FileDialog::getOpenFileName(Gui::getMainWindow(),
-      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;All Files (*.*)"));
+      QString::null, QString(), QObject::tr("Ascii Points (*.asc);;Binary PLY Points (*.ply);;All Files (*.*)"));
   if ( fn.isEmpty() )
     return;
 
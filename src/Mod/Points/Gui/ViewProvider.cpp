@@ -27,6 +27,7 @@
 # ifdef FC_OS_WIN32
 #  include <windows.h>
 # endif
+# include <algorithm>
 # include <Inventor/nodes/SoCamera.h>
 # include <Inventor/nodes/SoCoordinate3.h>
 # include <Inventor/nodes/SoDrawStyle.h>
@@ -67,7 +68,7 @@ PROPERTY_SOURCE(PointsGui::ViewProviderPoints, Gui::ViewProviderGeometryObject)
 
 App::PropertyFloatConstraint::Constraints ViewProviderPoints::floatRange = {1.0f,64.0f,1.0f};
 
-ViewProviderPoints::ViewProviderPoints()
+ViewProviderPoints::ViewProviderPoints() : numCloudPoints(0)
 {
     ADD_PROPERTY(PointSize,(2.0f));
     PointSize.setConstraints(&floatRange);
@@ -109,14 +110,15 @@ void ViewProviderPoints::onChanged(const App::Property* prop)
 void ViewProviderPoints::setVertexColorMode(App::PropertyColorList* pcProperty)
 {
     const std::vector<App::Color>& val = pcProperty->getValues();
-    unsigned long i=0;
+    unsigned long num = lodIndices.empty() ? val.size() : lodIndices.size();
 
     pcColorMat->enableNotify(false);
     pcColorMat->diffuseColor.deleteValues(0);
-    pcColorMat->diffuseColor.setNum(val.size());
+    pcColorMat->diffuseColor.setNum(num);
 
-    for ( std::vector<App::Color>::const_iterator it = val.begin(); it != val.end(); ++it ) {
-        pcColorMat->diffuseColor.set1Value(i++, SbColor(it->r, it->g, it->b));
+    for ( unsigned long i=0; i<num; i++ ) {
+        const App::Color& c = val[valueIndex(i)];
+        pcColorMat->diffuseColor.set1Value(i, SbColor(c.r, c.g, c.b));
     }
 
     pcColorMat->enableNotify(true);
@@ -126,14 +128,15 @@ void ViewProviderPoints::setVertexColorMode(App::PropertyColorList* pcProperty)
 void ViewProviderPoints::setVertexGreyvalueMode(Points::PropertyGreyValueList* pcProperty)
 {
     const std::vector<float>& val = pcProperty->getValues();
-    unsigned long i=0;
+    unsigned long num = lodIndices.empty() ? val.size() : lodIndices.size();
 
     pcColorMat->enableNotify(false);
     pcColorMat->diffuseColor.deleteValues(0);
-    pcColorMat->diffuseColor.setNum(val.size());
+    pcColorMat->diffuseColor.setNum(num);
 
-    for ( std::vector<float>::const_iterator it = val.begin(); it != val.end(); ++it ) {
-        pcColorMat->diffuseColor.set1Value(i++, SbColor(*it, *it, *it));
+    for ( unsigned long i=0; i<num; i++ ) {
+        float g = val[valueIndex(i)];
+        pcColorMat->diffuseColor.set1Value(i, SbColor(g, g, g));
     }
 
     pcColorMat->enableNotify(true);
@@ -143,14 +146,15 @@ void ViewProviderPoints::setVertexGreyvalueMode(Points::PropertyGreyValueList* p
 void ViewProviderPoints::setVertexNormalMode(Points::PropertyNormalList* pcProperty)
 {
     const std::vector<Base::Vector3f>& val = pcProperty->getValues();
-    unsigned long i=0;
+    unsigned long num = lodIndices.empty() ? val.size() : lodIndices.size();
 
     pcPointsNormal->enableNotify(false);
     pcPointsNormal->vector.deleteValues(0);
-    pcPointsNormal->vector.setNum(val.size());
+    pcPointsNormal->vector.setNum(num);
 
-    for ( std::vector<Base::Vector3f>::const_iterator it = val.begin(); it != val.end(); ++it ) {
-        pcPointsNormal->vector.set1Value(i++, it->x, it->y, it->z);
+    for ( unsigned long i=0; i<num; i++ ) {
+        const Base::Vector3f& n = val[valueIndex(i)];
+        pcPointsNormal->vector.set1Value(i, n.x, n.y, n.z);
     }
 
     pcPointsNormal->enableNotify(true);
@@ -197,7 +201,8 @@ void ViewProviderPoints::attach(App::DocumentObject* pcObj)
 
 void ViewProviderPoints::setDisplayMode(const char* ModeName)
 {
-  int numPoints = pcPointsCoord->point.getNum();
+  // the values of the per-point properties belong to all points of the cloud
+  int numPoints = (int)numCloudPoints;
 
   if ( strcmp("Color",ModeName)==0 )
   {
@@ -312,7 +317,8 @@ void ViewProviderPoints::updateData(const App::Property* prop)
     Gui::ViewProviderGeometryObject::updateData(prop);
     if (prop->getTypeId() == Points::PropertyPointKernel::getClassTypeId()) {
         ViewProviderPointsBuilder builder;
-        builder.createPoints(prop, pcPointsCoord, pcPoints);
+        builder.createPoints(prop, pcPointsCoord, pcPoints, &lodIndices);
+        numCloudPoints = static_cast<const Points::PropertyPointKernel*>(prop)->getValue().size();
 
         // The number of points might have changed, so force also a resize of the Inventor internals
         setActiveMode();
@@ -457,24 +463,37 @@ void ViewProviderPointsBuilder::buildNodes(const App::Property* prop, std::vecto
         createPoints(prop, pcPointsCoord, pcPoints);
 }
 
-void ViewProviderPointsBuilder::createPoints(const App::Property* prop, SoCoordinate3* coords, SoPointSet* points) const
+void ViewProviderPointsBuilder::createPoints(const App::Property* prop, SoCoordinate3* coords, SoPointSet* points,
+                                             std::vector<unsigned long>* indices) const
 {
     const Points::PropertyPointKernel* prop_points = static_cast<const Points::PropertyPointKernel*>(prop);
     const Points::PointKernel& cPts = prop_points->getValue();
 
+    // an out-of-core point cloud is too big to display, so show a subsample of it
+    std::vector<Base::Vector3f> lod;
+    std::vector<unsigned long> lodIndices;
+    if (cPts.isOutOfCore()) {
+        ParameterGrp::handle hGrp = App::GetApplication().GetParameterGroupByPath
+            ("User parameter:BaseApp/Preferences/Mod/Points");
+        unsigned long maxPoints = (unsigned long)std::max<long>(1, hGrp->GetInt("MaxDisplayPoints", 5000000));
+        cPts.getLevelOfDetail(maxPoints, lod, lodIndices);
+    }
+    if (indices)
+        indices->swap(lodIndices);
+    const std::vector<Base::Vector3f>& kernel = cPts.isOutOfCore() ? lod : cPts.getBasicPoints();
+
     // disable the notification, otherwise whenever a point is inserted SoPointSet gets notified
     coords->enableNotify(false);
     coords->point.deleteValues(0);
-    coords->point.setNum(cPts.size());
+    coords->point.setNum(kernel.size());
 
     // get all points
     int idx=0;
-    const std::vector<Base::Vector3f>& kernel = cPts.getBasicPoints();
     for (std::vector<Base::Vector3f>::const_iterator it = kernel.begin(); it != kernel.end(); ++it, idx++) {
         coords->point.set1Value(idx, it->x, it->y, it->z);
     }
 
-    points->numPoints = cPts.size();
+    points->numPoints = kernel.size();
     coords->enableNotify(true);
     coords->touch();
 }
@@ -60,7 +60,11 @@ public:
     ViewProviderPointsBuilder(){}
     ~ViewProviderPointsBuilder(){}
     virtual void buildNodes(const App::Property*, std::vector<SoNode*>&) const;
-    void createPoints(const App::Property*, SoCoordinate3*, SoPointSet*) const;
+    /** Creates the points. If only a subsample of an out-of-core point cloud is
+     * shown \a indices gets the indices of the shown points, otherwise it's cleared.
+     */
+    void createPoints(const App::Property*, SoCoordinate3*, SoPointSet*,
+                      std::vector<unsigned long>* indices = 0) const;
 };
 
 /**
@@ -114,6 +118,14 @@ protected:
     SoDrawStyle       *pcPointStyle;
 
 private:
+    /// index of the point value that belongs to the i-th shown point
+    unsigned long valueIndex(unsigned long i) const
+    { return lodIndices.empty() ? i : lodIndices[i]; }
+
+private:
+    // indices of the shown points if only a subsample of the cloud is shown
+    std::vector<unsigned long> lodIndices;
+    unsigned long numCloudPoints;
     static App::PropertyFloatConstraint::Constraints floatRange;
 };
 
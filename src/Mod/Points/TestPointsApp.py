@@ -0,0 +1,279 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, os, tempfile, unittest, random, struct, Points
+
+
+#---------------------------------------------------------------------------
+# define the functions to test the FreeCAD Points module
+#---------------------------------------------------------------------------
+
+def makeCloud(count):
+    return Points.Points([(float(i), float(i % 7), float(i % 13)) for i in range(count)])
+
+def pointTuples(cloud):
+    return [(v.x, v.y, v.z) for v in cloud.Points]
+
+# Undo/redo of point features
+
+class PointsUndoTestCases(unittest.TestCase):
+    def setUp(self):
+        self.doc = FreeCAD.newDocument("PointsUndoTest")
+        self.doc.UndoMode = 1
+        self.feature = self.doc.addObject("Points::Feature","Points")
+        self.feature.Points = makeCloud(10000)
+
+    def testUndoReplace(self):
+        # the undo copy shares the points until they get replaced
+        wrapper = self.feature.Points
+        self.doc.openTransaction("Replace")
+        self.feature.Points = makeCloud(10)
+        self.doc.commitTransaction()
+        self.failUnless(wrapper.CountPoints == 10)
+        replaced = self.doc.UndoRedoMemSize
+        self.failUnless(replaced >= 10000 * 12)
+        self.doc.undo()
+        self.failUnless(self.feature.Points.CountPoints == 10000)
+        self.failUnless(wrapper.CountPoints == 10000)
+        # the redo copy is the small cloud only
+        self.failUnless(self.doc.UndoRedoMemSize < replaced)
+        self.doc.redo()
+        self.failUnless(self.feature.Points.CountPoints == 10)
+
+    def testUndoPlacement(self):
+        # moving the feature must not move the points kept for undo
+        self.doc.openTransaction("Replace")
+        self.feature.Points = makeCloud(100)
+        self.doc.commitTransaction()
+        self.doc.openTransaction("Move")
+        self.feature.Placement = FreeCAD.Placement(FreeCAD.Vector(0,0,10), FreeCAD.Rotation())
+        self.doc.commitTransaction()
+        self.failUnless(self.feature.Points.Points[5].z == 15.0)
+        self.doc.undo()
+        self.failUnless(self.feature.Points.Points[5].z == 5.0)
+        self.doc.undo()
+        self.failUnless(self.feature.Points.CountPoints == 10000)
+        self.failUnless(self.feature.Points.Points[5].z == 5.0)
+        self.doc.redo()
+        self.doc.redo()
+        self.failUnless(self.feature.Points.Points[5].z == 15.0)
+
+    def tearDown(self):
+        FreeCAD.closeDocument("PointsUndoTest")
+
+# Reading and writing of ASCII and PLY files
+
+class PointsFileTestCases(unittest.TestCase):
+    def setUp(self):
+        self.files = []
+
+    def fileName(self, ext):
+        self.files.append(os.path.join(tempfile.gettempdir(), "PointsFileTest%d.%s" % (len(self.files), ext)))
+        return self.files[-1]
+
+    def readFile(self, ext, content):
+        fileName = self.fileName(ext)
+        f = open(fileName, "wb")
+        f.write(content)
+        f.close()
+        cloud = Points.Points()
+        cloud.read(fileName)
+        return cloud
+
+    def checkPoints(self, cloud, points):
+        self.failUnless(cloud.CountPoints == len(points))
+        for v, p in zip(cloud.Points, points):
+            self.failUnless(abs(v.x - p[0]) < 1e-6 and abs(v.y - p[1]) < 1e-6 and abs(v.z - p[2]) < 1e-6,
+                "Point (%f, %f, %f) instead of (%f, %f, %f)" % (v.x, v.y, v.z, p[0], p[1], p[2]))
+
+    def testRoundTrip(self):
+        rnd = random.Random(3)
+        cloud = Points.Points([(rnd.uniform(-1e3,1e3), rnd.uniform(-1,1), rnd.uniform(-1e-3,1e-3)) for i in range(1000)])
+        cloud.addPoints([(0.0, -0.0, 1e-30), (3.0e30, -1.5, 0.1)])
+        for ext in ["asc", "ply"]:
+            fileName = self.fileName(ext)
+            cloud.write(fileName)
+            copy = Points.Points()
+            copy.read(fileName)
+            # single precision values must be kept exactly
+            self.failUnless(copy.CountPoints == cloud.CountPoints)
+            self.failUnless(pointTuples(copy) == pointTuples(cloud), "Points differ after reading '%s'" % fileName)
+
+    def testRoundTripEmpty(self):
+        fileName = self.fileName("asc")
+        Points.Points().write(fileName)
+        cloud = Points.Points()
+        cloud.read(fileName)
+        self.failUnless(cloud.CountPoints == 0)
+
+    def testAsciiLines(self):
+        content = "# comment\r\n" \
+                  "1 2 3\r\n" \
+                  "  4.5\t5.5 6.5  \n" \
+                  "\n" \
+                  "5. 1 2\n" \
+                  "1.5x 2 3\n" \
+                  "1,5 2 3\n" \
+                  "7 8\n" \
+                  "1 2 3 4\n" \
+                  "1e 2 3\n" \
+                  "-.5 +1e2 3E-1\n" \
+                  "# 1 2 3\n" \
+                  "9 10 11"
+        cloud = self.readFile("asc", content)
+        self.checkPoints(cloud, [(1,2,3), (4.5,5.5,6.5), (-0.5,100,0.3), (9,10,11)])
+
+    def testAsciiNoPoints(self):
+        cloud = self.readFile("asc", "# only a comment\r\nx y z")
+        self.failUnless(cloud.CountPoints == 0)
+
+    def testPlyProperties(self):
+        # more properties than the coordinates, a CRLF header with comments and
+        # a further element after the vertices
+        header = "ply\r\n" \
+                 "format binary_little_endian 1.0\r\n" \
+                 "comment made by hand\r\n" \
+                 "element vertex 3\r\n" \
+                 "property double x\r\n" \
+                 "property float y\r\n" \
+                 "property uchar flag\r\n" \
+                 "property float z\r\n" \
+                 "element face 0\r\n" \
+                 "property list uchar int vertex_indices\r\n" \
+                 "end_header\r\n"
+        points = [(1.0,2.0,3.0), (-4.5,0.25,6.0), (7.0,8.0,-9.5)]
+        body = "".join([struct.pack("<dfBf", p[0], p[1], 255, p[2]) for p in points])
+        self.checkPoints(self.readFile("ply", header + body), points)
+
+    def testPlyBigEndian(self):
+        header = "ply\nformat binary_big_endian 1.0\nelement vertex 2\n" \
+                 "property float x\nproperty float y\nproperty float z\nend_header\n"
+        points = [(1.0,2.0,3.0), (-4.5,0.25,6.0)]
+        body = "".join([struct.pack(">fff", p[0], p[1], p[2]) for p in points])
+        self.checkPoints(self.readFile("ply", header + body), points)
+
+    def testPlyInvalid(self):
+        header = "ply\nformat %s 1.0\nelement vertex %d\n" \
+                 "property float x\nproperty float y\nproperty %s z\nend_header\n"
+        body = struct.pack("<fff", 1.0, 2.0, 3.0)
+        # ASCII PLY files are not supported
+        self.assertRaises(Exception, self.readFile, "ply", header % ("ascii", 1, "float") + "1 2 3\n")
+        # more vertices than data
+        self.assertRaises(Exception, self.readFile, "ply", header % ("binary_little_endian", 2, "float") + body)
+        # unknown property type
+        self.assertRaises(Exception, self.readFile, "ply", header % ("binary_little_endian", 1, "real") + body)
+        # no header end
+        self.assertRaises(Exception, self.readFile, "ply", "ply\nformat binary_little_endian 1.0\n")
+
+    def tearDown(self):
+        for fileName in self.files:
+            if os.path.exists(fileName):
+                os.remove(fileName)
+
+# Point clouds kept on disk
+
+def sortedPoints(cloud):
+    pts = pointTuples(cloud)
+    pts.sort()
+    return pts
+
+class PointsOutOfCoreTestCases(unittest.TestCase):
+    def setUp(self):
+        rnd = random.Random(7)
+        cloud = Points.Points([(rnd.random(), 2.0 * rnd.random(), 3.0 * rnd.random()) for i in range(120000)])
+        self.files = []
+        for ext in ["ply", "asc"]:
+            self.files.append(os.path.join(tempfile.gettempdir(), "PointsOutOfCore." + ext))
+            cloud.write(self.files[-1])
+        self.inCore = Points.Points()
+        self.inCore.read(self.files[0])
+        self.reference = sortedPoints(self.inCore)
+        # 1 MB are about 87000 points, so the cloud is kept in several tiles
+        # on disk and only some of them fit into the cache
+        self.param = FreeCAD.ParamGet("User parameter:BaseApp/Preferences/Mod/Points")
+        self.param.SetInt("OutOfCoreLimit", 1)
+        self.param.SetInt("TileCacheSize", 1)
+
+    def checkCloud(self, cloud):
+        self.failUnless(cloud.CountPoints == len(self.reference))
+        # the points are sorted into tiles, so only the sorted points match
+        self.failUnless(sortedPoints(cloud) == self.reference)
+        box = cloud.BoundBox
+        ref = self.inCore.BoundBox
+        self.failUnless(box.XMin == ref.XMin and box.YMin == ref.YMin and box.ZMin == ref.ZMin)
+        self.failUnless(box.XMax == ref.XMax and box.YMax == ref.YMax and box.ZMax == ref.ZMax)
+
+    def testReadPly(self):
+        cloud = Points.Points()
+        cloud.read(self.files[0])
+        self.checkCloud(cloud)
+
+    def testReadAscii(self):
+        cloud = Points.Points()
+        cloud.read(self.files[1])
+        self.inCore = Points.Points()
+        self.param.RemInt("OutOfCoreLimit")
+        self.inCore.read(self.files[1])
+        self.reference = sortedPoints(self.inCore)
+        self.checkCloud(cloud)
+
+    def testRestore(self):
+        doc = FreeCAD.newDocument("PointsOutOfCoreTest")
+        feature = doc.addObject("Points::Feature","Points")
+        feature.Points = self.inCore
+        fileName = os.path.join(tempfile.gettempdir(), "PointsOutOfCoreTest.FCStd")
+        self.files.append(fileName)
+        doc.saveAs(fileName)
+        FreeCAD.closeDocument(doc.Name)
+        doc = FreeCAD.openDocument(fileName)
+        try:
+            self.checkCloud(doc.getObject("Points").Points)
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+
+    def testBoundBoxRotated(self):
+        # the box of a rotated cloud on disk may be larger but must contain all points
+        doc = FreeCAD.newDocument("PointsOutOfCoreTest")
+        try:
+            feature = doc.addObject("Points::Feature","Points")
+            cloud = Points.Points()
+            cloud.read(self.files[0])
+            feature.Points = cloud
+            feature.Placement = FreeCAD.Placement(FreeCAD.Vector(), FreeCAD.Rotation(FreeCAD.Vector(1,1,1), 30))
+            box = feature.Points.BoundBox
+            pts = feature.Points.Points
+            self.failUnless(len(pts) == len(self.reference))
+            eps = 1e-5
+            for p in pts:
+                self.failUnless(box.XMin - eps <= p.x <= box.XMax + eps)
+                self.failUnless(box.YMin - eps <= p.y <= box.YMax + eps)
+                self.failUnless(box.ZMin - eps <= p.z <= box.ZMax + eps)
+        finally:
+            FreeCAD.closeDocument(doc.Name)
+
+    def tearDown(self):
+        self.param.RemInt("OutOfCoreLimit")
+        self.param.RemInt("TileCacheSize")
+        for fileName in self.files:
+            if os.path.exists(fileName):
+                os.remove(fileName)
@@ -33,6 +33,7 @@
 #include <Base/PyObjectBase.h>
 #include <Base/Exception.h>
 #include <Base/FileInfo.h>
+#include <Base/VectorPy.h>
 #include <App/Application.h>
 #include <App/Document.h>
 
@@ -41,6 +42,9 @@
 #include <Mod/Part/App/TopoShapePy.h>
 
 #include "SketchObjectSF.h"
+#include "SketchObject.h"
+#include "SketchObjectPy.h"
+#include "Sketch.h"
 
 using Base::Console;
 using namespace Part;
@@ -113,6 +117,106 @@ static PyObject * insert(PyObject *self, PyObject *args)
     Py_Return;
 }
 
+/* debug function */
+static PyObject * checkGradients(PyObject *self, PyObject *args)
+{
+    PyObject *pcObj;
+    if (!PyArg_ParseTuple(args, "O!", &(Sketcher::SketchObjectPy::Type), &pcObj))
+        return NULL;
+
+    std::map<int,double> deviations;
+    PY_TRY {
+        // compare gradVec() with grad() for the solver constraints of the sketch
+        const Sketcher::SketchObject* obj = static_cast<Sketcher::SketchObjectPy*>(pcObj)->getSketchObjectPtr();
+        Sketcher::Sketch sketch;
+        sketch.setUpSketch(obj->getCompleteGeometry(), obj->Constraints.getValues(),
+                           obj->getExternalGeometryCount());
+        sketch.checkGradients(deviations);
+    } PY_CATCH;
+
+    Py::Dict dict;
+    for (std::map<int,double>::const_iterator it = deviations.begin(); it != deviations.end(); ++it)
+        dict.setItem(Py::Int(it->first), Py::Float(it->second));
+    return Py::new_reference_to(dict);
+}
+
+namespace {
+
+// sets up the solver from the sketch object and starts a drag like SketchObject::movePoint()
+bool initDrag(Sketcher::Sketch& sketch, const Sketcher::SketchObject* obj, int GeoId, Sketcher::PointPos PosId)
+{
+    int dofs = sketch.setUpSketch(obj->getCompleteGeometry(), obj->Constraints.getValues(),
+                                  obj->getExternalGeometryCount());
+    if (dofs < 0 || sketch.hasConflicts())
+        return false;
+    return sketch.initMove(GeoId, PosId) == 0;
+}
+
+void applyDrag(const Sketcher::Sketch& sketch, Sketcher::SketchObject* obj)
+{
+    std::vector<Part::Geometry *> geomlist = sketch.extractGeometry();
+    obj->Geometry.setValues(geomlist);
+    for (std::vector<Part::Geometry *>::iterator it=geomlist.begin(); it != geomlist.end(); ++it) {
+        if (*it) delete *it;
+    }
+}
+
+}
+
+/* debug function */
+static PyObject * dragPoint(PyObject *self, PyObject *args)
+{
+    PyObject *pcObj, *pcList;
+    int GeoId, PointType;
+    PyObject *warm = Py_True;
+    if (!PyArg_ParseTuple(args, "O!iiO!|O!", &(Sketcher::SketchObjectPy::Type), &pcObj,
+                          &GeoId, &PointType, &PyList_Type, &pcList, &PyBool_Type, &warm))
+        return NULL;
+
+    std::vector<Base::Vector3d> path;
+    Py::List list(pcList);
+    for (Py::List::iterator it = list.begin(); it != list.end(); ++it) {
+        if (!PyObject_TypeCheck((*it).ptr(), &(Base::VectorPy::Type)))
+            Py_Error(PyExc_TypeError, "list of vectors expected");
+        path.push_back(*static_cast<Base::VectorPy*>((*it).ptr())->getVectorPtr());
+    }
+
+    Sketcher::SketchObject* obj = static_cast<Sketcher::SketchObjectPy*>(pcObj)->getSketchObjectPtr();
+    Sketcher::PointPos PosId = (Sketcher::PointPos)PointType;
+    std::vector<float> times;
+    PY_TRY {
+        if (PyObject_IsTrue(warm)) {
+            // one solver for the whole drag as the sketch view does it
+            Sketcher::Sketch sketch;
+            if (!initDrag(sketch, obj, GeoId, PosId))
+                Py_Error(PyExc_ValueError, "Not able to drag the point");
+            for (std::vector<Base::Vector3d>::iterator it = path.begin(); it != path.end(); ++it) {
+                if (sketch.movePoint(GeoId, PosId, *it) != 0)
+                    Py_Error(PyExc_ValueError, "Not able to move the point");
+                times.push_back(sketch.SolveTime);
+            }
+            applyDrag(sketch, obj);
+        }
+        else {
+            // a new solver for every step as SketchObject::movePoint() does it
+            for (std::vector<Base::Vector3d>::iterator it = path.begin(); it != path.end(); ++it) {
+                Sketcher::Sketch sketch;
+                if (!initDrag(sketch, obj, GeoId, PosId))
+                    Py_Error(PyExc_ValueError, "Not able to drag the point");
+                if (sketch.movePoint(GeoId, PosId, *it) != 0)
+                    Py_Error(PyExc_ValueError, "Not able to move the point");
+                times.push_back(sketch.SolveTime);
+                applyDrag(sketch, obj);
+            }
+        }
+    } PY_CATCH;
+
+    Py::List result;
+    for (std::vector<float>::iterator it = times.begin(); it != times.end(); ++it)
+        result.append(Py::Float(*it));
+    return Py::new_reference_to(result);
+}
+
 /* module functions */
 //static PyObject * read(PyObject *self, PyObject *args)
 //{
@@ -129,6 +233,17 @@ static PyObject * insert(PyObject *self, PyObject *args)
 struct PyMethodDef Sketcher_methods[] = {
     {"open"   , open,    1},
     {"insert" , insert,  1},
+    {"checkGradients", checkGradients, 1,
+     "checkGradients(sketch) -> dict\n"
+     "Debug function comparing the analytic gradients of the solver constraints of the\n"
+     "sketch with their per parameter counterparts. Returns the largest relative\n"
+     "deviation for every constraint type in the sketch."},
+    {"dragPoint", dragPoint, 1,
+     "dragPoint(sketch, GeoId, PointType, [Vector,...], [warm=True]) -> list\n"
+     "Debug function dragging a point of the sketch along the given positions.\n"
+     "With warm=True one solver is used for the whole drag like in the sketch view,\n"
+     "otherwise every step is solved from scratch like by movePoint(). The geometry\n"
+     "is set to the result. Returns the solve time of every step."},
 //    {"read"   , read,  1},
     {NULL, NULL}        /* end of table marker */
 };
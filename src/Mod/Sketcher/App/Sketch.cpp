@@ -1750,7 +1750,8 @@ int Sketch::initMove(int geoId, PointPos pos, bool fine)
     }
     InitParameters = MoveParameters;
 
-    GCSsys.initSolution();
+    // successive movePoint() calls continue from the previous solution
+    GCSsys.initSolution(true);
     isInitMove = true;
     return 0;
 }
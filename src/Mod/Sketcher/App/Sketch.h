@@ -88,13 +88,18 @@ public:
     bool hasRedundancies(void) const { return (Redundant.size() > 0); }
     const std::vector<int> &getRedundant(void) const { return Redundant; }
 
+    /// compares the analytic solver gradients, see GCS::System::checkGradients()
+    void checkGradients(std::map<int,double> &deviations) { GCSsys.checkGradients(deviations); }
+
     /** set the datum of a distance or angle constraint to a certain value and solve
       * This can cause the solving to fail!
       */
     int setDatum(int constrId, double value);
 
     /** initializes a point (or curve) drag by setting the current
-      * sketch status as a reference
+      * sketch status as a reference. The solver keeps its state
+      * between the following movePoint() calls, which start from
+      * the previous solution and only solve the dragged parts again
       */
     int initMove(int geoId, PointPos pos, bool fine=true);
 
@@ -21,6 +21,7 @@
  ***************************************************************************/
 
 #include <cmath>
+#include <algorithm>
 #include "Constraints.h"
 
 namespace GCS
@@ -35,7 +36,7 @@ Constraint::Constraint()
 {
 }
 
-void Constraint::redirectParams(MAP_pD_pD redirectionmap)
+void Constraint::redirectParams(const MAP_pD_pD &redirectionmap)
 {
     int i=0;
     for (VEC_pD::iterator param=origpvec.begin();
@@ -71,6 +72,17 @@ double Constraint::grad(double *param)
     return 0.;
 }
 
+void Constraint::gradVec(double *derivs)
+{
+    // generic version based on grad(), the derivative of a parameter
+    // is assigned to its first entry in pvec
+    for (int i=0; i < int(pvec.size()); i++) {
+        derivs[i] = 0.;
+        if (std::find(pvec.begin(), pvec.begin()+i, pvec[i]) == pvec.begin()+i)
+            derivs[i] = grad(pvec[i]);
+    }
+}
+
 double Constraint::maxStep(MAP_pD_D &dir, double lim)
 {
     return lim;
@@ -108,6 +120,12 @@ double ConstraintEqual::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintEqual::gradVec(double *derivs)
+{
+    derivs[0] = scale;
+    derivs[1] = -scale;
+}
+
 // Difference
 ConstraintDifference::ConstraintDifference(double *p1, double *p2, double *d)
 {
@@ -142,6 +160,13 @@ double ConstraintDifference::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintDifference::gradVec(double *derivs)
+{
+    derivs[0] = -scale;
+    derivs[1] = scale;
+    derivs[2] = -scale;
+}
+
 // P2PDistance
 ConstraintP2PDistance::ConstraintP2PDistance(Point &p1, Point &p2, double *d)
 {
@@ -191,6 +216,18 @@ double ConstraintP2PDistance::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintP2PDistance::gradVec(double *derivs)
+{
+    double dx = (*p1x() - *p2x());
+    double dy = (*p1y() - *p2y());
+    double d = sqrt(dx*dx + dy*dy);
+    derivs[0] = scale * dx/d;
+    derivs[1] = scale * dy/d;
+    derivs[2] = -derivs[0];
+    derivs[3] = -derivs[1];
+    derivs[4] = -scale;
+}
+
 double ConstraintP2PDistance::maxStep(MAP_pD_D &dir, double lim)
 {
     MAP_pD_D::iterator it;
@@ -282,6 +319,25 @@ double ConstraintP2PAngle::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintP2PAngle::gradVec(double *derivs)
+{
+    double dx = (*p2x() - *p1x());
+    double dy = (*p2y() - *p1y());
+    double a = *angle() + da;
+    double ca = cos(a);
+    double sa = sin(a);
+    double x = dx*ca + dy*sa;
+    double y = -dx*sa + dy*ca;
+    double r2 = dx*dx+dy*dy;
+    dx = -y/r2;
+    dy = x/r2;
+    derivs[0] = scale * (-ca*dx + sa*dy);
+    derivs[1] = scale * (-sa*dx - ca*dy);
+    derivs[2] = -derivs[0];
+    derivs[3] = -derivs[1];
+    derivs[4] = -scale;
+}
+
 double ConstraintP2PAngle::maxStep(MAP_pD_D &dir, double lim)
 {
     // step(angle()) <= pi/18 = 10°
@@ -360,6 +416,25 @@ double ConstraintP2LDistance::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintP2LDistance::gradVec(double *derivs)
+{
+    double x0=*p0x(), x1=*p1x(), x2=*p2x();
+    double y0=*p0y(), y1=*p1y(), y2=*p2y();
+    double dx = x2-x1;
+    double dy = y2-y1;
+    double d2 = dx*dx+dy*dy;
+    double d = sqrt(d2);
+    double area = -x0*dy+y0*dx+x1*y2-x2*y1;
+    double s = (area < 0) ? -scale : scale;
+    derivs[0] = s * (y1-y2) / d;
+    derivs[1] = s * (x2-x1) / d;
+    derivs[2] = s * ((y2-y0)*d + (dx/d)*area) / d2;
+    derivs[3] = s * ((x0-x2)*d + (dy/d)*area) / d2;
+    derivs[4] = s * ((y0-y1)*d - (dx/d)*area) / d2;
+    derivs[5] = s * ((x1-x0)*d - (dy/d)*area) / d2;
+    derivs[6] = -scale;
+}
+
 double ConstraintP2LDistance::maxStep(MAP_pD_D &dir, double lim)
 {
     MAP_pD_D::iterator it;
@@ -460,6 +535,23 @@ double ConstraintPointOnLine::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintPointOnLine::gradVec(double *derivs)
+{
+    double x0=*p0x(), x1=*p1x(), x2=*p2x();
+    double y0=*p0y(), y1=*p1y(), y2=*p2y();
+    double dx = x2-x1;
+    double dy = y2-y1;
+    double d2 = dx*dx+dy*dy;
+    double d = sqrt(d2);
+    double area = -x0*dy+y0*dx+x1*y2-x2*y1;
+    derivs[0] = scale * (y1-y2) / d;
+    derivs[1] = scale * (x2-x1) / d;
+    derivs[2] = scale * ((y2-y0)*d + (dx/d)*area) / d2;
+    derivs[3] = scale * ((x0-x2)*d + (dy/d)*area) / d2;
+    derivs[4] = scale * ((y0-y1)*d - (dx/d)*area) / d2;
+    derivs[5] = scale * ((x1-x0)*d - (dy/d)*area) / d2;
+}
+
 // Parallel
 ConstraintParallel::ConstraintParallel(Line &l1, Line &l2)
 {
@@ -514,6 +606,22 @@ double ConstraintParallel::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintParallel::gradVec(double *derivs)
+{
+    double dx1 = scale * (*l1p1x() - *l1p2x());
+    double dy1 = scale * (*l1p1y() - *l1p2y());
+    double dx2 = scale * (*l2p1x() - *l2p2x());
+    double dy2 = scale * (*l2p1y() - *l2p2y());
+    derivs[0] = dy2;
+    derivs[1] = -dx2;
+    derivs[2] = -dy2;
+    derivs[3] = dx2;
+    derivs[4] = -dy1;
+    derivs[5] = dx1;
+    derivs[6] = dy1;
+    derivs[7] = -dx1;
+}
+
 // Perpendicular
 ConstraintPerpendicular::ConstraintPerpendicular(Line &l1, Line &l2)
 {
@@ -583,6 +691,22 @@ double ConstraintPerpendicular::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintPerpendicular::gradVec(double *derivs)
+{
+    double dx1 = scale * (*l1p1x() - *l1p2x());
+    double dy1 = scale * (*l1p1y() - *l1p2y());
+    double dx2 = scale * (*l2p1x() - *l2p2x());
+    double dy2 = scale * (*l2p1y() - *l2p2y());
+    derivs[0] = dx2;
+    derivs[1] = dy2;
+    derivs[2] = -dx2;
+    derivs[3] = -dy2;
+    derivs[4] = dx1;
+    derivs[5] = dy1;
+    derivs[6] = -dx1;
+    derivs[7] = -dy1;
+}
+
 // L2LAngle
 ConstraintL2LAngle::ConstraintL2LAngle(Line &l1, Line &l2, double *a)
 {
@@ -676,6 +800,33 @@ double ConstraintL2LAngle::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintL2LAngle::gradVec(double *derivs)
+{
+    double dx1 = (*l1p2x() - *l1p1x());
+    double dy1 = (*l1p2y() - *l1p1y());
+    double r1 = dx1*dx1+dy1*dy1;
+    derivs[0] = scale * -dy1/r1;
+    derivs[1] = scale * dx1/r1;
+    derivs[2] = -derivs[0];
+    derivs[3] = -derivs[1];
+
+    double dx2 = (*l2p2x() - *l2p1x());
+    double dy2 = (*l2p2y() - *l2p1y());
+    double a = atan2(dy1,dx1) + *angle();
+    double ca = cos(a);
+    double sa = sin(a);
+    double x2 = dx2*ca + dy2*sa;
+    double y2 = -dx2*sa + dy2*ca;
+    double r2 = dx2*dx2+dy2*dy2;
+    dx2 = -y2/r2;
+    dy2 = x2/r2;
+    derivs[4] = scale * (-ca*dx2 + sa*dy2);
+    derivs[5] = scale * (-sa*dx2 - ca*dy2);
+    derivs[6] = -derivs[4];
+    derivs[7] = -derivs[5];
+    derivs[8] = -scale;
+}
+
 double ConstraintL2LAngle::maxStep(MAP_pD_D &dir, double lim)
 {
     // step(angle()) <= pi/18 = 10°
@@ -771,6 +922,27 @@ double ConstraintMidpointOnLine::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintMidpointOnLine::gradVec(double *derivs)
+{
+    double x0=((*l1p1x())+(*l1p2x()))/2;
+    double y0=((*l1p1y())+(*l1p2y()))/2;
+    double x1=*l2p1x(), x2=*l2p2x();
+    double y1=*l2p1y(), y2=*l2p2y();
+    double dx = x2-x1;
+    double dy = y2-y1;
+    double d2 = dx*dx+dy*dy;
+    double d = sqrt(d2);
+    double area = -x0*dy+y0*dx+x1*y2-x2*y1;
+    derivs[0] = scale * (y1-y2) / (2*d);
+    derivs[1] = scale * (x2-x1) / (2*d);
+    derivs[2] = derivs[0];
+    derivs[3] = derivs[1];
+    derivs[4] = scale * ((y2-y0)*d + (dx/d)*area) / d2;
+    derivs[5] = scale * ((x0-x2)*d + (dy/d)*area) / d2;
+    derivs[6] = scale * ((y0-y1)*d - (dx/d)*area) / d2;
+    derivs[7] = scale * ((x1-x0)*d - (dy/d)*area) / d2;
+}
+
 // TangentCircumf
 ConstraintTangentCircumf::ConstraintTangentCircumf(Point &p1, Point &p2,
                                                    double *rad1, double *rad2, bool internal_)
@@ -831,4 +1003,23 @@ double ConstraintTangentCircumf::grad(double *param)
     return scale * deriv;
 }
 
+void ConstraintTangentCircumf::gradVec(double *derivs)
+{
+    double dx = (*c1x() - *c2x());
+    double dy = (*c1y() - *c2y());
+    double d = sqrt(dx*dx + dy*dy);
+    derivs[0] = scale * dx/d;
+    derivs[1] = scale * dy/d;
+    derivs[2] = -derivs[0];
+    derivs[3] = -derivs[1];
+    if (internal) {
+        derivs[4] = (*r1() > *r2()) ? -scale : scale;
+        derivs[5] = -derivs[4];
+    }
+    else {
+        derivs[4] = -scale;
+        derivs[5] = -scale;
+    }
+}
+
 } //namespace GCS
@@ -60,7 +60,7 @@ namespace GCS
 
         inline VEC_pD params() { return pvec; }
 
-        void redirectParams(MAP_pD_pD redirectionmap);
+        void redirectParams(const MAP_pD_pD &redirectionmap);
         void revertParams();
         void setTag(int tagId) { tag = tagId; }
         int getTag() { return tag; }
@@ -69,7 +69,9 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
-        // virtual void grad(MAP_pD_D &deriv);  --> TODO: vectorized grad version
+        // partial derivatives of error() with respect to every entry of params(),
+        // derivatives of entries pointing to the same parameter have to be summed up
+        virtual void gradVec(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -85,6 +87,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
     };
 
     // Difference
@@ -100,6 +103,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
     };
 
     // P2PDistance
@@ -117,6 +121,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -136,6 +141,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -156,6 +162,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -175,6 +182,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
     };
 
     // Parallel
@@ -195,6 +203,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
     };
 
     // Perpendicular
@@ -216,6 +225,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
     };
 
     // L2LAngle
@@ -239,6 +249,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
         virtual double maxStep(MAP_pD_D &dir, double lim=1.);
     };
 
@@ -261,6 +272,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
     };
 
     // TangentCircumf
@@ -281,6 +293,7 @@ namespace GCS
         virtual void rescale(double coef=1.);
         virtual double error();
         virtual double grad(double *);
+        virtual void gradVec(double *derivs);
     };
 
 } //namespace GCS
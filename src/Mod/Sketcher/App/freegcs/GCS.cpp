@@ -27,9 +27,13 @@
 #include "qp_eq.h"
 #include <Eigen/QR>
 
+#include <boost/bind.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/connected_components.hpp>
 
+#include <QtConcurrentMap>
+#include <QThread>
+
 namespace GCS
 {
 
@@ -45,7 +49,8 @@ System::System()
   c2p(), p2c(),
   subSystems(0), subSystemsAux(0),
   reference(0),
-  hasUnknowns(false), hasDiagnosis(false), isInit(false)
+  hasUnknowns(false), hasDiagnosis(false), isInit(false), isDragging(false),
+  linearAlgebra(Automatic)
 {
 }
 
@@ -54,7 +59,8 @@ System::System(std::vector<Constraint *> clist_)
   c2p(), p2c(),
   subSystems(0), subSystemsAux(0),
   reference(0),
-  hasUnknowns(false), hasDiagnosis(false), isInit(false)
+  hasUnknowns(false), hasDiagnosis(false), isInit(false), isDragging(false),
+  linearAlgebra(Automatic)
 {
     // create own (shallow) copy of constraints
     for (std::vector<Constraint *>::iterator constr=clist_.begin();
@@ -569,7 +575,7 @@ void System::declareUnknowns(VEC_pD &params)
     hasUnknowns = true;
 }
 
-void System::initSolution()
+void System::initSolution(bool dragging)
 {
     // - Stores the current parameters values in the vector "reference"
     // - identifies any decoupled subsystems and partitions the original
@@ -580,6 +586,9 @@ void System::initSolution()
     // - Organizes the rest of constraints into two subsystems for
     //   tag ids >=0 and < 0 respectively and applies the
     //   system reduction specified in the previous step
+    // - In dragging mode, successive solves start from the last solution
+    //   instead of the reference and only the components containing move
+    //   constraints are solved again
 
     isInit = false;
     if (!hasUnknowns)
@@ -630,6 +639,7 @@ void System::initSolution()
     reductionmaps.resize(componentsSize); // create empty maps to be filled in
     {
         VEC_pD reducedParams=plist;
+        std::map<double *, VEC_I> reducedGroups; // indices of the parameters replaced by a kept parameter
 
         for (std::vector<Constraint *>::const_iterator constr=clistR.begin();
             constr != clistR.end(); ++constr) {
@@ -641,9 +651,18 @@ void System::initSolution()
                     reducedConstrs.insert(*constr);
                     double *p_kept = reducedParams[it1->second];
                     double *p_replaced = reducedParams[it2->second];
-                    for (int i=0; i < int(plist.size()); ++i)
-                       if (reducedParams[i] == p_replaced)
-                           reducedParams[i] = p_kept;
+                    if (p_kept != p_replaced) {
+                        VEC_I &kept = reducedGroups[p_kept];
+                        VEC_I &replaced = reducedGroups[p_replaced];
+                        if (kept.empty())
+                            kept.push_back(pIndex[p_kept]);
+                        if (replaced.empty())
+                            replaced.push_back(pIndex[p_replaced]);
+                        for (VEC_I::const_iterator i=replaced.begin(); i != replaced.end(); ++i)
+                            reducedParams[*i] = p_kept;
+                        kept.insert(kept.end(), replaced.begin(), replaced.end());
+                        reducedGroups.erase(p_replaced);
+                    }
                 }
             }
         }
@@ -692,6 +711,11 @@ void System::initSolution()
             subSystemsAux[cid] = new SubSystem(clist1, plists[cid], reductionmaps[cid]);
     }
 
+    isDragging = dragging;
+    if (isDragging) {
+        isDragSolved.resize(subSystems.size(), false);
+        hessians.resize(subSystems.size());
+    }
     isInit = true;
 }
 
@@ -726,21 +750,53 @@ int System::solve(bool isFine, Algorithm alg)
     if (!isInit)
         return Failed;
 
-    bool isReset = false;
+    // the components are decoupled, i.e. they share neither parameters
+    // nor constraints, so that they can be solved independently
+    std::vector< std::pair<int,int> > sizes; // (number of parameters, cid)
+    int xsize = 0;
+    for (int cid=0; cid < int(subSystems.size()); cid++) {
+        int size = 0;
+        if (subSystems[cid])
+            size = subSystems[cid]->pSize();
+        if (subSystemsAux[cid])
+            size = std::max(size, subSystemsAux[cid]->pSize());
+        if (isDragging && isDragSolved[cid])
+            continue; // not affected by the move constraints
+        if (subSystems[cid] || subSystemsAux[cid]) {
+            sizes.push_back(std::make_pair(size, cid));
+            xsize += size;
+        }
+    }
+
+    // start with the largest components for a better load balancing
+    std::sort(sizes.begin(), sizes.end());
+    std::vector<Component> components(sizes.size());
+    for (int i=0; i < int(sizes.size()); i++) {
+        components[i].cid = sizes[sizes.size()-1-i].second;
+        components[i].res = Success;
+    }
+
+    if (!components.empty() && !isDragging)
+        resetToReference();
+    if (components.size() > 1 && xsize >= ParallelThreshold &&
+        QThread::idealThreadCount() > 1) {
+        Eigen::initParallel();
+        QFuture<void> future = QtConcurrent::map(components,
+            boost::bind(&System::solveComponent, this, _1, isFine, alg));
+        future.waitForFinished();
+    }
+    else {
+        for (std::vector<Component>::iterator it=components.begin(); it != components.end(); ++it)
+            solveComponent(*it, isFine, alg);
+    }
+
     // return success by default in order to permit coincidence constraints to be applied
     // even if no other system has to be solved
     int res = Success;
-    for (int cid=0; cid < int(subSystems.size()); cid++) {
-        if ((subSystems[cid] || subSystemsAux[cid]) && !isReset) {
-             resetToReference();
-             isReset = true;
-        }
-        if (subSystems[cid] && subSystemsAux[cid])
-            res = std::max(res, solve(subSystems[cid], subSystemsAux[cid], isFine));
-        else if (subSystems[cid])
-            res = std::max(res, solve(subSystems[cid], isFine, alg));
-        else if (subSystemsAux[cid])
-            res = std::max(res, solve(subSystemsAux[cid], isFine, alg));
+    for (std::vector<Component>::const_iterator it=components.begin(); it != components.end(); ++it) {
+        res = std::max(res, it->res);
+        if (isDragging && !subSystemsAux[it->cid] && it->res == Success)
+            isDragSolved[it->cid] = true;
     }
     if (res == Success) {
         for (std::set<Constraint *>::const_iterator constr=redundant.begin();
@@ -753,6 +809,30 @@ int System::solve(bool isFine, Algorithm alg)
     return res;
 }
 
+void System::solveComponent(Component &comp, bool isFine, Algorithm alg)
+{
+    int cid = comp.cid;
+    if (subSystems[cid] && subSystemsAux[cid] && isDragging) {
+        // continue with the BFGS approximation of the previous drag step
+        // and fall back to a fresh one if it does not fit anymore
+        Eigen::MatrixXd &B = hessians[cid];
+        bool isWarm = B.size() > 0;
+        comp.res = solve_SQP(subSystems[cid], subSystemsAux[cid], B, isFine);
+        if (comp.res != Success && isWarm) {
+            B.resize(0,0);
+            comp.res = solve_SQP(subSystems[cid], subSystemsAux[cid], B, isFine);
+        }
+        if (comp.res != Success)
+            B.resize(0,0);
+    }
+    else if (subSystems[cid] && subSystemsAux[cid])
+        comp.res = solve(subSystems[cid], subSystemsAux[cid], isFine);
+    else if (subSystems[cid])
+        comp.res = solve(subSystems[cid], isFine, alg);
+    else if (subSystemsAux[cid])
+        comp.res = solve(subSystemsAux[cid], isFine, alg);
+}
+
 int System::solve(SubSystem *subsys, bool isFine, Algorithm alg)
 {
     if (alg == BFGS)
@@ -838,7 +918,77 @@ int System::solve_BFGS(SubSystem *subsys, bool isFine)
     return Failed;
 }
 
-int System::solve_LM(SubSystem* subsys)
+bool System::useSparse(int xsize) const
+{
+    return linearAlgebra == Sparse ||
+           (linearAlgebra == Automatic && xsize >= SparseThreshold);
+}
+
+// Linear algebra of the LM and DogLeg solvers for dense and sparse jacobi matrices
+
+// solves the damped normal equations (A+mu*I)*h=g and returns the relative error
+static double solveDamped(const Eigen::MatrixXd &A, double mu,
+                          const Eigen::VectorXd &g, Eigen::VectorXd &h)
+{
+    Eigen::MatrixXd A_mu = A;
+    for (int i=0; i < A_mu.rows(); ++i)
+        A_mu(i,i) += mu;
+    h = A_mu.fullPivLu().solve(g);
+    return (A_mu*h - g).norm() / g.norm();
+}
+
+static double solveDamped(const SparseMatrix &A, double mu,
+                          const Eigen::VectorXd &g, Eigen::VectorXd &h)
+{
+    // A is symmetric positive semi-definite so that A+mu*I can be factorized
+    // with a sparse Cholesky decomposition
+    Eigen::SimplicialLDLT<SparseMatrix> ldlt;
+    ldlt.setShift(mu);
+    ldlt.compute(A);
+    if (ldlt.info() != Eigen::Success)
+        return 1.;
+    h = ldlt.solve(g);
+    Eigen::VectorXd res = A*h + mu*h - g;
+    return res.norm() / g.norm();
+}
+
+// computes the Gauss-Newton step J*h=-fx, returns false if it could not be computed
+static bool gaussNewtonStep(const Eigen::MatrixXd &J, const Eigen::VectorXd &fx,
+                            Eigen::VectorXd &h)
+{
+    h = J.fullPivLu().solve(-fx);
+    return true;
+}
+
+static bool gaussNewtonStep(const SparseMatrix &J, const Eigen::VectorXd &fx,
+                            Eigen::VectorXd &h)
+{
+    SparseMatrix Jt = J.transpose();
+    Eigen::SimplicialLDLT<SparseMatrix> ldlt;
+    if (J.rows() <= J.cols()) {
+        // minimum norm solution of the under-determined system, h=J^T*(J*J^T)^-1*(-fx)
+        SparseMatrix JJt = J*Jt;
+        ldlt.compute(JJt);
+        if (ldlt.info() != Eigen::Success)
+            return false;
+        Eigen::VectorXd y = ldlt.solve(-fx);
+        h = Jt*y;
+    }
+    else {
+        // least squares solution of the over-determined system
+        SparseMatrix JtJ = Jt*J;
+        ldlt.compute(JtJ);
+        if (ldlt.info() != Eigen::Success)
+            return false;
+        Eigen::VectorXd b = Jt*(-fx);
+        h = ldlt.solve(b);
+    }
+    double hnorm = h.norm();
+    return hnorm == hnorm; // check for NaN
+}
+
+template <typename JacobiMatrix>
+static int solveLM(SubSystem* subsys)
 {
     int xsize = subsys->pSize();
     int csize = subsys->cSize();
@@ -847,8 +997,8 @@ int System::solve_LM(SubSystem* subsys)
         return Success;
 
     Eigen::VectorXd e(csize), e_new(csize); // vector of all function errors (every constraint is one function)
-    Eigen::MatrixXd J(csize, xsize);        // Jacobi of the subsystem
-    Eigen::MatrixXd A(xsize, xsize);
+    JacobiMatrix J(csize, xsize);           // Jacobi of the subsystem
+    JacobiMatrix A(xsize, xsize);
     Eigen::VectorXd x(xsize), h(xsize), x_new(xsize), g(xsize), diag_A(xsize);
 
     subsys->redirectParams();
@@ -884,8 +1034,8 @@ int System::solve_LM(SubSystem* subsys)
         g = J.transpose()*e;
 
         // Compute ||J^T e||_inf
-        double g_inf = g.lpNorm<Eigen::Infinity>();
-        diag_A = A.diagonal(); // save diagonal entries so that augmentation can be later canceled
+        double g_inf = g.template lpNorm<Eigen::Infinity>();
+        diag_A = A.diagonal();
 
         // check for convergence
         if (g_inf <= eps1) {
@@ -895,18 +1045,13 @@ int System::solve_LM(SubSystem* subsys)
 
         // compute initial damping factor
         if (iter == 0)
-            mu = tau * diag_A.lpNorm<Eigen::Infinity>();
+            mu = tau * diag_A.template lpNorm<Eigen::Infinity>();
 
         // determine increment using adaptive damping
         int k=0;
         while (k < 50) {
-            // augment normal equations A = A+uI
-            for (int i=0; i < xsize; ++i)
-                A(i,i) += mu;
-
-            //solve augmented functions A*h=-g
-            h = A.fullPivLu().solve(g);
-            double rel_error = (A*h - g).norm() / g.norm();
+            //solve augmented functions (A+uI)*h=-g
+            double rel_error = solveDamped(A, mu, g, h);
 
             // check if solving works
             if (rel_error < 1e-5) {
@@ -953,8 +1098,6 @@ int System::solve_LM(SubSystem* subsys)
 
             mu*=nu;
             nu*=2.0;
-            for (int i=0; i < xsize; ++i) // restore diagonal J^T J entries
-                A(i,i) = diag_A(i);
 
             k++;
         }
@@ -972,8 +1115,15 @@ int System::solve_LM(SubSystem* subsys)
     return (stop == 1) ? Success : Failed;
 }
 
+int System::solve_LM(SubSystem* subsys)
+{
+    if (useSparse(subsys->pSize()))
+        return solveLM<SparseMatrix>(subsys);
+    return solveLM<Eigen::MatrixXd>(subsys);
+}
 
-int System::solve_DL(SubSystem* subsys)
+template <typename JacobiMatrix>
+static int solveDL(SubSystem* subsys)
 {
     double tolg=1e-80, tolx=1e-80, tolf=1e-10;
 
@@ -985,8 +1135,9 @@ int System::solve_DL(SubSystem* subsys)
 
     Eigen::VectorXd x(xsize), x_new(xsize);
     Eigen::VectorXd fx(csize), fx_new(csize);
-    Eigen::MatrixXd Jx(csize, xsize), Jx_new(csize, xsize);
+    JacobiMatrix Jx(csize, xsize), Jx_new(csize, xsize);
     Eigen::VectorXd g(xsize), h_sd(xsize), h_gn(xsize), h_dl(xsize);
+    Eigen::VectorXd Jv(csize);
 
     subsys->redirectParams();
 
@@ -998,8 +1149,8 @@ int System::solve_DL(SubSystem* subsys)
     g = Jx.transpose()*(-fx);
 
     // get the infinity norm fx_inf and g_inf
-    double g_inf = g.lpNorm<Eigen::Infinity>();
-    double fx_inf = fx.lpNorm<Eigen::Infinity>();
+    double g_inf = g.template lpNorm<Eigen::Infinity>();
+    double fx_inf = fx.template lpNorm<Eigen::Infinity>();
 
     int maxIterNumber = MaxIterations * xsize;
     double divergingLim = 1e6*err + 1e12;
@@ -1024,12 +1175,15 @@ int System::solve_DL(SubSystem* subsys)
         }
         else {
             // get the steepest descent direction
-            alpha = g.squaredNorm()/(Jx*g).squaredNorm();
+            Jv = Jx*g;
+            alpha = g.squaredNorm()/Jv.squaredNorm();
             h_sd  = alpha*g;
 
             // get the gauss-newton step
-            h_gn = Jx.fullPivLu().solve(-fx);
-            double rel_error = (Jx*h_gn + fx).norm() / fx.norm();
+            if (!gaussNewtonStep(Jx, fx, h_gn))
+                break;
+            Jv = Jx*h_gn;
+            double rel_error = (Jv + fx).norm() / fx.norm();
             if (rel_error > 1e15)
                 break;
 
@@ -1080,7 +1234,8 @@ int System::solve_DL(SubSystem* subsys)
         subsys->calcJacobi(Jx_new);
 
         // calculate the linear model and the update ratio
-        double dL = err - 0.5*(fx + Jx*h_dl).squaredNorm();
+        Jv = Jx*h_dl;
+        double dL = err - 0.5*(fx + Jv).squaredNorm();
         double dF = err - err_new;
         double rho = dL/dF;
 
@@ -1093,8 +1248,8 @@ int System::solve_DL(SubSystem* subsys)
             g = Jx.transpose()*(-fx);
 
             // get infinity norms
-            g_inf = g.lpNorm<Eigen::Infinity>();
-            fx_inf = fx.lpNorm<Eigen::Infinity>();
+            g_inf = g.template lpNorm<Eigen::Infinity>();
+            fx_inf = fx.template lpNorm<Eigen::Infinity>();
         }
         else
             rho = -1;
@@ -1122,10 +1277,25 @@ int System::solve_DL(SubSystem* subsys)
     return (stop == 1) ? Success : Failed;
 }
 
+int System::solve_DL(SubSystem* subsys)
+{
+    if (useSparse(subsys->pSize()))
+        return solveDL<SparseMatrix>(subsys);
+    return solveDL<Eigen::MatrixXd>(subsys);
+}
+
 // The following solver variant solves a system compound of two subsystems
 // treating the first of them as of higher priority than the second
 int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine)
 {
+    Eigen::MatrixXd B;
+    return solve_SQP(subsysA, subsysB, B, isFine);
+}
+
+int System::solve_SQP(SubSystem *subsysA, SubSystem *subsysB, Eigen::MatrixXd &B, bool isFine)
+{
+    // B holds the approximation of the Hessian of the Lagrangian, it is
+    // initialized to the identity unless it matches the size of the problem
     int xsizeA = subsysA->pSize();
     int xsizeB = subsysB->pSize();
     int csizeA = subsysA->cSize();
@@ -1146,7 +1316,8 @@ int System::solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine)
     }
     int xsize = plistAB.size();
 
-    Eigen::MatrixXd B = Eigen::MatrixXd::Identity(xsize, xsize);
+    if (B.rows() != xsize || B.cols() != xsize)
+        B = Eigen::MatrixXd::Identity(xsize, xsize);
     Eigen::MatrixXd JA(csizeA, xsize);
     Eigen::MatrixXd Y,Z;
 
@@ -1301,6 +1472,41 @@ void System::applySolution()
 void System::undoSolution()
 {
     resetToReference();
+    // the next drag step has to start over from the reference
+    if (isDragging) {
+        isDragSolved.assign(isDragSolved.size(), false);
+        hessians.assign(hessians.size(), Eigen::MatrixXd());
+    }
+}
+
+void System::checkGradients(std::map<int,double> &deviations)
+{
+    deviations.clear();
+    for (std::vector<Constraint *>::iterator constr=clist.begin();
+         constr != clist.end(); ++constr) {
+        VEC_pD params = (*constr)->params();
+        VEC_D derivs(params.size(), 0.);
+        if (params.size() > 0)
+            (*constr)->gradVec(&derivs[0]);
+
+        // entries pointing to the same parameter are summed up
+        MAP_pD_D sums;
+        for (int i=0; i < int(params.size()); i++)
+            sums[params[i]] += derivs[i];
+
+        double deviation = 0.;
+        for (MAP_pD_D::const_iterator it=sums.begin(); it != sums.end(); ++it) {
+            double ref = (*constr)->grad(it->first);
+            deviation = std::max(deviation, std::abs(it->second - ref) / std::max(1., std::abs(ref)));
+        }
+
+        int type = (*constr)->getTypeId();
+        std::map<int,double>::iterator dev = deviations.find(type);
+        if (dev == deviations.end())
+            deviations[type] = deviation;
+        else
+            dev->second = std::max(dev->second, deviation);
+    }
 }
 
 int System::diagnose()
@@ -1324,15 +1530,68 @@ int System::diagnose()
     redundant.clear();
     conflictingTags.clear();
     redundantTags.clear();
-    Eigen::MatrixXd J(clist.size(), plist.size());
+
+    // For large systems first check with a sparse Cholesky decomposition of
+    // J*J^T if the constraints are independent. The dense decomposition below
+    // is only needed to identify conflicting or redundant constraints.
+    if (useSparse(int(plist.size()))) {
+        std::vector< Eigen::Triplet<double> > entries;
+        VEC_D derivs;
+        int col=0;
+        for (std::vector<Constraint *>::iterator constr=clist.begin();
+             constr != clist.end(); ++constr) {
+            (*constr)->revertParams();
+            if ((*constr)->getTag() >= 0) {
+                VEC_pD &cparams = c2p[*constr];
+                derivs.resize(cparams.size());
+                (*constr)->gradVec(&derivs[0]);
+                for (int k=0; k < int(cparams.size()); k++) {
+                    MAP_pD_I::const_iterator it = pIndex.find(cparams[k]);
+                    if (it != pIndex.end()) // duplicates are summed up by setFromTriplets
+                        entries.push_back(Eigen::Triplet<double>(col, it->second, derivs[k]));
+                }
+                col++;
+            }
+        }
+        if (col > 0) {
+            SparseMatrix Js(col, plist.size());
+            Js.setFromTriplets(entries.begin(), entries.end());
+            SparseMatrix JJt = Js*SparseMatrix(Js.transpose());
+            Eigen::SimplicialLDLT<SparseMatrix> ldlt(JJt);
+            if (ldlt.info() == Eigen::Success) {
+                // every pivot relative to the squared norm of its constraint gradient
+                // measures how far the constraint is from depending on the others
+                Eigen::VectorXd diag = JJt.diagonal();
+                Eigen::VectorXd pdiag = ldlt.permutationP() * diag;
+                Eigen::VectorXd D = ldlt.vectorD();
+                bool independent = true;
+                for (int i=0; i < col && independent; i++)
+                    independent = D[i] > 1e-12 * pdiag[i];
+                if (independent) {
+                    hasDiagnosis = true;
+                    dofs = int(plist.size()) - col;
+                    return dofs;
+                }
+            }
+        }
+    }
+
+    Eigen::MatrixXd J = Eigen::MatrixXd::Zero(clist.size(), plist.size());
+    VEC_D derivs;
     int count=0;
     for (std::vector<Constraint *>::iterator constr=clist.begin();
          constr != clist.end(); ++constr) {
         (*constr)->revertParams();
         if ((*constr)->getTag() >= 0) {
             count++;
-            for (int j=0; j < int(plist.size()); j++)
-                J(count-1,j) = (*constr)->grad(plist[j]);
+            VEC_pD &cparams = c2p[*constr];
+            derivs.resize(cparams.size());
+            (*constr)->gradVec(&derivs[0]);
+            for (int k=0; k < int(cparams.size()); k++) {
+                MAP_pD_I::const_iterator it = pIndex.find(cparams[k]);
+                if (it != pIndex.end())
+                    J(count-1,it->second) += derivs[k];
+            }
         }
     }
 
@@ -1494,10 +1753,13 @@ int System::diagnose()
 void System::clearSubSystems()
 {
     isInit = false;
+    isDragging = false;
     free(subSystems);
     free(subSystemsAux);
     subSystems.clear();
     subSystemsAux.clear();
+    isDragSolved.clear();
+    hessians.clear();
 }
 
 double lineSearch(SubSystem *subsys, Eigen::VectorXd &xdir)
@@ -44,6 +44,12 @@ namespace GCS
         DogLeg = 2
     };
 
+    enum LinearAlgebra {
+        Dense = 0,    // dense jacobi matrix and full pivoting decompositions
+        Sparse = 1,   // sparse jacobi matrix and sparse Cholesky decompositions
+        Automatic = 2 // Sparse for subsystems with at least SparseThreshold parameters
+    };
+
     class System
     {
     // This is the main class. It holds all constraints and information
@@ -74,10 +80,25 @@ namespace GCS
         bool hasUnknowns;  // if plist is filled with the unknown parameters
         bool hasDiagnosis; // if dofs, conflictingTags, redundantTags are up to date
         bool isInit;       // if plists, clists, reductionmaps are up to date
+        bool isDragging;   // if solve() is warm-started from the last solution
+
+        // drag state, reset together with the subsystems
+        std::vector<bool> isDragSolved;        // components without move constraints already solved
+        std::vector<Eigen::MatrixXd> hessians; // BFGS approximations kept between the drag steps
+
+        LinearAlgebra linearAlgebra;
+        bool useSparse(int xsize) const;
+
+        struct Component { // decoupled component to be solved by solve(isFine, alg)
+            int cid;
+            int res;
+        };
+        void solveComponent(Component &comp, bool isFine, Algorithm alg);
 
         int solve_BFGS(SubSystem *subsys, bool isFine);
         int solve_LM(SubSystem *subsys);
         int solve_DL(SubSystem *subsys);
+        int solve_SQP(SubSystem *subsysA, SubSystem *subsysB, Eigen::MatrixXd &B, bool isFine);
     public:
         System();
         System(std::vector<Constraint *> clist_);
@@ -154,13 +175,16 @@ namespace GCS
         void rescaleConstraint(int id, double coeff);
 
         void declareUnknowns(VEC_pD &params);
-        void initSolution();
+        void initSolution(bool dragging=false);
 
         int solve(bool isFine=true, Algorithm alg=DogLeg);
         int solve(VEC_pD &params, bool isFine=true, Algorithm alg=DogLeg);
         int solve(SubSystem *subsys, bool isFine=true, Algorithm alg=DogLeg);
         int solve(SubSystem *subsysA, SubSystem *subsysB, bool isFine=true);
 
+        void setLinearAlgebra(LinearAlgebra la) { linearAlgebra = la; }
+        LinearAlgebra getLinearAlgebra() const { return linearAlgebra; }
+
         void applySolution();
         void undoSolution();
 
@@ -170,6 +194,10 @@ namespace GCS
           { conflictingOut = hasDiagnosis ? conflictingTags : VEC_I(0); }
         void getRedundant(VEC_I &redundantOut) const
           { redundantOut = hasDiagnosis ? redundantTags : VEC_I(0); }
+
+        // compares gradVec() with grad() for every constraint, the largest relative
+        // deviation is returned per constraint type (used by the unit tests)
+        void checkGradients(std::map<int,double> &deviations);
     };
 
     ///////////////////////////////////////
@@ -180,6 +208,12 @@ namespace GCS
     #define smallF            1e-20
     #define MaxIterations     100 //Note that the total number of iterations allowed is MaxIterations *xLength
 
+    ///////////////////////////////////////
+    // LM and DogLeg Solver parameters
+    ///////////////////////////////////////
+    #define SparseThreshold   200 // number of parameters from which on Automatic uses sparse matrices
+    #define ParallelThreshold 100 // number of parameters from which on decoupled components are solved in parallel
+
     ///////////////////////////////////////
     // Helper elements
     ///////////////////////////////////////
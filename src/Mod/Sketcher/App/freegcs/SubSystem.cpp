@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include <iterator>
+#include <algorithm>
 #include "SubSystem.h"
 
 namespace GCS
@@ -126,6 +127,45 @@ void SubSystem::initialize(VEC_pD &params, MAP_pD_pD &reductionmap)
         }
 //        (*constr)->redirectParams(pmap); // redirect parameters to pvec
     }
+
+    // sparsity pattern of the jacobi matrix, the parameters of every
+    // constraint are sorted by their position in pvals
+    jrows.clear();
+    jcols.clear();
+    jslotrows.clear();
+    jslots.clear();
+    jrows.reserve(csize+1);
+    jrows.push_back(0);
+    jslotrows.reserve(csize+1);
+    jslotrows.push_back(0);
+    for (std::vector<Constraint *>::iterator constr=clist.begin();
+         constr != clist.end(); ++constr) {
+        VEC_pD &constr_params = c2p[*constr];
+        int rowstart = int(jcols.size());
+        for (VEC_pD::const_iterator p=constr_params.begin();
+             p != constr_params.end(); ++p)
+            jcols.push_back(int(*p - &pvals[0]));
+        jrows.push_back(int(jcols.size()));
+
+        // map the entries of the parameter vector of the constraint to the
+        // non-zeros of its row
+        VEC_pD constr_params_orig = (*constr)->params();
+        for (VEC_pD::const_iterator p=constr_params_orig.begin();
+             p != constr_params_orig.end(); ++p) {
+            MAP_pD_pD::const_iterator pmapfind = pmap.find(*p);
+            if (pmapfind != pmap.end()) {
+                VEC_pD::const_iterator pos = std::lower_bound(constr_params.begin(),
+                                                              constr_params.end(),
+                                                              pmapfind->second);
+                jslots.push_back(rowstart + int(pos - constr_params.begin()));
+            }
+            else
+                jslots.push_back(-1);
+        }
+        jslotrows.push_back(int(jslots.size()));
+    }
+    jvals.resize(jcols.size());
+    jslotvals.resize(jslots.size());
 }
 
 void SubSystem::redirectParams()
@@ -253,44 +293,80 @@ void SubSystem::calcJacobi()
 }
 */
 
+void SubSystem::calcJacobiValues()
+{
+    std::fill(jvals.begin(), jvals.end(), 0.);
+    for (int i=0; i < csize; i++) {
+        if (jslotrows[i] == jslotrows[i+1])
+            continue;
+        clist[i]->gradVec(&jslotvals[jslotrows[i]]);
+        for (int s=jslotrows[i]; s < jslotrows[i+1]; s++)
+            if (jslots[s] >= 0)
+                jvals[jslots[s]] += jslotvals[s];
+    }
+}
+
 void SubSystem::calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi)
 {
+    Eigen::MatrixXd J;
+    calcJacobi(J);
     jacobi.setZero(csize, params.size());
     for (int j=0; j < int(params.size()); j++) {
         MAP_pD_pD::const_iterator
           pmapfind = pmap.find(params[j]);
         if (pmapfind != pmap.end())
-            for (int i=0; i < csize; i++)
-                jacobi(i,j) = clist[i]->grad(pmapfind->second);
+            jacobi.col(j) = J.col(int(pmapfind->second - &pvals[0]));
     }
 }
 
 void SubSystem::calcJacobi(Eigen::MatrixXd &jacobi)
 {
-    calcJacobi(plist, jacobi);
+    calcJacobiValues();
+    jacobi.setZero(csize, psize);
+    for (int i=0; i < csize; i++)
+        for (int k=jrows[i]; k < jrows[i+1]; k++)
+            jacobi(i,jcols[k]) = jvals[k];
+}
+
+void SubSystem::calcJacobi(SparseMatrix &jacobi)
+{
+    calcJacobiValues();
+    std::vector< Eigen::Triplet<double> > entries;
+    entries.reserve(jcols.size());
+    for (int i=0; i < csize; i++)
+        for (int k=jrows[i]; k < jrows[i+1]; k++)
+            entries.push_back(Eigen::Triplet<double>(i, jcols[k], jvals[k]));
+
+    jacobi.resize(csize, psize);
+    jacobi.setFromTriplets(entries.begin(), entries.end());
 }
 
 void SubSystem::calcGrad(VEC_pD &params, Eigen::VectorXd &grad)
 {
     assert(grad.size() == int(params.size()));
 
+    Eigen::VectorXd g(psize);
+    calcGrad(g);
     grad.setZero();
     for (int j=0; j < int(params.size()); j++) {
         MAP_pD_pD::const_iterator
           pmapfind = pmap.find(params[j]);
-        if (pmapfind != pmap.end()) {
-            // assert(p2c.find(pmapfind->second) != p2c.end());
-            std::vector<Constraint *> constrs=p2c[pmapfind->second];
-            for (std::vector<Constraint *>::const_iterator constr = constrs.begin();
-                 constr != constrs.end(); ++constr)
-                grad[j] += (*constr)->error() * (*constr)->grad(pmapfind->second);
-        }
+        if (pmapfind != pmap.end())
+            grad[j] = g[int(pmapfind->second - &pvals[0])];
     }
 }
 
 void SubSystem::calcGrad(Eigen::VectorXd &grad)
 {
-    calcGrad(plist, grad);
+    assert(grad.size() == psize);
+
+    calcJacobiValues();
+    grad.setZero();
+    for (int i=0; i < csize; i++) {
+        double err = clist[i]->error();
+        for (int k=jrows[i]; k < jrows[i+1]; k++)
+            grad[jcols[k]] += err * jvals[k];
+    }
 }
 
 double SubSystem::maxStep(VEC_pD &params, Eigen::VectorXd &xdir)
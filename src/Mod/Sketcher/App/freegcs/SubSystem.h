@@ -27,10 +27,12 @@
 #undef max
 
 #include <Eigen/Core>
+#include <Eigen/Sparse>
 #include "Constraints.h"
 
 namespace GCS
 {
+    typedef Eigen::SparseMatrix<double> SparseMatrix;
 
     class SubSystem
     {
@@ -43,7 +45,14 @@ namespace GCS
 //        JacobianMatrix jacobi;  // jacobi matrix of the residuals
         std::map<Constraint *,VEC_pD > c2p; // constraint to parameter adjacency list
         std::map<double *,std::vector<Constraint *> > p2c; // parameter to constraint adjacency list
+        VEC_I jrows;       // offsets of the rows of the constraints in jcols (csize+1)
+        VEC_I jcols;       // column indices of the non-zeros of the jacobi matrix
+        VEC_D jvals;       // values of the non-zeros of the jacobi matrix
+        VEC_I jslotrows;   // offsets of the parameter entries of the constraints in jslots (csize+1)
+        VEC_I jslots;      // non-zero every parameter entry contributes to, -1 for fixed parameters
+        VEC_D jslotvals;   // partial derivatives of all parameter entries
         void initialize(VEC_pD &params, MAP_pD_pD &reductionmap); // called by the constructors
+        void calcJacobiValues(); // fills jvals with one gradVec() call per constraint
     public:
         SubSystem(std::vector<Constraint *> &clist_, VEC_pD &params);
         SubSystem(std::vector<Constraint *> &clist_, VEC_pD &params,
@@ -69,6 +78,8 @@ namespace GCS
         void calcResidual(Eigen::VectorXd &r, double &err);
         void calcJacobi(VEC_pD &params, Eigen::MatrixXd &jacobi);
         void calcJacobi(Eigen::MatrixXd &jacobi);
+        void calcJacobi(SparseMatrix &jacobi);
+        int jacobiNonZeros() { return int(jcols.size()); }
         void calcGrad(VEC_pD &params, Eigen::VectorXd &grad);
         void calcGrad(Eigen::VectorXd &grad);
 
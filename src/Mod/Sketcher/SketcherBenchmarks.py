@@ -0,0 +1,56 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, Sketcher, BenchmarkApp
+from TestSketcherApp import CreateStairProfileSet, CreateDragChainSet, CreateDragPath
+
+
+def benchSolver():
+	# how the solver scales with the size of a fully constrained sketch
+	doc = FreeCAD.newDocument("SketcherBenchmark")
+	for count in [100, 200, 400, 800, 1600, 3200]:
+		profile = doc.addObject('Sketcher::SketchObject','SketchProfile')
+		CreateStairProfileSet(profile, count)
+		BenchmarkApp.measure("%d lines, %d constraints" % (count, len(profile.Constraints)), doc.recompute)
+		doc.removeObject(profile.Name)
+	FreeCAD.closeDocument(doc.Name)
+
+def benchDrag():
+	# time per drag step with one solver that keeps its state between the steps
+	# (warm start) and with a new solver for every step (cold start)
+	doc = FreeCAD.newDocument("SketcherBenchmark")
+	path = CreateDragPath(50)
+	for count in [100, 400]:
+		for warm in [False, True]:
+			chain = doc.addObject('Sketcher::SketchObject','SketchChain')
+			CreateDragChainSet(chain, count)
+			doc.recompute()
+			label = "drag %d lines, %s start" % (count, warm and "warm" or "cold")
+			times = BenchmarkApp.measure(label, Sketcher.dragPoint, chain, 0, 2, path, warm)
+			FreeCAD.Console.PrintMessage("%s: %.2f ms solver time per step\n" % (label, 1000.0 * sum(times) / len(times)))
+			doc.removeObject(chain.Name)
+	FreeCAD.closeDocument(doc.Name)
+
+def run():
+	benchSolver()
+	benchDrag()
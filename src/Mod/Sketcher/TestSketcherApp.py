@@ -81,7 +81,59 @@ def CreateSlotPlateInnerSet(SketchFeature):
 	SketchFeature.addGeometry(Part.ArcOfCircle(Part.Circle(App.Vector(192.422913,38.216347,0),App.Vector(0,0,1),45.315174),2.635158,3.602228))
 	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',7,2,8,1)) 
 	SketchFeature.addConstraint(Sketcher.Constraint('Coincident',8,2,5,1))
+
+def CreateStairProfileSet(SketchFeature, count):
+	# open profile of alternating horizontal and vertical lines with slightly
+	# displaced end points, fully constrained
+	x = 0.0
+	y = 0.0
+	for i in range(count):
+		offset = 0.05 * ((i * 7) % 5)
+		if i % 2 == 0:
+			SketchFeature.addGeometry(Part.Line(App.Vector(x,y,0),App.Vector(x+1.0+offset,y+offset,0)))
+			x = x+1.0
+		else:
+			SketchFeature.addGeometry(Part.Line(App.Vector(x,y,0),App.Vector(x+offset,y+1.0+offset,0)))
+			y = y+1.0
+	for i in range(count):
+		if i % 2 == 0:
+			SketchFeature.addConstraint(Sketcher.Constraint('Horizontal',i))
+		else:
+			SketchFeature.addConstraint(Sketcher.Constraint('Vertical',i))
+		SketchFeature.addConstraint(Sketcher.Constraint('Distance',i,1.0))
+		if i > 0:
+			SketchFeature.addConstraint(Sketcher.Constraint('Coincident',i-1,2,i,1))
+	SketchFeature.addConstraint(Sketcher.Constraint('DistanceX',0,1,0.0))
+	SketchFeature.addConstraint(Sketcher.Constraint('DistanceY',0,1,0.0))
 	
+def CreateDragChainSet(SketchFeature, count):
+	# the first line goes from a fixed point to the point to drag, it is followed
+	# by lines of unit length which are alternately horizontal and vertical, so
+	# the position of the dragged point determines the whole chain
+	SketchFeature.addGeometry(Part.Line(App.Vector(2,3,0),App.Vector(10,5,0)))
+	SketchFeature.addConstraint(Sketcher.Constraint('DistanceX',0,1,2.0))
+	SketchFeature.addConstraint(Sketcher.Constraint('DistanceY',0,1,3.0))
+	x = 10.0
+	y = 5.0
+	for i in range(1, count):
+		offset = 0.05 * ((i * 7) % 5)
+		if i % 2 == 1:
+			SketchFeature.addGeometry(Part.Line(App.Vector(x,y,0),App.Vector(x+1.0+offset,y+offset,0)))
+			x = x+1.0
+		else:
+			SketchFeature.addGeometry(Part.Line(App.Vector(x,y,0),App.Vector(x+offset,y+1.0+offset,0)))
+			y = y+1.0
+		if i == 1:
+			SketchFeature.addConstraint(Sketcher.Constraint('Horizontal',i))
+		else:
+			SketchFeature.addConstraint(Sketcher.Constraint('Perpendicular',i-1,i))
+		SketchFeature.addConstraint(Sketcher.Constraint('Distance',i,1.0))
+		SketchFeature.addConstraint(Sketcher.Constraint('Coincident',i-1,2,i,1))
+
+def CreateDragPath(count):
+	# small steps of the end point of the first line of CreateDragChainSet
+	return [App.Vector(10.0+0.2*i, 5.0+0.1*i, 0) for i in range(1, count+1)]
+
 
 
 #---------------------------------------------------------------------------
@@ -113,8 +165,77 @@ class SketcherSolverTestCases(unittest.TestCase):
 		CreateSlotPlateInnerSet(self.Slot)
 		self.Doc.recompute()
 		self.failUnless(len(self.Slot.Shape.Edges) == 9)
+
+	def testStairProfile(self):
+		# 400 parameters are above the threshold of the sparse linear algebra
+		profile = self.Doc.addObject('Sketcher::SketchObject','SketchProfile')
+		CreateStairProfileSet(profile, 100)
+		self.Doc.recompute()
+		self.failUnless(len(profile.Shape.Edges) == 100)
+		# all lines have unit length, so the profile ends at (50,50)
+		end = profile.getPoint(99,2)
+		self.failUnless((end - App.Vector(50,50,0)).Length < 1e-6)
+
+	def testGradients(self):
+		# the solver uses gradVec() of its constraints, it has to agree with grad()
+		sketch = self.Doc.addObject('Sketcher::SketchObject','SketchGradients')
+		sketch.addGeometry(Part.Line(App.Vector(0,0,0),App.Vector(40,5,0)))
+		sketch.addGeometry(Part.Line(App.Vector(45,10,0),App.Vector(60,40,0)))
+		sketch.addGeometry(Part.Line(App.Vector(-10,20,0),App.Vector(30,28,0)))
+		sketch.addGeometry(Part.Line(App.Vector(-20,-30,0),App.Vector(-5,-12,0)))
+		sketch.addGeometry(Part.Circle(App.Vector(10,-30,0),App.Vector(0,0,1),8))
+		sketch.addGeometry(Part.Circle(App.Vector(35,-30,0),App.Vector(0,0,1),12))
+		sketch.addGeometry(Part.ArcOfCircle(Part.Circle(App.Vector(70,-20,0),App.Vector(0,0,1),10),0.3,2.5))
+		sketch.addConstraint(Sketcher.Constraint('Coincident',0,2,1,1))
+		sketch.addConstraint(Sketcher.Constraint('DistanceX',0,1,2.0))
+		sketch.addConstraint(Sketcher.Constraint('Distance',1,30.0))
+		sketch.addConstraint(Sketcher.Constraint('Angle',3,0.9))
+		sketch.addConstraint(Sketcher.Constraint('Angle',0,1,0.8))
+		sketch.addConstraint(Sketcher.Constraint('Parallel',0,2))
+		sketch.addConstraint(Sketcher.Constraint('PointOnObject',3,1,2))
+		sketch.addConstraint(Sketcher.Constraint('Tangent',3,4))
+		sketch.addConstraint(Sketcher.Constraint('Tangent',4,5))
+		sketch.addConstraint(Sketcher.Constraint('Symmetric',1,1,1,2,3))
+		deviations = Sketcher.checkGradients(sketch)
+		# all eleven constraint types of the solver are covered
+		self.failUnless(sorted(deviations.keys()) == range(1,12))
+		for type, deviation in deviations.items():
+			self.failUnless(deviation < 1e-9, "gradient mismatch for constraint type %d" % type)
 	
 	
+	def testDragWarmStart(self):
+		# a drag with one solver that keeps its state between the steps must end
+		# where a sequence of movePoint() calls, each solved from scratch, ends
+		path = CreateDragPath(20)
+		sketches = []
+		for name in ['SketchDragWarm','SketchDragCold']:
+			sketch = self.Doc.addObject('Sketcher::SketchObject',name)
+			CreateDragChainSet(sketch, 10)
+			# a second component which is not affected by the drag
+			sketch.addGeometry(Part.Circle(App.Vector(-20,0,0),App.Vector(0,0,1),5))
+			sketch.addConstraint(Sketcher.Constraint('Radius',10,4.0))
+			sketches.append(sketch)
+		self.Doc.recompute()
+		warm, cold = sketches
+		times = Sketcher.dragPoint(warm, 0, 2, path)
+		self.failUnless(len(times) == len(path))
+		for point in path:
+			cold.movePoint(0, 2, point)
+		self.failUnless((warm.getPoint(0,2) - path[-1]).Length < 1e-6)
+		for i in range(10):
+			for pos in [1,2]:
+				self.failUnless((warm.getPoint(i,pos) - cold.getPoint(i,pos)).Length < 1e-6,
+					"point %d of line %d differs" % (pos, i))
+		self.failUnless((warm.getPoint(10,3) - cold.getPoint(10,3)).Length < 1e-6)
+		self.failUnless(abs(warm.Geometry[10].Radius - 4.0) < 1e-6)
+		# the drag without warm start is the same as the movePoint() calls
+		Sketcher.dragPoint(warm, 0, 2, list(reversed(path)), False)
+		for point in reversed(path):
+			cold.movePoint(0, 2, point)
+		for i in range(10):
+			for pos in [1,2]:
+				self.failUnless((warm.getPoint(i,pos) - cold.getPoint(i,pos)).Length < 1e-6)
+	
 	def tearDown(self):
 		#closing doc
 		FreeCAD.closeDocument("SketchSolverTest")
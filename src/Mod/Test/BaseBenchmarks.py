@@ -0,0 +1,44 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, BenchmarkApp
+
+
+def lookup(grp, count, reset):
+    for i in xrange(count):
+        grp.Notify(reset)
+        grp.GetFloat("Value99")
+
+def benchParameterCache():
+    # compares the lookup from the DOM with the one from the cache
+    grp = FreeCAD.ParamGet("System parameter:Benchmark")
+    for i in range(100):
+        grp.SetFloat("Value%d" % i,i)
+    count = 100000
+    # resetting the looked up entry forces the DOM lookup
+    BenchmarkApp.measure("%d lookups from the DOM" % count, lookup, grp, count, "Value99")
+    BenchmarkApp.measure("%d lookups from the cache" % count, lookup, grp, count, "Value00")
+    grp.Clear()
+
+def run():
+    benchParameterCache()
@@ -182,7 +182,23 @@ class ParameterTestCase(unittest.TestCase):
         Temp.Import(TempPath)
         self.failUnless(Temp.GetFloat("ExTest") == 4711.4711,"ExportImport error")
         Temp = 0
-        
+
+    def testCache(self):
+        # the values are cached after the first read, every change must reset them
+        self.failUnless(self.TestPar.GetFloat("Cache",1.5) == 1.5,"Preset error at cached Float")
+        self.TestPar.SetFloat("Cache",2.5)
+        self.failUnless(self.TestPar.GetFloat("Cache",1.5) == 2.5,"Cache not reset at Float")
+        self.TestPar.SetInt("Cache",3)
+        self.failUnless(self.TestPar.GetInt("Cache") == 3,"Cache not reset at Int")
+        self.failUnless(self.TestPar.GetFloat("Cache") == 2.5,"Cache mixed up types")
+        Temp = FreeCAD.ParamGet("System parameter:Test")
+        Temp.SetString("Cache","abc")
+        self.failUnless(self.TestPar.GetString("Cache") == "abc","Cache not shared by the handles")
+        self.TestPar.RemFloat("Cache")
+        self.failUnless(self.TestPar.GetFloat("Cache",1.5) == 1.5,"Cache not reset at deletion")
+        self.TestPar.Clear()
+        self.failUnless(self.TestPar.GetInt("Cache",7) == 7,"Cache not reset at Clear")
+
     def tearDown(self):
         #remove all
         TestPar = FreeCAD.ParamGet("System parameter:Test")
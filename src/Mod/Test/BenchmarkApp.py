@@ -0,0 +1,53 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, time
+
+# The benchmarks are kept apart from the unit tests because they take long
+# and only print timings. Each module listed here has a function run().
+# Run all of them with
+#   import BenchmarkApp; BenchmarkApp.runAll()
+# or a single one with e.g. BenchmarkApp.run("SketcherBenchmarks").
+Benchmarks = [
+    "BaseBenchmarks",
+    "DocumentBenchmarks",
+    "SketcherBenchmarks",
+    "FemBenchmarks",
+    "MeshBenchmarks",
+]
+
+
+def measure(label, func, *args):
+    """ Calls func with args, prints the elapsed time and returns the result """
+    start = time.time()
+    result = func(*args)
+    FreeCAD.Console.PrintMessage("%s: %.2f s\n" % (label, time.time() - start))
+    return result
+
+def run(name):
+    FreeCAD.Console.PrintMessage("--- %s\n" % name)
+    __import__(name).run()
+
+def runAll():
+    for name in Benchmarks:
+        run(name)
@@ -305,6 +305,41 @@ class UndoRedoCases(unittest.TestCase):
     self.Doc.clearUndos()
     self.assertEqual(self.Doc.ActiveObject,None)
 
+  def testUndoListRange(self):
+    # switch on the Undo
+    self.Doc.UndoMode = 1
+    obj = self.Doc.getObject("Base")
+    pts = [(float(i),0.0,0.0) for i in range(10000)]
+    flt = [float(i) for i in range(10000)]
+
+    self.Doc.openTransaction("Transaction1")
+    obj.VectorList = pts
+    obj.FloatList = flt
+    self.Doc.commitTransaction()
+
+    # the size doesn't change, so only the modified values are recorded
+    self.Doc.openTransaction("Transaction2")
+    pts[5000] = (0.5,0.5,0.5)
+    flt[5000] = 0.5
+    obj.VectorList = pts
+    obj.FloatList = flt
+    pts[5001] = (0.25,0.25,0.25)
+    obj.VectorList = pts
+    self.Doc.commitTransaction()
+    self.failUnless(self.Doc.UndoRedoMemSize < 10000)
+
+    self.Doc.undo()
+    self.assertEqual(obj.VectorList[5000].x, 5000.0)
+    self.assertEqual(obj.VectorList[5001].x, 5001.0)
+    self.assertEqual(obj.FloatList[5000], 5000.0)
+    self.Doc.redo()
+    self.assertEqual(obj.VectorList[5000].y, 0.5)
+    self.assertEqual(obj.VectorList[5001].y, 0.25)
+    self.assertEqual(obj.FloatList[5000], 0.5)
+    self.Doc.undo()
+    self.Doc.undo()
+    self.assertEqual(len(obj.VectorList), 1)
+
   def testUndo(self):
     # switch on the Undo
     self.Doc.UndoMode = 1
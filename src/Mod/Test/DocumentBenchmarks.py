@@ -0,0 +1,42 @@
+#***************************************************************************
+#*   (c) FreeCAD contributors 2026                                         *
+#*                                                                         *
+#*   This file is part of the FreeCAD CAx development system.              *
+#*                                                                         *
+#*   This program is free software; you can redistribute it and/or modify  *
+#*   it under the terms of the GNU Lesser General Public License (LGPL)    *
+#*   as published by the Free Software Foundation; either version 2 of     *
+#*   the License, or (at your option) any later version.                   *
+#*   for detail see the LICENCE text file.                                 *
+#*                                                                         *
+#*   FreeCAD is distributed in the hope that it will be useful,            *
+#*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+#*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+#*   GNU Library General Public License for more details.                  *
+#*                                                                         *
+#*   You should have received a copy of the GNU Library General Public     *
+#*   License along with FreeCAD; if not, write to the Free Software        *
+#*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  *
+#*   USA                                                                   *
+#*                                                                         *
+#***************************************************************************/
+
+import FreeCAD, os, tempfile, BenchmarkApp
+
+
+def benchRestore():
+    # restores a document with many objects, this mainly stresses
+    # the lookup of types and properties by name
+    doc = FreeCAD.newDocument("RestoreBenchmark")
+    for i in range(10000):
+        doc.addObject("App::FeatureTest","Feature")
+    fileName = os.path.join(tempfile.gettempdir(), "RestoreBenchmark.FCStd")
+    doc.FileName = fileName
+    doc.save()
+    FreeCAD.closeDocument(doc.Name)
+    doc = BenchmarkApp.measure("restore of 10000 objects", FreeCAD.open, fileName)
+    FreeCAD.closeDocument(doc.Name)
+    os.remove(fileName)
+
+def run():
+    benchRestore()
@@ -48,6 +48,9 @@ class TestCmd:
         QtUnitGui.addTest("TestSketcherApp")
         QtUnitGui.addTest("TestPartApp")
         QtUnitGui.addTest("TestPartDesignApp")
+        QtUnitGui.addTest("TestFemApp")
+        QtUnitGui.addTest("TestPointsApp")
+        QtUnitGui.addTest("TestInspectionApp")
         QtUnitGui.addTest("Workbench")
         QtUnitGui.addTest("Menu")
         QtUnitGui.addTest("Menu.MenuDeleteCases")
@@ -56,6 +56,13 @@ void ZipOutputStream::putNextEntry(const std::string& entryName) {
 }
 
 
+void ZipOutputStream::putRawEntry( const ZipCDirEntry &entry, const char *data, 
+                                   uint32 compressed_size, uint32 size, uint32 crc,
+                                   StorageMethod method ) {
+  ozf->putRawEntry( entry, data, compressed_size, size, crc, method ) ;
+}
+
+
 void ZipOutputStream::setComment( const std::string &comment ) {
   ozf->setComment( comment ) ;
 }
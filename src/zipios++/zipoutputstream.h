@@ -54,6 +54,13 @@ public:
   */
   void putNextEntry(const std::string& entryName);
 
+  /** Writes a complete entry with data that was already compressed
+      by the caller. See ZipOutputStreambuf::putRawEntry().
+  */
+  void putRawEntry( const ZipCDirEntry &entry, const char *data, 
+                    uint32 compressed_size, uint32 size, uint32 crc,
+                    StorageMethod method ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const std::string& comment ) ;
 
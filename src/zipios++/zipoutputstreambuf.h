@@ -49,6 +49,20 @@ public:
       entry. */
   void putNextEntry( const ZipCDirEntry &entry ) ;
 
+  /** Writes a complete entry whose data has already been compressed
+      (or not, if method is STORED) by the caller. This allows to
+      compress several entries concurrently and only write them
+      serially.
+      @param entry the entry to write.
+      @param data the (compressed) data.
+      @param compressed_size number of bytes in data.
+      @param size the uncompressed size.
+      @param crc the crc32 of the uncompressed data.
+      @param method the method that was used to compress data. */
+  void putRawEntry( const ZipCDirEntry &entry, const char *data, 
+                    uint32 compressed_size, uint32 size, uint32 crc,
+                    StorageMethod method ) ;
+
   /** Sets the global comment for the Zip archive. */
   void setComment( const string &comment ) ;
 